@@ -0,0 +1,159 @@
+// this_file: benchmarks/bench_arithmetickernels.cpp
+
+#include <benchmark/benchmark.h>
+#include <vector>
+#include <cstdlib>
+#include <ibp/imgproc/util.h>
+#include <ibp/imgproc/lut.h>
+#include <ibp/imgproc/pixelblending.h>
+
+using namespace ibp::imgproc;
+
+namespace {
+
+const int kPixels = 4096 * 1024;
+
+std::vector<BGRA> randomPixels(unsigned int seed)
+{
+    std::vector<BGRA> pixels(kPixels);
+    srand(seed);
+    for (BGRA & p : pixels)
+    {
+        p.b = rand() & 255;
+        p.g = rand() & 255;
+        p.r = rand() & 255;
+        p.a = rand() & 255;
+    }
+    return pixels;
+}
+
+void BM_PremultiplyLookupTable(benchmark::State & state)
+{
+    std::vector<BGRA> source = randomPixels(1), pixels;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        pixels = source;
+        state.ResumeTiming();
+        for (BGRA & p : pixels)
+        {
+            p.b = lut01[p.b][p.a];
+            p.g = lut01[p.g][p.a];
+            p.r = lut01[p.r][p.a];
+        }
+        benchmark::DoNotOptimize(pixels.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kPixels);
+}
+BENCHMARK(BM_PremultiplyLookupTable);
+
+void BM_PremultiplyArithmetic(benchmark::State & state)
+{
+    std::vector<BGRA> source = randomPixels(1), pixels;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        pixels = source;
+        state.ResumeTiming();
+        for (BGRA & p : pixels)
+        {
+            p.b = normalizedMultiply(p.b, p.a);
+            p.g = normalizedMultiply(p.g, p.a);
+            p.r = normalizedMultiply(p.r, p.a);
+        }
+        benchmark::DoNotOptimize(pixels.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kPixels);
+}
+BENCHMARK(BM_PremultiplyArithmetic);
+
+void BM_PremultiplySpan(benchmark::State & state)
+{
+    std::vector<BGRA> source = randomPixels(1), pixels;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        pixels = source;
+        state.ResumeTiming();
+        premultiplyBGRA(pixels.data(), kPixels);
+        benchmark::DoNotOptimize(pixels.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kPixels);
+}
+BENCHMARK(BM_PremultiplySpan);
+
+void BM_PostmultiplyLookupTable(benchmark::State & state)
+{
+    std::vector<BGRA> source = randomPixels(2), pixels;
+    premultiplyBGRA(source.data(), kPixels);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        pixels = source;
+        state.ResumeTiming();
+        for (BGRA & p : pixels)
+        {
+            p.b = lut02[p.b][p.a];
+            p.g = lut02[p.g][p.a];
+            p.r = lut02[p.r][p.a];
+        }
+        benchmark::DoNotOptimize(pixels.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kPixels);
+}
+BENCHMARK(BM_PostmultiplyLookupTable);
+
+void BM_PostmultiplyArithmetic(benchmark::State & state)
+{
+    std::vector<BGRA> source = randomPixels(2), pixels;
+    premultiplyBGRA(source.data(), kPixels);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        pixels = source;
+        state.ResumeTiming();
+        for (BGRA & p : pixels)
+        {
+            p.b = normalizedDivide(p.b, p.a);
+            p.g = normalizedDivide(p.g, p.a);
+            p.r = normalizedDivide(p.r, p.a);
+        }
+        benchmark::DoNotOptimize(pixels.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kPixels);
+}
+BENCHMARK(BM_PostmultiplyArithmetic);
+
+void BM_PostmultiplySpan(benchmark::State & state)
+{
+    std::vector<BGRA> source = randomPixels(2), pixels;
+    premultiplyBGRA(source.data(), kPixels);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        pixels = source;
+        state.ResumeTiming();
+        postmultiplyBGRA(pixels.data(), kPixels);
+        benchmark::DoNotOptimize(pixels.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kPixels);
+}
+BENCHMARK(BM_PostmultiplySpan);
+
+// Whole blend as built, run once with IBP_USE_ARITHMETIC_KERNELS=ON and once with OFF to compare
+void BM_BlendColors(benchmark::State & state)
+{
+    std::vector<BGRA> src = randomPixels(3), dst = randomPixels(4), blend(kPixels);
+    void (*blendFunction)(BGRA, BGRA, BGRA &) = blendColors[state.range(0)];
+    for (auto _ : state)
+    {
+        for (int i = 0; i < kPixels; i++)
+            blendFunction(src[i], dst[i], blend[i]);
+        benchmark::DoNotOptimize(blend.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kPixels);
+    state.SetLabel(colorCompositionModeEnumToString((ColorCompositionMode)state.range(0)).toStdString());
+}
+BENCHMARK(BM_BlendColors)->DenseRange(ColorCompositionMode_Normal, ColorCompositionMode_Luminosity);
+
+}
@@ -0,0 +1,136 @@
+// this_file: benchmarks/bench_itkn4warmstart.cpp
+
+#include <benchmark/benchmark.h>
+#include <math.h>
+#include <itkImage.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+#include <itkN4BiasFieldCorrectionImageFilter.h>
+#include <itkBSplineControlPointImageFilter.h>
+
+namespace {
+
+// the N4 setup of imagefilter_itkn4iihc: a single fitting level over the lightness resized to 128 pixels
+typedef itk::Image<float, 2> ImageType;
+typedef itk::Image<unsigned char, 2> MaskImageType;
+typedef itk::N4BiasFieldCorrectionImageFilter<ImageType, MaskImageType, ImageType> CorrecterType;
+typedef CorrecterType::BiasFieldControlPointLatticeType LatticeType;
+typedef itk::BSplineControlPointImageFilter<LatticeType, CorrecterType::ScalarImageType> BSplinerType;
+
+const int kWidth = 128, kHeight = 96, kGridSize = 3, kSplineOrder = 3, kMaximumIterations = 50;
+
+// blocks of reflectance under a smooth illumination that drifts a little from frame to frame, as in a session
+ImageType::Pointer frame(int k)
+{
+    ImageType::Pointer image = ImageType::New();
+    ImageType::RegionType region;
+    ImageType::SizeType size;
+    size[0] = kWidth;
+    size[1] = kHeight;
+    region.SetSize(size);
+    image->SetRegions(region);
+    image->Allocate();
+
+    itk::ImageRegionIterator<ImageType> it(image, region);
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+        const int x = (int)it.GetIndex()[0], y = (int)it.GetIndex()[1];
+        const double u = (double)x / kWidth, v = (double)y / kHeight;
+        const double reflectance = .3 + .6 * (((x / 16) * 7 + (y / 16) * 3) % 5) / 4.;
+        const double illumination = exp(.5 * (u - .5) + .4 * (v - .4 - .02 * k) * (v - .4 - .02 * k) - .2 * u * v);
+        it.Set((float)(reflectance * illumination));
+    }
+    return image;
+}
+
+// N4 on image, returning the log bias lattice and the iterations it took
+LatticeType::Pointer fit(ImageType * image, double convergenceThreshold, unsigned int & iterations)
+{
+    CorrecterType::Pointer correcter = CorrecterType::New();
+    CorrecterType::ArrayType numberOfControlPoints;
+    numberOfControlPoints.Fill(kGridSize + 1);
+    correcter->SetNumberOfControlPoints(numberOfControlPoints);
+    correcter->SetSplineOrder(kSplineOrder);
+    CorrecterType::VariableSizeArrayType maximumNumberOfIterations(1);
+    maximumNumberOfIterations.Fill(kMaximumIterations);
+    correcter->SetNumberOfFittingLevels(1);
+    correcter->SetMaximumNumberOfIterations(maximumNumberOfIterations);
+    correcter->SetConvergenceThreshold(convergenceThreshold);
+    correcter->SetInput(image);
+    correcter->Update();
+    iterations = correcter->GetElapsedIterations();
+
+    const LatticeType * fitted = correcter->GetLogBiasFieldControlPointLattice();
+    LatticeType::Pointer lattice = LatticeType::New();
+    lattice->CopyInformation(fitted);
+    lattice->SetRegions(fitted->GetLargestPossibleRegion());
+    lattice->Allocate();
+    itk::ImageRegionConstIterator<LatticeType> itFitted(fitted, fitted->GetLargestPossibleRegion());
+    itk::ImageRegionIterator<LatticeType> itLattice(lattice, lattice->GetLargestPossibleRegion());
+    for (itFitted.GoToBegin(), itLattice.GoToBegin(); !itFitted.IsAtEnd(); ++itFitted, ++itLattice)
+        itLattice.Set(itFitted.Get());
+    return lattice;
+}
+
+// image with the field of lattice divided out, as the warm start of imagefilter_itkn4iihc does
+ImageType::Pointer divideField(ImageType * image, LatticeType * lattice)
+{
+    BSplinerType::Pointer bspliner = BSplinerType::New();
+    bspliner->SetInput(lattice);
+    bspliner->SetSplineOrder(kSplineOrder);
+    bspliner->SetSize(image->GetLargestPossibleRegion().GetSize());
+    bspliner->SetOrigin(image->GetOrigin());
+    bspliner->SetDirection(image->GetDirection());
+    bspliner->SetSpacing(image->GetSpacing());
+    bspliner->Update();
+
+    ImageType::Pointer divided = ImageType::New();
+    divided->CopyInformation(image);
+    divided->SetRegions(image->GetLargestPossibleRegion());
+    divided->Allocate();
+    itk::ImageRegionIterator<CorrecterType::ScalarImageType> itField(
+        bspliner->GetOutput(), bspliner->GetOutput()->GetLargestPossibleRegion());
+    itk::ImageRegionIterator<ImageType> itImage(image, image->GetLargestPossibleRegion());
+    itk::ImageRegionIterator<ImageType> itDivided(divided, divided->GetLargestPossibleRegion());
+    for (itField.GoToBegin(), itImage.GoToBegin(), itDivided.GoToBegin(); !itField.IsAtEnd();
+         ++itField, ++itImage, ++itDivided)
+        itDivided.Set(itImage.Get() / exp(itField.Get()[0]));
+    return divided;
+}
+
+// args: convergence threshold in units of 1e-4. Cold: the second frame of a session on its own
+void BM_N4ColdStart(benchmark::State & state)
+{
+    const double convergenceThreshold = state.range(0) * 1e-4;
+    ImageType::Pointer image = frame(1);
+    unsigned int iterations = 0;
+
+    for (auto _ : state)
+    {
+        LatticeType::Pointer lattice = fit(image, convergenceThreshold, iterations);
+        benchmark::DoNotOptimize(lattice.GetPointer());
+    }
+    state.counters["iterations"] = iterations;
+}
+BENCHMARK(BM_N4ColdStart)->Arg(10)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// args: convergence threshold in units of 1e-4. Warm: the second frame with the field of the first divided out,
+// the division included in the time
+void BM_N4WarmStart(benchmark::State & state)
+{
+    const double convergenceThreshold = state.range(0) * 1e-4;
+    ImageType::Pointer first = frame(0), image = frame(1);
+    unsigned int iterations = 0;
+    LatticeType::Pointer previous = fit(first, convergenceThreshold, iterations);
+
+    for (auto _ : state)
+    {
+        ImageType::Pointer divided = divideField(image, previous);
+        LatticeType::Pointer lattice = fit(divided, convergenceThreshold, iterations);
+        benchmark::DoNotOptimize(lattice.GetPointer());
+    }
+    state.counters["iterations"] = iterations;
+}
+BENCHMARK(BM_N4WarmStart)->Arg(10)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+} // namespace
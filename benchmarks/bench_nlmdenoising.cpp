@@ -0,0 +1,70 @@
+// this_file: benchmarks/bench_nlmdenoising.cpp
+
+#include <benchmark/benchmark.h>
+#include <opencv2/photo.hpp>
+#include <ibp/imgproc/tiling.h>
+
+using namespace ibp::imgproc;
+
+namespace {
+
+// one sigma per band of the sigma -> templateWindowSize table of imagefilter_nlmdenoising, with the same parameters
+struct NLMBand
+{
+    double sigma, h, hColor;
+    int templateWindowSize, searchWindowSize;
+};
+
+NLMBand band(double sigma)
+{
+    NLMBand b;
+    b.sigma = sigma;
+    b.h = sigma * (sigma <= 30. ? .4 : sigma <= 75. ? .35 : .3);
+    b.hColor = sigma * (sigma <= 25. ? .55 : sigma <= 55. ? .4 : .35);
+    b.templateWindowSize = sigma <= 15. ? 3 : sigma <= 30. ? 5 : sigma <= 45. ? 7 : sigma <= 75. ? 9 : 11;
+    b.searchWindowSize = sigma <= 37.5 ? 21 : 35;
+    return b;
+}
+
+cv::Mat noisyImage(double sigma)
+{
+    cv::Mat image(768, 1024, CV_8UC3, cv::Scalar(90, 140, 200)), noise(image.size(), CV_16SC3);
+    cv::randn(noise, cv::Scalar::all(0), cv::Scalar::all(sigma));
+    image.convertTo(image, CV_16SC3);
+    image += noise;
+    image.convertTo(image, CV_8UC3);
+    return image;
+}
+
+// args: sigma, colored (0 or 1), tiled (0 or 1)
+void BM_NLMDenoising(benchmark::State & state)
+{
+    const NLMBand b = band(state.range(0));
+    const bool colored = state.range(1) != 0, tiled = state.range(2) != 0;
+    const cv::Mat src = noisyImage(b.sigma);
+    cv::Mat dst(src.size(), src.type());
+    const TileFunction denoise = [&](const cv::Mat & tile, cv::Mat & out)
+    {
+        if (colored)
+            cv::fastNlMeansDenoisingColored(tile, out, b.h, b.hColor, b.templateWindowSize, b.searchWindowSize);
+        else
+            cv::fastNlMeansDenoising(tile, out, b.h, b.templateWindowSize, b.searchWindowSize);
+    };
+
+    for (auto _ : state)
+    {
+        if (tiled)
+            parallelForTiles(src, dst, 256, b.searchWindowSize / 2 + b.templateWindowSize / 2, denoise);
+        else
+            denoise(src, dst);
+        benchmark::DoNotOptimize(dst.data);
+    }
+    state.counters["Mpx/s"] = benchmark::Counter(state.iterations() * src.total() / 1e6,
+                                                 benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_NLMDenoising)
+    ->ArgsProduct({{10, 25, 40, 60, 90}, {0, 1}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
@@ -0,0 +1,98 @@
+// this_file: benchmarks/bench_tvdenoising.cpp
+
+#include <benchmark/benchmark.h>
+#include <math.h>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/photo.hpp>
+#include <ibp/imgproc/tvdenoising.h>
+
+using namespace ibp::imgproc;
+
+namespace {
+
+// flat regions, a disk, a ramp and a checkerboard, and the same with gaussian noise
+void images(cv::Mat & clean, cv::Mat & noisy)
+{
+    clean = cv::Mat(768, 1024, CV_8UC1, cv::Scalar(60));
+    clean.colRange(340, 1024).setTo(cv::Scalar(160));
+    cv::circle(clean, cv::Point(700, 400), 150, cv::Scalar(210), -1);
+    for (int y = 0; y < clean.rows; y++)
+        for (int x = 0; x < 340; x++)
+            clean.at<uchar>(y, x) += (uchar)(40 * (((x / 64) + (y / 64)) % 2) + y / 16);
+    cv::Mat noise(clean.size(), CV_16SC1);
+    cv::randn(noise, cv::Scalar::all(0), cv::Scalar::all(25));
+    clean.convertTo(noisy, CV_16SC1);
+    noisy += noise;
+    noisy.convertTo(noisy, CV_8UC1);
+}
+
+// the TV-L1 energy that both solvers minimize, with values in [0, 1]
+double energy(const cv::Mat & u, const cv::Mat & f, double lambda)
+{
+    double e = 0.;
+    for (int y = 0; y < u.rows; y++)
+    {
+        for (int x = 0; x < u.cols; x++)
+        {
+            const double v = u.at<uchar>(y, x) / 255.;
+            const double dx = x + 1 < u.cols ? u.at<uchar>(y, x + 1) / 255. - v : 0.;
+            const double dy = y + 1 < u.rows ? u.at<uchar>(y + 1, x) / 255. - v : 0.;
+            e += sqrt(dx * dx + dy * dy) + lambda * fabs(v - f.at<uchar>(y, x) / 255.);
+        }
+    }
+    return e;
+}
+
+void report(benchmark::State & state, const cv::Mat & dst, const cv::Mat & clean, const cv::Mat & noisy,
+            double lambda)
+{
+    state.counters["energy"] = energy(dst, noisy, lambda);
+    state.counters["PSNR"] = cv::PSNR(dst, clean);
+}
+
+// lambda of imagefilter_tvdenoising for strengths of 80, 70 and 50
+const double kLambdas[] = { .08, .27, 1.25 };
+
+// args: lambda index, iterations. The time to reach an energy is read off the rows of both benchmarks
+void BM_TVL1SingleScale(benchmark::State & state)
+{
+    const double lambda = kLambdas[state.range(0)];
+    const int iterations = state.range(1);
+    cv::Mat clean, noisy, dst;
+    images(clean, noisy);
+    const std::vector<cv::Mat> observations(1, noisy);
+
+    for (auto _ : state)
+    {
+        cv::denoise_TVL1(observations, dst, lambda, iterations);
+        benchmark::DoNotOptimize(dst.data);
+    }
+    report(state, dst, clean, noisy, lambda);
+}
+BENCHMARK(BM_TVL1SingleScale)
+    ->ArgsProduct({{0, 1, 2}, {10, 30, 60, 100}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// args: lambda index, maximum iterations per level, tolerance in units of 1e-5
+void BM_TVL1Multiscale(benchmark::State & state)
+{
+    const double lambda = kLambdas[state.range(0)];
+    const int iterations = state.range(1);
+    const double tolerance = state.range(2) * 1e-5;
+    cv::Mat clean, noisy, dst;
+    images(clean, noisy);
+
+    for (auto _ : state)
+    {
+        denoiseTVL1(noisy, dst, lambda, iterations, 3, tolerance);
+        benchmark::DoNotOptimize(dst.data);
+    }
+    report(state, dst, clean, noisy, lambda);
+}
+BENCHMARK(BM_TVL1Multiscale)
+    ->ArgsProduct({{0, 1, 2}, {100}, {100, 30, 10}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
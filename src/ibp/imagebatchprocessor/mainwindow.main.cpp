@@ -287,6 +287,14 @@ bool MainWindow::applyFiltersAndSave(const QString &filterListFile,
     mViewEditImageFilterList.startProcessing();
     loop.exec(); // Wait for processing to complete
 
+    // Log the stages timed by the filters, for profiling
+    for (int i = 0; i < mViewEditImageFilterList.count(); i++)
+    {
+        const QList<QPair<QString, double> > timings = mViewEditImageFilterList.stageTimings(i);
+        for (int j = 0; j < timings.size(); j++)
+            qDebug() << "Filter" << i + 1 << "stage" << timings.at(j).first << "took" << timings.at(j).second << "ms";
+    }
+
     // Save output
     qDebug() << "Saving output image...";
     logImageInfo("Output", mViewEditOutputImage);
@@ -0,0 +1,145 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <opencv2/imgproc.hpp>
+#include <vector>
+#include <algorithm>
+
+#include "biasfieldcache.h"
+#include "util.h"
+
+namespace ibp {
+namespace imgproc {
+
+namespace {
+
+const int kMaximumCachedBiasFields = 16;
+
+cv::Size storedSize(cv::Size size)
+{
+    if (size.width <= kBiasFieldCacheMaximumSize && size.height <= kBiasFieldCacheMaximumSize)
+        return size;
+    if (size.width > size.height)
+        return cv::Size(kBiasFieldCacheMaximumSize,
+                        qMax(1, size.height * kBiasFieldCacheMaximumSize / size.width));
+    return cv::Size(qMax(1, size.width * kBiasFieldCacheMaximumSize / size.height), kBiasFieldCacheMaximumSize);
+}
+
+cv::Mat medianOfFields(const std::vector<cv::Mat> & frames)
+{
+    const int n = (int)frames.size();
+    if (n == 1)
+        return frames[0];
+
+    cv::Mat median(frames[0].size(), CV_32FC1);
+    parallelForRows(median.rows, qMax(1, 16384 / median.cols), [&](int startRow, int endRow)
+    {
+        std::vector<float> values(n);
+        for (int y = startRow; y < endRow; y++)
+        {
+            float * bitsMedian = median.ptr<float>(y);
+            for (int x = 0; x < median.cols; x++)
+            {
+                for (int i = 0; i < n; i++)
+                    values[i] = frames[i].ptr<float>(y)[x];
+                std::nth_element(values.begin(), values.begin() + n / 2, values.end());
+                bitsMedian[x] = values[n / 2];
+            }
+        }
+    });
+    return median;
+}
+
+}
+
+bool BiasFieldCache::find(cv::Size size, cv::Mat & field) const
+{
+    cv::Mat median;
+    {
+        QMutexLocker locker(&mMutex);
+        QHash<QPair<int, int>, CachedBiasField>::const_iterator i =
+            mFields.constFind(qMakePair(size.width, size.height));
+        if (i == mFields.constEnd() || i.value().median.empty())
+            return false;
+        // the median is never written again, so it can be shared outside the lock
+        median = i.value().median;
+    }
+
+    cv::Mat resized;
+    if (median.size() != size)
+        cv::resize(median, resized, size, 0, 0, cv::INTER_LINEAR);
+    else
+        resized = median;
+    resized.convertTo(field, CV_8UC1);
+    return true;
+}
+
+void BiasFieldCache::add(const cv::Mat & field, int nFrames)
+{
+    CV_Assert(field.type() == CV_8UC1 && nFrames > 0);
+
+    cv::Mat stored;
+    const cv::Size size = storedSize(field.size());
+    if (size != field.size())
+        cv::resize(field, stored, size, 0, 0, cv::INTER_AREA);
+    else
+        stored = field;
+    stored.convertTo(stored, CV_32FC1);
+
+    const QPair<int, int> k = qMakePair(field.cols, field.rows);
+    std::vector<cv::Mat> frames;
+    {
+        QMutexLocker locker(&mMutex);
+        if (!mFields.contains(k) && mFields.size() >= kMaximumCachedBiasFields)
+            mFields.clear();
+        CachedBiasField & cached = mFields[k];
+        // images processed in parallel may have estimated their fields while the median was being found
+        if (!cached.median.empty() || (int)cached.frames.size() >= nFrames)
+            return;
+        cached.frames.push_back(stored);
+        if ((int)cached.frames.size() < nFrames)
+            return;
+        frames = cached.frames;
+    }
+
+    const cv::Mat median = medianOfFields(frames);
+
+    QMutexLocker locker(&mMutex);
+    QHash<QPair<int, int>, CachedBiasField>::iterator i = mFields.find(k);
+    if (i == mFields.end())
+        return;
+    i.value().median = median;
+    i.value().frames.clear();
+}
+
+void BiasFieldCache::clear()
+{
+    QMutexLocker locker(&mMutex);
+    mFields.clear();
+}
+
+}}
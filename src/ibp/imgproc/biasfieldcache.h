@@ -0,0 +1,78 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef IBP_IMGPROC_BIASFIELDCACHE_H
+#define IBP_IMGPROC_BIASFIELDCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <opencv2/core.hpp>
+#include <vector>
+
+namespace ibp {
+namespace imgproc {
+
+/*******************************************************
+** Illumination (bias) fields shared by the images of a
+** batch, which in microscopy or document scanning all
+** come from the same session. A filter holds one cache,
+** shared with its copies, and starts a new one when its
+** estimation parameters change; as a batch loads its
+** own filters, fields never leak between batches. The
+** fields estimated for the first nFrames images of each
+** size are kept, and once there are nFrames of them
+** their per pixel median is found for every later image
+** of that size, which then only needs the correction
+** step. Fields are CV_8UC1 images of the full size;
+** being smooth, they are stored as CV_32FC1 with at most
+** kBiasFieldCacheMaximumSize pixels on the long side.
+** All functions are thread safe.
+********************************************************/
+const int kBiasFieldCacheMaximumSize = 512;
+
+class BiasFieldCache
+{
+public:
+    bool find(cv::Size size, cv::Mat & field) const;
+    void add(const cv::Mat & field, int nFrames);
+    void clear();
+
+private:
+    struct CachedBiasField
+    {
+        // the fields of the first frames, until there are as many as asked for
+        std::vector<cv::Mat> frames;
+        // their median, empty until then
+        cv::Mat median;
+    };
+
+    mutable QMutex mMutex;
+    QHash<QPair<int, int>, CachedBiasField> mFields;
+};
+
+} // namespace imgproc
+} // namespace ibp
+
+#endif // IBP_IMGPROC_BIASFIELDCACHE_H
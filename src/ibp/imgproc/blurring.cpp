@@ -0,0 +1,550 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <opencv2/imgproc.hpp>
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+#include "blurring.h"
+#include "util.h"
+#include "../misc/util.h"
+
+namespace ibp {
+namespace imgproc {
+
+// passes of the stacked box filter, four keep the mean error around one grey level against a true Gaussian
+static const int kBoxPasses = 4;
+// columns (times channels) blurred together in the vertical passes
+static const int kColumnStripWidth = 64;
+
+// index of the element i of a signal of length n extended with cv::BORDER_REFLECT_101
+static inline int reflect101(int i, int n)
+{
+    if (n == 1)
+        return 0;
+    const int period = 2 * n - 2;
+    i %= period;
+    if (i < 0)
+        i += period;
+    return i < n ? i : period - i;
+}
+
+// One box filter of radius r over n elements of lanes interleaved floats each
+static void boxPass(const float * in, float * out, int n, int lanes, int r, double * sums)
+{
+    register int x, l;
+    register const float * add, * sub;
+    const double scale = 1. / (2 * r + 1);
+
+    for (l = 0; l < lanes; l++)
+        sums[l] = 0.;
+
+    // the initial window may wrap around the signal many times, so whole periods are added at once
+    int windowSize = 2 * r + 1, start = -r;
+    if (n > 1 && windowSize >= 2 * n - 2)
+    {
+        const int period = 2 * n - 2;
+        const int periods = windowSize / period;
+        for (x = 0; x < period; x++)
+        {
+            add = in + reflect101(x, n) * lanes;
+            for (l = 0; l < lanes; l++)
+                sums[l] += add[l] * (double)periods;
+        }
+        start += periods * period;
+        windowSize -= periods * period;
+    }
+    for (x = start; x < start + windowSize; x++)
+    {
+        add = in + reflect101(x, n) * lanes;
+        for (l = 0; l < lanes; l++)
+            sums[l] += add[l];
+    }
+
+    for (x = 0; x < n; x++)
+    {
+        for (l = 0; l < lanes; l++)
+            out[x * lanes + l] = sums[l] * scale;
+        add = in + reflect101(x + r + 1, n) * lanes;
+        sub = in + reflect101(x - r, n) * lanes;
+        for (l = 0; l < lanes; l++)
+            sums[l] += add[l] - sub[l];
+    }
+}
+
+// Box radii whose stacked variance best matches sigma (Kovesi, the widths are odd and differ by 2 at most)
+static void boxRadii(double sigma, int * radii)
+{
+    const double idealWidth = sqrt(12. * sigma * sigma / kBoxPasses + 1.);
+    int lowerWidth = (int)floor(idealWidth);
+    if (lowerWidth % 2 == 0)
+        lowerWidth--;
+    const int upperWidth = lowerWidth + 2;
+    const int nLower = (int)round((12. * sigma * sigma - kBoxPasses * lowerWidth * lowerWidth -
+                                   4. * kBoxPasses * lowerWidth - 3. * kBoxPasses) / (-4. * lowerWidth - 4.));
+    for (int i = 0; i < kBoxPasses; i++)
+        radii[i] = ((i < nLower ? lowerWidth : upperWidth) - 1) / 2;
+}
+
+// The horizontal passes are rounded into dst, where the vertical ones run in place, so no image sized float buffer
+// is needed. The rounding in between costs 1 grey level at most against keeping the horizontal passes in floats
+static void stackedBoxBlur(const cv::Mat & src, cv::Mat & dst, double sigma)
+{
+    const int w = src.cols, h = src.rows, channels = src.channels();
+    int radii[kBoxPasses];
+    boxRadii(sigma, radii);
+
+    // horizontal passes, one row at a time
+    parallelForRows(h, IBP_maximum(1, 16384 / (w * channels)), [&](int startRow, int endRow)
+    {
+        std::vector<float> row0(w * channels), row1(w * channels);
+        std::vector<double> sums(channels);
+        for (int y = startRow; y < endRow; y++)
+        {
+            const unsigned char * bitsSrc = src.ptr(y);
+            for (int i = 0; i < w * channels; i++)
+                row0[i] = bitsSrc[i];
+            for (int p = 0; p < kBoxPasses; p++)
+            {
+                boxPass(row0.data(), row1.data(), w, channels, radii[p], sums.data());
+                row0.swap(row1);
+            }
+            unsigned char * bitsDst = dst.ptr(y);
+            for (int i = 0; i < w * channels; i++)
+                bitsDst[i] = (unsigned char)IBP_clamp(0, (int)(row0[i] + .5f), 255);
+        }
+    });
+
+    // vertical passes, on strips of adjacent columns so every row read is a contiguous run
+    const int rowLength = w * channels;
+    const int nStrips = (rowLength + kColumnStripWidth - 1) / kColumnStripWidth;
+    parallelForRows(nStrips, 1, [&](int startStrip, int endStrip)
+    {
+        std::vector<float> strip0(h * kColumnStripWidth), strip1(h * kColumnStripWidth);
+        std::vector<double> sums(kColumnStripWidth);
+        for (int s = startStrip; s < endStrip; s++)
+        {
+            const int x0 = s * kColumnStripWidth;
+            const int lanes = IBP_minimum(kColumnStripWidth, rowLength - x0);
+            for (int y = 0; y < h; y++)
+            {
+                const unsigned char * bitsDst = dst.ptr(y) + x0;
+                float * bitsStrip = &strip0[y * lanes];
+                for (int i = 0; i < lanes; i++)
+                    bitsStrip[i] = bitsDst[i];
+            }
+            for (int p = 0; p < kBoxPasses; p++)
+            {
+                boxPass(strip0.data(), strip1.data(), h, lanes, radii[p], sums.data());
+                strip0.swap(strip1);
+            }
+            for (int y = 0; y < h; y++)
+            {
+                unsigned char * bitsDst = dst.ptr(y) + x0;
+                const float * bitsStrip = &strip0[y * lanes];
+                for (int i = 0; i < lanes; i++)
+                    bitsDst[i] = (unsigned char)IBP_clamp(0, (int)(bitsStrip[i] + .5f), 255);
+            }
+        }
+    });
+}
+
+// kernel += add - sub on n 16 bit counters, n multiple of 8. Counts wrap around but the results are exact
+static inline void mergeHistograms(unsigned short * kernel, const unsigned short * add, const unsigned short * sub,
+                                   int n)
+{
+    register int i = 0;
+#ifdef IBP_SSE2
+    for (; i < n; i += 8)
+    {
+        __m128i k = _mm_loadu_si128((const __m128i *)(kernel + i));
+        k = _mm_add_epi16(k, _mm_loadu_si128((const __m128i *)(add + i)));
+        k = _mm_sub_epi16(k, _mm_loadu_si128((const __m128i *)(sub + i)));
+        _mm_storeu_si128((__m128i *)(kernel + i), k);
+    }
+#endif
+    for (; i < n; i++)
+        kernel[i] += add[i] - sub[i];
+}
+
+// Median blur of the output columns [x0, x1) of src. Every column keeps the histogram of its 2 * radius + 1 rows,
+// with 256 fine bins and 16 coarse bins per channel. The coarse kernel histogram slides over them along each row,
+// while the 16 fine bins of a coarse bin are only brought up to the current column when the median falls in it
+static void histogramMedianBlurStrip(const cv::Mat & src, cv::Mat & dst, int radius, int x0, int x1)
+{
+    const int w = src.cols, h = src.rows, cn = src.channels();
+    const int fineSize = cn * 256, coarseSize = cn * 16;
+    const int cx0 = IBP_maximum(x0 - radius, 0), cx1 = IBP_minimum(x1 + radius, w);
+    const int half = ((2 * radius + 1) * (2 * radius + 1)) / 2 + 1;
+    std::vector<unsigned short> fineColumns((cx1 - cx0) * fineSize, 0), coarseColumns((cx1 - cx0) * coarseSize, 0);
+    std::vector<unsigned short> fineKernel(fineSize), coarseKernel(coarseSize), zero(fineSize, 0);
+    // output column every 16 fine bins of the kernel are up to date with
+    std::vector<int> fineKernelColumns(coarseSize);
+    register const unsigned char * bits;
+    register int x, c, v;
+
+    for (int dy = -radius; dy <= radius; dy++)
+    {
+        bits = src.ptr(IBP_clamp(0, dy, h - 1)) + cx0 * cn;
+        for (x = 0; x < cx1 - cx0; x++)
+            for (c = 0; c < cn; c++)
+            {
+                v = *bits++;
+                fineColumns[x * fineSize + c * 256 + v]++;
+                coarseColumns[x * coarseSize + c * 16 + (v >> 4)]++;
+            }
+    }
+
+    for (int y = 0; y < h; y++)
+    {
+        const int rowOut = IBP_clamp(0, y - radius - 1, h - 1), rowIn = IBP_clamp(0, y + radius, h - 1);
+        if (y > 0 && rowOut != rowIn)
+        {
+            register const unsigned char * bitsOut = src.ptr(rowOut) + cx0 * cn;
+            bits = src.ptr(rowIn) + cx0 * cn;
+            for (x = 0; x < cx1 - cx0; x++)
+                for (c = 0; c < cn; c++)
+                {
+                    v = *bitsOut++;
+                    fineColumns[x * fineSize + c * 256 + v]--;
+                    coarseColumns[x * coarseSize + c * 16 + (v >> 4)]--;
+                    v = *bits++;
+                    fineColumns[x * fineSize + c * 256 + v]++;
+                    coarseColumns[x * coarseSize + c * 16 + (v >> 4)]++;
+                }
+        }
+
+        std::fill(coarseKernel.begin(), coarseKernel.end(), 0);
+        for (int dx = -radius; dx <= radius; dx++)
+        {
+            x = IBP_clamp(0, x0 + dx, w - 1) - cx0;
+            mergeHistograms(coarseKernel.data(), &coarseColumns[x * coarseSize], zero.data(), coarseSize);
+        }
+        // far enough behind that the first use of every fine bin group builds it anew
+        std::fill(fineKernelColumns.begin(), fineKernelColumns.end(), x0 - 2 * radius - 2);
+
+        unsigned char * bitsDst = dst.ptr(y) + x0 * cn;
+        for (x = x0; x < x1; x++)
+        {
+            if (x > x0)
+            {
+                const int xIn = IBP_minimum(x + radius, w - 1) - cx0, xOut = IBP_maximum(x - radius - 1, 0) - cx0;
+                if (xIn != xOut)
+                    mergeHistograms(coarseKernel.data(), &coarseColumns[xIn * coarseSize],
+                                    &coarseColumns[xOut * coarseSize], coarseSize);
+            }
+
+            for (c = 0; c < cn; c++)
+            {
+                register const unsigned short * coarse = &coarseKernel[c * 16];
+                register unsigned short * fine;
+                register int count = 0, bin = 0;
+                while (count + coarse[bin] < half)
+                    count += coarse[bin++];
+
+                const int offset = c * 256 + bin * 16;
+                fine = &fineKernel[offset];
+                int & fineColumn = fineKernelColumns[c * 16 + bin];
+                if (x - fineColumn > 2 * radius + 1)
+                {
+                    // sliding would merge more columns than building the bins from the whole window
+                    memset(fine, 0, 16 * sizeof(unsigned short));
+                    for (int dx = -radius; dx <= radius; dx++)
+                        mergeHistograms(fine, &fineColumns[(IBP_clamp(0, x + dx, w - 1) - cx0) * fineSize + offset],
+                                        zero.data(), 16);
+                }
+                else
+                {
+                    for (int xf = fineColumn + 1; xf <= x; xf++)
+                    {
+                        const int xIn = IBP_minimum(xf + radius, w - 1) - cx0;
+                        const int xOut = IBP_maximum(xf - radius - 1, 0) - cx0;
+                        if (xIn != xOut)
+                            mergeHistograms(fine, &fineColumns[xIn * fineSize + offset],
+                                            &fineColumns[xOut * fineSize + offset], 16);
+                    }
+                }
+                fineColumn = x;
+
+                v = 0;
+                while (count + fine[v] < half)
+                    count += fine[v++];
+                *bitsDst++ = (bin << 4) + v;
+            }
+        }
+    }
+}
+
+// the grid blur is a gaussian cut at two sigmas
+static const double kGridBlurExtent = 2.;
+// coarsening step of the grid sampling while the grid has more cells than the image has pixels
+static const double kGridSamplingStep = 1.1;
+
+// Taps of a gaussian of sigma cells, cut at kGridBlurExtent sigmas, which is also the padding of the grid
+static int gridBlurTaps(double sigma, std::vector<float> & taps)
+{
+    const int radius = IBP_maximum(1, (int)ceil(kGridBlurExtent * sigma));
+    taps.resize(radius + 1);
+    for (int k = 0; k <= radius; k++)
+        taps[k] = (float)exp(-k * k / (2. * sigma * sigma));
+    return radius;
+}
+
+// Blurs n samples, stride floats apart, of lanes interleaved floats each along one axis of the grid
+static void blurGridLine(float * samples, int n, int stride, int lanes, const std::vector<float> & taps,
+                         float * buffer)
+{
+    register int i, k, l;
+    register float * out;
+    register const float * in;
+    const int radius = (int)taps.size() - 1;
+    float norm = taps[0];
+    for (k = 1; k <= radius; k++)
+        norm += 2.f * taps[k];
+    norm = 1.f / norm;
+
+    for (i = 0; i < n; i++)
+        memcpy(buffer + i * lanes, samples + i * stride, lanes * sizeof(float));
+    for (i = 0; i < n; i++)
+    {
+        out = samples + i * stride;
+        in = buffer + i * lanes;
+        for (l = 0; l < lanes; l++)
+            out[l] = in[l] * taps[0];
+        // the grid is empty outside, so out of range taps add nothing
+        for (k = 1; k <= radius; k++)
+        {
+            if (i - k >= 0)
+            {
+                in = buffer + (i - k) * lanes;
+                for (l = 0; l < lanes; l++)
+                    out[l] += in[l] * taps[k];
+            }
+            if (i + k < n)
+            {
+                in = buffer + (i + k) * lanes;
+                for (l = 0; l < lanes; l++)
+                    out[l] += in[l] * taps[k];
+            }
+        }
+        for (l = 0; l < lanes; l++)
+            out[l] *= norm;
+    }
+}
+
+// Filters one channel of src into the same channel of dst, on a grid whose range axis is that channel, so edges
+// between colours of the same luma keep the channels that change across them
+static void bilateralGridFilter(const cv::Mat & src, cv::Mat & dst, int channel, double sigmaRange,
+                                double sigmaSpace, double samplingRange, double samplingSpace)
+{
+    const int w = src.cols, h = src.rows, channels = src.channels();
+    // every cell holds the sum of the channel and of the weights
+    const int lanes = 2;
+    std::vector<float> tapsSpace, tapsRange;
+    const int paddingSpace = gridBlurTaps(sigmaSpace / samplingSpace, tapsSpace);
+    const int paddingRange = gridBlurTaps(sigmaRange / samplingRange, tapsRange);
+    const int nx = (int)((w - 1) / samplingSpace) + 2 + 2 * paddingSpace;
+    const int ny = (int)((h - 1) / samplingSpace) + 2 + 2 * paddingSpace;
+    const int nz = (int)(255. / samplingRange) + 2 + 2 * paddingRange;
+    const int planeSize = nx * nz * lanes;
+    std::vector<float> grid((size_t)ny * planeSize, 0.f);
+
+    // the image rows splatted on each grid row, which are disjoint so the planes can be filled in parallel
+    std::vector<int> firstRow(ny + 1, h);
+    for (int y = h - 1; y >= 0; y--)
+        firstRow[(int)(y / samplingSpace + .5) + paddingSpace] = y;
+    for (int gy = ny - 1; gy >= 0; gy--)
+        firstRow[gy] = IBP_minimum(firstRow[gy], firstRow[gy + 1]);
+
+    // splatting and blurring along x and the range axis, one plane at a time
+    parallelForRows(ny, 1, [&](int startPlane, int endPlane)
+    {
+        std::vector<float> buffer(IBP_maximum(nx, nz) * lanes);
+        for (int gy = startPlane; gy < endPlane; gy++)
+        {
+            float * plane = grid.data() + (size_t)gy * planeSize;
+            for (int y = firstRow[gy]; y < firstRow[gy + 1]; y++)
+            {
+                const unsigned char * bitsSrc = src.ptr(y) + channel;
+                for (int x = 0; x < w; x++, bitsSrc += channels)
+                {
+                    const int gx = (int)(x / samplingSpace + .5) + paddingSpace;
+                    const int gz = (int)(*bitsSrc / samplingRange + .5) + paddingRange;
+                    float * cell = plane + (gx * nz + gz) * lanes;
+                    cell[0] += *bitsSrc;
+                    cell[1] += 1.f;
+                }
+            }
+            if (firstRow[gy] == firstRow[gy + 1])
+                continue;
+            for (int gx = 0; gx < nx; gx++)
+                blurGridLine(plane + gx * nz * lanes, nz, lanes, lanes, tapsRange, buffer.data());
+            for (int gz = 0; gz < nz; gz++)
+                blurGridLine(plane + gz * lanes, nx, nz * lanes, lanes, tapsSpace, buffer.data());
+        }
+    });
+
+    // blurring along y, on columns of whole range lines, which are contiguous
+    const int lineSize = nz * lanes;
+    parallelForRows(nx, 1, [&](int startColumn, int endColumn)
+    {
+        std::vector<float> buffer((size_t)ny * lineSize);
+        for (int gx = startColumn; gx < endColumn; gx++)
+            blurGridLine(grid.data() + gx * lineSize, ny, planeSize, lineSize, tapsSpace, buffer.data());
+    });
+
+    // slicing, each pixel interpolated trilinearly at its own position and value
+    parallelForRows(h, IBP_maximum(1, 16384 / w), [&](int startRow, int endRow)
+    {
+        float sums[lanes];
+        for (int y = startRow; y < endRow; y++)
+        {
+            const unsigned char * bitsSrc = src.ptr(y) + channel;
+            unsigned char * bitsDst = dst.ptr(y) + channel;
+            const float fy = y / samplingSpace + paddingSpace;
+            const int gy = (int)fy;
+            const float wy = fy - gy;
+            for (int x = 0; x < w; x++, bitsSrc += channels, bitsDst += channels)
+            {
+                const float fx = x / samplingSpace + paddingSpace;
+                const float fz = *bitsSrc / samplingRange + paddingRange;
+                const int gx = (int)fx, gz = (int)fz;
+                const float wx = fx - gx, wz = fz - gz;
+                for (int l = 0; l < lanes; l++)
+                    sums[l] = 0.f;
+                for (int corner = 0; corner < 8; corner++)
+                {
+                    const float weight = (corner & 1 ? wx : 1.f - wx) * (corner & 2 ? wy : 1.f - wy) *
+                                         (corner & 4 ? wz : 1.f - wz);
+                    const float * cell = grid.data() + (size_t)(gy + ((corner >> 1) & 1)) * planeSize +
+                                         ((gx + (corner & 1)) * nz + gz + ((corner >> 2) & 1)) * lanes;
+                    for (int l = 0; l < lanes; l++)
+                        sums[l] += cell[l] * weight;
+                }
+                *bitsDst = sums[1] <= 0.f ? *bitsSrc : cv::saturate_cast<unsigned char>(sums[0] / sums[1]);
+            }
+        }
+    });
+}
+
+void gaussianBlur(cv::InputArray _src, cv::OutputArray _dst, double sigma)
+{
+    cv::Mat src = _src.getMat();
+    CV_Assert(src.depth() == CV_8U && src.channels() <= 4);
+    CV_Assert(sigma > 0.);
+
+    _dst.create(src.size(), src.type());
+    cv::Mat dst = _dst.getMat();
+
+    if (sigma < kStackedBoxBlurMinimumSigma || src.empty())
+    {
+        cv::GaussianBlur(src, dst, cv::Size(0, 0), sigma);
+        return;
+    }
+
+    stackedBoxBlur(src, dst, sigma);
+}
+
+void medianBlur(cv::InputArray _src, cv::OutputArray _dst, int radius)
+{
+    cv::Mat src = _src.getMat();
+    CV_Assert(src.depth() == CV_8U && src.channels() <= 4);
+    CV_Assert(radius >= 0);
+
+    _dst.create(src.size(), src.type());
+    cv::Mat dst = _dst.getMat();
+
+    // above radius 127 the window no longer fits the 16 bit counters
+    if (radius < kHistogramMedianMinimumRadius || radius > 127 || src.empty())
+    {
+        // cv::medianBlur rejects two channel images, their channels are filtered one at a time
+        if (src.channels() == 2)
+        {
+            cv::Mat planes[2];
+            cv::split(src, planes);
+            for (int c = 0; c < 2; c++)
+                cv::medianBlur(planes[c], planes[c], 2 * radius + 1);
+            cv::merge(planes, 2, dst);
+        }
+        else
+            cv::medianBlur(src, dst, 2 * radius + 1);
+        return;
+    }
+
+    if (src.data == dst.data)
+        src = src.clone();
+
+    // strips are at least as wide as the window so building each row's first kernel stays a small share of the work
+    const int stripWidth = IBP_maximum(64, 2 * radius);
+    const int nStrips = (src.cols + stripWidth - 1) / stripWidth;
+    parallelForRows(nStrips, 1, [&](int startStrip, int endStrip)
+    {
+        for (int s = startStrip; s < endStrip; s++)
+            histogramMedianBlurStrip(src, dst, radius, s * stripWidth, IBP_minimum((s + 1) * stripWidth, src.cols));
+    });
+}
+
+
+void bilateralGrid(cv::InputArray _src, cv::OutputArray _dst, double sigmaColor, double sigmaSpace,
+                   double spaceDownsampling, double rangeDownsampling)
+{
+    cv::Mat src = _src.getMat();
+    CV_Assert(src.type() == CV_8UC1 || src.type() == CV_8UC3);
+    CV_Assert(sigmaColor > 0. && sigmaSpace > 0.);
+    CV_Assert(spaceDownsampling > 0. && rangeDownsampling > 0.);
+
+    if (sigmaSpace < kBilateralGridMinimumSigma || src.empty())
+    {
+        // cv::bilateralFilter does not run in place
+        cv::Mat dst;
+        cv::bilateralFilter(src, dst, 0, sigmaColor, sigmaSpace);
+        dst.copyTo(_dst);
+        return;
+    }
+
+    _dst.create(src.size(), src.type());
+    cv::Mat dst = _dst.getMat();
+
+    // the differences of each channel are about a third of those summed over B, G and R; never below one level
+    const double sigmaRange = IBP_maximum(1., src.channels() == 1 ? sigmaColor : sigmaColor / 3.);
+    double samplingSpace = sigmaSpace * spaceDownsampling, samplingRange = sigmaRange * rangeDownsampling;
+    // both axes are sampled coarser until the grid, without its padding, has no more cells than the image has pixels
+    const double pixels = (double)src.cols * src.rows;
+    for (;;)
+    {
+        const double cells = ((int)((src.cols - 1) / samplingSpace) + 2.) *
+                             ((int)((src.rows - 1) / samplingSpace) + 2.) * ((int)(255. / samplingRange) + 2.);
+        if (cells <= pixels || (samplingSpace >= IBP_maximum(src.cols, src.rows) && samplingRange >= 255.))
+            break;
+        samplingSpace *= kGridSamplingStep;
+        samplingRange *= kGridSamplingStep;
+    }
+    // every channel reads and writes only its own samples, so they can run in place one after another
+    for (int c = 0; c < src.channels(); c++)
+        bilateralGridFilter(src, dst, c, sigmaRange, sigmaSpace, samplingRange, samplingSpace);
+}
+
+}}
@@ -0,0 +1,87 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef IBP_IMGPROC_BLURRING_H
+#define IBP_IMGPROC_BLURRING_H
+
+#include <opencv2/core.hpp>
+
+namespace ibp {
+namespace imgproc {
+
+/*******************************************************
+** Gaussian blur of a CV_8UC1 to CV_8UC4 image, which
+** may be done in place. Small sigmas go through
+** cv::GaussianBlur; from kStackedBoxBlurMinimumSigma on
+** the kernel is approximated by stacked box filters,
+** which cost the same per pixel for any sigma:
+**
+** Peter Kovesi. “Fast Almost-Gaussian Filtering”,
+** Digital Image Computing: Techniques and Applications,
+** DICTA 2010, Sydney, Australia. Dec. 2010
+********************************************************/
+const double kStackedBoxBlurMinimumSigma = 12.;
+void gaussianBlur(cv::InputArray _src, cv::OutputArray _dst, double sigma);
+
+/*******************************************************
+** Median of the (2 * radius + 1)^2 neighborhood of a
+** CV_8UC1 to CV_8UC4 image with replicated borders, the
+** same result as cv::medianBlur. From
+** kHistogramMedianMinimumRadius on it runs in constant
+** time per pixel, with sliding column histograms:
+**
+** Simon Perreault, Patrick Hébert. “Median Filtering in
+** Constant Time”, IEEE Transactions on Image Processing,
+** 16(9):2389-2394, Sep. 2007
+********************************************************/
+const int kHistogramMedianMinimumRadius = 4;
+void medianBlur(cv::InputArray _src, cv::OutputArray _dst, int radius);
+
+/*******************************************************
+** Bilateral filter of a CV_8UC1 or CV_8UC3 image with
+** the sigmas of cv::bilateralFilter, approximated on a
+** grid so it runs in the same time for any spatial
+** sigma. The grid is sampled every spaceDownsampling
+** spatial sigmas and every rangeDownsampling range
+** sigmas; both are raised as needed so the grid never
+** has more cells than the image has pixels. Colour
+** images are filtered one channel at a time, each on
+** a grid whose range axis is the channel itself, with
+** a third of sigmaColor, as cv::bilateralFilter adds
+** the differences of the three channels. Spatial sigmas
+** under kBilateralGridMinimumSigma go through
+** cv::bilateralFilter:
+**
+** Jiawen Chen, Sylvain Paris, Frédo Durand. “Real-time
+** Edge-Aware Image Processing with the Bilateral Grid”,
+** ACM Transactions on Graphics, 26(3), Jul. 2007
+********************************************************/
+const double kBilateralGridMinimumSigma = 3.;
+void bilateralGrid(cv::InputArray _src, cv::OutputArray _dst, double sigmaColor, double sigmaSpace,
+                   double spaceDownsampling = 1., double rangeDownsampling = 1.);
+
+} // namespace imgproc
+} // namespace ibp
+
+#endif // IBP_IMGPROC_BLURRING_H
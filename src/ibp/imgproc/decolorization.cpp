@@ -0,0 +1,312 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <math.h>
+#include <limits>
+#include <vector>
+#include <opencv2/imgproc.hpp>
+
+#include "decolorization.h"
+#include "util.h"
+#include "../misc/util.h"
+
+// parameters of cv::decolor
+#define DECOLORIZATION_SIGMA 0.02
+#define DECOLORIZATION_MAXIMUM_ITERATIONS 15
+#define DECOLORIZATION_TOLERANCE 0.0001
+#define DECOLORIZATION_WEAK_ORDER_LEVEL 0.05
+
+// the monomials of the polynomial, with r, g and b in [0, 1]
+#define DECOLORIZATION_TERMS 9
+
+namespace ibp {
+namespace imgproc {
+
+enum DecolorizationTerm
+{
+    Term_R, Term_G, Term_B, Term_RR, Term_GG, Term_BB, Term_RG, Term_RB, Term_GB
+};
+
+static inline void decolorizationTerms(double r, double g, double b, double * terms)
+{
+    terms[Term_R] = r;
+    terms[Term_G] = g;
+    terms[Term_B] = b;
+    terms[Term_RR] = r * r;
+    terms[Term_GG] = g * g;
+    terms[Term_BB] = b * b;
+    terms[Term_RG] = r * g;
+    terms[Term_RB] = r * b;
+    terms[Term_GB] = g * b;
+}
+
+// Forward differences of values (w x h, nValues per pixel) to the right and below, 0 past the last column or
+// row: w * h horizontal differences followed by w * h vertical ones per value
+static void forwardDifferences(const double * values, int nValues, int w, int h, std::vector<double> & differences)
+{
+    const int n = w * h;
+    differences.assign(2 * n * nValues, 0.);
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            const int i = y * w + x;
+            for (int v = 0; v < nValues; v++)
+            {
+                if (x + 1 < w)
+                    differences[(v * 2) * n + i] = values[i * nValues + v] - values[(i + 1) * nValues + v];
+                if (y + 1 < h)
+                    differences[(v * 2 + 1) * n + i] = values[i * nValues + v] - values[(i + w) * nValues + v];
+            }
+        }
+    }
+}
+
+// The weights of the terms for the BGR image small (CV_32FC3, values in [0, 1]), as in cv::decolor: the
+// differences of the gray image must match the color differences, with the signs given by the weak color order
+static void solveDecolorizationWeights(const cv::Mat & small, double * weights)
+{
+    const int w = small.cols, h = small.rows, n = w * h, nDifferences = 2 * n;
+    std::vector<double> pixels(n * 3), lab(n * 3), terms(n * DECOLORIZATION_TERMS);
+    std::vector<double> colorDifferences, rgbDifferences, termDifferences;
+    std::vector<double> contrast(nDifferences), order(nDifferences);
+    cv::Mat labM;
+    register int i, k, l;
+
+    cv::cvtColor(small, labM, cv::COLOR_BGR2Lab);
+    for (int y = 0; y < h; y++)
+    {
+        const float * bgr = small.ptr<float>(y), * lab0 = labM.ptr<float>(y);
+        for (int x = 0; x < w; x++)
+        {
+            i = y * w + x;
+            pixels[i * 3] = bgr[x * 3 + 2];
+            pixels[i * 3 + 1] = bgr[x * 3 + 1];
+            pixels[i * 3 + 2] = bgr[x * 3];
+            for (k = 0; k < 3; k++)
+                lab[i * 3 + k] = lab0[x * 3 + k];
+            decolorizationTerms(pixels[i * 3], pixels[i * 3 + 1], pixels[i * 3 + 2],
+                                &terms[i * DECOLORIZATION_TERMS]);
+        }
+    }
+
+    // color contrast, and +1 or -1 where r, g and b all clearly grow or shrink together
+    forwardDifferences(lab.data(), 3, w, h, colorDifferences);
+    forwardDifferences(pixels.data(), 3, w, h, rgbDifferences);
+    forwardDifferences(terms.data(), DECOLORIZATION_TERMS, w, h, termDifferences);
+    for (i = 0; i < nDifferences; i++)
+    {
+        const double dL = colorDifferences[i], da = colorDifferences[nDifferences + i],
+                     db = colorDifferences[2 * nDifferences + i];
+        const double dRed = rgbDifferences[i], dGreen = rgbDifferences[nDifferences + i],
+                     dBlue = rgbDifferences[2 * nDifferences + i];
+        contrast[i] = sqrt(dL * dL + da * da + db * db) / 100.;
+        order[i] = (dRed > DECOLORIZATION_WEAK_ORDER_LEVEL && dGreen > DECOLORIZATION_WEAK_ORDER_LEVEL &&
+                    dBlue > DECOLORIZATION_WEAK_ORDER_LEVEL) ? 1. :
+                   (dRed < -DECOLORIZATION_WEAK_ORDER_LEVEL && dGreen < -DECOLORIZATION_WEAK_ORDER_LEVEL &&
+                    dBlue < -DECOLORIZATION_WEAK_ORDER_LEVEL) ? -1. : 0.;
+    }
+
+    // normal matrix of the least squares fit of the term differences, solved once
+    cv::Matx<double, DECOLORIZATION_TERMS, DECOLORIZATION_TERMS> normal;
+    for (k = 0; k < DECOLORIZATION_TERMS; k++)
+    {
+        for (l = k; l < DECOLORIZATION_TERMS; l++)
+        {
+            double sum = 0.;
+            const double * a = &termDifferences[k * nDifferences], * b = &termDifferences[l * nDifferences];
+            for (i = 0; i < nDifferences; i++)
+                sum += a[i] * b[i];
+            normal(k, l) = normal(l, k) = sum;
+        }
+    }
+    const cv::Matx<double, DECOLORIZATION_TERMS, DECOLORIZATION_TERMS> inverse = normal.inv(cv::DECOMP_SVD);
+
+    // start from the mean of r, g and b
+    std::vector<double> gray(nDifferences), target(nDifferences);
+    double energy = 0., previousEnergy = std::numeric_limits<double>::infinity();
+    const double sigma = DECOLORIZATION_SIGMA;
+    for (k = 0; k < DECOLORIZATION_TERMS; k++)
+        weights[k] = k <= Term_B ? .33 : 0.;
+
+    for (int iteration = 1; fabs(energy - previousEnergy) > DECOLORIZATION_TOLERANCE; iteration++)
+    {
+        previousEnergy = energy;
+
+        std::fill(gray.begin(), gray.end(), 0.);
+        for (k = 0; k < DECOLORIZATION_TERMS; k++)
+            for (i = 0; i < nDifferences; i++)
+                gray[i] += termDifferences[k * nDifferences + i] * weights[k];
+
+        // expected sign of every gray difference, given its match with +contrast and -contrast
+        for (i = 0; i < nDifferences; i++)
+        {
+            const double plus = gray[i] - contrast[i], minus = gray[i] + contrast[i];
+            const double positive = (1. + order[i]) / 2. * exp(-.5 * plus * plus / (sigma * sigma));
+            const double negative = (1. - order[i]) / 2. * exp(-.5 * minus * minus / (sigma * sigma));
+            const double sum = positive + negative;
+            target[i] = contrast[i] * (positive - negative) / (sum == 0. ? 1. : sum);
+        }
+
+        // least squares fit of the term differences to the targets
+        cv::Vec<double, DECOLORIZATION_TERMS> rhs;
+        for (k = 0; k < DECOLORIZATION_TERMS; k++)
+        {
+            double sum = 0.;
+            for (i = 0; i < nDifferences; i++)
+                sum += termDifferences[k * nDifferences + i] * target[i];
+            rhs[k] = sum;
+        }
+        const cv::Vec<double, DECOLORIZATION_TERMS> solution = inverse * rhs;
+
+        energy = 0.;
+        for (i = 0; i < nDifferences; i++)
+        {
+            double value = 0.;
+            for (k = 0; k < DECOLORIZATION_TERMS; k++)
+                value += termDifferences[k * nDifferences + i] * solution[k];
+            const double plus = value - contrast[i], minus = value + contrast[i];
+            energy -= log(exp(-plus * plus / sigma) + exp(-minus * minus / sigma));
+        }
+        energy /= nDifferences;
+
+        for (k = 0; k < DECOLORIZATION_TERMS; k++)
+            weights[k] = solution[k];
+
+        if (iteration > DECOLORIZATION_MAXIMUM_ITERATIONS)
+            break;
+    }
+}
+
+// The polynomial of the weights for the n BGRA pixels from bits, into values (may be null); returns its extremes
+static void evaluateDecolorization(const BGRA * bits, int n, const float * weights, float * values,
+                                   float & minimum, float & maximum)
+{
+    register int i = 0;
+    float r, g, b, v;
+#ifdef IBP_SSE2
+    const __m128i mask = _mm_set1_epi32(0xff);
+    const __m128 scale = _mm_set1_ps(1.f / 255.f);
+    __m128 w[DECOLORIZATION_TERMS], vMinimum = _mm_set1_ps(minimum), vMaximum = _mm_set1_ps(maximum);
+    for (int k = 0; k < DECOLORIZATION_TERMS; k++)
+        w[k] = _mm_set1_ps(weights[k]);
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m128i p = _mm_loadu_si128((const __m128i *)(bits + i));
+        const __m128 vb = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(p, mask)), scale);
+        const __m128 vg = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(p, 8), mask)), scale);
+        const __m128 vr = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(p, 16), mask)), scale);
+        // r (w_r + w_rr r + w_rg g + w_rb b) + g (w_g + w_gg g + w_gb b) + b (w_b + w_bb b)
+        const __m128 x = _mm_add_ps(_mm_add_ps(w[Term_R], _mm_mul_ps(w[Term_RR], vr)),
+                                    _mm_add_ps(_mm_mul_ps(w[Term_RG], vg), _mm_mul_ps(w[Term_RB], vb)));
+        const __m128 y = _mm_add_ps(w[Term_G], _mm_add_ps(_mm_mul_ps(w[Term_GG], vg), _mm_mul_ps(w[Term_GB], vb)));
+        const __m128 z = _mm_add_ps(w[Term_B], _mm_mul_ps(w[Term_BB], vb));
+        const __m128 vv = _mm_add_ps(_mm_mul_ps(vr, x), _mm_add_ps(_mm_mul_ps(vg, y), _mm_mul_ps(vb, z)));
+        vMinimum = _mm_min_ps(vMinimum, vv);
+        vMaximum = _mm_max_ps(vMaximum, vv);
+        if (values)
+            _mm_storeu_ps(values + i, vv);
+    }
+    float m[4];
+    _mm_storeu_ps(m, vMinimum);
+    minimum = IBP_minimum(IBP_minimum(m[0], m[1]), IBP_minimum(m[2], m[3]));
+    _mm_storeu_ps(m, vMaximum);
+    maximum = IBP_maximum(IBP_maximum(m[0], m[1]), IBP_maximum(m[2], m[3]));
+#endif
+    for (; i < n; i++)
+    {
+        r = bits[i].r / 255.f;
+        g = bits[i].g / 255.f;
+        b = bits[i].b / 255.f;
+        v = r * (weights[Term_R] + weights[Term_RR] * r + weights[Term_RG] * g + weights[Term_RB] * b) +
+            g * (weights[Term_G] + weights[Term_GG] * g + weights[Term_GB] * b) +
+            b * (weights[Term_B] + weights[Term_BB] * b);
+        minimum = IBP_minimum(minimum, v);
+        maximum = IBP_maximum(maximum, v);
+        if (values)
+            values[i] = v;
+    }
+}
+
+void decolorize(cv::InputArray _src, cv::OutputArray _dst, int solveSize)
+{
+    cv::Mat src = _src.getMat();
+    CV_Assert(src.type() == CV_8UC4 && solveSize > 0);
+
+    _dst.create(src.size(), CV_8UC1);
+    cv::Mat dst = _dst.getMat();
+    if (src.empty())
+        return;
+
+    // the weights, from a downsampled copy
+    const double scale = IBP_minimum(1., (double)solveSize / IBP_maximum(src.cols, src.rows));
+    cv::Mat small, smallBGR;
+    if (scale < 1.)
+        cv::resize(src, small, cv::Size(IBP_maximum(1, cvRound(src.cols * scale)),
+                                        IBP_maximum(1, cvRound(src.rows * scale))), 0, 0, cv::INTER_AREA);
+    else
+        small = src;
+    cv::cvtColor(small, smallBGR, cv::COLOR_BGRA2BGR);
+    smallBGR.convertTo(smallBGR, CV_32FC3, 1. / 255.);
+
+    double weights[DECOLORIZATION_TERMS];
+    float weightsF[DECOLORIZATION_TERMS];
+    solveDecolorizationWeights(smallBGR, weights);
+    for (int k = 0; k < DECOLORIZATION_TERMS; k++)
+        weightsF[k] = (float)weights[k];
+
+    // the extremes of the gray image over src, then the gray image normalized to them
+    const int chunk = IBP_maximum(1, 16384 / src.cols);
+    float minimum = std::numeric_limits<float>::max(), maximum = -std::numeric_limits<float>::max();
+    QMutex mutex;
+    parallelForRows(src.rows, chunk, [&](int startRow, int endRow)
+    {
+        float chunkMinimum = std::numeric_limits<float>::max(), chunkMaximum = -std::numeric_limits<float>::max();
+        for (int y = startRow; y < endRow; y++)
+            evaluateDecolorization(src.ptr<BGRA>(y), src.cols, weightsF, 0, chunkMinimum, chunkMaximum);
+        QMutexLocker locker(&mutex);
+        minimum = IBP_minimum(minimum, chunkMinimum);
+        maximum = IBP_maximum(maximum, chunkMaximum);
+    });
+
+    const float range = maximum - minimum, factor = range > 0.f ? 255.f / range : 0.f;
+    parallelForRows(src.rows, chunk, [&](int startRow, int endRow)
+    {
+        std::vector<float> values(src.cols);
+        for (int y = startRow; y < endRow; y++)
+        {
+            float unusedMinimum = 0.f, unusedMaximum = 0.f;
+            unsigned char * bitsDst = dst.ptr(y);
+            evaluateDecolorization(src.ptr<BGRA>(y), src.cols, weightsF, values.data(), unusedMinimum,
+                                   unusedMaximum);
+            for (int x = 0; x < src.cols; x++)
+                bitsDst[x] = cv::saturate_cast<unsigned char>((values[x] - minimum) * factor);
+        }
+    });
+}
+
+}}
@@ -0,0 +1,54 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef IBP_IMGPROC_DECOLORIZATION_H
+#define IBP_IMGPROC_DECOLORIZATION_H
+
+#include <opencv2/core.hpp>
+
+namespace ibp {
+namespace imgproc {
+
+/*******************************************************
+** Contrast preserving decolorization of a CV_8UC4 (BGRA)
+** image into a CV_8UC1 one, the algorithm of cv::decolor:
+** the gray image is a second order polynomial of r, g and
+** b, with the weights that best keep the color contrast
+** of neighbor pixels, normalized to [0, 255]:
+**
+** Cewu Lu, Li Xu, Jiaya Jia. “Contrast Preserving
+** Decolorization”, IEEE International Conference on
+** Computational Photography (ICCP), 2012
+**
+** The weights are global, so they are solved on a copy
+** of src downsampled to at most solveSize pixels per
+** side, and the polynomial is then evaluated once per
+** pixel of src (SSE2 where available), rows in parallel.
+********************************************************/
+void decolorize(cv::InputArray _src, cv::OutputArray _dst, int solveSize);
+
+} // namespace imgproc
+} // namespace ibp
+
+#endif // IBP_IMGPROC_DECOLORIZATION_H
@@ -32,6 +32,11 @@
 #include <QHash>
 #include <QSettings>
 #include <QWidget>
+#include <QAtomicInt>
+#include <QList>
+#include <QPair>
+#include <QMutex>
+#include <QMutexLocker>
 
 namespace ibp {
 namespace imgproc {
@@ -41,6 +46,7 @@ class ImageFilter : public QObject
     Q_OBJECT
 
 public:
+    ImageFilter() : mCancelFlag(0) {}
     virtual ~ImageFilter() {}
     virtual ImageFilter * clone() = 0;
     virtual QHash<QString, QString> info() = 0;
@@ -48,8 +54,50 @@ public:
     virtual bool loadParameters(QSettings & s) = 0;
     virtual bool saveParameters(QSettings & s) = 0;
     virtual QWidget * widget(QWidget * parent = 0) = 0;
+    // How a filter takes the alpha of its input in ImageFilterList's premultiplied alpha mode. Agnostic filters
+    // move whole pixels around without looking into them, and keep the format of the image they get, straight
+    // or premultiplied, so ImageFilterList leaves it as it is. The others get their image converted to the
+    // format they need, if it is not already in it
+    enum AlphaHandling
+    {
+        AlphaHandling_Agnostic,
+        AlphaHandling_Premultiplied,
+        AlphaHandling_Straight
+    };
+    virtual AlphaHandling alphaHandling() { return AlphaHandling_Straight; }
+    // ImageFilterList points the copies it runs to a flag raised when their output is going to be discarded.
+    // Filters made of independent pieces of work may poll isCancelled() between them and return early
+    void setCancelFlag(const QAtomicInt * flag) { mCancelFlag = flag; }
+    bool isCancelled() const { return mCancelFlag && mCancelFlag->loadAcquire() != 0; }
+    // For profiling, filters may time the stages of their last process() call: the name of every stage and the
+    // milliseconds it took, in the order they ran. Empty for filters that do not time themselves. process() runs in
+    // a worker thread, so this is meant to be read from another one, like the GUI thread: while process() runs, it
+    // returns the stages finished so far. ImageFilterList runs copies of its filters, and keeps the timings of the
+    // last copy of every filter that finished, see ImageFilterList::stageTimings()
+    QList<QPair<QString, double> > stageTimings() const
+    {
+        QMutexLocker locker(&mStageTimingsMutex);
+        return mStageTimings;
+    }
 signals:
     void parametersChanged();
+
+protected:
+    void clearStageTimings()
+    {
+        QMutexLocker locker(&mStageTimingsMutex);
+        mStageTimings.clear();
+    }
+    void addStageTiming(const QString & stage, double milliseconds)
+    {
+        QMutexLocker locker(&mStageTimingsMutex);
+        mStageTimings.append(qMakePair(stage, milliseconds));
+    }
+
+private:
+    const QAtomicInt * mCancelFlag;
+    QList<QPair<QString, double> > mStageTimings;
+    mutable QMutex mStageTimingsMutex;
 };
 
 }}
@@ -28,6 +28,7 @@
 #include <math.h>
 
 #include "imagefilterlist.h"
+#include "util.h"
 
 namespace ibp {
 namespace imgproc {
@@ -38,10 +39,12 @@ ImageFilterList::ImageFilterList(QObject *parent) :
     mFilters(),
     mAutoRun(false),
     mUseCache(false),
+    mPremultipliedAlpha(false),
     mName(),
     mDescription(),
     mPluginLoader(0),
-    mMustRestart(false)
+    mMustRestart(false),
+    mCancelRequested(0)
 {
 }
 
@@ -50,10 +53,12 @@ ImageFilterList::ImageFilterList(const ImageFilterList &other) :
     mInputImage(other.mInputImage),
     mAutoRun(other.mAutoRun),
     mUseCache(other.mUseCache),
+    mPremultipliedAlpha(other.mPremultipliedAlpha),
     mName(other.mName),
     mDescription(other.mDescription),
     mPluginLoader(other.mPluginLoader),
-    mMustRestart(false)
+    mMustRestart(false),
+    mCancelRequested(0)
 {
     mFilters = copyFilterList(other.mFilters);
     mBypasses = other.mBypasses;
@@ -68,6 +73,7 @@ ImageFilterList &ImageFilterList::operator=(const ImageFilterList &other)
     mInputImage = other.mInputImage;
     mAutoRun = other.mAutoRun;
     mUseCache = other.mUseCache;
+    mPremultipliedAlpha = other.mPremultipliedAlpha;
     mName = other.mName;
     mDescription = other.mDescription;
     mPluginLoader = other.mPluginLoader;
@@ -75,6 +81,7 @@ ImageFilterList &ImageFilterList::operator=(const ImageFilterList &other)
     mFilters = copyFilterList(other.mFilters);
     mBypasses = other.mBypasses;
     mCache = other.mCache;
+    mStageTimings.clear();
     for (int i = 0; i < mFilters.size(); i++)
         connect(other.mFilters.at(i), SIGNAL(parametersChanged()), this, SLOT(On_ImageFilter_parametersChanged()));
 
@@ -103,11 +110,22 @@ bool ImageFilterList::useCache() const
     return mUseCache;
 }
 
+bool ImageFilterList::premultipliedAlpha() const
+{
+    return mPremultipliedAlpha;
+}
+
 bool ImageFilterList::bypass(int i) const
 {
     return mBypasses.at(i);
 }
 
+QList<QPair<QString, double> > ImageFilterList::stageTimings(int i) const
+{
+    QMutexLocker locker(&mMutex);
+    return mStageTimings.value(mFilters.at(i));
+}
+
 const ImageFilter *ImageFilterList::at(int index) const
 {
     return mFilters.at(index);
@@ -179,6 +197,7 @@ bool ImageFilterList::load(const QString &fileName)
     QSettings s(fileName, QSettings::IniFormat, this);
 
     QString fileType, name, description, id;
+    bool premultipliedAlpha;
     int nFilters = 0;
     ImageFilter * filter;
 
@@ -188,12 +207,15 @@ bool ImageFilterList::load(const QString &fileName)
         return false;
     name = s.value("name", QString()).toString();
     description = s.value("description", QString()).toString();
+    premultipliedAlpha = s.value("premultipliedAlpha", false).toBool();
     nFilters = s.value("nFilters", 0).toInt();
     s.endGroup();
 
     mMutex.lock();
+    mPremultipliedAlpha = premultipliedAlpha;
     clearFilterList(mFilters);
     mBypasses.clear();
+    mStageTimings.clear();
     for (int i = 0; i < nFilters; i++)
     {
         s.beginGroup("imageFilter" + QString::number(i + 1));
@@ -238,6 +260,8 @@ bool ImageFilterList::save(const QString &fileName)
     s.setValue("fileType", "ibp.imagefilterlist");
     s.setValue("name", mName);
     s.setValue("description", mDescription);
+    if (mPremultipliedAlpha)
+        s.setValue("premultipliedAlpha", true);
     s.setValue("nFilters", mFilters.count());
     s.endGroup();
 
@@ -281,6 +305,7 @@ void ImageFilterList::removeAt(int i)
 {
     mMutex.lock();
     ImageFilter * f = mFilters.takeAt(i);
+    mStageTimings.remove(f);
     if (f)
         delete f;
     mBypasses.removeAt(i);
@@ -301,6 +326,7 @@ void ImageFilterList::clear()
     clearFilterList(mFilters);
     mBypasses.clear();
     mCache.clear();
+    mStageTimings.clear();
     if (mAutoRun)
     {
         mMutex.unlock();
@@ -361,6 +387,25 @@ void ImageFilterList::setUseCache(bool c)
     mMutex.unlock();
 }
 
+void ImageFilterList::setPremultipliedAlpha(bool p)
+{
+    mMutex.lock();
+    if (mPremultipliedAlpha == p)
+    {
+        mMutex.unlock();
+        return;
+    }
+    mPremultipliedAlpha = p;
+    mCache.clear();
+    if (mAutoRun)
+    {
+        mMutex.unlock();
+        startProcessing();
+        return;
+    }
+    mMutex.unlock();
+}
+
 void ImageFilterList::setBypass(int i, bool b)
 {
     mMutex.lock();
@@ -387,6 +432,7 @@ void ImageFilterList::startProcessing(Priority p)
     {
         mMutex.lock();
         mMustRestart = false;
+        mCancelRequested.storeRelease(0);
         mMutex.unlock();
         start(p);
     }
@@ -394,6 +440,7 @@ void ImageFilterList::startProcessing(Priority p)
     {
         mMutex.lock();
         mMustRestart = true;
+        mCancelRequested.storeRelease(1);
         mMutex.unlock();
     }
 }
@@ -422,6 +469,8 @@ void ImageFilterList::run()
     emit processingStarted();
 
     QList<ImageFilter *> filters;
+    // the filters of the list the copies in filters were made from
+    QList<const ImageFilter *> originals;
     QList<bool> bypasses;
     QList<QImage> cache;
 
@@ -445,9 +494,16 @@ void ImageFilterList::run()
         }
 
         bool uc = mUseCache;
+        bool pa = mPremultipliedAlpha;
         int nFilter = mCache.size() - 1;
         clearFilterList(filters);
         filters = copyFilterList(mFilters);
+        originals.clear();
+        for (int i = 0; i < mFilters.size(); i++)
+            originals.append(mFilters.at(i));
+        for (int i = 0; i < filters.size(); i++)
+            if (filters.at(i))
+                filters.at(i)->setCancelFlag(&mCancelRequested);
         bypasses.clear();
         bypasses = mBypasses;
         cache = mCache;
@@ -456,6 +512,7 @@ void ImageFilterList::run()
         const int partialProgress = 100 / filters.count();
         int progress = 0;
         mMustRestart = false;
+        mCancelRequested.storeRelease(0);
 
         emit processingProgress(0);
         if (uc && nFilter > -1)
@@ -463,6 +520,7 @@ void ImageFilterList::run()
             for (int i = 0; i <= nFilter; i++)
             {
                 filters.removeFirst();
+                originals.removeFirst();
                 bypasses.removeFirst();
                 emit processingProgress(progress += partialProgress);
             }
@@ -485,7 +543,18 @@ void ImageFilterList::run()
             mMutex.unlock();
 
             filter = filters.takeFirst();
+            const ImageFilter * original = originals.takeFirst();
             bypass = bypasses.takeFirst();
+            // Images keep their format across the filters that do not mind it, and are only converted where a
+            // filter needs the other one
+            if (pa && filter && !bypass)
+            {
+                const ImageFilter::AlphaHandling alphaHandling = filter->alphaHandling();
+                if (alphaHandling == ImageFilter::AlphaHandling_Premultiplied)
+                    image = convertToPremultipliedAlpha(image);
+                else if (alphaHandling == ImageFilter::AlphaHandling_Straight)
+                    image = convertToStraightAlpha(image);
+            }
             if (uc)
             {
                 if (filter && !bypass)
@@ -512,6 +581,9 @@ void ImageFilterList::run()
                 break;
             }
             mCache = cache;
+            // the copies only live for this run, their timings are kept for the filters they were made from
+            if (filter && !bypass)
+                mStageTimings.insert(original, filter->stageTimings());
             mMutex.unlock();
 
             emit processingProgress(progress += partialProgress);
@@ -526,7 +598,7 @@ void ImageFilterList::run()
         }
         mMutex.unlock();
 
-        emit processingCompleted(image);
+        emit processingCompleted(convertToStraightAlpha(image));
         return;
     }
 }
@@ -49,7 +49,10 @@ public:
     QImage inputImage() const;
     bool autoRun() const;
     bool useCache() const;
+    bool premultipliedAlpha() const;
     bool bypass(int i) const;
+    // stages timed by the last copy of the filter at i that finished, see ImageFilter::stageTimings()
+    QList<QPair<QString, double> > stageTimings(int i) const;
     const ImageFilter *at(int index) const;
     int count() const;
     bool isEmpty() const;
@@ -68,12 +71,16 @@ private:
     QList<bool> mBypasses;
     bool mAutoRun;
     bool mUseCache;
+    bool mPremultipliedAlpha;
     QList<QImage> mCache;
+    QHash<const ImageFilter *, QList<QPair<QString, double> > > mStageTimings;
     QString mName, mDescription;
     ImageFilterPluginLoader * mPluginLoader;
 
     bool mMustRestart;
-    QMutex mMutex;
+    // mMustRestart, readable by the running filters without the mutex
+    QAtomicInt mCancelRequested;
+    mutable QMutex mMutex;
 
     void clearFilterList(QList<ImageFilter *> & list);
     QList<ImageFilter *> copyFilterList(const QList<ImageFilter *> & list) const;
@@ -88,6 +95,7 @@ public slots:
     void setInputImage(const QImage & i);
     void setAutoRun(bool a);
     void setUseCache(bool c);
+    void setPremultipliedAlpha(bool p);
     void setBypass(int i, bool b);
     void append(ImageFilter * f);
     void insert(int index, ImageFilter * f);
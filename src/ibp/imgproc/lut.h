@@ -31,6 +31,7 @@ namespace imgproc {
 extern unsigned char lut01[256][256];
 extern unsigned short lut02[256][256];
 extern unsigned char lut03[256][256];
+extern unsigned int lut04[256];
 
 }}
 #endif // IBP_IMGPROC_LUT_H
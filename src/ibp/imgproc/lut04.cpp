@@ -0,0 +1,48 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+namespace ibp {
+namespace imgproc {
+
+// ceil(255 * 65536 / b), so that a * 255 / b == (a * lut04[b]) >> 16 for a, b in [0, 255]
+unsigned int lut04[256] = {
+0, 16711680, 8355840, 5570560, 4177920, 3342336, 2785280, 2387383, 2088960, 1856854, 1671168, 1519244, 1392640, 1285514, 1193692, 1114112,
+1044480, 983040, 928427, 879563, 835584, 795795, 759622, 726595, 696320, 668468, 642757, 618952, 596846, 576265, 557056, 539087,
+522240, 506415, 491520, 477477, 464214, 451668, 439782, 428505, 417792, 407602, 397898, 388644, 379811, 371371, 363298, 355568,
+348160, 341055, 334234, 327680, 321379, 315315, 309476, 303849, 298423, 293188, 288133, 283249, 278528, 273962, 269544, 265265,
+261120, 257103, 253208, 249429, 245760, 242199, 238739, 235376, 232107, 228928, 225834, 222823, 219891, 217035, 214253, 211541,
+208896, 206318, 203801, 201346, 198949, 196608, 194322, 192089, 189906, 187772, 185686, 183645, 181649, 179696, 177784, 175913,
+174080, 172286, 170528, 168805, 167117, 165463, 163840, 162250, 160690, 159159, 157658, 156184, 154738, 153319, 151925, 150556,
+149212, 147891, 146594, 145319, 144067, 142835, 141625, 140435, 139264, 138114, 136981, 135868, 134772, 133694, 132633, 131589,
+130560, 129548, 128552, 127571, 126604, 125652, 124715, 123791, 122880, 121984, 121100, 120228, 119370, 118523, 117688, 116865,
+116054, 115253, 114464, 113685, 112917, 112159, 111412, 110674, 109946, 109227, 108518, 107818, 107127, 106444, 105771, 105105,
+104448, 103800, 103159, 102526, 101901, 101283, 100673, 100070, 99475, 98886, 98304, 97730, 97161, 96600, 96045, 95496,
+94953, 94417, 93886, 93362, 92843, 92330, 91823, 91321, 90825, 90334, 89848, 89368, 88892, 88422, 87957, 87496,
+87040, 86590, 86143, 85701, 85264, 84831, 84403, 83979, 83559, 83143, 82732, 82324, 81920, 81521, 81125, 80733,
+80345, 79961, 79580, 79203, 78829, 78459, 78092, 77729, 77369, 77013, 76660, 76310, 75963, 75619, 75278, 74941,
+74606, 74275, 73946, 73620, 73297, 72977, 72660, 72345, 72034, 71724, 71418, 71114, 70813, 70514, 70218, 69924,
+69632, 69344, 69057, 68773, 68491, 68211, 67934, 67659, 67386, 67116, 66847, 66581, 66317, 66055, 65795, 65536
+};
+
+}}
@@ -0,0 +1,239 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <opencv2/imgproc.hpp>
+#include <string.h>
+#include <vector>
+
+#include "morphology.h"
+#include "util.h"
+#include "../misc/util.h"
+
+namespace ibp {
+namespace imgproc {
+
+// columns (times channels) processed together in the vertical pass of rectangles
+static const int kColumnStripWidth = 64;
+
+struct KernelRun
+{
+    int dy, dx, length;
+};
+
+template <bool isDilation>
+static inline unsigned char morphologyOp(unsigned char a, unsigned char b)
+{
+    return isDilation ? IBP_maximum(a, b) : IBP_minimum(a, b);
+}
+
+// out[x] = op of in[x + offset] .. in[x + offset + length - 1] for x in [0, n), for each of the lanes interleaved
+// values of every element. Elements outside [0, n) are ignored. extended holds (n + length - 1) * lanes values and
+// prefix and suffix as many (van Herk / Gil-Werman)
+template <bool isDilation>
+static void slidingOp(const unsigned char * in, unsigned char * out, int n, int lanes, int offset, int length,
+                      unsigned char * extended, unsigned char * prefix, unsigned char * suffix)
+{
+    const unsigned char identity = isDilation ? 0 : 255;
+    const int extendedSize = n + length - 1;
+    register int i, l;
+
+    for (i = 0; i < extendedSize; i++)
+    {
+        const int j = i + offset;
+        if (j >= 0 && j < n)
+            memcpy(extended + i * lanes, in + j * lanes, lanes);
+        else
+            memset(extended + i * lanes, identity, lanes);
+    }
+
+    if (length == 1)
+    {
+        memcpy(out, extended, n * lanes);
+        return;
+    }
+
+    for (int blockStart = 0; blockStart < extendedSize; blockStart += length)
+    {
+        const int blockEnd = IBP_minimum(blockStart + length, extendedSize);
+        memcpy(prefix + blockStart * lanes, extended + blockStart * lanes, lanes);
+        for (i = blockStart + 1; i < blockEnd; i++)
+            for (l = 0; l < lanes; l++)
+                prefix[i * lanes + l] = morphologyOp<isDilation>(prefix[(i - 1) * lanes + l],
+                                                                 extended[i * lanes + l]);
+        memcpy(suffix + (blockEnd - 1) * lanes, extended + (blockEnd - 1) * lanes, lanes);
+        for (i = blockEnd - 2; i >= blockStart; i--)
+            for (l = 0; l < lanes; l++)
+                suffix[i * lanes + l] = morphologyOp<isDilation>(suffix[(i + 1) * lanes + l],
+                                                                 extended[i * lanes + l]);
+    }
+
+    // the window [x, x + length - 1] spans at most two blocks: the end of one and the start of the next
+    for (i = 0; i < n; i++)
+        for (l = 0; l < lanes; l++)
+            out[i * lanes + l] = morphologyOp<isDilation>(suffix[i * lanes + l],
+                                                          prefix[(i + length - 1) * lanes + l]);
+}
+
+// true if every row of the kernel is a single run of the same length and position
+static bool isRectangle(const std::vector<KernelRun> & runs, const cv::Mat & kernel)
+{
+    if ((int)runs.size() != kernel.rows)
+        return false;
+    for (size_t i = 1; i < runs.size(); i++)
+        if (runs[i].dx != runs[0].dx || runs[i].length != runs[0].length)
+            return false;
+    return true;
+}
+
+template <bool isDilation>
+static void runMorphology(const cv::Mat & src, cv::Mat & dst, const cv::Mat & kernel)
+{
+    const int w = src.cols, h = src.rows, cn = src.channels();
+    const int anchorX = kernel.cols / 2, anchorY = kernel.rows / 2;
+    int maximumLength = 1;
+
+    // split the structuring element in horizontal runs
+    std::vector<KernelRun> runs;
+    for (int y = 0; y < kernel.rows; y++)
+    {
+        const unsigned char * bitsKernel = kernel.ptr(y);
+        for (int x = 0; x < kernel.cols; x++)
+        {
+            if (!bitsKernel[x])
+                continue;
+            KernelRun run;
+            run.dy = y - anchorY;
+            run.dx = x - anchorX;
+            while (x < kernel.cols && bitsKernel[x])
+                x++;
+            run.length = x - anchorX - run.dx;
+            maximumLength = IBP_maximum(maximumLength, run.length);
+            runs.push_back(run);
+        }
+    }
+
+    if (runs.empty())
+    {
+        dst.setTo(cv::Scalar::all(isDilation ? 0 : 255));
+        return;
+    }
+
+    if (isRectangle(runs, kernel))
+    {
+        // separable: rows first, then strips of columns
+        cv::Mat rows(h, w, src.type());
+        parallelForRows(h, IBP_maximum(1, 16384 / (w * cn)), [&](int startRow, int endRow)
+        {
+            std::vector<unsigned char> buffers(3 * (w + maximumLength) * cn);
+            unsigned char * extended = buffers.data(), * prefix = extended + (w + maximumLength) * cn,
+                          * suffix = prefix + (w + maximumLength) * cn;
+            for (int y = startRow; y < endRow; y++)
+                slidingOp<isDilation>(src.ptr(y), rows.ptr(y), w, cn, runs[0].dx, runs[0].length,
+                                      extended, prefix, suffix);
+        });
+
+        const int rowLength = w * cn, length = kernel.rows, offset = -anchorY;
+        const int nStrips = (rowLength + kColumnStripWidth - 1) / kColumnStripWidth;
+        parallelForRows(nStrips, 1, [&](int startStrip, int endStrip)
+        {
+            std::vector<unsigned char> strip(h * kColumnStripWidth), stripOut(h * kColumnStripWidth);
+            std::vector<unsigned char> buffers(3 * (h + length) * kColumnStripWidth);
+            unsigned char * extended = buffers.data(), * prefix = extended + (h + length) * kColumnStripWidth,
+                          * suffix = prefix + (h + length) * kColumnStripWidth;
+            for (int s = startStrip; s < endStrip; s++)
+            {
+                const int x0 = s * kColumnStripWidth;
+                const int lanes = IBP_minimum(kColumnStripWidth, rowLength - x0);
+                for (int y = 0; y < h; y++)
+                    memcpy(&strip[y * lanes], rows.ptr(y) + x0, lanes);
+                slidingOp<isDilation>(strip.data(), stripOut.data(), h, lanes, offset, length,
+                                      extended, prefix, suffix);
+                for (int y = 0; y < h; y++)
+                    memcpy(dst.ptr(y) + x0, &stripOut[y * lanes], lanes);
+            }
+        });
+        return;
+    }
+
+    // general shapes: every output row is the op of one sliding op per run
+    parallelForRows(h, IBP_maximum(1, 16384 / (w * cn)), [&](int startRow, int endRow)
+    {
+        std::vector<unsigned char> accumulator(w * cn), runOutput(w * cn);
+        std::vector<unsigned char> buffers(3 * (w + maximumLength) * cn);
+        unsigned char * extended = buffers.data(), * prefix = extended + (w + maximumLength) * cn,
+                      * suffix = prefix + (w + maximumLength) * cn;
+        for (int y = startRow; y < endRow; y++)
+        {
+            std::fill(accumulator.begin(), accumulator.end(), isDilation ? 0 : 255);
+            for (size_t r = 0; r < runs.size(); r++)
+            {
+                const int sy = y + runs[r].dy;
+                if (sy < 0 || sy >= h)
+                    continue;
+                slidingOp<isDilation>(src.ptr(sy), runOutput.data(), w, cn, runs[r].dx, runs[r].length,
+                                      extended, prefix, suffix);
+                for (int i = 0; i < w * cn; i++)
+                    accumulator[i] = morphologyOp<isDilation>(accumulator[i], runOutput[i]);
+            }
+            memcpy(dst.ptr(y), accumulator.data(), w * cn);
+        }
+    });
+}
+
+template <bool isDilation>
+static void morphology(cv::InputArray _src, cv::OutputArray _dst, const cv::Mat & kernel)
+{
+    cv::Mat src = _src.getMat();
+    CV_Assert(src.depth() == CV_8U && src.channels() <= 4);
+    CV_Assert(kernel.type() == CV_8UC1);
+
+    _dst.create(src.size(), src.type());
+    cv::Mat dst = _dst.getMat();
+
+    if (IBP_maximum(kernel.cols, kernel.rows) < kRunMorphologyMinimumSize || src.empty())
+    {
+        if (isDilation)
+            cv::dilate(src, dst, kernel);
+        else
+            cv::erode(src, dst, kernel);
+        return;
+    }
+
+    if (src.data == dst.data)
+        src = src.clone();
+
+    runMorphology<isDilation>(src, dst, kernel);
+}
+
+void dilate(cv::InputArray _src, cv::OutputArray _dst, const cv::Mat & kernel)
+{
+    morphology<true>(_src, _dst, kernel);
+}
+
+void erode(cv::InputArray _src, cv::OutputArray _dst, const cv::Mat & kernel)
+{
+    morphology<false>(_src, _dst, kernel);
+}
+
+}}
@@ -0,0 +1,61 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef IBP_IMGPROC_MORPHOLOGY_H
+#define IBP_IMGPROC_MORPHOLOGY_H
+
+#include <opencv2/core.hpp>
+
+namespace ibp {
+namespace imgproc {
+
+/*******************************************************
+** Dilation and erosion of a CV_8UC1 to CV_8UC4 image
+** with the same result as cv::dilate and cv::erode
+** (centered anchor, pixels outside the image ignored).
+** From kRunMorphologyMinimumSize on, the structuring
+** element is split into horizontal runs and every run
+** is a sliding maximum (minimum) in constant time per
+** pixel, so the cost grows with the element height
+** instead of its area; rectangles are separable and
+** cost the same for any size:
+**
+** Marcel van Herk. “A fast algorithm for local minimum
+** and maximum filters on rectangular and octagonal
+** kernels”, Pattern Recognition Letters, 13(7):517-521,
+** Jul. 1992
+**
+** Joseph Gil, Michael Werman. “Computing 2-D min,
+** median, and max filters”, IEEE Transactions on Pattern
+** Analysis and Machine Intelligence, 15(5):504-507,
+** May 1993
+********************************************************/
+const int kRunMorphologyMinimumSize = 11;
+void dilate(cv::InputArray _src, cv::OutputArray _dst, const cv::Mat & kernel);
+void erode(cv::InputArray _src, cv::OutputArray _dst, const cv::Mat & kernel);
+
+} // namespace imgproc
+} // namespace ibp
+
+#endif // IBP_IMGPROC_MORPHOLOGY_H
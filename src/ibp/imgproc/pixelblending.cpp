@@ -22,6 +22,8 @@
 // SOFTWARE.
 //
 
+#include <string.h>
+
 #include "pixelblending.h"
 #include "lut.h"
 #include "util.h"
@@ -46,6 +48,21 @@ blendSourceClearDestination,
 blendSourceXorDestination
 };
 
+void (*premultipliedAlphaBlendColors[12])(BGRA src, BGRA dst, BGRA & blend) = {
+blendPremultipliedSource,
+blendPremultipliedDestination,
+blendPremultipliedSourceOverDestination,
+blendPremultipliedDestinationOverSource,
+blendPremultipliedSourceInDestination,
+blendPremultipliedDestinationInSource,
+blendPremultipliedSourceOutDestination,
+blendPremultipliedDestinationOutSource,
+blendPremultipliedSourceAtopDestination,
+blendPremultipliedDestinationAtopSource,
+blendPremultipliedSourceClearDestination,
+blendPremultipliedSourceXorDestination
+};
+
 void (*blendColors[24])(BGRA src, BGRA dst, BGRA & blend) = {
 blendSourceOverDestination,
 blendDarken,
@@ -94,7 +111,7 @@ if (dst.a == 0) \
 
 #define IBP_EARLY_ALPHA_DISCARD \
 IBP_EARLY_SRC_DST_ALPHA_DISCARD; \
-blend.a = lut03[dst.a][src.a]; \
+blend.a = IBP_screen(dst.a, src.a); \
 IBP_EARLY_BLEND_ALPHA_DISCARD;
 
 #define IBP_PRE_BLEND \
@@ -103,9 +120,9 @@ IBP_premultiplyBGRA(src); \
 IBP_premultiplyBGRA(dst);
 
 #define IBP_POST_BLEND \
-blend.r += lut01[src.r][255 - dst.a] + lut01[dst.r][255 - src.a]; \
-blend.g += lut01[src.g][255 - dst.a] + lut01[dst.g][255 - src.a]; \
-blend.b += lut01[src.b][255 - dst.a] + lut01[dst.b][255 - src.a]; \
+blend.r += IBP_multiply(src.r, 255 - dst.a) + IBP_multiply(dst.r, 255 - src.a); \
+blend.g += IBP_multiply(src.g, 255 - dst.a) + IBP_multiply(dst.g, 255 - src.a); \
+blend.b += IBP_multiply(src.b, 255 - dst.a) + IBP_multiply(dst.b, 255 - src.a); \
 IBP_postmultiplyBGRA(blend);
 
 void blendSource(BGRA src, BGRA /*dst*/, BGRA & blend)
@@ -120,30 +137,30 @@ void blendDestination(BGRA /*src*/, BGRA dst, BGRA & blend)
 
 void blendSourceOverDestination(BGRA src, BGRA dst, BGRA & blend)
 {
-    blend.a = lut03[dst.a][src.a];
+    blend.a = IBP_screen(dst.a, src.a);
     IBP_EARLY_BLEND_ALPHA_DISCARD;
 
     IBP_premultiplyBGRA(src);
     IBP_premultiplyBGRA(dst);
 
-    blend.r = src.r + lut01[dst.r][255 - src.a];
-    blend.g = src.g + lut01[dst.g][255 - src.a];
-    blend.b = src.b + lut01[dst.b][255 - src.a];
+    blend.r = src.r + IBP_multiply(dst.r, 255 - src.a);
+    blend.g = src.g + IBP_multiply(dst.g, 255 - src.a);
+    blend.b = src.b + IBP_multiply(dst.b, 255 - src.a);
 
     IBP_postmultiplyBGRA(blend);
 }
 
 void blendDestinationOverSource(BGRA src, BGRA dst, BGRA & blend)
 {
-    blend.a = lut03[src.a][dst.a];
+    blend.a = IBP_screen(src.a, dst.a);
     IBP_EARLY_BLEND_ALPHA_DISCARD;
 
     IBP_premultiplyBGRA(src);
     IBP_premultiplyBGRA(dst);
 
-    blend.r = dst.r + lut01[src.r][255 - dst.a];
-    blend.g = dst.g + lut01[src.g][255 - dst.a];
-    blend.b = dst.b + lut01[src.b][255 - dst.a];
+    blend.r = dst.r + IBP_multiply(src.r, 255 - dst.a);
+    blend.g = dst.g + IBP_multiply(src.g, 255 - dst.a);
+    blend.b = dst.b + IBP_multiply(src.b, 255 - dst.a);
 
     IBP_postmultiplyBGRA(blend);
 }
@@ -153,7 +170,7 @@ void blendSourceInDestination(BGRA src, BGRA dst, BGRA & blend)
     blend.r = src.r;
     blend.g = src.g;
     blend.b = src.b;
-    blend.a = lut01[src.a][dst.a];
+    blend.a = IBP_multiply(src.a, dst.a);
 }
 
 void blendDestinationInSource(BGRA src, BGRA dst, BGRA & blend)
@@ -161,7 +178,7 @@ void blendDestinationInSource(BGRA src, BGRA dst, BGRA & blend)
     blend.r = dst.r;
     blend.g = dst.g;
     blend.b = dst.b;
-    blend.a = lut01[dst.a][src.a];
+    blend.a = IBP_multiply(dst.a, src.a);
 }
 
 void blendSourceOutDestination(BGRA src, BGRA dst, BGRA & blend)
@@ -169,7 +186,7 @@ void blendSourceOutDestination(BGRA src, BGRA dst, BGRA & blend)
     blend.r = src.r;
     blend.g = src.g;
     blend.b = src.b;
-    blend.a = lut01[src.a][255 - dst.a];
+    blend.a = IBP_multiply(src.a, 255 - dst.a);
 }
 
 void blendDestinationOutSource(BGRA src, BGRA dst, BGRA & blend)
@@ -177,16 +194,16 @@ void blendDestinationOutSource(BGRA src, BGRA dst, BGRA & blend)
     blend.r = dst.r;
     blend.g = dst.g;
     blend.b = dst.b;
-    blend.a = lut01[dst.a][255 - src.a];
+    blend.a = IBP_multiply(dst.a, 255 - src.a);
 }
 
 void blendSourceAtopDestination(BGRA src, BGRA dst, BGRA & blend)
 {
     IBP_premultiplyBGRA(src);
 
-    blend.r = src.r + lut01[dst.r][255 - src.a];
-    blend.g = src.g + lut01[dst.g][255 - src.a];
-    blend.b = src.b + lut01[dst.b][255 - src.a];
+    blend.r = src.r + IBP_multiply(dst.r, 255 - src.a);
+    blend.g = src.g + IBP_multiply(dst.g, 255 - src.a);
+    blend.b = src.b + IBP_multiply(dst.b, 255 - src.a);
     blend.a = dst.a;
 }
 
@@ -194,9 +211,9 @@ void blendDestinationAtopSource(BGRA src, BGRA dst, BGRA & blend)
 {
     IBP_premultiplyBGRA(dst);
 
-    blend.r = dst.r + lut01[src.r][255 - dst.a];
-    blend.g = dst.g + lut01[src.g][255 - dst.a];
-    blend.b = dst.b + lut01[src.b][255 - dst.a];
+    blend.r = dst.r + IBP_multiply(src.r, 255 - dst.a);
+    blend.g = dst.g + IBP_multiply(src.g, 255 - dst.a);
+    blend.b = dst.b + IBP_multiply(src.b, 255 - dst.a);
     blend.a = src.a;
 }
 
@@ -207,26 +224,117 @@ void blendSourceClearDestination(BGRA /*src*/, BGRA /*dst*/, BGRA & blend)
 
 void blendSourceXorDestination(BGRA src, BGRA dst, BGRA & blend)
 {
-    blend.a = src.a + dst.a - (lut01[src.a][dst.a] << 1);
+    blend.a = src.a + dst.a - (IBP_multiply(src.a, dst.a) << 1);
     IBP_EARLY_BLEND_ALPHA_DISCARD;
 
     IBP_premultiplyBGRA(src);
     IBP_premultiplyBGRA(dst);
 
-    blend.r = lut01[src.r][255 - dst.a] + lut01[dst.r][255 - src.a];
-    blend.g = lut01[src.g][255 - dst.a] + lut01[dst.g][255 - src.a];
-    blend.b = lut01[src.b][255 - dst.a] + lut01[dst.b][255 - src.a];
+    blend.r = IBP_multiply(src.r, 255 - dst.a) + IBP_multiply(dst.r, 255 - src.a);
+    blend.g = IBP_multiply(src.g, 255 - dst.a) + IBP_multiply(dst.g, 255 - src.a);
+    blend.b = IBP_multiply(src.b, 255 - dst.a) + IBP_multiply(dst.b, 255 - src.a);
 
     IBP_postmultiplyBGRA(blend);
 }
 
+void blendPremultipliedSource(BGRA src, BGRA /*dst*/, BGRA & blend)
+{
+    blend = src;
+}
+
+void blendPremultipliedDestination(BGRA /*src*/, BGRA dst, BGRA & blend)
+{
+    blend = dst;
+}
+
+void blendPremultipliedSourceOverDestination(BGRA src, BGRA dst, BGRA & blend)
+{
+    blend.r = src.r + IBP_multiply(dst.r, 255 - src.a);
+    blend.g = src.g + IBP_multiply(dst.g, 255 - src.a);
+    blend.b = src.b + IBP_multiply(dst.b, 255 - src.a);
+    blend.a = src.a + IBP_multiply(dst.a, 255 - src.a);
+}
+
+void blendPremultipliedDestinationOverSource(BGRA src, BGRA dst, BGRA & blend)
+{
+    blend.r = dst.r + IBP_multiply(src.r, 255 - dst.a);
+    blend.g = dst.g + IBP_multiply(src.g, 255 - dst.a);
+    blend.b = dst.b + IBP_multiply(src.b, 255 - dst.a);
+    blend.a = dst.a + IBP_multiply(src.a, 255 - dst.a);
+}
+
+void blendPremultipliedSourceInDestination(BGRA src, BGRA dst, BGRA & blend)
+{
+    IBP_premultiplyBGRAWithAlpha(src, dst.a);
+    blend.r = src.r;
+    blend.g = src.g;
+    blend.b = src.b;
+    blend.a = IBP_multiply(src.a, dst.a);
+}
+
+void blendPremultipliedDestinationInSource(BGRA src, BGRA dst, BGRA & blend)
+{
+    IBP_premultiplyBGRAWithAlpha(dst, src.a);
+    blend.r = dst.r;
+    blend.g = dst.g;
+    blend.b = dst.b;
+    blend.a = IBP_multiply(dst.a, src.a);
+}
+
+void blendPremultipliedSourceOutDestination(BGRA src, BGRA dst, BGRA & blend)
+{
+    IBP_premultiplyBGRAWithAlpha(src, 255 - dst.a);
+    blend.r = src.r;
+    blend.g = src.g;
+    blend.b = src.b;
+    blend.a = IBP_multiply(src.a, 255 - dst.a);
+}
+
+void blendPremultipliedDestinationOutSource(BGRA src, BGRA dst, BGRA & blend)
+{
+    IBP_premultiplyBGRAWithAlpha(dst, 255 - src.a);
+    blend.r = dst.r;
+    blend.g = dst.g;
+    blend.b = dst.b;
+    blend.a = IBP_multiply(dst.a, 255 - src.a);
+}
+
+void blendPremultipliedSourceAtopDestination(BGRA src, BGRA dst, BGRA & blend)
+{
+    blend.r = IBP_multiply(src.r, dst.a) + IBP_multiply(dst.r, 255 - src.a);
+    blend.g = IBP_multiply(src.g, dst.a) + IBP_multiply(dst.g, 255 - src.a);
+    blend.b = IBP_multiply(src.b, dst.a) + IBP_multiply(dst.b, 255 - src.a);
+    blend.a = dst.a;
+}
+
+void blendPremultipliedDestinationAtopSource(BGRA src, BGRA dst, BGRA & blend)
+{
+    blend.r = IBP_multiply(dst.r, src.a) + IBP_multiply(src.r, 255 - dst.a);
+    blend.g = IBP_multiply(dst.g, src.a) + IBP_multiply(src.g, 255 - dst.a);
+    blend.b = IBP_multiply(dst.b, src.a) + IBP_multiply(src.b, 255 - dst.a);
+    blend.a = src.a;
+}
+
+void blendPremultipliedSourceClearDestination(BGRA /*src*/, BGRA /*dst*/, BGRA & blend)
+{
+    blend.r = blend.g = blend.b = blend.a = 0;
+}
+
+void blendPremultipliedSourceXorDestination(BGRA src, BGRA dst, BGRA & blend)
+{
+    blend.r = IBP_multiply(src.r, 255 - dst.a) + IBP_multiply(dst.r, 255 - src.a);
+    blend.g = IBP_multiply(src.g, 255 - dst.a) + IBP_multiply(dst.g, 255 - src.a);
+    blend.b = IBP_multiply(src.b, 255 - dst.a) + IBP_multiply(dst.b, 255 - src.a);
+    blend.a = src.a + dst.a - (IBP_multiply(src.a, dst.a) << 1);
+}
+
 void blendDarken(BGRA src, BGRA dst, BGRA & blend)
 {
     IBP_PRE_BLEND
 
-    blend.r = qMin<int>(lut01[src.r][dst.a], lut01[dst.r][src.a]);
-    blend.g = qMin<int>(lut01[src.g][dst.a], lut01[dst.g][src.a]);
-    blend.b = qMin<int>(lut01[src.b][dst.a], lut01[dst.b][src.a]);
+    blend.r = qMin<int>(IBP_multiply(src.r, dst.a), IBP_multiply(dst.r, src.a));
+    blend.g = qMin<int>(IBP_multiply(src.g, dst.a), IBP_multiply(dst.g, src.a));
+    blend.b = qMin<int>(IBP_multiply(src.b, dst.a), IBP_multiply(dst.b, src.a));
 
     IBP_POST_BLEND
 }
@@ -235,9 +343,9 @@ void blendMultiply(BGRA src, BGRA dst, BGRA & blend)
 {
     IBP_PRE_BLEND
 
-    blend.r = lut01[src.r][dst.r];
-    blend.g = lut01[src.g][dst.g];
-    blend.b = lut01[src.b][dst.b];
+    blend.r = IBP_multiply(src.r, dst.r);
+    blend.g = IBP_multiply(src.g, dst.g);
+    blend.b = IBP_multiply(src.b, dst.b);
 
     IBP_POST_BLEND
 }
@@ -249,33 +357,36 @@ void blendColorBurn(BGRA src, BGRA dst, BGRA & blend)
     if (src.r == 0)
     {
         if (dst.r == dst.a)
-            blend.r = lut01[src.a][dst.a] + lut01[dst.r][255 - src.a];
+            blend.r = IBP_multiply(src.a, dst.a) + IBP_multiply(dst.r, 255 - src.a);
         else
-            blend.r = lut01[dst.r][255 - src.a];
+            blend.r = IBP_multiply(dst.r, 255 - src.a);
     }
     else
-        blend.r = lut01[lut01[src.a][dst.a]][255 - qMin<int>(255, (255 - lut02[dst.r][dst.a]) * src.a / src.r)] +
-                  lut01[src.r][255 - dst.a] + lut01[dst.r][255 - src.a];
+        blend.r = IBP_multiply(IBP_multiply(src.a, dst.a),
+                               255 - qMin<int>(255, (255 - IBP_divide(dst.r, dst.a)) * src.a / src.r)) +
+                  IBP_multiply(src.r, 255 - dst.a) + IBP_multiply(dst.r, 255 - src.a);
     if (src.g == 0)
     {
         if (dst.g == dst.a)
-            blend.g = lut01[src.a][dst.a] + lut01[dst.g][255 - src.a];
+            blend.g = IBP_multiply(src.a, dst.a) + IBP_multiply(dst.g, 255 - src.a);
         else
-            blend.g = lut01[dst.g][255 - src.a];
+            blend.g = IBP_multiply(dst.g, 255 - src.a);
     }
     else
-        blend.g = lut01[lut01[src.a][dst.a]][255 - qMin<int>(255, (255 - lut02[dst.g][dst.a]) * src.a / src.g)] +
-                lut01[src.g][255 - dst.a] + lut01[dst.g][255 - src.a];
+        blend.g = IBP_multiply(IBP_multiply(src.a, dst.a),
+                               255 - qMin<int>(255, (255 - IBP_divide(dst.g, dst.a)) * src.a / src.g)) +
+                IBP_multiply(src.g, 255 - dst.a) + IBP_multiply(dst.g, 255 - src.a);
     if (src.b == 0)
     {
         if (dst.b == dst.a)
-            blend.b = lut01[src.a][dst.a] + lut01[dst.b][255 - src.a];
+            blend.b = IBP_multiply(src.a, dst.a) + IBP_multiply(dst.b, 255 - src.a);
         else
-            blend.b = lut01[dst.b][255 - src.a];
+            blend.b = IBP_multiply(dst.b, 255 - src.a);
     }
     else
-        blend.b = lut01[lut01[src.a][dst.a]][255 - qMin<int>(255, (255 - lut02[dst.b][dst.a]) * src.a / src.b)] +
-                lut01[src.b][255 - dst.a] + lut01[dst.b][255 - src.a];
+        blend.b = IBP_multiply(IBP_multiply(src.a, dst.a),
+                               255 - qMin<int>(255, (255 - IBP_divide(dst.b, dst.a)) * src.a / src.b)) +
+                IBP_multiply(src.b, 255 - dst.a) + IBP_multiply(dst.b, 255 - src.a);
 
     IBP_postmultiplyBGRA(blend);
 }
@@ -284,9 +395,9 @@ void blendLinearBurn(BGRA src, BGRA dst, BGRA & blend)
 {
     IBP_PRE_BLEND
 
-    blend.r = qMax<int>(src.r + dst.r - lut01[src.a][dst.a], 0);
-    blend.g = qMax<int>(src.g + dst.g - lut01[src.a][dst.a], 0);
-    blend.b = qMax<int>(src.b + dst.b - lut01[src.a][dst.a], 0);
+    blend.r = qMax<int>(src.r + dst.r - IBP_multiply(src.a, dst.a), 0);
+    blend.g = qMax<int>(src.g + dst.g - IBP_multiply(src.a, dst.a), 0);
+    blend.b = qMax<int>(src.b + dst.b - IBP_multiply(src.a, dst.a), 0);
 
     IBP_postmultiplyBGRA(blend);
 }
@@ -297,15 +408,15 @@ void blendDarkerColor(BGRA src, BGRA dst, BGRA & blend)
 
     if (IBP_pixelIntensity1(src) < IBP_pixelIntensity1(dst))
     {
-        blend.r = lut01[src.r][dst.a];
-        blend.g = lut01[src.g][dst.a];
-        blend.b = lut01[src.b][dst.a];
+        blend.r = IBP_multiply(src.r, dst.a);
+        blend.g = IBP_multiply(src.g, dst.a);
+        blend.b = IBP_multiply(src.b, dst.a);
     }
     else
     {
-        blend.r = lut01[dst.r][src.a];
-        blend.g = lut01[dst.g][src.a];
-        blend.b = lut01[dst.b][src.a];
+        blend.r = IBP_multiply(dst.r, src.a);
+        blend.g = IBP_multiply(dst.g, src.a);
+        blend.b = IBP_multiply(dst.b, src.a);
     }
 
     IBP_POST_BLEND
@@ -316,9 +427,9 @@ void blendLighten(BGRA src, BGRA dst, BGRA & blend)
 {
     IBP_PRE_BLEND
 
-    blend.r = qMax<int>(lut01[src.r][dst.a], lut01[dst.r][src.a]);
-    blend.g = qMax<int>(lut01[src.g][dst.a], lut01[dst.g][src.a]);
-    blend.b = qMax<int>(lut01[src.b][dst.a], lut01[dst.b][src.a]);
+    blend.r = qMax<int>(IBP_multiply(src.r, dst.a), IBP_multiply(dst.r, src.a));
+    blend.g = qMax<int>(IBP_multiply(src.g, dst.a), IBP_multiply(dst.g, src.a));
+    blend.b = qMax<int>(IBP_multiply(src.b, dst.a), IBP_multiply(dst.b, src.a));
 
     IBP_POST_BLEND
 }
@@ -327,9 +438,9 @@ void blendScreen(BGRA src, BGRA dst, BGRA & blend)
 {
     IBP_PRE_BLEND
 
-    blend.r = lut03[src.r][dst.r];
-    blend.g = lut03[src.g][dst.g];
-    blend.b = lut03[src.b][dst.b];
+    blend.r = IBP_screen(src.r, dst.r);
+    blend.g = IBP_screen(src.g, dst.g);
+    blend.b = IBP_screen(src.b, dst.b);
 
     IBP_postmultiplyBGRA(blend);
 }
@@ -341,33 +452,39 @@ void blendColorDodge(BGRA src, BGRA dst, BGRA & blend)
     if (src.r == src.a)
     {
         if (dst.r == 0)
-            blend.r = lut01[src.r][255 - dst.a];
+            blend.r = IBP_multiply(src.r, 255 - dst.a);
         else
-            blend.r = lut01[src.a][dst.a] + lut01[src.r][255- dst.a] + lut01[dst.r][255 - src.a];
+            blend.r = IBP_multiply(src.a, dst.a) + IBP_multiply(src.r, 255- dst.a) +
+                    IBP_multiply(dst.r, 255 - src.a);
     }
     else
-        blend.r = lut01[lut01[src.a][dst.a]][qMin<int>(255, lut02[dst.r][dst.a] * src.a / (src.a - src.r))] +
-                lut01[src.r][255- dst.a] + lut01[dst.r][255 - src.a];
+        blend.r = IBP_multiply(IBP_multiply(src.a, dst.a),
+                               qMin<int>(255, IBP_divide(dst.r, dst.a) * src.a / (src.a - src.r))) +
+                IBP_multiply(src.r, 255- dst.a) + IBP_multiply(dst.r, 255 - src.a);
     if (src.g == src.a)
     {
         if (dst.g == 0)
-            blend.g = lut01[src.g][255 - dst.a];
+            blend.g = IBP_multiply(src.g, 255 - dst.a);
         else
-            blend.g = lut01[src.a][dst.a] + lut01[src.g][255- dst.a] + lut01[dst.g][255 - src.a];
+            blend.g = IBP_multiply(src.a, dst.a) + IBP_multiply(src.g, 255- dst.a) +
+                    IBP_multiply(dst.g, 255 - src.a);
     }
     else
-        blend.g = lut01[lut01[src.a][dst.a]][qMin<int>(255, lut02[dst.g][dst.a] * src.a / (src.a - src.g))] +
-                lut01[src.g][255- dst.a] + lut01[dst.g][255 - src.a];
+        blend.g = IBP_multiply(IBP_multiply(src.a, dst.a),
+                               qMin<int>(255, IBP_divide(dst.g, dst.a) * src.a / (src.a - src.g))) +
+                IBP_multiply(src.g, 255- dst.a) + IBP_multiply(dst.g, 255 - src.a);
     if (src.b == src.a)
     {
         if (dst.b == 0)
-            blend.b = lut01[src.b][255 - dst.a];
+            blend.b = IBP_multiply(src.b, 255 - dst.a);
         else
-            blend.b = lut01[src.a][dst.a] + lut01[src.b][255- dst.a] + lut01[dst.b][255 - src.a];
+            blend.b = IBP_multiply(src.a, dst.a) + IBP_multiply(src.b, 255- dst.a) +
+                    IBP_multiply(dst.b, 255 - src.a);
     }
     else
-        blend.b = lut01[lut01[src.a][dst.a]][qMin<int>(255, lut02[dst.b][dst.a] * src.a / (src.a - src.b))] +
-                lut01[src.b][255- dst.a] + lut01[dst.b][255 - src.a];
+        blend.b = IBP_multiply(IBP_multiply(src.a, dst.a),
+                               qMin<int>(255, IBP_divide(dst.b, dst.a) * src.a / (src.a - src.b))) +
+                IBP_multiply(src.b, 255- dst.a) + IBP_multiply(dst.b, 255 - src.a);
 
     IBP_postmultiplyBGRA(blend);
 }
@@ -379,9 +496,9 @@ void blendLinearDodge(BGRA src, BGRA dst, BGRA & blend)
     //blend.r = qMin<int>((src.r + dst.r) * 255 / blend.a, 255);
     //blend.g = qMin<int>((src.g + dst.g) * 255 / blend.a, 255);
     //blend.b = qMin<int>((src.b + dst.b) * 255 / blend.a, 255);
-    blend.r = qMin<int>(lut02[src.r][blend.a] + lut02[dst.r][blend.a], 255);
-    blend.g = qMin<int>(lut02[src.g][blend.a] + lut02[dst.g][blend.a], 255);
-    blend.b = qMin<int>(lut02[src.b][blend.a] + lut02[dst.b][blend.a], 255);
+    blend.r = qMin<int>(IBP_divide(src.r, blend.a) + IBP_divide(dst.r, blend.a), 255);
+    blend.g = qMin<int>(IBP_divide(src.g, blend.a) + IBP_divide(dst.g, blend.a), 255);
+    blend.b = qMin<int>(IBP_divide(src.b, blend.a) + IBP_divide(dst.b, blend.a), 255);
 }
 
 void blendLighterColor(BGRA src, BGRA dst, BGRA & blend)
@@ -390,15 +507,15 @@ void blendLighterColor(BGRA src, BGRA dst, BGRA & blend)
 
     if (IBP_pixelIntensity1(src) > IBP_pixelIntensity1(dst))
     {
-        blend.r = lut01[src.r][dst.a];
-        blend.g = lut01[src.g][dst.a];
-        blend.b = lut01[src.b][dst.a];
+        blend.r = IBP_multiply(src.r, dst.a);
+        blend.g = IBP_multiply(src.g, dst.a);
+        blend.b = IBP_multiply(src.b, dst.a);
     }
     else
     {
-        blend.r = lut01[dst.r][src.a];
-        blend.g = lut01[dst.g][src.a];
-        blend.b = lut01[dst.b][src.a];
+        blend.r = IBP_multiply(dst.r, src.a);
+        blend.g = IBP_multiply(dst.g, src.a);
+        blend.b = IBP_multiply(dst.b, src.a);
     }
 
     IBP_POST_BLEND
@@ -410,22 +527,25 @@ void blendOverlay(BGRA src, BGRA dst, BGRA & blend)
     IBP_PRE_BLEND
 
     if (2 * dst.r <= dst.a)
-        blend.r = 2 * lut01[src.r][dst.r] + lut01[src.r][255 - dst.a] + lut01[dst.r][255 - src.a];
+        blend.r = 2 * IBP_multiply(src.r, dst.r) + IBP_multiply(src.r, 255 - dst.a) +
+                IBP_multiply(dst.r, 255 - src.a);
     else
-        blend.r = src.r * (255 + dst.a) / 255 + dst.r * (255 + src.a) / 255 - 2 * lut01[dst.r][src.r] -
-                lut01[dst.a][src.a];
+        blend.r = src.r * (255 + dst.a) / 255 + dst.r * (255 + src.a) / 255 - 2 * IBP_multiply(dst.r, src.r) -
+                IBP_multiply(dst.a, src.a);
 
     if (2 * dst.g <= dst.a)
-        blend.g = 2 * lut01[src.g][dst.g] + lut01[src.g][255 - dst.a] + lut01[dst.g][255 - src.a];
+        blend.g = 2 * IBP_multiply(src.g, dst.g) + IBP_multiply(src.g, 255 - dst.a) +
+                IBP_multiply(dst.g, 255 - src.a);
     else
-        blend.g = src.g * (255 + dst.a) / 255 + dst.g * (255 + src.a) / 255 - 2 * lut01[dst.g][src.g] -
-                lut01[dst.a][src.a];
+        blend.g = src.g * (255 + dst.a) / 255 + dst.g * (255 + src.a) / 255 - 2 * IBP_multiply(dst.g, src.g) -
+                IBP_multiply(dst.a, src.a);
 
     if (2 * dst.b <= dst.a)
-        blend.b = 2 * lut01[src.b][dst.b] + lut01[src.b][255 - dst.a] + lut01[dst.b][255 - src.a];
+        blend.b = 2 * IBP_multiply(src.b, dst.b) + IBP_multiply(src.b, 255 - dst.a) +
+                IBP_multiply(dst.b, 255 - src.a);
     else
-        blend.b = src.b * (255 + dst.a) / 255 + dst.b * (255 + src.a) / 255 - 2 * lut01[dst.b][src.b] -
-                lut01[dst.a][src.a];
+        blend.b = src.b * (255 + dst.a) / 255 + dst.b * (255 + src.a) / 255 - 2 * IBP_multiply(dst.b, src.b) -
+                IBP_multiply(dst.a, src.a);
 
     IBP_postmultiplyBGRA(blend);
 }
@@ -436,32 +556,35 @@ void blendSoftLight(BGRA src, BGRA dst, BGRA & blend)
 
     IBP_PRE_BLEND
 
-    m = lut02[dst.r][dst.a] / 255.0f;
+    m = IBP_divide(dst.r, dst.a) / 255.0f;
     if (2 * src.r < src.a)
-        blend.r = lut01[dst.r][src.a + (int)((2 * src.r - src.a) * (1.0f - m))];
+        blend.r = IBP_multiply(dst.r, src.a + (int)((2 * src.r - src.a) * (1.0f - m)));
     else if (2 * src.r > src.a && 4 * dst.r <= dst.a)
-        blend.r = lut01[dst.r][src.a] + lut01[dst.a][(int)((2 * src.r - src.a) * (((4.0f * m) * (4.0f * m + 1.0f)) *
-                                                                                  (m - 1.0f) + 7.0f * m))];
+        blend.r = IBP_multiply(dst.r, src.a) + IBP_multiply(dst.a, (int)((2 * src.r - src.a) *
+                                                                           (((4.0f * m) * (4.0f * m + 1.0f)) *
+                                                                           (m - 1.0f) + 7.0f * m)));
     else
-        blend.r = lut01[dst.r][src.a] + lut01[dst.a][(int)((2 * src.r - src.a) * (pow(m, 0.5f) - m))];
+        blend.r = IBP_multiply(dst.r, src.a) + IBP_multiply(dst.a, (int)((2 * src.r - src.a) * (pow(m, 0.5f) - m)));
 
-    m = lut02[dst.g][dst.a] / 255.0f;
+    m = IBP_divide(dst.g, dst.a) / 255.0f;
     if (2 * src.g < src.a)
-        blend.g = lut01[dst.g][src.a + (int)((2 * src.g - src.a) * (1.0f - m))];
+        blend.g = IBP_multiply(dst.g, src.a + (int)((2 * src.g - src.a) * (1.0f - m)));
     else if (2 * src.g > src.a && 4 * dst.g <= dst.a)
-        blend.g = lut01[dst.g][src.a] + lut01[dst.a][(int)((2 * src.g - src.a) * (((4.0f * m) * (4.0f * m + 1.0f)) *
-                                                                                  (m - 1.0f) + 7.0f * m))];
+        blend.g = IBP_multiply(dst.g, src.a) + IBP_multiply(dst.a, (int)((2 * src.g - src.a) *
+                                                                           (((4.0f * m) * (4.0f * m + 1.0f)) *
+                                                                           (m - 1.0f) + 7.0f * m)));
     else
-        blend.g = lut01[dst.g][src.a] + lut01[dst.a][(int)((2 * src.g - src.a) * (pow(m, 0.5f) - m))];
+        blend.g = IBP_multiply(dst.g, src.a) + IBP_multiply(dst.a, (int)((2 * src.g - src.a) * (pow(m, 0.5f) - m)));
 
-    m = lut02[dst.b][dst.a] / 255.0f;
+    m = IBP_divide(dst.b, dst.a) / 255.0f;
     if (2 * src.b < src.a)
-        blend.b = lut01[dst.b][src.a + (int)((2 * src.b - src.a) * (1.0f - m))];
+        blend.b = IBP_multiply(dst.b, src.a + (int)((2 * src.b - src.a) * (1.0f - m)));
     else if (2 * src.b > src.a && 4 * dst.b <= dst.a)
-        blend.b = lut01[dst.b][src.a] + lut01[dst.a][(int)((2 * src.b - src.a) * (((4.0f * m) * (4.0f * m + 1.0f)) *
-                                                                                  (m - 1.0f) + 7.0f * m))];
+        blend.b = IBP_multiply(dst.b, src.a) + IBP_multiply(dst.a, (int)((2 * src.b - src.a) *
+                                                                           (((4.0f * m) * (4.0f * m + 1.0f)) *
+                                                                           (m - 1.0f) + 7.0f * m)));
     else
-        blend.b = lut01[dst.b][src.a] + lut01[dst.a][(int)((2 * src.b - src.a) * (pow(m, 0.5f) - m))];
+        blend.b = IBP_multiply(dst.b, src.a) + IBP_multiply(dst.a, (int)((2 * src.b - src.a) * (pow(m, 0.5f) - m)));
 
     IBP_POST_BLEND
 }
@@ -471,22 +594,25 @@ void blendHardLight(BGRA src, BGRA dst, BGRA & blend)
     IBP_PRE_BLEND
 
     if (2 * src.r <= src.a)
-        blend.r = 2 * lut01[src.r][dst.r] + lut01[src.r][255 - dst.a] + lut01[dst.r][255 - src.a];
+        blend.r = 2 * IBP_multiply(src.r, dst.r) + IBP_multiply(src.r, 255 - dst.a) +
+                IBP_multiply(dst.r, 255 - src.a);
     else
-        blend.r = src.r * (255 + dst.a) / 255 + dst.r * (255 + src.a) / 255 - 2 * lut01[src.r][dst.r] -
-                lut01[src.a][dst.a];
+        blend.r = src.r * (255 + dst.a) / 255 + dst.r * (255 + src.a) / 255 - 2 * IBP_multiply(src.r, dst.r) -
+                IBP_multiply(src.a, dst.a);
 
     if (2 * src.g <= src.a)
-        blend.g = 2 * lut01[src.g][dst.g] + lut01[src.g][255 - dst.a] + lut01[dst.g][255 - src.a];
+        blend.g = 2 * IBP_multiply(src.g, dst.g) + IBP_multiply(src.g, 255 - dst.a) +
+                IBP_multiply(dst.g, 255 - src.a);
     else
-        blend.g = src.g * (255 + dst.a) / 255 + dst.g * (255 + src.a) / 255 - 2 * lut01[src.g][dst.g] -
-                lut01[src.a][dst.a];
+        blend.g = src.g * (255 + dst.a) / 255 + dst.g * (255 + src.a) / 255 - 2 * IBP_multiply(src.g, dst.g) -
+                IBP_multiply(src.a, dst.a);
 
     if (2 * src.b <= src.a)
-        blend.b = 2 * lut01[src.b][dst.b] + lut01[src.b][255 - dst.a] + lut01[dst.b][255 - src.a];
+        blend.b = 2 * IBP_multiply(src.b, dst.b) + IBP_multiply(src.b, 255 - dst.a) +
+                IBP_multiply(dst.b, 255 - src.a);
     else
-        blend.b = src.b * (255 + dst.a) / 255 + dst.b * (255 + src.a) / 255 - 2 * lut01[src.b][dst.b] -
-                lut01[src.a][dst.a];
+        blend.b = src.b * (255 + dst.a) / 255 + dst.b * (255 + src.a) / 255 - 2 * IBP_multiply(src.b, dst.b) -
+                IBP_multiply(src.a, dst.a);
 
     IBP_postmultiplyBGRA(blend);
 }
@@ -499,70 +625,79 @@ void blendVividLight(BGRA src, BGRA dst, BGRA & blend)
     {
         if (src.r == 0)
         {
-            blend.r = lut01[dst.r][255 - src.a];
+            blend.r = IBP_multiply(dst.r, 255 - src.a);
         }
         else
-            blend.r = lut01[lut01[src.a][dst.a]][255 - qMin<int>(255, (255 - lut02[dst.r][dst.a]) * src.a /
-                    (2 * src.r))] + lut01[src.r][255 - dst.a] + lut01[dst.r][255 - src.a];
+            blend.r = IBP_multiply(IBP_multiply(src.a, dst.a),
+                                   255 - qMin<int>(255, (255 - IBP_divide(dst.r, dst.a)) * src.a / (2 * src.r))) +
+                    IBP_multiply(src.r, 255 - dst.a) + IBP_multiply(dst.r, 255 - src.a);
     }
     else
     {
         if (src.r == src.a)
         {
             if (dst.r == 0)
-                blend.r = lut01[src.r][255 - dst.a];
+                blend.r = IBP_multiply(src.r, 255 - dst.a);
             else
-                blend.r = lut01[src.a][dst.a] + lut01[src.r][255 - dst.a] + lut01[dst.r][255 - src.a];
+                blend.r = IBP_multiply(src.a, dst.a) + IBP_multiply(src.r, 255 - dst.a) +
+                        IBP_multiply(dst.r, 255 - src.a);
         }
         else
-            blend.r = lut01[lut01[src.a][dst.a]][qMin<int>(255, lut02[dst.r][dst.a] * src.a /
-                    (2 * (src.a - src.r)))] + lut01[src.r][255 - dst.a] + lut01[dst.r][255 - src.a];
+            blend.r = IBP_multiply(IBP_multiply(src.a, dst.a),
+                                   qMin<int>(255, IBP_divide(dst.r, dst.a) * src.a / (2 * (src.a - src.r)))) +
+                    IBP_multiply(src.r, 255 - dst.a) + IBP_multiply(dst.r, 255 - src.a);
     }
     if (2 * src.g <= src.a)
     {
         if (src.g == 0)
         {
-            blend.g = lut01[dst.g][255 - src.a];
+            blend.g = IBP_multiply(dst.g, 255 - src.a);
         }
         else
-            blend.g = lut01[lut01[src.a][dst.a]][255 - qMin<int>(255, (255 - lut02[dst.g][dst.a]) * src.a /
-                    (2 * src.g))] + lut01[src.g][255 - dst.a] + lut01[dst.g][255 - src.a];
+            blend.g = IBP_multiply(IBP_multiply(src.a, dst.a),
+                                   255 - qMin<int>(255, (255 - IBP_divide(dst.g, dst.a)) * src.a / (2 * src.g))) +
+                    IBP_multiply(src.g, 255 - dst.a) + IBP_multiply(dst.g, 255 - src.a);
     }
     else
     {
         if (src.g == src.a)
         {
             if (dst.g == 0)
-                blend.g = lut01[src.g][255 - dst.a];
+                blend.g = IBP_multiply(src.g, 255 - dst.a);
             else
-                blend.g = lut01[src.a][dst.a] + lut01[src.g][255 - dst.a] + lut01[dst.g][255 - src.a];
+                blend.g = IBP_multiply(src.a, dst.a) + IBP_multiply(src.g, 255 - dst.a) +
+                        IBP_multiply(dst.g, 255 - src.a);
         }
         else
-            blend.g = lut01[lut01[src.a][dst.a]][qMin<int>(255, lut02[dst.g][dst.a] * src.a /
-                    (2 * (src.a - src.g)))] + lut01[src.g][255 - dst.a] + lut01[dst.g][255 - src.a];
+            blend.g = IBP_multiply(IBP_multiply(src.a, dst.a),
+                                   qMin<int>(255, IBP_divide(dst.g, dst.a) * src.a / (2 * (src.a - src.g)))) +
+                    IBP_multiply(src.g, 255 - dst.a) + IBP_multiply(dst.g, 255 - src.a);
     }
     if (2 * src.b <= src.a)
     {
         if (src.b == 0)
         {
-            blend.b = lut01[dst.b][255 - src.a];
+            blend.b = IBP_multiply(dst.b, 255 - src.a);
         }
         else
-            blend.b = lut01[lut01[src.a][dst.a]][255 - qMin<int>(255, (255 - lut02[dst.b][dst.a]) * src.a /
-                    (2 * src.b))] + lut01[src.b][255 - dst.a] + lut01[dst.b][255 - src.a];
+            blend.b = IBP_multiply(IBP_multiply(src.a, dst.a),
+                                   255 - qMin<int>(255, (255 - IBP_divide(dst.b, dst.a)) * src.a / (2 * src.b))) +
+                    IBP_multiply(src.b, 255 - dst.a) + IBP_multiply(dst.b, 255 - src.a);
     }
     else
     {
         if (src.b == src.a)
         {
             if (dst.b == 0)
-                blend.b = lut01[src.b][255 - dst.a];
+                blend.b = IBP_multiply(src.b, 255 - dst.a);
             else
-                blend.b = lut01[src.a][dst.a] + lut01[src.b][255 - dst.a] + lut01[dst.b][255 - src.a];
+                blend.b = IBP_multiply(src.a, dst.a) + IBP_multiply(src.b, 255 - dst.a) +
+                        IBP_multiply(dst.b, 255 - src.a);
         }
         else
-            blend.b = lut01[lut01[src.a][dst.a]][qMin<int>(255, lut02[dst.b][dst.a] * src.a /
-                    (2 * (src.a - src.b)))] + lut01[src.b][255 - dst.a] + lut01[dst.b][255 - src.a];
+            blend.b = IBP_multiply(IBP_multiply(src.a, dst.a),
+                                   qMin<int>(255, IBP_divide(dst.b, dst.a) * src.a / (2 * (src.a - src.b)))) +
+                    IBP_multiply(src.b, 255 - dst.a) + IBP_multiply(dst.b, 255 - src.a);
     }
 
     IBP_postmultiplyBGRA(blend);
@@ -573,17 +708,23 @@ void blendLinearLight(BGRA src, BGRA dst, BGRA & blend)
     IBP_PRE_BLEND
 
     if (2 * src.r <= src.a)
-        blend.r = qMax<int>((lut01[src.r][dst.a] - lut01[src.a][dst.a] + src.r + dst.r) * 255 / blend.a, 0);
+        blend.r = qMax<int>((IBP_multiply(src.r, dst.a) - IBP_multiply(src.a, dst.a) + src.r + dst.r) * 255 /
+                            blend.a, 0);
     else
-        blend.r = qMin<int>((lut01[src.r][dst.a] - lut01[src.a][dst.a] + src.r + dst.r) * 255 / blend.a, 255);
+        blend.r = qMin<int>((IBP_multiply(src.r, dst.a) - IBP_multiply(src.a, dst.a) + src.r + dst.r) * 255 /
+                            blend.a, 255);
     if (2 * src.g <= src.a)
-        blend.g = qMax<int>((lut01[src.g][dst.a] - lut01[src.a][dst.a] + src.g + dst.g) * 255 / blend.a, 0);
+        blend.g = qMax<int>((IBP_multiply(src.g, dst.a) - IBP_multiply(src.a, dst.a) + src.g + dst.g) * 255 /
+                            blend.a, 0);
     else
-        blend.g = qMin<int>((lut01[src.g][dst.a] - lut01[src.a][dst.a] + src.g + dst.g) * 255 / blend.a, 255);
+        blend.g = qMin<int>((IBP_multiply(src.g, dst.a) - IBP_multiply(src.a, dst.a) + src.g + dst.g) * 255 /
+                            blend.a, 255);
     if (2 * src.b <= src.a)
-        blend.b = qMax<int>((lut01[src.b][dst.a] - lut01[src.a][dst.a] + src.b + dst.b) * 255 / blend.a, 0);
+        blend.b = qMax<int>((IBP_multiply(src.b, dst.a) - IBP_multiply(src.a, dst.a) + src.b + dst.b) * 255 /
+                            blend.a, 0);
     else
-        blend.b = qMin<int>((lut01[src.b][dst.a] - lut01[src.a][dst.a] + src.b + dst.b) * 255 / blend.a, 255);
+        blend.b = qMin<int>((IBP_multiply(src.b, dst.a) - IBP_multiply(src.a, dst.a) + src.b + dst.b) * 255 /
+                            blend.a, 255);
     /*
     if (2 * src.r <= src.a)
         blend.r = qMax<int>(((src.r - src.a) * dst.a / 255 + src.r + dst.r) * 255 / blend.a, 0);
@@ -604,24 +745,24 @@ void blendPinLight(BGRA src, BGRA dst, BGRA & blend)
 {
     IBP_PRE_BLEND
 
-    if (lut01[dst.r][src.a] < dst.a * (2 * src.r - src.a) / 255)
-        blend.r = src.r * (dst.a + 255) / 255 - lut01[src.a][dst.a] + lut01[dst.r][255 - src.a];
-    else if (lut01[dst.r][src.a] > 2 * lut01[src.r][dst.a])
-        blend.r = lut01[src.r][dst.a] + src.r + lut01[dst.r][255 - src.a];
+    if (IBP_multiply(dst.r, src.a) < dst.a * (2 * src.r - src.a) / 255)
+        blend.r = src.r * (dst.a + 255) / 255 - IBP_multiply(src.a, dst.a) + IBP_multiply(dst.r, 255 - src.a);
+    else if (IBP_multiply(dst.r, src.a) > 2 * IBP_multiply(src.r, dst.a))
+        blend.r = IBP_multiply(src.r, dst.a) + src.r + IBP_multiply(dst.r, 255 - src.a);
     else
-        blend.r = lut01[src.r][255 - dst.a] + dst.r;
-    if (lut01[dst.g][src.a] < dst.a * (2 * src.g - src.a) / 255)
-        blend.g = src.g * (dst.a + 255) / 255 - lut01[src.a][dst.a] + lut01[dst.g][255 - src.a];
-    else if (lut01[dst.g][src.a] > 2 * lut01[src.g][dst.a])
-        blend.g = lut01[src.g][dst.a] + src.g + lut01[dst.g][255 - src.a];
+        blend.r = IBP_multiply(src.r, 255 - dst.a) + dst.r;
+    if (IBP_multiply(dst.g, src.a) < dst.a * (2 * src.g - src.a) / 255)
+        blend.g = src.g * (dst.a + 255) / 255 - IBP_multiply(src.a, dst.a) + IBP_multiply(dst.g, 255 - src.a);
+    else if (IBP_multiply(dst.g, src.a) > 2 * IBP_multiply(src.g, dst.a))
+        blend.g = IBP_multiply(src.g, dst.a) + src.g + IBP_multiply(dst.g, 255 - src.a);
     else
-        blend.g = lut01[src.g][255 - dst.a] + dst.g;
-    if (lut01[dst.b][src.a] < dst.a * (2 * src.b - src.a) / 255)
-        blend.b = src.b * (dst.a + 255) / 255 - lut01[src.a][dst.a] + lut01[dst.b][255 - src.a];
-    else if (lut01[dst.b][src.a] > 2 * lut01[src.b][dst.a])
-        blend.b = lut01[src.b][dst.a] + src.b + lut01[dst.b][255 - src.a];
+        blend.g = IBP_multiply(src.g, 255 - dst.a) + dst.g;
+    if (IBP_multiply(dst.b, src.a) < dst.a * (2 * src.b - src.a) / 255)
+        blend.b = src.b * (dst.a + 255) / 255 - IBP_multiply(src.a, dst.a) + IBP_multiply(dst.b, 255 - src.a);
+    else if (IBP_multiply(dst.b, src.a) > 2 * IBP_multiply(src.b, dst.a))
+        blend.b = IBP_multiply(src.b, dst.a) + src.b + IBP_multiply(dst.b, 255 - src.a);
     else
-        blend.b = lut01[src.b][255 - dst.a] + dst.b;
+        blend.b = IBP_multiply(src.b, 255 - dst.a) + dst.b;
 
     IBP_postmultiplyBGRA(blend);
 }
@@ -630,9 +771,9 @@ void blendHardMix(BGRA src, BGRA dst, BGRA & blend)
 {
     IBP_EARLY_ALPHA_DISCARD
 
-    blend.r = src.r < 255 - dst.r ? 0 : lut01[src.a][dst.a];
-    blend.g = src.g < 255 - dst.g ? 0 : lut01[src.a][dst.a];
-    blend.b = src.b < 255 - dst.b ? 0 : lut01[src.a][dst.a];
+    blend.r = src.r < 255 - dst.r ? 0 : IBP_multiply(src.a, dst.a);
+    blend.g = src.g < 255 - dst.g ? 0 : IBP_multiply(src.a, dst.a);
+    blend.b = src.b < 255 - dst.b ? 0 : IBP_multiply(src.a, dst.a);
 
     IBP_premultiplyBGRA(src);
     IBP_premultiplyBGRA(dst);
@@ -645,9 +786,9 @@ void blendDifference(BGRA src, BGRA dst, BGRA & blend)
 {
     IBP_PRE_BLEND
 
-    blend.r = src.r + dst.r - 2 * qMin<int>(lut01[src.r][dst.a], lut01[dst.r][src.a]);
-    blend.g = src.g + dst.g - 2 * qMin<int>(lut01[src.g][dst.a], lut01[dst.g][src.a]);
-    blend.b = src.b + dst.b - 2 * qMin<int>(lut01[src.b][dst.a], lut01[dst.b][src.a]);
+    blend.r = src.r + dst.r - 2 * qMin<int>(IBP_multiply(src.r, dst.a), IBP_multiply(dst.r, src.a));
+    blend.g = src.g + dst.g - 2 * qMin<int>(IBP_multiply(src.g, dst.a), IBP_multiply(dst.g, src.a));
+    blend.b = src.b + dst.b - 2 * qMin<int>(IBP_multiply(src.b, dst.a), IBP_multiply(dst.b, src.a));
 
     IBP_postmultiplyBGRA(blend);
 }
@@ -656,9 +797,9 @@ void blendExclusion(BGRA src, BGRA dst, BGRA & blend)
 {
     IBP_PRE_BLEND
 
-    blend.r = lut01[src.r][dst.a] + lut01[dst.r][src.a] - 2 * lut01[src.r][dst.r];
-    blend.g = lut01[src.g][dst.a] + lut01[dst.g][src.a] - 2 * lut01[src.g][dst.g];
-    blend.b = lut01[src.b][dst.a] + lut01[dst.b][src.a] - 2 * lut01[src.b][dst.b];
+    blend.r = IBP_multiply(src.r, dst.a) + IBP_multiply(dst.r, src.a) - 2 * IBP_multiply(src.r, dst.r);
+    blend.g = IBP_multiply(src.g, dst.a) + IBP_multiply(dst.g, src.a) - 2 * IBP_multiply(src.g, dst.g);
+    blend.b = IBP_multiply(src.b, dst.a) + IBP_multiply(dst.b, src.a) - 2 * IBP_multiply(src.b, dst.b);
 
     IBP_POST_BLEND
 }
@@ -744,4 +885,150 @@ void blendLuminosity(BGRA src, BGRA dst, BGRA & blend)
     IBP_POST_BLEND
 }
 
+bool isSeparableColorCompositionMode(ColorCompositionMode mode)
+{
+    return mode != ColorCompositionMode_DarkerColor && mode != ColorCompositionMode_LighterColor &&
+           mode < ColorCompositionMode_Hue;
+}
+
+void makeConstantSourceBlendTables(BGRA src, const std::function<void (BGRA, BGRA, BGRA &)> & blendFunction,
+                                   ConstantSourceBlendTables & tables)
+{
+    BGRA dst, blend;
+    for (register int a = 0; a < 256; a++)
+    {
+        dst.a = a;
+        for (register int v = 0; v < 256; v++)
+        {
+            dst.b = dst.g = dst.r = v;
+            blendFunction(src, dst, blend);
+            tables.b[a][v] = blend.b;
+            tables.g[a][v] = blend.g;
+            tables.r[a][v] = blend.r;
+        }
+        tables.a[a] = blend.a;
+    }
+}
+
+void blendConstantSource(const ConstantSourceBlendTables & tables, const BGRA * dst, BGRA * blend, int nPixels)
+{
+    register int a;
+    while (nPixels--)
+    {
+        a = dst->a;
+        blend->b = tables.b[a][dst->b];
+        blend->g = tables.g[a][dst->g];
+        blend->r = tables.r[a][dst->r];
+        blend->a = tables.a[a];
+        dst++;
+        blend++;
+    }
+}
+
+// blendDarkerColor and blendLighterColor past the early discard of a transparent source, with src premultiplied and
+// its intensity computed by the caller
+template <bool isDarker>
+static inline void blendConstantSourceColor(BGRA originalSrc, BGRA src, int srcIntensity, BGRA dst, BGRA & blend)
+{
+    if (dst.a == 0)
+    {
+        blend = originalSrc;
+        return;
+    }
+    blend.a = IBP_screen(dst.a, src.a);
+    IBP_premultiplyBGRA(dst);
+
+    const int dstIntensity = IBP_pixelIntensity1(dst);
+    if (isDarker ? srcIntensity < dstIntensity : srcIntensity > dstIntensity)
+    {
+        blend.r = IBP_multiply(src.r, dst.a);
+        blend.g = IBP_multiply(src.g, dst.a);
+        blend.b = IBP_multiply(src.b, dst.a);
+    }
+    else
+    {
+        blend.r = IBP_multiply(dst.r, src.a);
+        blend.g = IBP_multiply(dst.g, src.a);
+        blend.b = IBP_multiply(dst.b, src.a);
+    }
+
+    IBP_POST_BLEND
+}
+
+// Alpha handling of blendHue, blendSaturation, blendColor and blendLuminosity once the color of blend is set, with
+// src premultiplied and neither alpha 0
+static inline void finishConstantSourceHSLBlend(BGRA src, BGRA dst, BGRA & blend)
+{
+    blend.a = IBP_screen(dst.a, src.a);
+    IBP_premultiplyBGRA(dst);
+    IBP_premultiplyBGRAWithAlpha(blend, src.a);
+    IBP_premultiplyBGRAWithAlpha(blend, dst.a);
+
+    IBP_POST_BLEND
+}
+
+void blendConstantSource(BGRA src, const BGRA * dst, BGRA * blend, int nPixels, ColorCompositionMode mode)
+{
+    const int runLength = 256;
+    BGRA premultipliedSrc = src;
+    HSL srcHSL, hsl[runLength];
+    register int i;
+
+    if (src.a == 0)
+    {
+        memcpy(blend, dst, nPixels * sizeof(BGRA));
+        return;
+    }
+
+    IBP_premultiplyBGRA(premultipliedSrc);
+    if (mode == ColorCompositionMode_DarkerColor || mode == ColorCompositionMode_LighterColor)
+    {
+        const int srcIntensity = IBP_pixelIntensity1(premultipliedSrc);
+        if (mode == ColorCompositionMode_DarkerColor)
+            for (i = 0; i < nPixels; i++)
+                blendConstantSourceColor<true>(src, premultipliedSrc, srcIntensity, dst[i], blend[i]);
+        else
+            for (i = 0; i < nPixels; i++)
+                blendConstantSourceColor<false>(src, premultipliedSrc, srcIntensity, dst[i], blend[i]);
+        return;
+    }
+
+    if (mode < ColorCompositionMode_Hue || mode > ColorCompositionMode_Luminosity)
+    {
+        for (i = 0; i < nPixels; i++)
+            blendColors[mode](src, dst[i], blend[i]);
+        return;
+    }
+
+    convertBGRToHSL((const unsigned char *)&src, (unsigned char *)&srcHSL, 1);
+    for (int start = 0; start < nPixels; start += runLength)
+    {
+        const int count = IBP_minimum(runLength, nPixels - start);
+        convertBGRToHSL((const unsigned char *)(dst + start), (unsigned char *)hsl, count);
+        for (i = 0; i < count; i++)
+        {
+            if (mode == ColorCompositionMode_Hue)
+                hsl[i].h = srcHSL.h;
+            else if (mode == ColorCompositionMode_Saturation)
+                hsl[i].s = srcHSL.s;
+            else if (mode == ColorCompositionMode_Color)
+            {
+                hsl[i].h = srcHSL.h;
+                hsl[i].s = srcHSL.s;
+            }
+            else
+                hsl[i].l = srcHSL.l;
+        }
+        // only writes the color of blend
+        convertHSLToBGR((const unsigned char *)hsl, (unsigned char *)(blend + start), count);
+        for (i = start; i < start + count; i++)
+        {
+            if (dst[i].a == 0)
+                blend[i] = src;
+            else
+                finishConstantSourceHSLBlend(premultipliedSrc, dst[i], blend[i]);
+        }
+    }
+}
+
 }}
@@ -25,6 +25,8 @@
 #ifndef PIXELBLENDING_H
 #define PIXELBLENDING_H
 
+#include <functional>
+
 #include "types.h"
 
 namespace ibp {
@@ -45,6 +47,22 @@ void blendSourceXorDestination(BGRA src, BGRA dst, BGRA & blend);
 
 extern void (*alphaBlendColors[12])(BGRA src, BGRA dst, BGRA & blend);
 
+// Same operators on premultiplied alpha pixels (src, dst and blend)
+void blendPremultipliedSource(BGRA src, BGRA dst, BGRA & blend);
+void blendPremultipliedDestination(BGRA src, BGRA dst, BGRA & blend);
+void blendPremultipliedSourceOverDestination(BGRA src, BGRA dst, BGRA & blend);
+void blendPremultipliedDestinationOverSource(BGRA src, BGRA dst, BGRA & blend);
+void blendPremultipliedSourceInDestination(BGRA src, BGRA dst, BGRA & blend);
+void blendPremultipliedDestinationInSource(BGRA src, BGRA dst, BGRA & blend);
+void blendPremultipliedSourceOutDestination(BGRA src, BGRA dst, BGRA & blend);
+void blendPremultipliedDestinationOutSource(BGRA src, BGRA dst, BGRA & blend);
+void blendPremultipliedSourceAtopDestination(BGRA src, BGRA dst, BGRA & blend);
+void blendPremultipliedDestinationAtopSource(BGRA src, BGRA dst, BGRA & blend);
+void blendPremultipliedSourceClearDestination(BGRA src, BGRA dst, BGRA & blend);
+void blendPremultipliedSourceXorDestination(BGRA src, BGRA dst, BGRA & blend);
+
+extern void (*premultipliedAlphaBlendColors[12])(BGRA src, BGRA dst, BGRA & blend);
+
 void blendDarken(BGRA src, BGRA dst, BGRA & blend);
 void blendMultiply(BGRA src, BGRA dst, BGRA & blend);
 void blendColorBurn(BGRA src, BGRA dst, BGRA & blend);
@@ -71,6 +89,26 @@ void blendLuminosity(BGRA src, BGRA dst, BGRA & blend);
 
 extern void (*blendColors[24])(BGRA src, BGRA dst, BGRA & blend);
 
+// Results of blending a constant source with every destination pixel, for blend functions where each color channel
+// of the result only depends on that channel and the alpha of the destination. Indexed [dst alpha][dst value]
+struct ConstantSourceBlendTables
+{
+    unsigned char b[256][256];
+    unsigned char g[256][256];
+    unsigned char r[256][256];
+    unsigned char a[256];
+};
+
+// True for the color composition modes whose channels blend independently (all but Darker Color, Lighter Color, Hue,
+// Saturation, Color and Luminosity)
+bool isSeparableColorCompositionMode(ColorCompositionMode mode);
+void makeConstantSourceBlendTables(BGRA src, const std::function<void (BGRA, BGRA, BGRA &)> & blendFunction,
+                                   ConstantSourceBlendTables & tables);
+void blendConstantSource(const ConstantSourceBlendTables & tables, const BGRA * dst, BGRA * blend, int nPixels);
+// Same results as blendColors[mode](src, dst[i], blend[i]), with the work on src done once and the destination
+// converted to HSL in runs. blend must not overlap dst
+void blendConstantSource(BGRA src, const BGRA * dst, BGRA * blend, int nPixels, ColorCompositionMode mode);
+
 }}
 
 #endif // PIXELBLENDING_H
@@ -0,0 +1,86 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <math.h>
+#include <vector>
+
+#include "random.h"
+#include "../misc/util.h"
+
+namespace ibp {
+namespace imgproc {
+
+void uniformNoise(unsigned long long key, long long first, int n, int amount, int * values)
+{
+    const unsigned long long range = 2 * amount + 1;
+    register unsigned long long bits;
+    register int i;
+
+    // two 32 bit numbers of every 64 bit one, mapped to the range by a multiplication
+    i = 0;
+    if ((first & 1) && n > 0)
+    {
+        bits = counterRandom(key, first >> 1);
+        values[i++] = (int)(((bits >> 32) * range) >> 32) - amount;
+    }
+    for (; i + 1 < n; i += 2)
+    {
+        bits = counterRandom(key, (first + i) >> 1);
+        values[i] = (int)(((bits & 0xFFFFFFFFULL) * range) >> 32) - amount;
+        values[i + 1] = (int)(((bits >> 32) * range) >> 32) - amount;
+    }
+    if (i < n)
+    {
+        bits = counterRandom(key, (first + i) >> 1);
+        values[i] = (int)(((bits & 0xFFFFFFFFULL) * range) >> 32) - amount;
+    }
+}
+
+void gaussianNoise(unsigned long long key, long long first, int n, float * values)
+{
+    const float twoPi = IBP_2PI, scale = 1.f / 16777216.f;
+    const long long firstPair = first >> 1, lastPair = (first + n - 1) >> 1;
+    const int nPairs = n > 0 ? lastPair - firstPair + 1 : 0;
+    std::vector<float> radius(nPairs), angle(nPairs);
+    register int i;
+
+    // 24 bits for each uniform, the first in (0, 1] for the logarithm. Split in plain loops over the pairs
+    for (i = 0; i < nPairs; i++)
+    {
+        const unsigned long long bits = counterRandom(key, firstPair + i);
+        radius[i] = ((bits >> 40) + 1) * scale;
+        angle[i] = (bits & 0xFFFFFF) * scale * twoPi;
+    }
+    for (i = 0; i < nPairs; i++)
+        radius[i] = sqrtf(-2.f * logf(radius[i]));
+
+    for (i = 0; i < n; i++)
+    {
+        const long long v = first + i;
+        const int pair = (v >> 1) - firstPair;
+        values[i] = radius[pair] * ((v & 1) ? sinf(angle[pair]) : cosf(angle[pair]));
+    }
+}
+
+}}
@@ -0,0 +1,69 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef IBP_IMGPROC_RANDOM_H
+#define IBP_IMGPROC_RANDOM_H
+
+namespace ibp {
+namespace imgproc {
+
+/*******************************************************
+** Counter-based random numbers: the value at position
+** counter of the stream of a key is a hash of both, so
+** any range of a stream can be generated on its own
+** and in any order, always with the same values. The
+** hash is the finalizer of SplitMix64:
+**
+** Guy L. Steele, Doug Lea, Christine H. Flood.
+** "Fast Splittable Pseudorandom Number Generators",
+** OOPSLA 2014.
+********************************************************/
+inline unsigned long long splitMix64(unsigned long long z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Key of the stream of a seed, so streams of nearby seeds do not overlap
+inline unsigned long long randomStreamKey(unsigned long long seed)
+{
+    return splitMix64(seed + 0x9E3779B97F4A7C15ULL);
+}
+
+inline unsigned long long counterRandom(unsigned long long key, unsigned long long counter)
+{
+    return splitMix64(key + (counter + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+// Values first to first + n - 1 of the stream of key as integers uniform in [-amount, amount]
+void uniformNoise(unsigned long long key, long long first, int n, int amount, int * values);
+// Values first to first + n - 1 of the stream of key as standard normal values. Every 64 bit random number gives a
+// pair of values through the Box-Muller transform, both used
+void gaussianNoise(unsigned long long key, long long first, int n, float * values);
+
+} // namespace imgproc
+} // namespace ibp
+
+#endif // IBP_IMGPROC_RANDOM_H
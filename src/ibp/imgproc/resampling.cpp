@@ -0,0 +1,327 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+#include <opencv2/imgproc.hpp>
+
+#include "resampling.h"
+#include "util.h"
+#include "../misc/util.h"
+
+#define LANCZOS_RADIUS 3
+#define LANCZOS_WEIGHT_BITS 14
+
+namespace ibp {
+namespace imgproc {
+
+// For every destination index, taps source indices (clamped to the border) and their weights, which add up to
+// 1 << LANCZOS_WEIGHT_BITS. taps is even, padded with zero weights, so taps can be taken in pairs
+struct LanczosWeights
+{
+    int taps;
+    std::vector<int> indices;
+    std::vector<short> weights;
+};
+
+static double lanczosKernel(double x)
+{
+    if (x == 0.)
+        return 1.;
+    if (fabs(x) >= LANCZOS_RADIUS)
+        return 0.;
+    const double px = IBP_PI * x;
+    return LANCZOS_RADIUS * sin(px) * sin(px / LANCZOS_RADIUS) / (px * px);
+}
+
+static void makeLanczosWeights(int srcSize, int dstSize, LanczosWeights & lw)
+{
+    const double ratio = (double)srcSize / dstSize, scale = IBP_maximum(1., ratio);
+    const double support = LANCZOS_RADIUS * scale;
+    std::vector<double> w;
+    register int d, k;
+
+    lw.taps = ((int)ceil(2. * support) + 2) & ~1;
+    lw.indices.resize(dstSize * lw.taps);
+    lw.weights.resize(dstSize * lw.taps);
+    w.resize(lw.taps);
+
+    for (d = 0; d < dstSize; d++)
+    {
+        const double center = (d + .5) * ratio - .5;
+        const int first = (int)ceil(center - support);
+        int * indices = &lw.indices[d * lw.taps];
+        short * weights = &lw.weights[d * lw.taps];
+        double sum = 0.;
+        int total = 0, largest = 0;
+
+        for (k = 0; k < lw.taps; k++)
+        {
+            w[k] = lanczosKernel((first + k - center) / scale);
+            sum += w[k];
+            indices[k] = IBP_clamp(0, first + k, srcSize - 1);
+        }
+        for (k = 0; k < lw.taps; k++)
+        {
+            weights[k] = (short)lround(w[k] / sum * (1 << LANCZOS_WEIGHT_BITS));
+            total += weights[k];
+            if (weights[k] > weights[largest])
+                largest = k;
+        }
+        // the rounding error goes to the largest weight, so that flat areas stay flat
+        weights[largest] += (1 << LANCZOS_WEIGHT_BITS) - total;
+    }
+}
+
+// row[j] = sum of weights[k] * rows[k][j] over the taps, scaled to 6 fractional bits: the vertical pass
+static void lanczosRows(const unsigned char * const * rows, const short * weights, int taps, short * row, int n)
+{
+    register int j = 0, k;
+#ifdef IBP_SSE2
+    // 16 pixels of two rows interleaved against the interleaved weights of their taps, added pairwise by madd
+    const __m128i zero = _mm_setzero_si128(), half = _mm_set1_epi32(1 << 7);
+    std::vector<short> pairWeights(taps * 4);
+    for (k = 0; k < taps * 4; k += 2)
+    {
+        pairWeights[k] = weights[(k >> 3) * 2];
+        pairWeights[k + 1] = weights[(k >> 3) * 2 + 1];
+    }
+    for (; j + 16 <= n; j += 16)
+    {
+        __m128i s0 = half, s1 = half, s2 = half, s3 = half;
+        for (k = 0; k < taps; k += 2)
+        {
+            const __m128i a = _mm_loadu_si128((const __m128i *)(rows[k] + j));
+            const __m128i b = _mm_loadu_si128((const __m128i *)(rows[k + 1] + j));
+            const __m128i lo = _mm_unpacklo_epi8(a, b), hi = _mm_unpackhi_epi8(a, b);
+            const __m128i w = _mm_loadu_si128((const __m128i *)&pairWeights[k * 4]);
+            s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), w));
+            s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), w));
+            s2 = _mm_add_epi32(s2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), w));
+            s3 = _mm_add_epi32(s3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), w));
+        }
+        _mm_storeu_si128((__m128i *)(row + j), _mm_packs_epi32(_mm_srai_epi32(s0, 8), _mm_srai_epi32(s1, 8)));
+        _mm_storeu_si128((__m128i *)(row + j + 8), _mm_packs_epi32(_mm_srai_epi32(s2, 8), _mm_srai_epi32(s3, 8)));
+    }
+#endif
+    for (; j < n; j++)
+    {
+        register int sum = 1 << 7;
+        for (k = 0; k < taps; k++)
+            sum += weights[k] * rows[k][j];
+        row[j] = sum >> 8;
+    }
+}
+
+// dst[x] = sum of weights * the BGRA values of row at the indices of x, rounded and saturated: the horizontal pass
+static void lanczosColumns(const short * row, const LanczosWeights & lw, unsigned char * dst, int width)
+{
+    const int taps = lw.taps;
+    register int x, k;
+
+    for (x = 0; x < width; x++, dst += 4)
+    {
+        const int * indices = &lw.indices[x * taps];
+        const short * weights = &lw.weights[x * taps];
+#ifdef IBP_SSE2
+        __m128i sum = _mm_set1_epi32(1 << 19);
+        for (k = 0; k < taps; k += 2)
+        {
+            const __m128i a = _mm_loadl_epi64((const __m128i *)(row + indices[k] * 4));
+            const __m128i b = _mm_loadl_epi64((const __m128i *)(row + indices[k + 1] * 4));
+            const __m128i w = _mm_set_epi16(weights[k + 1], weights[k], weights[k + 1], weights[k],
+                                            weights[k + 1], weights[k], weights[k + 1], weights[k]);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+        }
+        sum = _mm_srai_epi32(sum, 20);
+        sum = _mm_packs_epi32(sum, sum);
+        *(int *)dst = _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+#else
+        int sums[4] = { 1 << 19, 1 << 19, 1 << 19, 1 << 19 };
+        for (k = 0; k < taps; k++)
+            for (int c = 0; c < 4; c++)
+                sums[c] += weights[k] * row[indices[k] * 4 + c];
+        for (int c = 0; c < 4; c++)
+            dst[c] = IBP_clamp(0, sums[c] >> 20, 255);
+#endif
+    }
+}
+
+void lanczosResize(cv::InputArray _src, cv::OutputArray _dst, cv::Size dsize)
+{
+    cv::Mat src = _src.getMat();
+    CV_Assert(src.type() == CV_8UC4 && dsize.width > 0 && dsize.height > 0);
+
+    _dst.create(dsize, src.type());
+    cv::Mat dst = _dst.getMat();
+    CV_Assert(src.data != dst.data);
+
+    if (src.empty() || (src.cols < dsize.width * kLanczosDownscaleMinimumRatio &&
+                        src.rows < dsize.height * kLanczosDownscaleMinimumRatio))
+    {
+        cv::resize(src, dst, dsize, 0, 0, cv::INTER_LANCZOS4);
+        return;
+    }
+
+    LanczosWeights horizontal, vertical;
+    makeLanczosWeights(src.cols, dsize.width, horizontal);
+    makeLanczosWeights(src.rows, dsize.height, vertical);
+
+    parallelForRows(dsize.height, IBP_maximum(1, 4096 / dsize.width), [&](int startRow, int endRow)
+    {
+        std::vector<short> row(src.cols * 4);
+        std::vector<const unsigned char *> rows(vertical.taps);
+        for (int y = startRow; y < endRow; y++)
+        {
+            for (int k = 0; k < vertical.taps; k++)
+                rows[k] = src.ptr(vertical.indices[y * vertical.taps + k]);
+            lanczosRows(rows.data(), &vertical.weights[y * vertical.taps], vertical.taps, row.data(),
+                        src.cols * 4);
+            lanczosColumns(row.data(), horizontal, dst.ptr(y), dsize.width);
+        }
+    });
+}
+
+void maskedAreaResize(cv::InputArray _src, cv::InputArray _mask, cv::OutputArray _dst, cv::OutputArray _dstMask,
+                      cv::Size dsize, double minimumCoverage)
+{
+    cv::Mat src = _src.getMat(), mask = _mask.getMat();
+    CV_Assert(src.type() == CV_8UC1 && mask.type() == CV_8UC1 && mask.size() == src.size());
+    CV_Assert(dsize.width > 0 && dsize.height > 0);
+
+    // the sums of the unmasked lightness and of the unmasked area over every dst pixel, as means
+    cv::Mat coverage = 255 - mask, weighted, weightedResized, coverageResized;
+    cv::multiply(src, coverage, weighted, 1. / 255., CV_32F);
+    coverage.convertTo(coverage, CV_32F, 1. / 255.);
+    cv::resize(weighted, weightedResized, dsize, 0, 0, cv::INTER_AREA);
+    cv::resize(coverage, coverageResized, dsize, 0, 0, cv::INTER_AREA);
+
+    _dst.create(dsize, CV_8UC1);
+    _dstMask.create(dsize, CV_8UC1);
+    cv::Mat dst = _dst.getMat(), dstMask = _dstMask.getMat();
+    const float minimum = (float)minimumCoverage;
+    for (int y = 0; y < dsize.height; y++)
+    {
+        const float * weightedsl = weightedResized.ptr<float>(y), * coveragesl = coverageResized.ptr<float>(y);
+        unsigned char * dstsl = dst.ptr(y), * dstMasksl = dstMask.ptr(y);
+        for (int x = 0; x < dsize.width; x++)
+        {
+            if (coveragesl[x] < minimum || coveragesl[x] <= 0.f)
+            {
+                dstsl[x] = 0;
+                dstMasksl[x] = 255;
+            }
+            else
+            {
+                dstsl[x] = cv::saturate_cast<unsigned char>(weightedsl[x] / coveragesl[x]);
+                dstMasksl[x] = 0;
+            }
+        }
+    }
+}
+
+// Indices of the 4 src pixels around every one of the n dst pixels of a side, and their gaussian weights
+static void makeJointBilateralTaps(int srcSize, int dstSize, std::vector<int> & indices, std::vector<float> & weights)
+{
+    const double ratio = (double)srcSize / dstSize;
+    indices.resize(dstSize * 4);
+    weights.resize(dstSize * 4);
+    for (int d = 0; d < dstSize; d++)
+    {
+        const double center = (d + .5) * ratio - .5;
+        const int first = (int)floor(center) - 1;
+        for (int k = 0; k < 4; k++)
+        {
+            const double distance = first + k - center;
+            indices[d * 4 + k] = IBP_clamp(0, first + k, srcSize - 1);
+            weights[d * 4 + k] = (float)exp(-.5 * distance * distance);
+        }
+    }
+}
+
+void jointBilateralUpsample(cv::InputArray _src, cv::InputArray _srcGuide, cv::InputArray _guide,
+                            cv::OutputArray _dst, cv::InputArray _srcMask, cv::InputArray _mask,
+                            double sigmaRange, double minimumRangeWeight)
+{
+    cv::Mat src = _src.getMat(), srcGuide = _srcGuide.getMat(), guide = _guide.getMat();
+    CV_Assert(src.type() == CV_8UC1 && srcGuide.type() == CV_8UC1 && guide.type() == CV_8UC1);
+    CV_Assert(srcGuide.size() == src.size() && !src.empty() && sigmaRange > 0.);
+    // no masks are all zero ones, trusting the whole guide
+    cv::Mat srcMask = _srcMask.empty() ? cv::Mat::zeros(src.size(), CV_8UC1) : _srcMask.getMat();
+    cv::Mat mask = _mask.empty() ? cv::Mat::zeros(guide.size(), CV_8UC1) : _mask.getMat();
+    CV_Assert(srcMask.type() == CV_8UC1 && srcMask.size() == src.size());
+    CV_Assert(mask.type() == CV_8UC1 && mask.size() == guide.size());
+
+    _dst.create(guide.size(), CV_8UC1);
+    cv::Mat dst = _dst.getMat();
+    CV_Assert(dst.data != src.data && dst.data != guide.data);
+
+    std::vector<int> columns, rows;
+    std::vector<float> columnWeights, rowWeights;
+    makeJointBilateralTaps(src.cols, guide.cols, columns, columnWeights);
+    makeJointBilateralTaps(src.rows, guide.rows, rows, rowWeights);
+    float rangeWeights[256];
+    for (int d = 0; d < 256; d++)
+        rangeWeights[d] = (float)IBP_maximum(exp(-.5 * d * d / (sigmaRange * sigmaRange)), minimumRangeWeight);
+
+    parallelForRows(guide.rows, IBP_maximum(1, 4096 / guide.cols), [&](int startRow, int endRow)
+    {
+        const unsigned char * srcRows[4], * srcGuideRows[4], * srcMaskRows[4];
+        for (int y = startRow; y < endRow; y++)
+        {
+            for (int j = 0; j < 4; j++)
+            {
+                srcRows[j] = src.ptr(rows[y * 4 + j]);
+                srcGuideRows[j] = srcGuide.ptr(rows[y * 4 + j]);
+                srcMaskRows[j] = srcMask.ptr(rows[y * 4 + j]);
+            }
+            const float * wy = &rowWeights[y * 4];
+            const unsigned char * guidesl = guide.ptr(y), * masksl = mask.ptr(y);
+            unsigned char * dstsl = dst.ptr(y);
+            for (int x = 0; x < guide.cols; x++)
+            {
+                const int * xs = &columns[x * 4];
+                const float * wx = &columnWeights[x * 4];
+                const int g = guidesl[x];
+                const bool masked = masksl[x] != 0;
+                float sum = 0.f, sumWeights = 0.f;
+                for (int j = 0; j < 4; j++)
+                {
+                    for (int i = 0; i < 4; i++)
+                    {
+                        float w = wy[j] * wx[i];
+                        if (!masked && !srcMaskRows[j][xs[i]])
+                            w *= rangeWeights[abs(g - srcGuideRows[j][xs[i]])];
+                        sum += w * srcRows[j][xs[i]];
+                        sumWeights += w;
+                    }
+                }
+                dstsl[x] = (unsigned char)IBP_clamp(0, (int)(sum / sumWeights + .5f), 255);
+            }
+        }
+    });
+}
+
+}}
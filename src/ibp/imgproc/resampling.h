@@ -0,0 +1,85 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef IBP_IMGPROC_RESAMPLING_H
+#define IBP_IMGPROC_RESAMPLING_H
+
+#include <opencv2/core.hpp>
+
+namespace ibp {
+namespace imgproc {
+
+/*******************************************************
+** Lanczos resize of a CV_8UC4 image to dsize, like
+** cv::resize with cv::INTER_LANCZOS4. When either side
+** shrinks by kLanczosDownscaleMinimumRatio or more, the
+** kernel (of radius 3) is widened by the ratio so every
+** source pixel is averaged in instead of aliased. It is
+** separable: each row of dst is the vertical pass over
+** the source rows it needs followed by the horizontal
+** pass, both with precomputed 14 bit fixed point weight
+** tables (SSE2 where available), rows in parallel. dst
+** may be a header over existing memory of dsize, which
+** is then written in place. It must not overlap src.
+********************************************************/
+const double kLanczosDownscaleMinimumRatio = 2.;
+void lanczosResize(cv::InputArray _src, cv::OutputArray _dst, cv::Size dsize);
+
+/*******************************************************
+** Area resize of a CV_8UC1 image to the smaller dsize
+** that averages only the pixels outside mask (CV_8UC1,
+** 255 where masked), so masked pixels do not bleed into
+** those around them. dst pixels covered by less than
+** minimumCoverage of unmasked area are set to 0 and to
+** 255 in dstMask (0 elsewhere), ready for inpainting.
+********************************************************/
+const double kMaskedResizeMinimumCoverage = .25;
+void maskedAreaResize(cv::InputArray _src, cv::InputArray _mask, cv::OutputArray _dst, cv::OutputArray _dstMask,
+                      cv::Size dsize, double minimumCoverage = kMaskedResizeMinimumCoverage);
+
+/*******************************************************
+** Joint bilateral upsampling of a CV_8UC1 image to the
+** size of guide (CV_8UC1). Every dst pixel averages the
+** 4x4 src pixels around it, weighted by a gaussian of
+** their distance (sigma of 1 src pixel) and one of the
+** difference between its guide value and their value in
+** srcGuide, the guide at the size of src (sigmaRange).
+** The range weights never go below minimumRangeWeight,
+** so pixels unlike all of their neighbours fall back to
+** the spatial gaussian. The optional srcMask (size of
+** src) and mask (size of guide), CV_8UC1 and nonzero
+** where the guide is not to be trusted, leave the range
+** weight out for those pixels. Rows in parallel.
+********************************************************/
+const double kJointBilateralSigmaRange = 20.;
+const double kJointBilateralMinimumRangeWeight = .01;
+void jointBilateralUpsample(cv::InputArray _src, cv::InputArray _srcGuide, cv::InputArray _guide,
+                            cv::OutputArray _dst, cv::InputArray _srcMask = cv::noArray(),
+                            cv::InputArray _mask = cv::noArray(), double sigmaRange = kJointBilateralSigmaRange,
+                            double minimumRangeWeight = kJointBilateralMinimumRangeWeight);
+
+} // namespace imgproc
+} // namespace ibp
+
+#endif // IBP_IMGPROC_RESAMPLING_H
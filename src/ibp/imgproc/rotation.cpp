@@ -0,0 +1,184 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <string.h>
+#include <vector>
+
+#include "rotation.h"
+#include "util.h"
+#include "../misc/util.h"
+
+// pixels per side of the tiles transposed at once: a tile of src and one of dst take 8 KB
+#define ROTATION_TILE_SIZE 32
+
+namespace ibp {
+namespace imgproc {
+
+// dst[i * dstStride + j] = src[j * srcStride + i] for the width x height pixels of src, reversing every row of
+// dst when reverseRows is true (its pixel j then goes to height - 1 - j)
+template <bool reverseRows>
+static inline void transposeTile(const BGRA * src, int srcStride, BGRA * dst, int dstStride, int width, int height)
+{
+    register int x, y = 0;
+
+#ifdef IBP_SSE2
+    for (; y + 4 <= height; y += 4)
+    {
+        const BGRA * s = src + y * srcStride;
+        BGRA * d = reverseRows ? dst + height - y - 4 : dst + y;
+        for (x = 0; x + 4 <= width; x += 4, s += 4, d += 4 * dstStride)
+        {
+            const __m128i r0 = _mm_loadu_si128((const __m128i *)s);
+            const __m128i r1 = _mm_loadu_si128((const __m128i *)(s + srcStride));
+            const __m128i r2 = _mm_loadu_si128((const __m128i *)(s + 2 * srcStride));
+            const __m128i r3 = _mm_loadu_si128((const __m128i *)(s + 3 * srcStride));
+            const __m128i t0 = _mm_unpacklo_epi32(r0, r1), t1 = _mm_unpackhi_epi32(r0, r1);
+            const __m128i t2 = _mm_unpacklo_epi32(r2, r3), t3 = _mm_unpackhi_epi32(r2, r3);
+            __m128i c0 = _mm_unpacklo_epi64(t0, t2), c1 = _mm_unpackhi_epi64(t0, t2);
+            __m128i c2 = _mm_unpacklo_epi64(t1, t3), c3 = _mm_unpackhi_epi64(t1, t3);
+            if (reverseRows)
+            {
+                c0 = _mm_shuffle_epi32(c0, _MM_SHUFFLE(0, 1, 2, 3));
+                c1 = _mm_shuffle_epi32(c1, _MM_SHUFFLE(0, 1, 2, 3));
+                c2 = _mm_shuffle_epi32(c2, _MM_SHUFFLE(0, 1, 2, 3));
+                c3 = _mm_shuffle_epi32(c3, _MM_SHUFFLE(0, 1, 2, 3));
+            }
+            _mm_storeu_si128((__m128i *)d, c0);
+            _mm_storeu_si128((__m128i *)(d + dstStride), c1);
+            _mm_storeu_si128((__m128i *)(d + 2 * dstStride), c2);
+            _mm_storeu_si128((__m128i *)(d + 3 * dstStride), c3);
+        }
+        // the columns left of this band of four rows
+        for (; x < width; x++)
+            for (int k = y; k < y + 4; k++)
+                dst[x * dstStride + (reverseRows ? height - 1 - k : k)] = src[k * srcStride + x];
+    }
+#endif
+    for (; y < height; y++)
+        for (x = 0; x < width; x++)
+            dst[x * dstStride + (reverseRows ? height - 1 - y : y)] = src[y * srcStride + x];
+}
+
+void rotatePixels90(const BGRA * src, BGRA * dst, int width, int height, bool clockwise)
+{
+    const int nBands = (width + ROTATION_TILE_SIZE - 1) / ROTATION_TILE_SIZE;
+
+    // a band of columns of src is a band of rows of dst: the threads never write the same rows
+    parallelForRows(nBands, 1, [&](int startBand, int endBand)
+    {
+        for (int band = startBand; band < endBand; band++)
+        {
+            const int x0 = band * ROTATION_TILE_SIZE, tileWidth = IBP_minimum(ROTATION_TILE_SIZE, width - x0);
+            for (int y0 = 0; y0 < height; y0 += ROTATION_TILE_SIZE)
+            {
+                const int tileHeight = IBP_minimum(ROTATION_TILE_SIZE, height - y0);
+                const BGRA * s = src + y0 * width + x0;
+                if (clockwise)
+                    // dst(height - 1 - y, x) = src(x, y)
+                    transposeTile<true>(s, width, dst + x0 * height + height - y0 - tileHeight, height,
+                                        tileWidth, tileHeight);
+                else
+                {
+                    // dst(y, width - 1 - x) = src(x, y): the tile of dst is upside down, walked bottom up
+                    BGRA * d = dst + (width - 1 - x0) * height + y0;
+                    transposeTile<false>(s, width, d, -height, tileWidth, tileHeight);
+                }
+            }
+        }
+    });
+}
+
+// dst[i] = src[n - 1 - i]. dst may be src: every step loads both ends before storing them
+static void reversePixels(const BGRA * src, BGRA * dst, int n)
+{
+    register int i = 0, j = n;
+
+#ifdef IBP_SSE2
+    for (; i + 4 <= j - 4; i += 4, j -= 4)
+    {
+        const __m128i front = _mm_loadu_si128((const __m128i *)(src + i));
+        const __m128i back = _mm_loadu_si128((const __m128i *)(src + j - 4));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_shuffle_epi32(back, _MM_SHUFFLE(0, 1, 2, 3)));
+        _mm_storeu_si128((__m128i *)(dst + j - 4), _mm_shuffle_epi32(front, _MM_SHUFFLE(0, 1, 2, 3)));
+    }
+#endif
+    for (; i < j - 1; i++, j--)
+    {
+        const BGRA front = src[i];
+        dst[i] = src[j - 1];
+        dst[j - 1] = front;
+    }
+    if (i == j - 1)
+        dst[i] = src[i];
+}
+
+void flipPixels(const BGRA * src, BGRA * dst, int width, int height, bool horizontally, bool vertically)
+{
+    const bool inPlace = src == dst;
+    const size_t rowSize = width * sizeof(BGRA);
+
+    if (!vertically)
+    {
+        if (!horizontally && !inPlace)
+            memcpy(dst, src, rowSize * height);
+        else if (horizontally)
+            parallelForRows(height, IBP_maximum(1, 16384 / width), [&](int startRow, int endRow)
+            {
+                for (int y = startRow; y < endRow; y++)
+                    reversePixels(src + y * width, dst + y * width, width);
+            });
+        return;
+    }
+
+    // rows y and height - 1 - y go together, so that in place both are read before they are written
+    parallelForRows((height + 1) / 2, IBP_maximum(1, 16384 / width), [&](int startRow, int endRow)
+    {
+        std::vector<BGRA> row(inPlace ? width : 0);
+        for (int y = startRow; y < endRow; y++)
+        {
+            const int opposite = height - 1 - y;
+            const BGRA * top = src + y * width, * bottom = src + opposite * width;
+            if (inPlace && y != opposite)
+            {
+                memcpy(row.data(), top, rowSize);
+                top = row.data();
+            }
+            if (horizontally)
+            {
+                reversePixels(bottom, dst + y * width, width);
+                if (y != opposite)
+                    reversePixels(top, dst + opposite * width, width);
+            }
+            else if (y != opposite)
+            {
+                memcpy(dst + y * width, bottom, rowSize);
+                memcpy(dst + opposite * width, top, rowSize);
+            }
+            else if (!inPlace)
+                memcpy(dst + y * width, top, rowSize);
+        }
+    });
+}
+
+}}
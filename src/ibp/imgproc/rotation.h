@@ -0,0 +1,53 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef IBP_IMGPROC_ROTATION_H
+#define IBP_IMGPROC_ROTATION_H
+
+#include "types.h"
+
+namespace ibp {
+namespace imgproc {
+
+/*******************************************************
+** Rotates the width x height pixels of src by 90 degrees
+** into the height x width pixels of dst. The image is
+** transposed in square tiles that fit in the L1 cache
+** (4 x 4 pixel blocks with SSE2), each thread writing a
+** band of rows of dst. src and dst must not overlap.
+********************************************************/
+void rotatePixels90(const BGRA * src, BGRA * dst, int width, int height, bool clockwise);
+
+/*******************************************************
+** Mirrors the width x height pixels of src into dst:
+** left to right, top to bottom or both (the rotation by
+** 180 degrees). dst may be src, for an in-place flip
+** that needs a single row of extra memory per thread.
+********************************************************/
+void flipPixels(const BGRA * src, BGRA * dst, int width, int height, bool horizontally, bool vertically);
+
+} // namespace imgproc
+} // namespace ibp
+
+#endif // IBP_IMGPROC_ROTATION_H
@@ -23,13 +23,100 @@
 //
 
 #include <opencv2/imgproc.hpp>
+#include <vector>
 
 #include "thresholding.h"
+#include "util.h"
 #include "../misc/util.h"
 
 namespace ibp {
 namespace imgproc {
 
+// Sauvola's threshold from the sums of n pixels. The mean and the variance are truncated, as they always were, so
+// the factor applied to the mean is looked up by variance. The variance of 8 bit values is at most 255 * 255
+template <typename SquaresType>
+static inline unsigned char thresholdPixel(unsigned char value, unsigned int sum, SquaresType sumSq, int n,
+                                           const double * factors)
+{
+    const int mean = sum / n;
+    const int variance = (sumSq - (SquaresType)(mean * mean) * n) / n;
+    return value < mean * factors[variance] ? 0 : 255;
+}
+
+// The integral images are unsigned and may wrap around, the sums of a window are exact while they fit. Every pixel
+// only reads its own value after the integral images are built, so src may be dst
+template <typename SquaresType>
+static void adaptiveThresholdIntegralSums(const cv::Mat & src, cv::Mat & dst, int radius, double kappa)
+{
+    const int w = src.cols, h = src.rows, stride = w + 1;
+    std::vector<unsigned int> integral(stride * (h + 1), 0);
+    std::vector<SquaresType> integralSq(stride * (h + 1), 0);
+    std::vector<double> factors(255 * 255 + 1);
+    register int x, y;
+
+    for (x = 0; x < (int)factors.size(); x++)
+        factors[x] = 1. + kappa * (sqrt((double)x) / 128. - 1.);
+
+    for (y = 0; y < h; y++)
+    {
+        register const unsigned char * bitsSrc = src.ptr(y);
+        register const unsigned int * scanlineIntegralTop = integral.data() + y * stride;
+        register unsigned int * scanlineIntegral = integral.data() + (y + 1) * stride;
+        register const SquaresType * scanlineIntegralSqTop = integralSq.data() + y * stride;
+        register SquaresType * scanlineIntegralSq = integralSq.data() + (y + 1) * stride;
+        register unsigned int rowSum = 0;
+        register SquaresType rowSumSq = 0;
+        for (x = 0; x < w; x++)
+        {
+            rowSum += bitsSrc[x];
+            rowSumSq += bitsSrc[x] * bitsSrc[x];
+            scanlineIntegral[x + 1] = scanlineIntegralTop[x + 1] + rowSum;
+            scanlineIntegralSq[x + 1] = scanlineIntegralSqTop[x + 1] + rowSumSq;
+        }
+    }
+
+    // Windows of columns far enough from the left and right borders all hold the same number of pixels, so they
+    // are summed without clamps
+    const int interiorStart = IBP_minimum(radius, w), interiorEnd = IBP_maximum(interiorStart, w - radius);
+    parallelForRows(h, IBP_maximum(1, 16384 / w), [&](int startRow, int endRow)
+    {
+        for (int y = startRow; y < endRow; y++)
+        {
+            const int y0 = IBP_maximum(y - radius, 0), y1 = IBP_minimum(y + radius, h - 1), rows = y1 - y0 + 1;
+            const unsigned char * bitsSrc = src.ptr(y);
+            unsigned char * bitsDst = dst.ptr(y);
+            const unsigned int * top = integral.data() + y0 * stride;
+            const unsigned int * bottom = integral.data() + (y1 + 1) * stride;
+            const SquaresType * topSq = integralSq.data() + y0 * stride;
+            const SquaresType * bottomSq = integralSq.data() + (y1 + 1) * stride;
+            int x;
+
+            for (x = 0; x < interiorStart; x++)
+            {
+                const int x0 = 0, x1 = IBP_minimum(x + radius, w - 1);
+                bitsDst[x] = thresholdPixel(bitsSrc[x], bottom[x1 + 1] + top[x0] - bottom[x0] - top[x1 + 1],
+                                            bottomSq[x1 + 1] + topSq[x0] - bottomSq[x0] - topSq[x1 + 1],
+                                            (x1 - x0 + 1) * rows, factors.data());
+            }
+
+            const int n = (2 * radius + 1) * rows;
+            for (; x < interiorEnd; x++)
+                bitsDst[x] = thresholdPixel(bitsSrc[x], bottom[x + radius + 1] + top[x - radius] -
+                                                        bottom[x - radius] - top[x + radius + 1],
+                                            bottomSq[x + radius + 1] + topSq[x - radius] -
+                                            bottomSq[x - radius] - topSq[x + radius + 1], n, factors.data());
+
+            for (; x < w; x++)
+            {
+                const int x0 = IBP_maximum(x - radius, 0), x1 = w - 1;
+                bitsDst[x] = thresholdPixel(bitsSrc[x], bottom[x1 + 1] + top[x0] - bottom[x0] - top[x1 + 1],
+                                            bottomSq[x1 + 1] + topSq[x0] - bottomSq[x0] - topSq[x1 + 1],
+                                            (x1 - x0 + 1) * rows, factors.data());
+            }
+        }
+    });
+}
+
 void adaptiveThresholdIntegral(cv::InputArray _src, cv::OutputArray _dst, int blockSize, double k)
 {
     cv::Mat src = _src.getMat();
@@ -37,45 +124,64 @@ void adaptiveThresholdIntegral(cv::InputArray _src, cv::OutputArray _dst, int bl
     CV_Assert(blockSize % 2 == 1 && blockSize > 1);
     cv::Size size = src.size();
 
+    // the largest window has to fit the 32 bit sums
+    const double maximumPixels = (double)IBP_minimum(blockSize, size.width) * IBP_minimum(blockSize, size.height);
+    CV_Assert(maximumPixels * 255. < 4294967296.);
+
     _dst.create(size, src.type());
     cv::Mat dst = _dst.getMat();
-    cv::Mat integral, integralSq;
-    cv::integral(src, integral, integralSq, CV_32F, CV_64F);
-
-    const int radius = blockSize >> 1;
-    const double kappa = k, R = 128.;
-    register unsigned char * bitsSrc, * bitsDst;
-    register float * scanlineIntegralTop, * scanlineIntegralBottom;
-    register double * scanlineIntegralSqTop, * scanlineIntegralSqBottom;
-    register int x, y, w = src.cols, h = src.rows, rp = w - 1, bp = h - 1, x0, x1, y0, y1, n;
-    register int mean, stdDev;
+    if (size.area() == 0)
+        return;
 
-    for (y = 0; y < h; y++)
-    {
-        y0 = IBP_maximum(y - radius, 0);
-        y1 = IBP_minimum(y + radius, bp);
+    if (maximumPixels * 255. * 255. < 4294967296.)
+        adaptiveThresholdIntegralSums<unsigned int>(src, dst, blockSize >> 1, k);
+    else
+        adaptiveThresholdIntegralSums<unsigned long long>(src, dst, blockSize >> 1, k);
+}
 
-        bitsSrc = (unsigned char *)src.ptr(y);
-        bitsDst = (unsigned char *)dst.ptr(y);
+void thresholdChannels(cv::Mat & image, bool luma, const bool affectedChannels[5],
+                       const std::function<void (cv::Mat &)> & threshold)
+{
+    CV_Assert(image.type() == CV_8UC4);
+    // channel of the image each flag reads and writes, past the luma one
+    static const int kChannels[5] = { -1, 2, 1, 0, 3 };
+    register const BGRA * bits;
+    register unsigned char * bitsPlane;
+    register int x;
 
-        scanlineIntegralTop = (float *)integral.ptr(y0);
-        scanlineIntegralBottom = (float *)integral.ptr(y1 + 1);
-        scanlineIntegralSqTop = (double *)integralSq.ptr(y0);
-        scanlineIntegralSqBottom = (double *)integralSq.ptr(y1 + 1);
+    for (int c = 0; c < 5; c++)
+    {
+        if (!affectedChannels[c] || (c == 0 && !luma) || (c > 0 && c < 4 && luma))
+            continue;
 
-        for (x = 0; x < w; x++, bitsSrc++, bitsDst++)
+        cv::Mat plane(image.rows, image.cols, CV_8UC1);
+        if (c == 0)
         {
-            x0 = IBP_maximum(x - radius, 0);
-            x1 = IBP_minimum(x + radius, rp);
-
-            n = (x1 - x0 + 1) * (y1 - y0 + 1);
+            for (int y = 0; y < image.rows; y++)
+            {
+                bits = image.ptr<BGRA>(y);
+                bitsPlane = plane.ptr(y);
+                for (x = 0; x < image.cols; x++, bits++)
+                    bitsPlane[x] = IBP_pixelIntensity4(bits->r, bits->g, bits->b);
+            }
+        }
+        else
+        {
+            int from_to[] = { kChannels[c], 0 };
+            cv::mixChannels(&image, 1, &plane, 1, from_to, 1);
+        }
 
-            mean = (scanlineIntegralBottom[x1 + 1] + scanlineIntegralTop[x0] -
-                    scanlineIntegralBottom[x0] - scanlineIntegralTop[x1 + 1]) / n;
-            stdDev = (scanlineIntegralSqBottom[x1 + 1] + scanlineIntegralSqTop[x0] -
-                      scanlineIntegralSqBottom[x0] - scanlineIntegralSqTop[x1 + 1]) / n - mean * mean;
+        threshold(plane);
 
-            *bitsDst = (*bitsSrc) < (mean * (1. + kappa * (sqrt(stdDev) / R - 1.))) ? 0 : 255;
+        if (c == 0)
+        {
+            int from_to[] = { 0,0, 0,1, 0,2 };
+            cv::mixChannels(&plane, 1, &image, 1, from_to, 3);
+        }
+        else
+        {
+            int from_to[] = { 0, kChannels[c] };
+            cv::mixChannels(&plane, 1, &image, 1, from_to, 1);
         }
     }
 }
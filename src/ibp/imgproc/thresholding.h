@@ -26,6 +26,7 @@
 #define IBP_IMGPROC_THRESHOLDING_H
 
 #include <opencv2/core.hpp>
+#include <functional>
 
 namespace ibp {
 namespace imgproc {
@@ -42,6 +43,18 @@ namespace imgproc {
 ********************************************************/
 void adaptiveThresholdIntegral(cv::InputArray _src, cv::OutputArray _dst, int blockSize, double k);
 
+/*******************************************************
+** Thresholds in place the channels of a BGRA CV_8UC4
+** image that the threshold plugins select, each one as
+** a CV_8UC1 plane handed to threshold. affectedChannels
+** holds the luma, red, green, blue and alpha flags.
+** With luma set, the luma is thresholded and written
+** back to B, G and R; otherwise red, green and blue are
+** thresholded one by one. Alpha is used in both modes
+********************************************************/
+void thresholdChannels(cv::Mat & image, bool luma, const bool affectedChannels[5],
+                       const std::function<void (cv::Mat &)> & threshold);
+
 } // namespace imgproc
 } // namespace ibp
 
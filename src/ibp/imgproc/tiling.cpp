@@ -0,0 +1,163 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <atomic>
+#include <math.h>
+#include <vector>
+
+#include "tiling.h"
+#include "util.h"
+#include "../misc/util.h"
+
+namespace ibp {
+namespace imgproc {
+
+bool parallelForTiles(const cv::Mat & src, cv::Mat & dst, int tileSize, int margin, const TileFunction & f,
+                      const std::function<bool ()> & isCancelled)
+{
+    CV_Assert(tileSize > 0 && margin >= 0);
+    CV_Assert(dst.size() == src.size() && dst.data != src.data);
+
+    const int nTilesX = (src.cols + tileSize - 1) / tileSize;
+    const int nTilesY = (src.rows + tileSize - 1) / tileSize;
+    const cv::Rect bounds(0, 0, src.cols, src.rows);
+    std::atomic<bool> cancelled(false);
+
+    parallelForRows(nTilesX * nTilesY, 1, [&](int startTile, int endTile)
+    {
+        for (int t = startTile; t < endTile; t++)
+        {
+            if (cancelled.load() || (isCancelled && isCancelled()))
+            {
+                cancelled.store(true);
+                return;
+            }
+
+            const cv::Rect tile = cv::Rect((t % nTilesX) * tileSize, (t / nTilesX) * tileSize,
+                                           tileSize, tileSize) & bounds;
+            const cv::Rect grown = cv::Rect(tile.x - margin, tile.y - margin,
+                                            tile.width + 2 * margin, tile.height + 2 * margin) & bounds;
+            cv::Mat out;
+            f(src(grown), out);
+            CV_Assert(out.size() == grown.size() && out.type() == dst.type());
+            out(tile - grown.tl()).copyTo(dst(tile));
+        }
+    });
+
+    return !cancelled.load();
+}
+
+// Weight of a tile spanning [start, end) of a side of n pixels at the index i of its band grown by feather
+static inline float tileRamp(int i, int start, int end, int n, int feather)
+{
+    float w = 1.f;
+    if (start > 0)
+        w = IBP_minimum(w, (i - start + feather + .5f) / (2 * feather));
+    if (end < n)
+        w = IBP_minimum(w, (end + feather - i - .5f) / (2 * feather));
+    return w;
+}
+
+bool parallelForBlendedTiles(const cv::Mat & src, cv::Mat & dst, int tileSize, int margin, int feather,
+                             const TileFunction & f, const std::function<bool ()> & isCancelled)
+{
+    CV_Assert(tileSize > 0 && margin >= 0 && feather >= 0);
+    CV_Assert(dst.size() == src.size() && dst.data != src.data && dst.depth() == CV_8U);
+
+    // tiles of a pass are two tiles apart, so their bands never meet
+    feather = IBP_minimum(feather, tileSize / 2);
+    const int nTilesX = (src.cols + tileSize - 1) / tileSize;
+    const int nTilesY = (src.rows + tileSize - 1) / tileSize;
+    const int nPassTilesX = (nTilesX + 1) / 2, nPassTilesY = (nTilesY + 1) / 2;
+    const cv::Rect bounds(0, 0, src.cols, src.rows);
+    const int channels = dst.channels();
+    std::atomic<bool> cancelled(false);
+
+    for (int pass = 0; pass < 4 && !cancelled.load(); pass++)
+    {
+        const int px = pass & 1, py = pass >> 1;
+        parallelForRows(nPassTilesX * nPassTilesY, 1, [&](int startTile, int endTile)
+        {
+            std::vector<float> wx;
+            for (int t = startTile; t < endTile; t++)
+            {
+                if (cancelled.load() || (isCancelled && isCancelled()))
+                {
+                    cancelled.store(true);
+                    return;
+                }
+
+                const int tx = (t % nPassTilesX) * 2 + px, ty = (t / nPassTilesX) * 2 + py;
+                if (tx >= nTilesX || ty >= nTilesY)
+                    continue;
+                const cv::Rect tile = cv::Rect(tx * tileSize, ty * tileSize, tileSize, tileSize) & bounds;
+                const cv::Rect band = cv::Rect(tile.x - feather, tile.y - feather, tile.width + 2 * feather,
+                                               tile.height + 2 * feather) & bounds;
+                const cv::Rect grown = cv::Rect(band.x - margin, band.y - margin, band.width + 2 * margin,
+                                                band.height + 2 * margin) & bounds;
+                cv::Mat out;
+                f(src(grown), out);
+                CV_Assert(out.size() == grown.size() && out.type() == dst.type());
+
+                // the ramps of this tile and of its neighbours add up to 1; a neighbour's share only counts once
+                // its pass has run, so each pixel ends up with the weighted mean of all the tiles over it
+                wx.resize(band.width);
+                for (int x = 0; x < band.width; x++)
+                    wx[x] = tileRamp(band.x + x, tile.x, tile.x + tile.width, src.cols, feather);
+                for (int y = 0; y < band.height; y++)
+                {
+                    const float wy = tileRamp(band.y + y, tile.y, tile.y + tile.height, src.rows, feather);
+                    const unsigned char * bitsOut = out.ptr(band.y - grown.y + y) + (band.x - grown.x) * channels;
+                    unsigned char * bitsDst = dst.ptr(band.y + y) + band.x * channels;
+                    for (int x = 0; x < band.width; x++)
+                    {
+                        const float w = wx[x] * wy;
+                        // shares of this tile, of the neighbour across x, across y and across the corner
+                        const float shares[4] = { w, (1.f - wx[x]) * wy, wx[x] * (1.f - wy),
+                                                  (1.f - wx[x]) * (1.f - wy) };
+                        float done = 0.f;
+                        for (int k = 0; k < 4; k++)
+                            if (((px ^ (k & 1)) + 2 * (py ^ (k >> 1))) <= pass)
+                                done += shares[k];
+                        const float alpha = w / done;
+                        for (int c = 0; c < channels; c++, bitsOut++, bitsDst++)
+                            *bitsDst = (unsigned char)(*bitsDst + alpha * (*bitsOut - *bitsDst) + .5f);
+                    }
+                }
+            }
+        });
+    }
+
+    return !cancelled.load();
+}
+
+int budgetedTileSize(int margin, double bytesPerPixel, size_t memoryBudget)
+{
+    CV_Assert(margin >= 0 && bytesPerPixel > 0.);
+
+    const int grownSize = (int)sqrt((double)memoryBudget / threadBudget() / bytesPerPixel);
+    return IBP_maximum(kMinimumTileSize, grownSize - 2 * margin);
+}
+
+}}
@@ -0,0 +1,79 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef IBP_IMGPROC_TILING_H
+#define IBP_IMGPROC_TILING_H
+
+#include <functional>
+#include <opencv2/core.hpp>
+
+namespace ibp {
+namespace imgproc {
+
+/*******************************************************
+** Runs f on tiles of tileSize x tileSize pixels of src
+** in parallel. Every tile is grown by margin pixels on
+** each side (as far as the image goes) before f sees
+** it, and only its centre is copied from f's output to
+** dst, which must have the size of src and the type f
+** outputs. Filters that read no further than margin
+** pixels away thus give the same result as on the whole
+** image, with no seams to blend. Returns false, with dst
+** partially written, when isCancelled returns true
+** between two tiles; it may be called from any thread.
+********************************************************/
+typedef std::function<void (const cv::Mat & src, cv::Mat & dst)> TileFunction;
+bool parallelForTiles(const cv::Mat & src, cv::Mat & dst, int tileSize, int margin, const TileFunction & f,
+                      const std::function<bool ()> & isCancelled = std::function<bool ()>());
+
+/*******************************************************
+** Like parallelForTiles, for filters whose tiles do not
+** match the whole image exactly (they fit parameters to
+** what they see, or read further than any margin). Each
+** tile is grown by feather pixels more on its inner
+** sides, and its output over that band is cross-faded
+** with its neighbours' along linear ramps, so no seams
+** show. feather is at most half of tileSize. Tiles are
+** filtered in four passes of non-adjacent tiles, each
+** pass in parallel. dst must be CV_8U.
+********************************************************/
+bool parallelForBlendedTiles(const cv::Mat & src, cv::Mat & dst, int tileSize, int margin, int feather,
+                             const TileFunction & f,
+                             const std::function<bool ()> & isCancelled = std::function<bool ()>());
+
+/*******************************************************
+** Side of the tiles that keeps the tiles filtered at
+** once, one per thread and each grown by margin on every
+** side, within memoryBudget bytes, for a filter that
+** needs bytesPerPixel bytes for every pixel it is given.
+** It is never below kMinimumTileSize.
+********************************************************/
+const size_t kTilingMemoryBudget = (size_t)512 << 20;
+const int kMinimumTileSize = 64;
+int budgetedTileSize(int margin, double bytesPerPixel, size_t memoryBudget = kTilingMemoryBudget);
+
+} // namespace imgproc
+} // namespace ibp
+
+#endif // IBP_IMGPROC_TILING_H
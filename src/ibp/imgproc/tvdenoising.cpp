@@ -0,0 +1,162 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <math.h>
+#include <vector>
+#include <opencv2/imgproc.hpp>
+
+#include "tvdenoising.h"
+#include "util.h"
+#include "../misc/util.h"
+
+// primal and dual step sizes of cv::denoise_TVL1, tau * sigma * 8 = 1 (8 is the squared norm of the gradient)
+#define TVL1_TAU 0.02f
+#define TVL1_SIGMA (1.f / (8.f * TVL1_TAU))
+
+// levels smaller than this on either side are not worth adding to the pyramid
+#define TVL1_MINIMUM_LEVEL_SIZE 16
+
+namespace ibp {
+namespace imgproc {
+
+// Primal-dual iterations for the observation f (CV_32FC1), from the primal x (CV_32FC1), the dual p of the
+// gradient (CV_32FC2, within the unit disk) and the dual r of the data term (CV_32FC1, within [-lambda, lambda]),
+// which are all updated. Returns the number of iterations run
+static int iterateTVL1(const cv::Mat & f, cv::Mat & x, cv::Mat & p, cv::Mat & r, float lambda,
+                       int maximumIterations, float tolerance)
+{
+    const int w = f.cols, h = f.rows, rowsPerChunk = IBP_maximum(1, 16384 / w);
+    // x extrapolated from the last two iterations, the point the dual step is taken from
+    cv::Mat xBar = x.clone();
+    std::vector<double> rowChanges(h);
+    int iteration = 0;
+
+    while (iteration < maximumIterations)
+    {
+        // p = p + sigma * grad(xBar), projected back to the unit disk, r = clamp(r + sigma * (xBar - f))
+        parallelForRows(h, rowsPerChunk, [&](int startRow, int endRow)
+        {
+            register int i;
+            for (int y = startRow; y < endRow; y++)
+            {
+                const float * xBarRow = xBar.ptr<float>(y), * fRow = f.ptr<float>(y);
+                const float * xBarNext = y + 1 < h ? xBar.ptr<float>(y + 1) : xBarRow;
+                float * pRow = p.ptr<float>(y), * rRow = r.ptr<float>(y);
+                for (i = 0; i < w; i++)
+                {
+                    // the gradient is 0 past the last column and row, and so is p there
+                    float px = i + 1 < w ? pRow[i * 2] + TVL1_SIGMA * (xBarRow[i + 1] - xBarRow[i]) : 0.f;
+                    float py = y + 1 < h ? pRow[i * 2 + 1] + TVL1_SIGMA * (xBarNext[i] - xBarRow[i]) : 0.f;
+                    const float m = px * px + py * py;
+                    if (m > 1.f)
+                    {
+                        const float s = 1.f / sqrtf(m);
+                        px *= s;
+                        py *= s;
+                    }
+                    pRow[i * 2] = px;
+                    pRow[i * 2 + 1] = py;
+                    rRow[i] = IBP_clamp(-lambda, rRow[i] + TVL1_SIGMA * (xBarRow[i] - fRow[i]), lambda);
+                }
+            }
+        });
+
+        // x' = x + tau * (div(p) - r), xBar = 2 * x' - x
+        parallelForRows(h, rowsPerChunk, [&](int startRow, int endRow)
+        {
+            register int i;
+            for (int y = startRow; y < endRow; y++)
+            {
+                const float * pRow = p.ptr<float>(y), * pPrevious = y > 0 ? p.ptr<float>(y - 1) : 0;
+                const float * rRow = r.ptr<float>(y);
+                float * xRow = x.ptr<float>(y), * xBarRow = xBar.ptr<float>(y);
+                double change = 0.;
+                for (i = 0; i < w; i++)
+                {
+                    float divergence = pRow[i * 2] + pRow[i * 2 + 1];
+                    if (i > 0)
+                        divergence -= pRow[i * 2 - 2];
+                    if (pPrevious)
+                        divergence -= pPrevious[i * 2 + 1];
+                    const float xNew = xRow[i] + TVL1_TAU * (divergence - rRow[i]);
+                    change += fabsf(xNew - xRow[i]);
+                    xBarRow[i] = 2.f * xNew - xRow[i];
+                    xRow[i] = xNew;
+                }
+                rowChanges[y] = change;
+            }
+        });
+
+        iteration++;
+        double change = 0.;
+        for (int y = 0; y < h; y++)
+            change += rowChanges[y];
+        if (change < tolerance * w * h)
+            break;
+    }
+
+    return iteration;
+}
+
+void denoiseTVL1(cv::InputArray _src, cv::OutputArray _dst, double lambda, int maximumIterations, int nLevels,
+                 double tolerance)
+{
+    cv::Mat src = _src.getMat();
+    CV_Assert(src.type() == CV_8UC1);
+
+    // observations, finest first
+    std::vector<cv::Mat> f(1);
+    src.convertTo(f[0], CV_32F, 1. / 255.);
+    while ((int)f.size() < nLevels && f.back().cols >= TVL1_MINIMUM_LEVEL_SIZE * 2 &&
+           f.back().rows >= TVL1_MINIMUM_LEVEL_SIZE * 2)
+    {
+        cv::Mat level;
+        cv::resize(f.back(), level, cv::Size((f.back().cols + 1) / 2, (f.back().rows + 1) / 2), 0, 0,
+                   cv::INTER_AREA);
+        f.push_back(level);
+    }
+
+    cv::Mat x = f.back().clone();
+    cv::Mat p = cv::Mat::zeros(x.size(), CV_32FC2), r = cv::Mat::zeros(x.size(), CV_32FC1);
+    for (int level = (int)f.size() - 1; level >= 0; level--)
+    {
+        if (level < (int)f.size() - 1)
+        {
+            // warm start: p stays in the unit disk when interpolated, and at the optimum r balances a divergence
+            // of p that halves with the pixel size
+            const cv::Size size = f[level].size();
+            cv::resize(x, x, size, 0, 0, cv::INTER_LINEAR);
+            cv::resize(p, p, size, 0, 0, cv::INTER_LINEAR);
+            cv::resize(r, r, size, 0, 0, cv::INTER_LINEAR);
+            r *= .5;
+        }
+        // the data term of a pixel of the level stands for (1 << level)^2 pixels, its total variation for
+        // (1 << level) of them
+        iterateTVL1(f[level], x, p, r, (float)(lambda * (1 << level)), maximumIterations, (float)tolerance);
+    }
+
+    x.convertTo(_dst, CV_8U, 255.);
+}
+
+}}
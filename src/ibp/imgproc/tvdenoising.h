@@ -0,0 +1,57 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef IBP_IMGPROC_TVDENOISING_H
+#define IBP_IMGPROC_TVDENOISING_H
+
+#include <opencv2/core.hpp>
+
+namespace ibp {
+namespace imgproc {
+
+/*******************************************************
+** TV-L1 denoising of a CV_8UC1 image, the problem of
+** cv::denoise_TVL1 with a single observation: minimize
+** |grad(x)| + lambda * |x - src|, solved with first
+** order primal-dual iterations, rows in parallel.
+**
+** The problem is solved coarse to fine: first on src
+** downsampled nLevels - 1 times by 2, then on every
+** finer level starting from the upsampled solution of
+** the coarser one, with lambda scaled to the level so
+** they all solve the same continuous problem. Every
+** level stops after maximumIterations or as soon as
+** the mean absolute change of x in an iteration is
+** below tolerance (x in [0, 1]), whichever is first.
+** nLevels = 1 and tolerance = 0 is the single scale
+** solver with a fixed number of iterations.
+********************************************************/
+const double kTVL1DefaultTolerance = 3e-4;
+void denoiseTVL1(cv::InputArray _src, cv::OutputArray _dst, double lambda, int maximumIterations, int nLevels = 3,
+                 double tolerance = kTVL1DefaultTolerance);
+
+} // namespace imgproc
+} // namespace ibp
+
+#endif // IBP_IMGPROC_TVDENOISING_H
@@ -22,6 +22,8 @@
 // SOFTWARE.
 //
 
+#include <opencv2/core.hpp>
+
 #include "util.h"
 
 namespace ibp {
@@ -36,4 +38,66 @@ QStringList colorCompositionModeStrings = QStringList() <<
      "hue" << "saturation" << "color" << "luminosity" <<
      "unsupported";
 
+QImage convertToPremultipliedAlpha(const QImage & image)
+{
+    if (image.format() != QImage::Format_ARGB32)
+        return image;
+
+    QImage i = image.copy();
+    premultiplyBGRA((BGRA *)i.bits(), i.width() * i.height());
+    i.reinterpretAsFormat(QImage::Format_ARGB32_Premultiplied);
+    return i;
+}
+
+QImage convertToStraightAlpha(const QImage & image)
+{
+    if (image.format() != QImage::Format_ARGB32_Premultiplied)
+        return image;
+
+    QImage i = image.copy();
+    postmultiplyBGRA((BGRA *)i.bits(), i.width() * i.height());
+    i.reinterpretAsFormat(QImage::Format_ARGB32);
+    return i;
+}
+
+class ParallelRowsLoopBody : public cv::ParallelLoopBody
+{
+public:
+    ParallelRowsLoopBody(int nRows, int rowsPerChunk, const std::function<void (int, int)> & f) :
+        mNRows(nRows),
+        mRowsPerChunk(rowsPerChunk),
+        mF(f)
+    {
+    }
+
+    void operator()(const cv::Range & range) const
+    {
+        for (int chunk = range.start; chunk < range.end; chunk++)
+            mF(chunk * mRowsPerChunk, qMin((chunk + 1) * mRowsPerChunk, mNRows));
+    }
+
+private:
+    int mNRows, mRowsPerChunk;
+    const std::function<void (int, int)> & mF;
+};
+
+void parallelForRows(int nRows, int rowsPerChunk, const std::function<void (int, int)> & f)
+{
+    if (nRows <= 0)
+        return;
+    if (rowsPerChunk < 1)
+        rowsPerChunk = 1;
+
+    const int nChunks = (nRows + rowsPerChunk - 1) / rowsPerChunk;
+    if (nChunks == 1)
+        f(0, nRows);
+    else
+        cv::parallel_for_(cv::Range(0, nChunks), ParallelRowsLoopBody(nRows, rowsPerChunk, f));
+}
+
+int threadBudget()
+{
+    return qMax(1, cv::getNumThreads());
+}
+
 }}
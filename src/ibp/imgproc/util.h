@@ -27,32 +27,69 @@
 
 #include <QStringList>
 #include <QString>
+#include <QImage>
+#include <functional>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IBP_SSE2
+#include <emmintrin.h>
+#endif
 
 #include "types.h"
+#include "lut.h"
 
 namespace ibp {
 namespace imgproc {
 
+// a * b / 255, truncated. Same values as lut01.
+inline int normalizedMultiply(int a, int b)
+{
+    register int x = a * b;
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+// a * 255 / b, truncated, 0 if b is 0. Same values as lut02.
+inline int normalizedDivide(int a, int b)
+{
+    return (int)((a * lut04[b]) >> 16);
+}
+
+// a + b - a * b / 255. Same values as lut03.
+inline int normalizedScreen(int a, int b)
+{
+    return a + b - normalizedMultiply(a, b);
+}
+
+#ifdef IBP_ARITHMETIC_KERNELS
+#define IBP_multiply(a, b) ibp::imgproc::normalizedMultiply((a), (b))
+#define IBP_divide(a, b) ibp::imgproc::normalizedDivide((a), (b))
+#define IBP_screen(a, b) ibp::imgproc::normalizedScreen((a), (b))
+#else
+#define IBP_multiply(a, b) lut01[(a)][(b)]
+#define IBP_divide(a, b) lut02[(a)][(b)]
+#define IBP_screen(a, b) lut03[(a)][(b)]
+#endif
+
 #define IBP_premultiplyBGRAWithAlpha(src, alpha) \
-(src).b = lut01[(src).b][(alpha)]; \
-(src).g = lut01[(src).g][(alpha)]; \
-(src).r = lut01[(src).r][(alpha)];
+(src).b = IBP_multiply((src).b, (alpha)); \
+(src).g = IBP_multiply((src).g, (alpha)); \
+(src).r = IBP_multiply((src).r, (alpha));
 
 #define IBP_premultiplyBGRA(src) \
-(src).b = lut01[(src).b][(src).a]; \
-(src).g = lut01[(src).g][(src).a]; \
-(src).r = lut01[(src).r][(src).a];
+(src).b = IBP_multiply((src).b, (src).a); \
+(src).g = IBP_multiply((src).g, (src).a); \
+(src).r = IBP_multiply((src).r, (src).a);
 
 #define IBP_postmultiplyBGRA(src) \
-(src).b = lut02[(src).b][(src).a]; \
-(src).g = lut02[(src).g][(src).a]; \
-(src).r = lut02[(src).r][(src).a];
+(src).b = IBP_divide((src).b, (src).a); \
+(src).g = IBP_divide((src).g, (src).a); \
+(src).r = IBP_divide((src).r, (src).a);
 
 #define IBP_pixelIntensity1(src) \
-    (lut01[(src).r][54] + lut01[(src).g][183] + lut01[(src).b][18])
+    (IBP_multiply((src).r, 54) + IBP_multiply((src).g, 183) + IBP_multiply((src).b, 18))
 
 #define IBP_pixelIntensity2(red, green, blue) \
-    (lut01[red][54] + lut01[green][183] + lut01[blue][18])
+    (IBP_multiply((red), 54) + IBP_multiply((green), 183) + IBP_multiply((blue), 18))
 
 #define IBP_pixelIntensity3(src) \
     ((int)(((src).r * .2126) + ((src).g * .7152) + ((src).b * .0722) + .5))
@@ -60,6 +97,148 @@ namespace imgproc {
 #define IBP_pixelIntensity4(red, green, blue) \
     ((int)(((red) * .2126) + ((green) * .7152) + ((blue) * .0722) + .5))
 
+// Integer form of IBP_pixelIntensity4. Exact Rec. 709 luma rounded half up, IBP_pixelIntensity4 can
+// round exact halves down because of floating point error
+#define IBP_pixelLuma(red, green, blue) \
+    (((red) * 2126 + (green) * 7152 + (blue) * 722 + 5000) / 10000)
+
+#ifdef IBP_SSE2
+// Eight 16 bit lanes holding values in [0, 255]: x * y / 255, truncated
+inline __m128i normalizedMultiply(__m128i x, __m128i y)
+{
+    __m128i p = _mm_mullo_epi16(x, y);
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(p, _mm_set1_epi16(1)), _mm_srli_epi16(p, 8)), 8);
+}
+#endif
+
+// output[i] = a[i] * b[i] / 255. output may alias a or b.
+inline void normalizedMultiply(const unsigned char * a, const unsigned char * b, unsigned char * output, int n)
+{
+    register int i = 0;
+#ifdef IBP_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+        __m128i lo = normalizedMultiply(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero));
+        __m128i hi = normalizedMultiply(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero));
+        _mm_storeu_si128((__m128i *)(output + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < n; i++)
+        output[i] = normalizedMultiply(a[i], b[i]);
+}
+
+// luma[i] = IBP_pixelLuma of bits[i], a single channel plane that can be blurred or thresholded on its own
+inline void convertBGRAToLuma(const BGRA * bits, unsigned char * luma, int nPixels)
+{
+    register int i = 0;
+#ifdef IBP_SSE2
+    // per 32 bit lane: (b + r << 16) and (g + a << 16), weighted with madd
+    const __m128i maskRB = _mm_set1_epi32(0x00ff00ff);
+    const __m128i weightsRB = _mm_set1_epi32((2126 << 16) | 722);
+    const __m128i weightsGA = _mm_set1_epi32(7152);
+    const __m128i half = _mm_set1_epi32(5000);
+    // the quotient of sums below 2^22 truncates exactly in single precision
+    const __m128 scale = _mm_set1_ps(1.f / 10000.f);
+    __m128i q[4];
+    for (; i + 16 <= nPixels; i += 16)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(bits + i + j * 4));
+            __m128i x = _mm_add_epi32(_mm_madd_epi16(_mm_and_si128(v, maskRB), weightsRB),
+                                      _mm_madd_epi16(_mm_srli_epi16(v, 8), weightsGA));
+            q[j] = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(x, half)), scale));
+        }
+        _mm_storeu_si128((__m128i *)(luma + i),
+                         _mm_packus_epi16(_mm_packs_epi32(q[0], q[1]), _mm_packs_epi32(q[2], q[3])));
+    }
+#endif
+    for (; i < nPixels; i++)
+        luma[i] = IBP_pixelLuma(bits[i].r, bits[i].g, bits[i].b);
+}
+
+// In place straight to premultiplied alpha, same result as IBP_premultiplyBGRA on every pixel
+inline void premultiplyBGRA(BGRA * bits, int nPixels)
+{
+    register int i = 0;
+#ifdef IBP_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i colorMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    const __m128i alphaOne = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    for (; i + 4 <= nPixels; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(bits + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        __m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        alo = _mm_or_si128(_mm_and_si128(alo, colorMask), alphaOne);
+        ahi = _mm_or_si128(_mm_and_si128(ahi, colorMask), alphaOne);
+        _mm_storeu_si128((__m128i *)(bits + i),
+                         _mm_packus_epi16(normalizedMultiply(lo, alo), normalizedMultiply(hi, ahi)));
+    }
+#endif
+    for (; i < nPixels; i++)
+    {
+        IBP_premultiplyBGRA(bits[i]);
+    }
+}
+
+// In place premultiplied to straight alpha. Colors above alpha saturate at 255.
+inline void postmultiplyBGRA(BGRA * bits, int nPixels)
+{
+    register int i = 0;
+#ifdef IBP_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i max = _mm_set1_epi16(255);
+    for (; i + 4 <= nPixels; i += 4)
+    {
+        // a * 255 / b == a * (r >> 16) + ((a * (r & 0xFFFF)) >> 16), with r = lut04[b]
+        __m128i r = _mm_set_epi32(lut04[bits[i + 3].a], lut04[bits[i + 2].a],
+                                  lut04[bits[i + 1].a], lut04[bits[i].a]);
+        __m128i rlo = _mm_unpacklo_epi32(r, r);
+        __m128i rhi = _mm_unpackhi_epi32(r, r);
+        __m128i v = _mm_loadu_si128((const __m128i *)(bits + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        lo = _mm_add_epi16(
+                 _mm_mullo_epi16(lo, _mm_shufflehi_epi16(_mm_shufflelo_epi16(rlo, 0x55), 0x55)),
+                 _mm_mulhi_epu16(lo, _mm_shufflehi_epi16(_mm_shufflelo_epi16(rlo, 0x00), 0x00)));
+        hi = _mm_add_epi16(
+                 _mm_mullo_epi16(hi, _mm_shufflehi_epi16(_mm_shufflelo_epi16(rhi, 0x55), 0x55)),
+                 _mm_mulhi_epu16(hi, _mm_shufflehi_epi16(_mm_shufflelo_epi16(rhi, 0x00), 0x00)));
+        // min(x, 255), packus would read values above 32767 as negative
+        lo = _mm_sub_epi16(lo, _mm_subs_epu16(lo, max));
+        hi = _mm_sub_epi16(hi, _mm_subs_epu16(hi, max));
+        v = _mm_or_si128(_mm_and_si128(_mm_packus_epi16(lo, hi), colorMask), _mm_andnot_si128(colorMask, v));
+        _mm_storeu_si128((__m128i *)(bits + i), v);
+    }
+#endif
+    for (; i < nPixels; i++)
+    {
+        bits[i].b = qMin(normalizedDivide(bits[i].b, bits[i].a), 255);
+        bits[i].g = qMin(normalizedDivide(bits[i].g, bits[i].a), 255);
+        bits[i].r = qMin(normalizedDivide(bits[i].r, bits[i].a), 255);
+    }
+}
+
+// Format_ARGB32 <-> Format_ARGB32_Premultiplied with the same rounding as IBP_premultiplyBGRA and
+// IBP_postmultiplyBGRA. Images already in the target format are returned as is.
+QImage convertToPremultipliedAlpha(const QImage & image);
+QImage convertToStraightAlpha(const QImage & image);
+
+// Calls f(startRow, endRow) for consecutive chunks of rowsPerChunk rows covering [0, nRows), spreading
+// the chunks over the OpenCV thread pool. Chunks never overlap, so f may write its rows without locking.
+void parallelForRows(int nRows, int rowsPerChunk, const std::function<void (int, int)> & f);
+
+// Threads the filters may use, those of the OpenCV thread pool (cv::setNumThreads), so a single setting also
+// bounds the libraries that some filters drive with threads of their own
+int threadBudget();
+
 extern QStringList colorCompositionModeStrings;
 inline ColorCompositionMode colorCompositionModeStringToEnum(const QString & mode)
 {
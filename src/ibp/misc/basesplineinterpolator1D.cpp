@@ -25,6 +25,7 @@
 #include "basesplineinterpolator1D.h"
 #include "math.h"
 #include <algorithm>
+#include <typeinfo>
 
 namespace ibp {
 namespace misc {
@@ -169,6 +170,47 @@ double BaseSplineInterpolator1D::f(double x)
     return F(x);
 }
 
+void BaseSplineInterpolator1D::evaluate(const double *x, double *y, int n)
+{
+    if (mKnots.size() < 1)
+    {
+        for (int i = 0; i < n; i++)
+            y[i] = 0.0;
+        return;
+    }
+
+    const double first = mKnots.first().x(), last = mKnots.last().x();
+    int piece = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (x[i] < first)
+            y[i] = floorExtrapolate(x[i]);
+        else if (x[i] > last)
+            y[i] = ceilExtrapolate(x[i]);
+        else
+        {
+            piece = pieceForValue(x[i], piece);
+            y[i] = F(x[i], piece);
+        }
+    }
+}
+
+QByteArray BaseSplineInterpolator1D::cacheKey() const
+{
+    QByteArray key(typeid(*this).name());
+    key.append((const char *)&mFloorExtrapolationMode, sizeof(mFloorExtrapolationMode));
+    key.append((const char *)&mCeilExtrapolationMode, sizeof(mCeilExtrapolationMode));
+    key.append((const char *)&mFloorExtrapolationValue, sizeof(mFloorExtrapolationValue));
+    key.append((const char *)&mCeilExtrapolationValue, sizeof(mCeilExtrapolationValue));
+    for (int i = 0; i < mKnots.size(); i++)
+    {
+        const double x = mKnots[i].x(), y = mKnots[i].y();
+        key.append((const char *)&x, sizeof(x));
+        key.append((const char *)&y, sizeof(y));
+    }
+    return key;
+}
+
 Interpolator1D::ExtrapolationMode BaseSplineInterpolator1D::floorExtrapolationMode() const
 {
     return mFloorExtrapolationMode;
@@ -207,4 +249,19 @@ int BaseSplineInterpolator1D::pieceForValue(double x) const
     return min;
 }
 
+int BaseSplineInterpolator1D::pieceForValue(double x, int previousPiece) const
+{
+    const int lastPiece = mKnots.size() - 2;
+    if (previousPiece < 0 || previousPiece > lastPiece || (previousPiece > 0 && !(mKnots[previousPiece].x() < x)))
+        return pieceForValue(x);
+    while (previousPiece < lastPiece && mKnots[previousPiece + 1].x() < x)
+        previousPiece++;
+    return previousPiece;
+}
+
+double BaseSplineInterpolator1D::F(double x)
+{
+    return F(x, pieceForValue(x));
+}
+
 }}
@@ -51,6 +51,8 @@ public:
     virtual bool removeKnot(int i);
 
     virtual double f(double x);
+    virtual void evaluate(const double * x, double * y, int n);
+    virtual QByteArray cacheKey() const;
 
     virtual ExtrapolationMode floorExtrapolationMode() const;
     virtual ExtrapolationMode ceilExtrapolationMode() const;
@@ -66,7 +68,10 @@ protected:
     double mCeilExtrapolationValue;
 
     virtual int pieceForValue(double x) const;
-    virtual double F(double x) = 0;
+    // same as pieceForValue(x), walking forward from the piece of a previous, smaller x
+    int pieceForValue(double x, int previousPiece) const;
+    double F(double x);
+    virtual double F(double x, int piece) = 0;
     virtual double floorExtrapolate(double x) = 0;
     virtual double ceilExtrapolate(double x) = 0;
 };
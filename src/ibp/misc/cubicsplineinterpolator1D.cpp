@@ -58,11 +58,10 @@ Interpolator1D * CubicSplineInterpolator1D::clone() const
     return si;
 }
 
-double CubicSplineInterpolator1D::F(double x)
+double CubicSplineInterpolator1D::F(double x, int piece)
 {
     if (mIsDirty)
         calculateCoefficients();
-    const int piece = pieceForValue(x);
     const double w = x - mKnots[piece].x();
     return ((mCoefficients[piece].a * w + mCoefficients[piece].b) * w +
             mCoefficients[piece].c) * w + mCoefficients[piece].d;
@@ -449,4 +448,14 @@ void CubicSplineInterpolator1D::setBoundaryConditions(BoundaryConditions f, Boun
     mIsDirty = true;
 }
 
+QByteArray CubicSplineInterpolator1D::cacheKey() const
+{
+    QByteArray key = BaseSplineInterpolator1D::cacheKey();
+    key.append((const char *)&mFloorBoundaryConditions, sizeof(mFloorBoundaryConditions));
+    key.append((const char *)&mCeilBoundaryConditions, sizeof(mCeilBoundaryConditions));
+    key.append((const char *)&mFloorBoundaryConditionsValue, sizeof(mFloorBoundaryConditionsValue));
+    key.append((const char *)&mCeilBoundaryConditionsValue, sizeof(mCeilBoundaryConditionsValue));
+    return key;
+}
+
 }}
@@ -97,8 +97,11 @@ public:
     double ceilBoundaryConditionsValue() const;
     void setBoundaryConditions(BoundaryConditions f, BoundaryConditions c, double fv = 0., double cv = 0.);
 
+    QByteArray cacheKey() const;
+
 protected:
-    double F(double x);
+    using BaseSplineInterpolator1D::F;
+    double F(double x, int piece);
     double floorExtrapolate(double x);
     double ceilExtrapolate(double x);
 
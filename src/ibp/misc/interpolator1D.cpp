@@ -22,6 +22,10 @@
 // SOFTWARE.
 //
 
+#include <QHash>
+#include <QMutex>
+#include <math.h>
+
 #include "interpolator1D.h"
 
 namespace ibp {
@@ -32,4 +36,54 @@ bool Interpolator1DKnotsLessThan(const Interpolator1DKnot &s1, const Interpolato
     return s1.x() < s2.x();
 }
 
+void Interpolator1D::evaluate(const double *x, double *y, int n)
+{
+    for (int i = 0; i < n; i++)
+        y[i] = f(x[i]);
+}
+
+void bakeInterpolator1DLUT(Interpolator1D *interpolator, unsigned char *lut, int n, bool inverted)
+{
+    static const int maximumCachedLUTs = 64;
+    static QMutex cacheMutex;
+    static QHash<QByteArray, QByteArray> cache;
+
+    if (n < 1)
+        return;
+
+    QByteArray key = interpolator->cacheKey();
+    key.append((const char *)&n, sizeof(n));
+
+    {
+        QMutexLocker locker(&cacheMutex);
+        QHash<QByteArray, QByteArray>::const_iterator i = cache.constFind(key);
+        if (i != cache.constEnd())
+        {
+            const unsigned char * cachedLUT = (const unsigned char *)i.value().constData();
+            for (int j = 0; j < n; j++)
+                lut[j] = inverted ? 255 - cachedLUT[j] : cachedLUT[j];
+            return;
+        }
+    }
+
+    QVector<double> x(n), y(n);
+    for (int i = 0; i < n; i++)
+        x[i] = n > 1 ? i / (n - 1.) : 0.;
+    interpolator->evaluate(x.constData(), y.data(), n);
+
+    QByteArray bakedLUT(n, 0);
+    for (int i = 0; i < n; i++)
+        bakedLUT[i] = (char)(y[i] <= 0. ? 0 : y[i] >= 1. ? 255 : (int)round(y[i] * 255.));
+
+    {
+        QMutexLocker locker(&cacheMutex);
+        if (cache.size() >= maximumCachedLUTs)
+            cache.clear();
+        cache.insert(key, bakedLUT);
+    }
+
+    for (int i = 0; i < n; i++)
+        lut[i] = inverted ? 255 - (unsigned char)bakedLUT[i] : (unsigned char)bakedLUT[i];
+}
+
 }}
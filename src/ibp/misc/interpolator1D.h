@@ -27,6 +27,7 @@
 
 #include <QPointF>
 #include <QVector>
+#include <QByteArray>
 
 namespace ibp {
 namespace misc {
@@ -66,6 +67,10 @@ public:
     virtual bool removeKnot(int i) = 0;
 
     virtual double f(double x) = 0;
+    // y[i] = f(x[i]). Implementations are fastest when x is sorted in ascending order
+    virtual void evaluate(const double * x, double * y, int n);
+    // Identifies everything f() depends on: two interpolators with the same key are the same curve
+    virtual QByteArray cacheKey() const = 0;
 
     virtual ExtrapolationMode floorExtrapolationMode() const = 0;
     virtual ExtrapolationMode ceilExtrapolationMode() const = 0;
@@ -74,5 +79,9 @@ public:
     virtual void setExtrapolationMode(ExtrapolationMode f, ExtrapolationMode c, double fv = 0., double cv = 0.) = 0;
 };
 
+// lut[i] = round(f(i / (n - 1)) * 255) clamped to [0, 255], inverted (255 - value) if requested. Baked tables
+// are memoised by cacheKey(), so re-baking an unchanged curve (clones, presets, inversion toggles) is a lookup
+void bakeInterpolator1DLUT(Interpolator1D * interpolator, unsigned char * lut, int n = 256, bool inverted = false);
+
 }}
 #endif // IBP_MISC_INTERPOLATOR1D_H
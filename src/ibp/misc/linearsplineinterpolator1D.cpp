@@ -48,11 +48,10 @@ Interpolator1D * LinearSplineInterpolator1D::clone() const
     return si;
 }
 
-double LinearSplineInterpolator1D::F(double x)
+double LinearSplineInterpolator1D::F(double x, int piece)
 {
     if (mIsDirty)
         calculateCoefficients();
-    const int piece = pieceForValue(x);
     return mCoefficients[piece].a * (x - mKnots[piece].x()) + mCoefficients[piece].b;
 }
 
@@ -47,7 +47,8 @@ public:
     bool removeKnot(int i);
 
 protected:
-    double F(double x);
+    using BaseSplineInterpolator1D::F;
+    double F(double x, int piece);
     double floorExtrapolate(double x);
     double ceilExtrapolate(double x);
 
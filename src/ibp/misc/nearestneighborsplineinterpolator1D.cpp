@@ -47,9 +47,8 @@ Interpolator1D * NearestNeighborSplineInterpolator1D::clone() const
     return si;
 }
 
-double NearestNeighborSplineInterpolator1D::F(double x)
+double NearestNeighborSplineInterpolator1D::F(double x, int piece)
 {
-    const int piece = pieceForValue(x);
     return x < (mKnots[piece].x() + mKnots[piece + 1].x()) / 2. ? mKnots[piece].y() : mKnots[piece + 1].y();
 }
 
@@ -37,7 +37,8 @@ public:
     Interpolator1D * clone() const;
 
 protected:
-    double F(double x);
+    using BaseSplineInterpolator1D::F;
+    double F(double x, int piece);
     double floorExtrapolate(double x);
     double ceilExtrapolate(double x);
 };
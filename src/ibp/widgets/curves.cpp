@@ -177,10 +177,14 @@ void Curves::paintEvent(QPaintEvent *)
 
     // graph
     QRect graphRectCopy = graphRect();
+    QVector<double> xValues(r.width()), yValues(r.width());
+    for (int i = 0; i < xValues.size(); i++)
+        xValues[i] = mapToSplineInterpolator(r.left() + i);
+    mSplineInterpolator->evaluate(xValues.constData(), yValues.data(), xValues.size());
     QPolygonF poly;
-    for (int i = r.left(); i <= r.right(); i++)
-        poly.append(QPointF(i, (1. - valueAt(mapToSplineInterpolator(i))) *
-                                graphRectCopy.height() + graphRectCopy.top()));
+    for (int i = 0; i < yValues.size(); i++)
+        poly.append(QPointF(r.left() + i, (1. - IBP_clamp(0., yValues[i], 1.)) *
+                                          graphRectCopy.height() + graphRectCopy.top()));
 
     // knots
     QVector<QPointF> knotPositions;
@@ -22,12 +22,17 @@
 // SOFTWARE.
 //
 
+#include <math.h>
 #include <opencv2/ximgproc.hpp>
 
 #include "filter.h"
 #include "filterwidget.h"
+#include <imgproc/tiling.h>
 #include <imgproc/types.h>
 
+// peak memory of cv::ximgproc::amFilter per pixel of a BGR image, as measured with OpenCV 5.0
+static const double kBytesPerPixel = 128.;
+
 Filter::Filter() :
     mRadius(0.0),
     mEdgePreservation(50)
@@ -75,7 +80,22 @@ QImage Filter::process(const QImage &inputImage)
     int from_to[] = { 0,0, 1,1, 2,2, 3,3 };
     cv::mixChannels(&msrc, 1, out, 2, from_to, 4);
 
-    cv::ximgproc::amFilter(msrcbgr, msrcbgr, mdstbgr, sigmaS, sigmaR, true);
+    // the manifolds are fitted to the image they see, so tiles only approximate the whole image: they are only
+    // used when the whole image would not fit the memory budget, grown by four sigmaS, where the spatial kernel has
+    // faded out, and blended across as much again
+    if (msrcbgr.total() * kBytesPerPixel <= kTilingMemoryBudget)
+        cv::ximgproc::amFilter(msrcbgr, msrcbgr, mdstbgr, sigmaS, sigmaR, true);
+    else
+    {
+        const int margin = (int)ceil(4. * sigmaS);
+        mdstbgr.create(msrcbgr.size(), msrcbgr.type());
+        if (!parallelForBlendedTiles(msrcbgr, mdstbgr, budgetedTileSize(2 * margin, kBytesPerPixel), margin, margin,
+                                     [&](const cv::Mat & src, cv::Mat & dst)
+        {
+            cv::ximgproc::amFilter(src, src, dst, sigmaS, sigmaR, true);
+        }, [this]() { return isCancelled(); }))
+            return inputImage;
+    }
 
     cv::Mat out2[] = { mdstbgr, msrcalpha };
     cv::mixChannels(out2, 2, &mdst, 1, from_to, 4);
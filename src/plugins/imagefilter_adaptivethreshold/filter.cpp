@@ -0,0 +1,212 @@
+//
+// MIT License
+// 
+// Copyright (c) Deif Lou
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <opencv2/imgproc.hpp>
+
+#include "filter.h"
+#include "filterwidget.h"
+#include <imgproc/types.h>
+#include <imgproc/thresholding.h>
+#include <imgproc/util.h>
+
+Filter::Filter() :
+    mRadius(10),
+    mSensitivity(.05),
+    mColorMode(0)
+{
+    for (int i = 0; i < 5; i++)
+        mAffectedChannel[i] = false;
+}
+
+Filter::~Filter()
+{
+
+}
+
+ImageFilter *Filter::clone()
+{
+    Filter * f = new Filter();
+    f->mRadius = mRadius;
+    f->mSensitivity = mSensitivity;
+    f->mColorMode = mColorMode;
+    for (int i = 0; i < 5; i++)
+        f->mAffectedChannel[i] = mAffectedChannel[i];
+    return f;
+}
+
+extern "C" QHash<QString, QString> getIBPPluginInfo();
+QHash<QString, QString> Filter::info()
+{
+    return getIBPPluginInfo();
+}
+
+QImage Filter::process(const QImage &inputImage)
+{
+    if (inputImage.isNull() || inputImage.format() != QImage::Format_ARGB32)
+        return inputImage;
+
+    QImage i = inputImage.copy();
+    cv::Mat dstMat(i.height(), i.width(), CV_8UC4, i.bits(), i.bytesPerLine());
+    const int windowSize = mRadius * 2 + 1;
+    const double k = mSensitivity;
+
+    thresholdChannels(dstMat, mColorMode == 0, mAffectedChannel, [&](cv::Mat & plane)
+    {
+        adaptiveThresholdIntegral(plane, plane, windowSize, k);
+    });
+
+    return i;
+}
+
+bool Filter::loadParameters(QSettings &s)
+{
+    QString colorModeStr, affectedChannelStr;
+    int radius, colorMode;
+    double sensitivity;
+    QStringList affectedChannelList;
+    bool affectedChannel[5] =  { false };
+    bool ok;
+
+    radius = s.value("radius", 10).toInt(&ok);
+    if (!ok || radius < 1 || radius > 200)
+        return false;
+
+    sensitivity = s.value("sensitivity", .05).toDouble(&ok);
+    if (!ok || sensitivity < 0. || sensitivity > 1.)
+        return false;
+
+    colorModeStr = s.value("colormode", "luma").toString();
+    if (colorModeStr == "luma")
+        colorMode = 0;
+    else if (colorModeStr == "rgb")
+        colorMode = 1;
+    else
+        return false;
+
+    affectedChannelStr = s.value("affectedchannels", "").toString();
+    affectedChannelList = affectedChannelStr.split(" ", Qt::SkipEmptyParts);
+    for (int i = 0; i < affectedChannelList.size(); i++)
+    {
+        affectedChannelStr = affectedChannelList.at(i);
+        if (affectedChannelList.at(i) == "luma")
+            affectedChannel[0] = true;
+        else if (affectedChannelList.at(i) == "red")
+            affectedChannel[1] = true;
+        else if (affectedChannelList.at(i) == "green")
+            affectedChannel[2] = true;
+        else if (affectedChannelList.at(i) == "blue")
+            affectedChannel[3] = true;
+        else if (affectedChannelList.at(i) == "alpha")
+            affectedChannel[4] = true;
+        else
+            return false;
+    }
+
+    setRadius(radius);
+    setSensitivity(sensitivity);
+    setColorMode(colorMode);
+    for (int i = 0; i < 5; i++)
+        setAffectedChannel(i, affectedChannel[i]);
+
+    return true;
+}
+
+bool Filter::saveParameters(QSettings &s)
+{
+    s.setValue("radius", mRadius);
+    s.setValue("sensitivity", mSensitivity);
+
+    s.setValue("colormode", mColorMode == 0 ? "luma" : "rgb");
+
+    QStringList affectedChannelList;
+    if (mAffectedChannel[0])
+        affectedChannelList.append("luma");
+    if (mAffectedChannel[1])
+        affectedChannelList.append("red");
+    if (mAffectedChannel[2])
+        affectedChannelList.append("green");
+    if (mAffectedChannel[3])
+        affectedChannelList.append("blue");
+    if (mAffectedChannel[4])
+        affectedChannelList.append("alpha");
+    s.setValue("affectedchannels", affectedChannelList.join(" "));
+
+    return true;
+}
+
+QWidget *Filter::widget(QWidget *parent)
+{
+    FilterWidget * fw = new FilterWidget(parent);
+    fw->setRadius(mRadius);
+    fw->setSensitivity(mSensitivity);
+    fw->setColorMode(mColorMode);
+    for (int i = 0; i < 5; i++)
+        fw->setAffectedChannel(i, mAffectedChannel[i]);
+    connect(this, SIGNAL(radiusChanged(int)), fw, SLOT(setRadius(int)));
+    connect(this, SIGNAL(sensitivityChanged(double)), fw, SLOT(setSensitivity(double)));
+    connect(this, SIGNAL(colorModeChanged(int)), fw, SLOT(setColorMode(int)));
+    connect(this, SIGNAL(affectedChannelChanged(int,bool)), fw, SLOT(setAffectedChannel(int,bool)));
+    connect(fw, SIGNAL(radiusChanged(int)), this, SLOT(setRadius(int)));
+    connect(fw, SIGNAL(sensitivityChanged(double)), this, SLOT(setSensitivity(double)));
+    connect(fw, SIGNAL(colorModeChanged(int)), this, SLOT(setColorMode(int)));
+    connect(fw, SIGNAL(affectedChannelChanged(int,bool)), this, SLOT(setAffectedChannel(int,bool)));
+    return fw;
+}
+
+void Filter::setRadius(int v)
+{
+    if (v == mRadius)
+        return;
+    mRadius = v;
+    emit radiusChanged(v);
+    emit parametersChanged();
+}
+
+void Filter::setSensitivity(double v)
+{
+    if (qFuzzyCompare(v, mSensitivity))
+        return;
+    mSensitivity = v;
+    emit sensitivityChanged(v);
+    emit parametersChanged();
+}
+
+void Filter::setColorMode(int m)
+{
+    if (m == mColorMode)
+        return;
+    mColorMode = m;
+    emit colorModeChanged(m);
+    emit parametersChanged();
+}
+
+void Filter::setAffectedChannel(int c, bool a)
+{
+    if (a == mAffectedChannel[c])
+        return;
+    mAffectedChannel[c] = a;
+    emit affectedChannelChanged(c, a);
+    emit parametersChanged();
+}
+
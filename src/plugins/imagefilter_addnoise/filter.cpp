@@ -23,13 +23,13 @@
 //
 
 #include <QTime>
-#include <QRandomGenerator>
-
-#include <math.h>
+#include <QVector>
 
 #include "filter.h"
 #include "filterwidget.h"
 #include <imgproc/types.h>
+#include <imgproc/util.h>
+#include <imgproc/random.h>
 #include <misc/util.h>
 
 using namespace ibp::imgproc;
@@ -72,82 +72,55 @@ QImage Filter::process(const QImage &inputImage)
         return inputImage;
 
     QImage i = QImage(inputImage.width(), inputImage.height(), QImage::Format_ARGB32);
-    register int totalPixels = inputImage.width() * inputImage.height();
-    register BGRA * srcBits = (BGRA *)inputImage.bits();
-    register BGRA * dstBits = (BGRA *)i.bits();
-    register int r, g, b;
-    register int amount = mAmount * 255 / 100;
-    const double minus_2_times_log_of_RAND_MAX_plus_1 = -2. * log (RAND_MAX + 1.0);
-    const double IBP_2PI_over_RAND_MAX = IBP_2PI / RAND_MAX;
-
-    QRandomGenerator randomGenerator(mSeed);
-
-    if (mColorMode == Monochromatic)
+    const int width = inputImage.width();
+    const int channels = mColorMode == Monochromatic ? 1 : 3;
+    const int amount = mAmount * 255 / 100;
+    const unsigned long long key = randomStreamKey(mSeed);
+    const BGRA * srcBits = (const BGRA *)inputImage.bits();
+    BGRA * dstBits = (BGRA *)i.bits();
+
+    // the noise of every pixel is the value of the stream at its index, so the rows can be generated in any order
+    parallelForRows(i.height(), IBP_maximum(1, 16384 / width), [&](int startRow, int endRow)
     {
+        const int nPixels = (endRow - startRow) * width, nValues = nPixels * channels;
+        const long long first = (long long)startRow * width * channels;
+        const BGRA * src = srcBits + startRow * width;
+        BGRA * dst = dstBits + startRow * width;
+        QVector<int> noise(nValues);
+        register int * n = noise.data();
+        register int j;
+
         if (mDistribution == Uniform)
-        {
-            while (totalPixels--)
-            {
-                r = 2 * (long)randomGenerator.generate() * amount / RAND_MAX - amount;
-                dstBits->r = IBP_clamp(0, srcBits->r + r, 255);
-                dstBits->g = IBP_clamp(0, srcBits->g + r, 255);
-                dstBits->b = IBP_clamp(0, srcBits->b + r, 255);
-                dstBits->a = srcBits->a;
-                srcBits++;
-                dstBits++;
-            }
-        }
+            uniformNoise(key, first, nValues, amount, n);
         else
         {
-            while (totalPixels--)
-            {
-                r = sqrt(-2. * log(randomGenerator.generate() + 1) - minus_2_times_log_of_RAND_MAX_plus_1) *
-                         cos(randomGenerator.generate() * IBP_2PI_over_RAND_MAX) * amount;
-                dstBits->r = IBP_clamp(0, srcBits->r + r, 255);
-                dstBits->g = IBP_clamp(0, srcBits->g + r, 255);
-                dstBits->b = IBP_clamp(0, srcBits->b + r, 255);
-                dstBits->a = srcBits->a;
-                srcBits++;
-                dstBits++;
-            }
+            QVector<float> gaussian(nValues);
+            gaussianNoise(key, first, nValues, gaussian.data());
+            for (j = 0; j < nValues; j++)
+                n[j] = qRound(gaussian[j] * amount);
         }
-    }
-    else
-    {
-        if (mDistribution == Uniform)
+
+        if (channels == 1)
         {
-            while (totalPixels--)
+            for (j = 0; j < nPixels; j++)
             {
-                r = 2 * (long)randomGenerator.generate() * amount / RAND_MAX - amount;
-                g = 2 * (long)randomGenerator.generate() * amount / RAND_MAX - amount;
-                b = 2 * (long)randomGenerator.generate() * amount / RAND_MAX - amount;
-                dstBits->r = IBP_clamp(0, srcBits->r + r, 255);
-                dstBits->g = IBP_clamp(0, srcBits->g + g, 255);
-                dstBits->b = IBP_clamp(0, srcBits->b + b, 255);
-                dstBits->a = srcBits->a;
-                srcBits++;
-                dstBits++;
+                dst[j].r = IBP_clamp(0, src[j].r + n[j], 255);
+                dst[j].g = IBP_clamp(0, src[j].g + n[j], 255);
+                dst[j].b = IBP_clamp(0, src[j].b + n[j], 255);
+                dst[j].a = src[j].a;
             }
         }
         else
         {
-            while (totalPixels--)
+            for (j = 0; j < nPixels; j++, n += 3)
             {
-                r = sqrt(-2. * log(randomGenerator.generate() + 1) - minus_2_times_log_of_RAND_MAX_plus_1) *
-                         cos(randomGenerator.generate() * IBP_2PI_over_RAND_MAX) * amount;
-                g = sqrt(-2. * log(randomGenerator.generate() + 1) - minus_2_times_log_of_RAND_MAX_plus_1) *
-                         cos(randomGenerator.generate() * IBP_2PI_over_RAND_MAX) * amount;
-                b = sqrt(-2. * log(randomGenerator.generate() + 1) - minus_2_times_log_of_RAND_MAX_plus_1) *
-                         cos(randomGenerator.generate() * IBP_2PI_over_RAND_MAX) * amount;
-                dstBits->r = IBP_clamp(0, srcBits->r + r, 255);
-                dstBits->g = IBP_clamp(0, srcBits->g + g, 255);
-                dstBits->b = IBP_clamp(0, srcBits->b + b, 255);
-                dstBits->a = srcBits->a;
-                srcBits++;
-                dstBits++;
+                dst[j].r = IBP_clamp(0, src[j].r + n[0], 255);
+                dst[j].g = IBP_clamp(0, src[j].g + n[1], 255);
+                dst[j].b = IBP_clamp(0, src[j].b + n[2], 255);
+                dst[j].a = src[j].a;
             }
         }
-    }
+    });
 
     return i;
 }
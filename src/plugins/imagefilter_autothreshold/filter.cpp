@@ -71,140 +71,13 @@ QImage Filter::process(const QImage &inputImage)
     const int windowSize = radius * 2 + 1;
     const double k = .05;
 
-    if (mColorMode == 0)
+    thresholdChannels(dstMat, mColorMode == 0, mAffectedChannel, [&](cv::Mat & plane)
     {
-        if (!mAffectedChannel[0] && !mAffectedChannel[4])
-            return i;
-
-        if (mAffectedChannel[0])
-        {
-            register BGRA * bitsSrc = (BGRA *)inputImage.bits();
-            register BGRA * bitsDst = (BGRA *)i.bits();
-            register int totalPixels = i.width() * i.height();
-            while (totalPixels--)
-            {
-                bitsDst->b = IBP_pixelIntensity4(bitsSrc->r, bitsSrc->g, bitsSrc->b);
-                bitsSrc++;
-                bitsDst++;
-            }
-        }
-
-        cv::Mat mSrcGray, mSrcAlpha;
-        if (mAffectedChannel[0])
-        {
-            mSrcGray = cv::Mat(dstMat.rows, dstMat.cols, CV_8UC1);
-            int from_to[] = { 0,0 };
-            cv::mixChannels(&dstMat, 1, &mSrcGray, 1, from_to, 1);
-        }
-        if (mAffectedChannel[4])
-        {
-            mSrcAlpha = cv::Mat(dstMat.rows, dstMat.cols, CV_8UC1);
-            int from_to[] = { 3,0 };
-            cv::mixChannels(&dstMat, 1, &mSrcAlpha, 1, from_to, 1);
-        }
-
         if (mThresholdMode == 0)
-        {
-            if (mAffectedChannel[0])
-                cv::threshold(mSrcGray, mSrcGray, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
-            if (mAffectedChannel[4])
-                cv::threshold(mSrcAlpha, mSrcAlpha, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
-        }
+            cv::threshold(plane, plane, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
         else
-        {
-            if (mAffectedChannel[0])
-                adaptiveThresholdIntegral(mSrcGray, mSrcGray, windowSize, k);
-            if (mAffectedChannel[4])
-                adaptiveThresholdIntegral(mSrcAlpha, mSrcAlpha, windowSize, k);
-        }
-
-        if (mAffectedChannel[0])
-        {
-            int from_to[] = { 0,0, 0,1, 0,2 };
-            cv::mixChannels(&mSrcGray, 1, &dstMat, 1, from_to, 3);
-        }
-        if (mAffectedChannel[4])
-        {
-            int from_to[] = { 0,3 };
-            cv::mixChannels(&mSrcAlpha, 1, &dstMat, 1, from_to, 1);
-        }
-    }
-    else
-    {
-        if (!mAffectedChannel[1] && !mAffectedChannel[2] &&
-            !mAffectedChannel[3] && !mAffectedChannel[4])
-            return i;
-
-        cv::Mat mSrcRed, mSrcGreen, mSrcBlue, mSrcAlpha;
-        if (mAffectedChannel[1])
-        {
-            mSrcBlue = cv::Mat(dstMat.rows, dstMat.cols, CV_8UC1);
-            int from_to[] = { 0,0 };
-            cv::mixChannels(&dstMat, 1, &mSrcBlue, 1, from_to, 1);
-        }
-        if (mAffectedChannel[2])
-        {
-            mSrcGreen = cv::Mat(dstMat.rows, dstMat.cols, CV_8UC1);
-            int from_to[] = { 1,0 };
-            cv::mixChannels(&dstMat, 1, &mSrcGreen, 1, from_to, 1);
-        }
-        if (mAffectedChannel[3])
-        {
-            mSrcRed = cv::Mat(dstMat.rows, dstMat.cols, CV_8UC1);
-            int from_to[] = { 2,0 };
-            cv::mixChannels(&dstMat, 1, &mSrcRed, 1, from_to, 1);
-        }
-        if (mAffectedChannel[4])
-        {
-            mSrcAlpha = cv::Mat(dstMat.rows, dstMat.cols, CV_8UC1);
-            int from_to[] = { 3,0 };
-            cv::mixChannels(&dstMat, 1, &mSrcAlpha, 1, from_to, 1);
-        }
-
-        if (mThresholdMode == 0)
-        {
-            if (mAffectedChannel[1])
-                cv::threshold(mSrcBlue, mSrcBlue, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
-            if (mAffectedChannel[2])
-                cv::threshold(mSrcGreen, mSrcGreen, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
-            if (mAffectedChannel[3])
-                cv::threshold(mSrcRed, mSrcRed, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
-            if (mAffectedChannel[4])
-                cv::threshold(mSrcAlpha, mSrcAlpha, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
-        }
-        else
-        {
-            if (mAffectedChannel[1])
-                adaptiveThresholdIntegral(mSrcBlue, mSrcBlue, windowSize, k);
-            if (mAffectedChannel[2])
-                adaptiveThresholdIntegral(mSrcGreen, mSrcGreen, windowSize, k);
-            if (mAffectedChannel[3])
-                adaptiveThresholdIntegral(mSrcRed, mSrcRed, windowSize, k);
-            if (mAffectedChannel[4])
-                adaptiveThresholdIntegral(mSrcAlpha, mSrcAlpha, windowSize, k);
-        }
-
-        if (mAffectedChannel[1])
-        {
-            int from_to[] = { 0,0 };
-            cv::mixChannels(&mSrcBlue, 1, &dstMat, 1, from_to, 1);
-        }
-        if (mAffectedChannel[2])
-        {
-            int from_to[] = { 0,1 };
-            cv::mixChannels(&mSrcGreen, 1, &dstMat, 1, from_to, 1);
-        }
-        if (mAffectedChannel[3])
-        {
-            int from_to[] = { 0,2 };
-            cv::mixChannels(&mSrcRed, 1, &dstMat, 1, from_to, 1);
-        }
-        if (mAffectedChannel[4])
-        {
-            int from_to[] = { 0,3 };
-            cv::mixChannels(&mSrcAlpha, 1, &dstMat, 1, from_to, 1);
-        }
-    }
+            adaptiveThresholdIntegral(plane, plane, windowSize, k);
+    });
 
     return i;
 }
@@ -22,9 +22,13 @@
 // SOFTWARE.
 //
 
+#include <atomic>
+
 #include "filter.h"
 #include "filterwidget.h"
 #include <imgproc/types.h>
+#include <imgproc/util.h>
+#include <misc/util.h>
 
 Filter::Filter() :
     mReference(AlphaChannel),
@@ -53,71 +57,142 @@ QHash<QString, QString> Filter::info()
     return getIBPPluginInfo();
 }
 
-QImage Filter::process(const QImage &inputImage)
+// fixed point weights of the luma that Reference Luma compares with the threshold
+#define AUTOTRIM_WEIGHT_RED 13932
+#define AUTOTRIM_WEIGHT_GREEN 46871
+#define AUTOTRIM_WEIGHT_BLUE 4731
+
+// a pixel is content if its alpha, or 255 minus its luma, is above the threshold
+template <bool isAlphaReference>
+static inline bool isContent(const BGRA & pixel, int threshold)
 {
-    if (inputImage.isNull() || inputImage.format() != QImage::Format_ARGB32)
-        return inputImage;
+    if (isAlphaReference)
+        return pixel.a > threshold;
+    return 255 - ((pixel.r * AUTOTRIM_WEIGHT_RED >> 16) + (pixel.g * AUTOTRIM_WEIGHT_GREEN >> 16) +
+                  (pixel.b * AUTOTRIM_WEIGHT_BLUE >> 16)) > threshold;
+}
 
-    register BGRA * bits = (BGRA *)inputImage.bits();
-    register int x, y, t, l, r, b;
-    const int w = inputImage.width();
-    const int h = inputImage.height();
-    const int threshold = mThreshold;
-    t = h - 1;
-    l = w - 1;
-    b = r = 0;
+#ifdef IBP_SSE2
+// isContent of four pixels as all ones or all zeros 32 bit lanes. The lanes of a channel hold values below 2^8 in
+// their low 16 bits, so the unsigned 16 bit high multiplication gives the truncated weighted values
+template <bool isAlphaReference>
+static inline __m128i isContent(__m128i pixels, __m128i threshold)
+{
+    if (isAlphaReference)
+        return _mm_cmpgt_epi32(_mm_srli_epi32(pixels, 24), threshold);
+    const __m128i mask = _mm_set1_epi32(0xff);
+    __m128i luma = _mm_mulhi_epu16(_mm_and_si128(pixels, mask), _mm_set1_epi32(AUTOTRIM_WEIGHT_BLUE));
+    luma = _mm_add_epi32(luma, _mm_mulhi_epu16(_mm_and_si128(_mm_srli_epi32(pixels, 8), mask),
+                                               _mm_set1_epi32(AUTOTRIM_WEIGHT_GREEN)));
+    luma = _mm_add_epi32(luma, _mm_mulhi_epu16(_mm_and_si128(_mm_srli_epi32(pixels, 16), mask),
+                                               _mm_set1_epi32(AUTOTRIM_WEIGHT_RED)));
+    return _mm_cmpgt_epi32(_mm_sub_epi32(_mm_set1_epi32(255), luma), threshold);
+}
 
-    if (mReference == AlphaChannel)
+// true if any of the 16 pixels from bits is content
+template <bool isAlphaReference>
+static inline bool anyContent16(const BGRA * bits, __m128i threshold)
+{
+    __m128i c = isContent<isAlphaReference>(_mm_loadu_si128((const __m128i *)bits), threshold);
+    c = _mm_or_si128(c, isContent<isAlphaReference>(_mm_loadu_si128((const __m128i *)(bits + 4)), threshold));
+    c = _mm_or_si128(c, isContent<isAlphaReference>(_mm_loadu_si128((const __m128i *)(bits + 8)), threshold));
+    c = _mm_or_si128(c, isContent<isAlphaReference>(_mm_loadu_si128((const __m128i *)(bits + 12)), threshold));
+    return _mm_movemask_epi8(c) != 0;
+}
+#endif
+
+// index of the first content pixel of the n from bits, n if there is none
+template <bool isAlphaReference>
+static int firstContent(const BGRA * bits, int n, int threshold)
+{
+    register int i = 0;
+#ifdef IBP_SSE2
+    const __m128i t = _mm_set1_epi32(threshold);
+    while (i + 16 <= n && !anyContent16<isAlphaReference>(bits + i, t))
+        i += 16;
+#endif
+    while (i < n && !isContent<isAlphaReference>(bits[i], threshold))
+        i++;
+    return i;
+}
+
+// index of the last content pixel of the n from bits, -1 if there is none
+template <bool isAlphaReference>
+static int lastContent(const BGRA * bits, int n, int threshold)
+{
+    register int i = n;
+#ifdef IBP_SSE2
+    const __m128i t = _mm_set1_epi32(threshold);
+    while (i >= 16 && !anyContent16<isAlphaReference>(bits + i - 16, t))
+        i -= 16;
+#endif
+    while (i > 0 && !isContent<isAlphaReference>(bits[i - 1], threshold))
+        i--;
+    return i - 1;
+}
+
+// Bounding box of the content pixels, null if there are none. Every edge is scanned inwards up to the first
+// content: the top and bottom rows at the same time, then the left and right ends of the rows between them,
+// in parallel chunks that narrow the columns left to scan as they find content
+template <bool isAlphaReference>
+static QRect contentBoundingBox(const BGRA * bits, int w, int h, int threshold)
+{
+    int top = h, bottom = -1;
+    parallelForRows(2, 1, [&](int startRow, int)
     {
-        for (y = 0; y < h; y++)
+        if (startRow == 0)
         {
-            for (x = 0; x < w; x++, bits++)
-            {
-                if (bits->a > threshold)
-                {
-                    if (y < t)
-                        t = y;
-                    if (x < l)
-                        l = x;
-                    if (y > b)
-                        b = y;
-                    if (x > r)
-                        r = x;
-                }
-            }
+            for (int y = 0; y < h && top == h; y++)
+                if (firstContent<isAlphaReference>(bits + y * w, w, threshold) < w)
+                    top = y;
         }
-    }
-    else
+        else
+        {
+            for (int y = h - 1; y >= 0 && bottom == -1; y--)
+                if (firstContent<isAlphaReference>(bits + y * w, w, threshold) < w)
+                    bottom = y;
+        }
+    });
+    if (bottom < 0)
+        return QRect();
+
+    // the top and bottom rows have content, so both ends are found in them
+    std::atomic<int> left(w), right(-1);
+    parallelForRows(bottom - top + 1, IBP_maximum(1, 16384 / w), [&](int startRow, int endRow)
     {
-        const unsigned int gR = .2126 * 0x10000;
-        const unsigned int gG = .7152 * 0x10000;
-        const unsigned int gB = .0722 * 0x10000;
-        register int g;
-        for (y = 0; y < h; y++)
+        int l = left.load(), r = right.load(), x, current;
+        for (int y = top + startRow; y < top + endRow; y++)
         {
-            for (x = 0; x < w; x++, bits++)
-            {
-                g = 255 - ((bits->r * gR >> 16) + (bits->g * gG >> 16) + (bits->b * gB >> 16));
-                if (g > threshold)
-                {
-                    if (y < t)
-                        t = y;
-                    if (x < l)
-                        l = x;
-                    if (y > b)
-                        b = y;
-                    if (x > r)
-                        r = x;
-                }
-            }
+            const BGRA * row = bits + y * w;
+            x = firstContent<isAlphaReference>(row, l, threshold);
+            if (x < l)
+                l = x;
+            x = lastContent<isAlphaReference>(row + r + 1, w - r - 1, threshold);
+            if (x >= 0)
+                r += x + 1;
         }
-    }
+        current = left.load();
+        while (l < current && !left.compare_exchange_weak(current, l));
+        current = right.load();
+        while (r > current && !right.compare_exchange_weak(current, r));
+    });
+
+    return QRect(left, top, right - left + 1, bottom - top + 1);
+}
 
-    QRect rect;
-    if (b - t < 0 || r - l < 0)
+QImage Filter::process(const QImage &inputImage)
+{
+    if (inputImage.isNull() || inputImage.format() != QImage::Format_ARGB32)
+        return inputImage;
+
+    const BGRA * bits = (const BGRA *)inputImage.bits();
+    const int w = inputImage.width();
+    const int h = inputImage.height();
+    QRect rect = mReference == AlphaChannel ? contentBoundingBox<true>(bits, w, h, mThreshold) :
+                                              contentBoundingBox<false>(bits, w, h, mThreshold);
+
+    if (rect.isNull())
         rect = QRect(0, 0, 1, 1);
-    else
-        rect = QRect(l, t, r - l + 1, b - t + 1);
     rect.adjust(-mMargins.left(), -mMargins.top(), mMargins.right(), mMargins.bottom());
 
     return inputImage.copy(rect.intersected(inputImage.rect()));
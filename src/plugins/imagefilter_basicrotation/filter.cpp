@@ -25,6 +25,7 @@
 #include "filter.h"
 #include "filterwidget.h"
 #include <imgproc/types.h>
+#include <imgproc/rotation.h>
 
 Filter::Filter() :
     mAngle(_90Clockwise)
@@ -50,69 +51,39 @@ QHash<QString, QString> Filter::info()
 
 QImage Filter::process(const QImage &inputImage)
 {
-    if (inputImage.isNull() || inputImage.format() != QImage::Format_ARGB32)
+    if (inputImage.isNull() || (inputImage.format() != QImage::Format_ARGB32 &&
+                                inputImage.format() != QImage::Format_ARGB32_Premultiplied))
         return inputImage;
 
     QImage i;
     if (mAngle == _180)
-        i = QImage(inputImage.width(), inputImage.height(), QImage::Format_ARGB32);
+        i = QImage(inputImage.width(), inputImage.height(), inputImage.format());
     else
-        i = QImage(inputImage.height(), inputImage.width(), QImage::Format_ARGB32);
-    register BGRA * bitsIn, * bitsOut;
-    register int pixels;
+        i = QImage(inputImage.height(), inputImage.width(), inputImage.format());
+    const BGRA * bitsIn = (const BGRA *)inputImage.bits();
+    BGRA * bitsOut = (BGRA *)i.bits();
 
     switch (mAngle)
     {
         case _90Clockwise:
-        {
-            pixels = i.width();
-            for (int y = 0; y < inputImage.height(); y++)
-            {
-                bitsIn = (BGRA *)inputImage.scanLine(y);
-                bitsOut = (BGRA *)i.bits() + pixels - y - 1;
-                for (int x = 0; x < inputImage.width(); x++)
-                {
-                    *bitsOut = *bitsIn;
-                    bitsIn++;
-                    bitsOut += pixels;
-                }
-            }
+            rotatePixels90(bitsIn, bitsOut, inputImage.width(), inputImage.height(), true);
             break;
-        }
         case _90CounterClockwise:
-        {
-            pixels = i.width();
-            for (int y = 0; y < inputImage.height(); y++)
-            {
-                bitsIn = (BGRA *)inputImage.scanLine(y);
-                bitsOut = (BGRA *)i.scanLine(i.height() - 1) + y;
-                for (int x = 0; x < inputImage.width(); x++)
-                {
-                    *bitsOut = *bitsIn;
-                    bitsIn++;
-                    bitsOut -= pixels;
-                }
-            }
+            rotatePixels90(bitsIn, bitsOut, inputImage.width(), inputImage.height(), false);
             break;
-        }
         case _180:
-        {
-            pixels = i.width() * i.height();
-            bitsIn = (BGRA *)inputImage.bits();
-            bitsOut = (BGRA *)i.bits() + pixels - 1;
-            while (pixels--)
-            {
-                *bitsOut = *bitsIn;
-                bitsIn++;
-                bitsOut--;
-            }
+            flipPixels(bitsIn, bitsOut, inputImage.width(), inputImage.height(), true, true);
             break;
-        }
     }
 
     return i;
 }
 
+ImageFilter::AlphaHandling Filter::alphaHandling()
+{
+    return AlphaHandling_Agnostic;
+}
+
 bool Filter::loadParameters(QSettings &s)
 {
     QString angleStr;
@@ -56,6 +56,7 @@ public:
     bool loadParameters(QSettings & s);
     bool saveParameters(QSettings & s);
     QWidget * widget(QWidget *parent = 0);
+    AlphaHandling alphaHandling();
 
 private:
     Angle mAngle;
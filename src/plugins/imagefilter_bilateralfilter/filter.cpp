@@ -27,10 +27,13 @@
 #include "filter.h"
 #include "filterwidget.h"
 #include <imgproc/types.h>
+#include <imgproc/blurring.h>
 
 Filter::Filter() :
     mRadius(0.0),
-    mEdgePreservation(50)
+    mEdgePreservation(50),
+    mMode(Exact),
+    mGridSampling(1.0)
 {
 }
 
@@ -44,6 +47,8 @@ ImageFilter *Filter::clone()
     Filter * f = new Filter();
     f->mRadius = mRadius;
     f->mEdgePreservation = mEdgePreservation;
+    f->mMode = mMode;
+    f->mGridSampling = mGridSampling;
     return f;
 }
 
@@ -75,7 +80,10 @@ QImage Filter::process(const QImage &inputImage)
     int from_to[] = { 0,0, 1,1, 2,2, 3,3 };
     cv::mixChannels(&msrc, 1, out, 2, from_to, 4);
 
-    cv::bilateralFilter(msrcbgr, mdstbgr, 0, sigmaR, sigmaS);
+    if (mMode == BilateralGrid)
+        bilateralGrid(msrcbgr, mdstbgr, sigmaR, sigmaS, mGridSampling, mGridSampling);
+    else
+        cv::bilateralFilter(msrcbgr, mdstbgr, 0, sigmaR, sigmaS);
 
     cv::Mat out2[] = { mdstbgr, msrcalpha };
     cv::mixChannels(out2, 2, &mdst, 1, from_to, 4);
@@ -87,6 +95,9 @@ bool Filter::loadParameters(QSettings &s)
 {
     double radius;
     int edgePreservation;
+    QString modeStr;
+    Mode mode;
+    double gridSampling;
     bool ok;
     radius = s.value("radius", 0.0).toDouble(&ok);
     if (!ok || radius < 0. || radius > 100.)
@@ -94,8 +105,20 @@ bool Filter::loadParameters(QSettings &s)
     edgePreservation = s.value("edgepreservation", 95).toInt(&ok);
     if (!ok || edgePreservation < 0 || edgePreservation > 100)
         return false;
+    modeStr = s.value("mode", "exact").toString();
+    if (modeStr == "exact")
+        mode = Exact;
+    else if (modeStr == "grid")
+        mode = BilateralGrid;
+    else
+        return false;
+    gridSampling = s.value("gridsampling", 1.0).toDouble(&ok);
+    if (!ok || gridSampling < .5 || gridSampling > 4.)
+        return false;
     setRadius(radius);
     setEdgePreservation(edgePreservation);
+    setMode(mode);
+    setGridSampling(gridSampling);
     return true;
 }
 
@@ -103,6 +126,8 @@ bool Filter::saveParameters(QSettings &s)
 {
     s.setValue("radius", mRadius);
     s.setValue("edgepreservation", mEdgePreservation);
+    s.setValue("mode", mMode == BilateralGrid ? "grid" : "exact");
+    s.setValue("gridsampling", mGridSampling);
     return true;
 }
 
@@ -111,10 +136,16 @@ QWidget *Filter::widget(QWidget *parent)
     FilterWidget * fw = new FilterWidget(parent);
     fw->setRadius(mRadius);
     fw->setEdgePreservation(mEdgePreservation);
+    fw->setMode(mMode);
+    fw->setGridSampling(mGridSampling);
     connect(this, SIGNAL(radiusChanged(double)), fw, SLOT(setRadius(double)));
     connect(this, SIGNAL(edgePreservationChanged(int)), fw, SLOT(setEdgePreservation(int)));
+    connect(this, SIGNAL(modeChanged(Filter::Mode)), fw, SLOT(setMode(Filter::Mode)));
+    connect(this, SIGNAL(gridSamplingChanged(double)), fw, SLOT(setGridSampling(double)));
     connect(fw, SIGNAL(radiusChanged(double)), this, SLOT(setRadius(double)));
     connect(fw, SIGNAL(edgePreservationChanged(int)), this, SLOT(setEdgePreservation(int)));
+    connect(fw, SIGNAL(modeChanged(Filter::Mode)), this, SLOT(setMode(Filter::Mode)));
+    connect(fw, SIGNAL(gridSamplingChanged(double)), this, SLOT(setGridSampling(double)));
     return fw;
 }
 
@@ -135,3 +166,21 @@ void Filter::setEdgePreservation(int v)
     emit edgePreservationChanged(v);
     emit parametersChanged();
 }
+
+void Filter::setMode(Filter::Mode m)
+{
+    if (m == mMode)
+        return;
+    mMode = m;
+    emit modeChanged(m);
+    emit parametersChanged();
+}
+
+void Filter::setGridSampling(double s)
+{
+    if (s == mGridSampling)
+        return;
+    mGridSampling = s;
+    emit gridSamplingChanged(s);
+    emit parametersChanged();
+}
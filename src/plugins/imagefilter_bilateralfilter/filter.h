@@ -41,6 +41,12 @@ class Filter : public ImageFilter
     Q_OBJECT
 
 public:
+    enum Mode
+    {
+        Exact,
+        BilateralGrid
+    };
+
     Filter();
     ~Filter();
     ImageFilter * clone();
@@ -53,14 +59,20 @@ public:
 private:
     double mRadius;
     int mEdgePreservation;
+    Mode mMode;
+    double mGridSampling;
 
 signals:
     void radiusChanged(double s);
     void edgePreservationChanged(int s);
+    void modeChanged(Filter::Mode m);
+    void gridSamplingChanged(double s);
 
 public slots:
     void setRadius(double s);
     void setEdgePreservation(int v);
+    void setMode(Filter::Mode m);
+    void setGridSampling(double s);
 };
 
 #endif // FILTER_H
@@ -33,6 +33,11 @@ FilterWidget::FilterWidget(QWidget *parent) :
     mEmitSignals(true)
 {
     ui->setupUi(this);
+
+    ui->mComboMode->addItems(QStringList() <<
+                             tr("Exact") <<
+                             tr("Bilateral Grid (fast)"));
+    ui->mComboMode->setCurrentIndex(0);
 }
 
 FilterWidget::~FilterWidget()
@@ -60,6 +65,23 @@ void FilterWidget::setEdgePreservation(int v)
     emit edgePreservationChanged(v);
 }
 
+void FilterWidget::setMode(Filter::Mode m)
+{
+    if (m == (Filter::Mode)ui->mComboMode->currentIndex())
+        return;
+    ui->mComboMode->setCurrentIndex(m);
+}
+
+void FilterWidget::setGridSampling(double s)
+{
+    if (ui->mSpinGridSampling->value() == s)
+        return;
+    mEmitSignals = false;
+    ui->mSpinGridSampling->setValue(s);
+    mEmitSignals = true;
+    emit gridSamplingChanged(s);
+}
+
 void FilterWidget::on_mSliderRadius_valueChanged(int value)
 {
     ui->mSpinRadius->setValue(value / 100.0);
@@ -87,3 +109,15 @@ void FilterWidget::on_mSpinEdgePreservation_valueChanged(int arg1)
     if (mEmitSignals)
         emit edgePreservationChanged(arg1);
 }
+
+void FilterWidget::on_mComboMode_currentIndexChanged(int index)
+{
+    if (mEmitSignals)
+        emit modeChanged((Filter::Mode)index);
+}
+
+void FilterWidget::on_mSpinGridSampling_valueChanged(double arg1)
+{
+    if (mEmitSignals)
+        emit gridSamplingChanged(arg1);
+}
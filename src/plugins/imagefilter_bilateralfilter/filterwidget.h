@@ -48,16 +48,22 @@ private:
 signals:
     void radiusChanged(double s);
     void edgePreservationChanged(int s);
+    void modeChanged(Filter::Mode m);
+    void gridSamplingChanged(double s);
 
 public slots:
     void setRadius(double s);
     void setEdgePreservation(int v);
+    void setMode(Filter::Mode m);
+    void setGridSampling(double s);
 
 private slots:
     void on_mSliderRadius_valueChanged(int value);
     void on_mSpinRadius_valueChanged(double arg1);
     void on_mSliderEdgePreservation_valueChanged(int value);
     void on_mSpinEdgePreservation_valueChanged(int arg1);
+    void on_mComboMode_currentIndexChanged(int index);
+    void on_mSpinGridSampling_valueChanged(double arg1);
 };
 
 #endif // FILTERWIDGET_H
@@ -22,11 +22,14 @@
 // SOFTWARE.
 //
 
-#include <opencv2/photo.hpp>
+#include <opencv2/imgproc.hpp>
 
 #include "filter.h"
+#include "filterwidget.h"
+#include <imgproc/decolorization.h>
 
-Filter::Filter()
+Filter::Filter() :
+    mSolveSize(512)
 {
 }
 
@@ -36,7 +39,9 @@ Filter::~Filter()
 
 ImageFilter *Filter::clone()
 {
-    return new Filter();
+    Filter * f = new Filter();
+    f->mSolveSize = mSolveSize;
+    return f;
 }
 
 extern "C" QHash<QString, QString> getIBPPluginInfo();
@@ -53,17 +58,23 @@ QImage Filter::process(const QImage &inputImage)
     QImage i = QImage(inputImage.width(), inputImage.height(), QImage::Format_ARGB32);
     cv::Mat mSrc(inputImage.height(), inputImage.width(), CV_8UC4, (void *)inputImage.bits());
     cv::Mat mDst(i.height(), i.width(), CV_8UC4, i.bits());
-    cv::Mat mRGB(inputImage.height(), inputImage.width(), CV_8UC3);
+    cv::Mat mBGR(inputImage.height(), inputImage.width(), CV_8UC3);
     cv::Mat mAlpha(inputImage.height(), inputImage.width(), CV_8UC1);
-    cv::Mat mColorBoost, mTmp;
+    cv::Mat mGray, mLab, mColorBoost;
     int fromTo[] = { 0, 0, 1, 1, 2, 2, 3, 3 };
 
+    // contrast preserving gray, with the weights solved on a downsampled copy
+    decolorize(mSrc, mGray, mSolveSize);
+
     // split the image channels
-    cv::Mat mOutSplit[] = { mRGB, mAlpha };
+    cv::Mat mOutSplit[] = { mBGR, mAlpha };
     cv::mixChannels(&mSrc, 1, mOutSplit, 2, fromTo, 4);
 
-    // denoise
-    cv::decolor(mRGB, mTmp, mColorBoost);
+    // the gray image as the lightness of the colors, as cv::decolor does
+    cv::cvtColor(mBGR, mLab, cv::COLOR_BGR2Lab);
+    int grayToLightness[] = { 0, 0 };
+    cv::mixChannels(&mGray, 1, &mLab, 1, grayToLightness, 1);
+    cv::cvtColor(mLab, mColorBoost, cv::COLOR_Lab2BGR);
 
     // merge image channels
     cv::Mat mOutMerge[] = { mColorBoost, mAlpha };
@@ -74,18 +85,35 @@ QImage Filter::process(const QImage &inputImage)
 
 bool Filter::loadParameters(QSettings &s)
 {
-    Q_UNUSED(s)
+    int solveSize;
+    bool ok;
+    solveSize = s.value("solvesize", 512).toInt(&ok);
+    if (!ok || solveSize < 64 || solveSize > 1024)
+        return false;
+    setSolveSize(solveSize);
     return true;
 }
 
 bool Filter::saveParameters(QSettings &s)
 {
-    Q_UNUSED(s)
+    s.setValue("solvesize", mSolveSize);
     return true;
 }
 
 QWidget *Filter::widget(QWidget *parent)
 {
-    Q_UNUSED(parent)
-    return 0;
+    FilterWidget * fw = new FilterWidget(parent);
+    fw->setSolveSize(mSolveSize);
+    connect(this, SIGNAL(solveSizeChanged(int)), fw, SLOT(setSolveSize(int)));
+    connect(fw, SIGNAL(solveSizeChanged(int)), this, SLOT(setSolveSize(int)));
+    return fw;
+}
+
+void Filter::setSolveSize(int s)
+{
+    if (s == mSolveSize)
+        return;
+    mSolveSize = s;
+    emit solveSizeChanged(s);
+    emit parametersChanged();
 }
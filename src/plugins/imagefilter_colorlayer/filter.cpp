@@ -22,11 +22,49 @@
 // SOFTWARE.
 //
 
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+
 #include "filter.h"
 #include "filterwidget.h"
 #include <imgproc/util.h>
 #include <imgproc/pixelblending.h>
 
+// tables kept for the last (color, opacity, position, composition mode) combinations
+#define MAX_CACHED_BLEND_TABLES 8
+
+// Shared by all the copies of the filter, so the tables are only built again when the parameters change
+static QMutex blendTablesCacheMutex;
+static QHash<QByteArray, QSharedPointer<const ConstantSourceBlendTables> > blendTablesCache;
+
+static QSharedPointer<const ConstantSourceBlendTables> blendTables(BGRA src, int configuration,
+                                                                   const std::function<void (BGRA, BGRA, BGRA &)> &
+                                                                   blendFunction)
+{
+    QByteArray key((const char *)&src, sizeof(src));
+    key.append((const char *)&configuration, sizeof(configuration));
+
+    {
+        QMutexLocker locker(&blendTablesCacheMutex);
+        QHash<QByteArray, QSharedPointer<const ConstantSourceBlendTables> >::const_iterator i =
+                blendTablesCache.constFind(key);
+        if (i != blendTablesCache.constEnd())
+            return i.value();
+    }
+
+    ConstantSourceBlendTables * tables = new ConstantSourceBlendTables;
+    makeConstantSourceBlendTables(src, blendFunction, *tables);
+    QSharedPointer<const ConstantSourceBlendTables> sharedTables(tables);
+
+    QMutexLocker locker(&blendTablesCacheMutex);
+    if (blendTablesCache.size() >= MAX_CACHED_BLEND_TABLES)
+        blendTablesCache.clear();
+    blendTablesCache.insert(key, sharedTables);
+    return sharedTables;
+}
+
 Filter::Filter() :
     mColor(255, 0, 0),
     mPosition(Front),
@@ -58,64 +96,102 @@ QHash<QString, QString> Filter::info()
 
 QImage Filter::process(const QImage &inputImage)
 {
-    if (inputImage.isNull() || inputImage.format() != QImage::Format_ARGB32)
+    if (inputImage.isNull() || (inputImage.format() != QImage::Format_ARGB32 &&
+                                (inputImage.format() != QImage::Format_ARGB32_Premultiplied ||
+                                 alphaHandling() != AlphaHandling_Premultiplied)))
         return inputImage;
 
-    QImage i(inputImage.width(), inputImage.height(), QImage::Format_ARGB32);
+    QImage i(inputImage.width(), inputImage.height(), inputImage.format());
 
     BGRA src;
     src.b = mColor.blue();
     src.g = mColor.green();
     src.r = mColor.red();
     src.a = qRound(mOpacity * 255 / 100.);
-    register BGRA * dst = (BGRA *)inputImage.bits(), * blend = (BGRA *)i.bits();
-
-    register int totalPixels = i.width() * i.height();
+    const BGRA * dst = (const BGRA *)inputImage.constBits();
+    BGRA * blend = (BGRA *)i.bits();
+    const int width = i.width();
 
-    if (mPosition == Front)
+    // The source is the same for every pixel, so the separable cases are table lookups and the others convert it once
+    std::function<void (BGRA, BGRA, BGRA &)> blendFunction;
+    int configuration;
+    if (inputImage.format() == QImage::Format_ARGB32_Premultiplied)
     {
-        while (totalPixels--)
-        {
-            blendColors[mColorCompositionMode](src, *dst, *blend);
-            dst++;
-            blend++;
-        }
+        IBP_premultiplyBGRA(src);
+        const AlphaCompositionMode mode = mPosition == Front ? AlphaCompositionMode_SourceOverDestination :
+                                          mPosition == Inside ? AlphaCompositionMode_SourceAtopDestination :
+                                                                AlphaCompositionMode_DestinationOverSource;
+        blendFunction = premultipliedAlphaBlendColors[mode];
+        configuration = -1 - mPosition;
+    }
+    else if (mPosition == Front)
+    {
+        if (isSeparableColorCompositionMode(mColorCompositionMode))
+            blendFunction = blendColors[mColorCompositionMode];
+        configuration = mColorCompositionMode;
     }
     else if (mPosition == Inside)
     {
         if (mColorCompositionMode == ColorCompositionMode_Normal)
+            blendFunction = alphaBlendColors[AlphaCompositionMode_SourceAtopDestination];
+        else if (isSeparableColorCompositionMode(mColorCompositionMode))
         {
-            while (totalPixels--)
+            const ColorCompositionMode mode = mColorCompositionMode;
+            blendFunction = [mode](BGRA s, BGRA d, BGRA & b)
             {
-                alphaBlendColors[AlphaCompositionMode_SourceAtopDestination](src, *dst, *blend);
-                dst++;
-                blend++;
-            }
+                blendColors[mode](s, d, b);
+                alphaBlendColors[AlphaCompositionMode_SourceAtopDestination](b, d, b);
+            };
         }
-        else
+        configuration = 100 + mColorCompositionMode;
+    }
+    else
+    {
+        blendFunction = alphaBlendColors[AlphaCompositionMode_DestinationOverSource];
+        configuration = 200;
+    }
+
+    if (blendFunction)
+    {
+        QSharedPointer<const ConstantSourceBlendTables> tables = blendTables(src, configuration, blendFunction);
+        parallelForRows(i.height(), IBP_maximum(1, 16384 / width), [&](int startRow, int endRow)
         {
-            while (totalPixels--)
-            {
-                blendColors[mColorCompositionMode](src, *dst, *blend);
-                alphaBlendColors[AlphaCompositionMode_SourceAtopDestination](*blend, *dst, *blend);
-                dst++;
-                blend++;
-            }
-        }
+            blendConstantSource(*tables, dst + startRow * width, blend + startRow * width,
+                                (endRow - startRow) * width);
+        });
     }
     else
     {
-        while (totalPixels--)
+        const bool inside = mPosition == Inside;
+        const ColorCompositionMode mode = mColorCompositionMode;
+        parallelForRows(i.height(), IBP_maximum(1, 16384 / width), [&](int startRow, int endRow)
         {
-            alphaBlendColors[AlphaCompositionMode_DestinationOverSource](src, *dst, *blend);
-            dst++;
-            blend++;
-        }
+            register const BGRA * d = dst + startRow * width;
+            register BGRA * b = blend + startRow * width;
+            register int nPixels = (endRow - startRow) * width;
+            blendConstantSource(src, d, b, nPixels, mode);
+            if (inside)
+            {
+                while (nPixels--)
+                {
+                    alphaBlendColors[AlphaCompositionMode_SourceAtopDestination](*b, *d, *b);
+                    d++;
+                    b++;
+                }
+            }
+        });
     }
 
     return i;
 }
 
+ImageFilter::AlphaHandling Filter::alphaHandling()
+{
+    // Only the plain alpha compositing cases work on premultiplied pixels
+    return mPosition == Behind || mColorCompositionMode == ColorCompositionMode_Normal ?
+           AlphaHandling_Premultiplied : AlphaHandling_Straight;
+}
+
 bool Filter::loadParameters(QSettings &s)
 {
     QString colorStr;
@@ -49,6 +49,15 @@ public:
     bool loadParameters(QSettings & s);
     bool saveParameters(QSettings & s);
     QWidget * widget(QWidget *parent = 0);
+
+private:
+    int mSolveSize;
+
+signals:
+    void solveSizeChanged(int s);
+
+public slots:
+    void setSolveSize(int s);
 };
 
 #endif // FILTER_H
@@ -297,12 +297,5 @@ void Filter::setInterpolationMode(Filter::InterpolationMode im)
 
 void Filter::makeLUT(WorkingChannel c)
 {
-    double x, y;
-    const double inc = 1.0 / 255.0;
-
-    for (x = 0.0; x <= 1.0; x += inc)
-    {
-        y = mSplineInterpolator[c]->f(x);
-        mLuts[c][qBound<int>(0, round(x * 255.0), 255)] = qBound<int>(0, round(y * 255.0), 255);
-    }
+    bakeInterpolator1DLUT(mSplineInterpolator[c], mLuts[c]);
 }
@@ -26,6 +26,12 @@
 
 #include "filter.h"
 #include "filterwidget.h"
+#include <imgproc/tiling.h>
+
+// peak memory of cv::xphoto::dctDenoising per pixel of a BGR image, as measured with OpenCV 5.0
+static const double kBytesPerPixel = 1536.;
+// side of the patches of cv::xphoto::dctDenoising, its default
+static const int kPatchSize = 16;
 
 Filter::Filter() :
     mStrength(0.)
@@ -72,8 +78,13 @@ QImage Filter::process(const QImage &inputImage)
     // split the image channels
     cv::mixChannels(&mSrc, 1, mOutSplit, 2, fromTo, 4);
 
-    // denoise
-    cv::xphoto::dctDenoising(mRGB, mRGBDenoised, sigma);
+    // denoise, in tiles grown by the side of the patches, which then see all the patches of the whole image
+    const int tileSize = budgetedTileSize(kPatchSize, kBytesPerPixel);
+    if (!parallelForTiles(mRGB, mRGBDenoised, tileSize, kPatchSize, [&](const cv::Mat & src, cv::Mat & dst)
+    {
+        cv::xphoto::dctDenoising(src, dst, sigma, kPatchSize);
+    }, [this]() { return isCancelled(); }))
+        return inputImage;
 
     // merge image channels
     cv::mixChannels(mOutMerge, 2, &mDst, 1, fromTo, 4);
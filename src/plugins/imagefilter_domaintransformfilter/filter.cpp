@@ -22,12 +22,17 @@
 // SOFTWARE.
 //
 
+#include <math.h>
 #include <opencv2/ximgproc.hpp>
 
 #include "filter.h"
 #include "filterwidget.h"
+#include <imgproc/tiling.h>
 #include <imgproc/types.h>
 
+// peak memory of cv::ximgproc::dtFilter per pixel of a BGR image, as measured with OpenCV 5.0
+static const double kBytesPerPixel = 36.;
+
 Filter::Filter() :
     mRadius(0.0),
     mEdgePreservation(50)
@@ -75,7 +80,17 @@ QImage Filter::process(const QImage &inputImage)
     int from_to[] = { 0,0, 1,1, 2,2, 3,3 };
     cv::mixChannels(&msrc, 1, out, 2, from_to, 4);
 
-    cv::ximgproc::dtFilter(msrcbgr, msrcbgr, mdstbgr, sigmaS, sigmaR);
+    // in tiles grown by 4.6 sigmaS, where the three box filters of the normalized convolution, compounded, have no
+    // weight left. The tiles are not bit exact: the box sums run from the tile border, so their float rounding
+    // differs, by 1 level at most
+    const int margin = (int)ceil(4.6 * sigmaS);
+    const int tileSize = budgetedTileSize(margin, kBytesPerPixel);
+    mdstbgr.create(msrcbgr.size(), msrcbgr.type());
+    if (!parallelForTiles(msrcbgr, mdstbgr, tileSize, margin, [&](const cv::Mat & src, cv::Mat & dst)
+    {
+        cv::ximgproc::dtFilter(src, src, dst, sigmaS, sigmaR);
+    }, [this]() { return isCancelled(); }))
+        return inputImage;
 
     cv::Mat out2[] = { mdstbgr, msrcalpha };
     cv::mixChannels(out2, 2, &mdst, 1, from_to, 4);
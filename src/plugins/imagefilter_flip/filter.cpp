@@ -25,6 +25,7 @@
 #include "filter.h"
 #include "filterwidget.h"
 #include <imgproc/types.h>
+#include <imgproc/rotation.h>
 
 Filter::Filter() :
     mDirection(Horizontal)
@@ -50,60 +51,23 @@ QHash<QString, QString> Filter::info()
 
 QImage Filter::process(const QImage &inputImage)
 {
-    if (inputImage.isNull() || inputImage.format() != QImage::Format_ARGB32)
+    if (inputImage.isNull() || (inputImage.format() != QImage::Format_ARGB32 &&
+                                inputImage.format() != QImage::Format_ARGB32_Premultiplied))
         return inputImage;
 
-    QImage i = QImage(inputImage.width(), inputImage.height(), QImage::Format_ARGB32);
-    register BGRA * bitsIn, * bitsOut;
-    register int pixels;
-
-    switch (mDirection)
-    {
-        case Horizontal:
-        {
-            pixels = i.width();
-            for (int y = 0; y < i.height(); y++)
-            {
-                bitsIn = (BGRA *)inputImage.scanLine(y);
-                bitsOut = (BGRA *)i.scanLine(y) + pixels - 1;
-                for (int x = 0; x < pixels; x++)
-                {
-                    *bitsOut = *bitsIn;
-                    bitsIn++;
-                    bitsOut--;
-                }
-            }
-            break;
-        }
-        case Vertical:
-        {
-            pixels = i.width() * 4;
-            for (int y = 0; y < i.height(); y++)
-            {
-                bitsIn = (BGRA *)inputImage.scanLine(y);
-                bitsOut = (BGRA *)i.scanLine(i.height() - y - 1);
-                memcpy(bitsOut, bitsIn, pixels);
-            }
-            break;
-        }
-        case Both:
-        {
-            pixels = i.width() * i.height();
-            bitsIn = (BGRA *)inputImage.bits();
-            bitsOut = (BGRA *)i.bits() + pixels - 1;
-            while (pixels--)
-            {
-                *bitsOut = *bitsIn;
-                bitsIn++;
-                bitsOut--;
-            }
-            break;
-        }
-    }
+    QImage i = QImage(inputImage.width(), inputImage.height(), inputImage.format());
+
+    flipPixels((const BGRA *)inputImage.bits(), (BGRA *)i.bits(), i.width(), i.height(),
+               mDirection != Vertical, mDirection != Horizontal);
 
     return i;
 }
 
+ImageFilter::AlphaHandling Filter::alphaHandling()
+{
+    return AlphaHandling_Agnostic;
+}
+
 bool Filter::loadParameters(QSettings &s)
 {
     QString directionStr;
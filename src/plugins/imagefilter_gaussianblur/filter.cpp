@@ -26,6 +26,7 @@
 
 #include "filter.h"
 #include "filterwidget.h"
+#include <imgproc/blurring.h>
 
 Filter::Filter() :
     mRadius(0.0),
@@ -72,34 +73,23 @@ QImage Filter::process(const QImage &inputImage)
 
     double sigma = (mRadius + .5) / 2.45;
 
-    // split the image channels
-    cv::Mat mRGB(inputImage.height(), inputImage.width(), CV_8UC3);
-    cv::Mat mAlpha(inputImage.height(), inputImage.width(), CV_8UC1);
-    cv::Mat mOutSplit[] = { mRGB, mAlpha };
-    int fromTo[] = { 0, 0, 1, 1, 2, 2, 3, 3 };
-    cv::mixChannels(&mSrc, 1, mOutSplit, 2, fromTo, 4);
-
-    // apply gaussian blur
-    cv::Mat mRGBBlurred;
-    cv::Mat mAlphaBlurred;
-    if (mBlurRGB)
+    if (mBlurRGB && mBlurAlpha)
+        gaussianBlur(mSrc, mDst, sigma);
+    else if (mBlurRGB)
     {
-        mRGBBlurred = cv::Mat(inputImage.height(), inputImage.width(), CV_8UC3);
-        cv::GaussianBlur(mRGB, mRGBBlurred, cv::Size(0, 0), sigma);
+        // restoring the alpha afterwards is cheaper than splitting and merging the channels
+        gaussianBlur(mSrc, mDst, sigma);
+        int fromTo[] = { 3, 3 };
+        cv::mixChannels(&mSrc, 1, &mDst, 1, fromTo, 1);
     }
     else
-        mRGBBlurred = mRGB;
-    if (mBlurAlpha)
     {
-        mAlphaBlurred = cv::Mat(inputImage.height(), inputImage.width(), CV_8UC1);
-        cv::GaussianBlur(mAlpha, mAlphaBlurred, cv::Size(0, 0), sigma);
+        cv::Mat mAlpha;
+        cv::extractChannel(mSrc, mAlpha, 3);
+        gaussianBlur(mAlpha, mAlpha, sigma);
+        mSrc.copyTo(mDst);
+        cv::insertChannel(mAlpha, mDst, 3);
     }
-    else
-        mAlphaBlurred = mAlpha;
-
-    // merge image channels
-    cv::Mat mOutMerge[] = { mRGBBlurred, mAlphaBlurred };
-    cv::mixChannels(mOutMerge, 2, &mDst, 1, fromTo, 4);
 
     return i;
 }
@@ -27,8 +27,12 @@
 
 #include "filter.h"
 #include "filterwidget.h"
+#include <imgproc/tiling.h>
 #include <imgproc/types.h>
 
+// peak memory of cv::ximgproc::guidedFilter per pixel of a BGR image, as measured with OpenCV 5.0
+static const double kBytesPerPixel = 144.;
+
 Filter::Filter() :
     mRadius(0),
     mEdgePreservation(50)
@@ -74,7 +78,15 @@ QImage Filter::process(const QImage &inputImage)
     int from_to[] = { 0,0, 1,1, 2,2, 3,3 };
     cv::mixChannels(&msrc, 1, out, 2, from_to, 4);
 
-    cv::ximgproc::guidedFilter(msrcbgr, msrcbgr, mdstbgr, mRadius, eps);
+    // in tiles grown by the reach of the two box filters of the guided filter, which then match the whole image
+    const int radius = mRadius;
+    const int tileSize = budgetedTileSize(2 * radius, kBytesPerPixel);
+    mdstbgr.create(msrcbgr.size(), msrcbgr.type());
+    if (!parallelForTiles(msrcbgr, mdstbgr, tileSize, 2 * radius, [&](const cv::Mat & src, cv::Mat & dst)
+    {
+        cv::ximgproc::guidedFilter(src, src, dst, radius, eps);
+    }, [this]() { return isCancelled(); }))
+        return inputImage;
 
     cv::Mat out2[] = { mdstbgr, msrcalpha };
     cv::mixChannels(out2, 2, &mdst, 1, from_to, 4);
@@ -30,6 +30,8 @@
 #include "filterwidget.h"
 #include <imgproc/types.h>
 #include <imgproc/lut.h>
+#include <imgproc/util.h>
+#include <imgproc/blurring.h>
 #include <imgproc/colorconversion.h>
 #include <imgproc/pixelblending.h>
 #include "../misc/nearestneighborsplineinterpolator1D.h"
@@ -69,7 +71,7 @@ Filter::Filter() :
     mSplineInterpolatorSaturation = new CubicSplineInterpolator1D();
     mSplineInterpolatorSaturation->addKnot(0., 0.);
     mSplineInterpolatorSaturation->addKnot(1., 1.);
-    makeLUT(ColorChannel_Saturation);
+    makeLUT(ColorChannel_Saturation, false);
     mSplineInterpolatorLightness = new CubicSplineInterpolator1D();
     mSplineInterpolatorLightness->addKnot(0., 0.);
     mSplineInterpolatorLightness->addKnot(.5, 1.);
@@ -103,7 +105,7 @@ ImageFilter * Filter::clone()
     f->mSplineInterpolatorSaturation = mSplineInterpolatorSaturation->clone();
     f->mInterpolationModeSaturation = mInterpolationModeSaturation;
     f->mIsInvertedSaturation = mIsInvertedSaturation;
-    f->makeLUT(ColorChannel_Saturation);
+    f->makeLUT(ColorChannel_Saturation, false);
 
     if (f->mSplineInterpolatorLightness)
         delete f->mSplineInterpolatorLightness;
@@ -136,160 +138,174 @@ QImage Filter::process(const QImage & inputImage)
         return inputImage;
 
     QImage outputImage = QImage(inputImage.width(), inputImage.height(), QImage::Format_ARGB32);
-    register int totalPixels = outputImage.width() * outputImage.height();
-    register BGRA * bits = (BGRA*)inputImage.bits();
-    register BGRA * bits2 = (BGRA*)outputImage.bits();
-    register HSL * bitsHSL;
-    register int i;
-    HSL * hslImage = (HSL *)malloc(totalPixels * sizeof(HSL));
-
-    // -------------------------------------------
-    // create mask
-    // -------------------------------------------
-    // pre blur
-    if (qFuzzyIsNull(mPreblurRadius))
-        convertBGRToHSL(inputImage.bits(), (unsigned char *)hslImage, totalPixels);
-    else
+    const bool preblurred = !qFuzzyIsNull(mPreblurRadius);
+    cv::Mat mBlurred;
+
+    // pre blur (alpha takes no part in the mask, so only the color channels are blurred)
+    if (preblurred)
     {
         cv::Mat mInput(inputImage.height(), inputImage.width(), CV_8UC4, (void *)inputImage.bits());
-        cv::Mat mBlurred(inputImage.height(), inputImage.width(), CV_8UC4, (void *)outputImage.bits());
+        cv::cvtColor(mInput, mBlurred, cv::COLOR_BGRA2BGR);
         double sigma = (mPreblurRadius + .5) / 2.45;
-        cv::GaussianBlur(mInput, mBlurred, cv::Size(0, 0), sigma);
-        convertBGRToHSL(outputImage.bits(), (unsigned char *)hslImage, totalPixels);
+        gaussianBlur(mBlurred, mBlurred, sigma);
     }
-    // output mask and return
-    bitsHSL = hslImage;
-    if (mOutputMode == Mask)
+
+    // Mask, correction and mix are done a few rows at a time, so the HSL buffer stays in cache
+    const int width = outputImage.width();
+    const BGRA * inputBits = (const BGRA *)inputImage.bits();
+    BGRA * outputBits = (BGRA *)outputImage.bits();
+
+    parallelForRows(outputImage.height(), IBP_maximum(1, 16384 / width), [&](int startRow, int endRow)
     {
-        while (totalPixels--)
+        const int totalPixels = (endRow - startRow) * width;
+        HSL * hslChunk = (HSL *)malloc(totalPixels * sizeof(HSL));
+        register const BGRA * bits = inputBits + startRow * width;
+        register BGRA * bits2 = outputBits + startRow * width;
+        register HSL * bitsHSL = hslChunk;
+        register int i;
+
+        // -------------------------------------------
+        // create mask
+        // -------------------------------------------
+        if (preblurred)
         {
-            bits2->r = bits2->g = bits2->b =
-                    lut01[bits->a][
-                    lut01[mLutHue[bitsHSL->h]][
-                    lut01[mLutSaturation[bitsHSL->s]][
-                    mLutLightness[bitsHSL->l]]]];
-            bits2->a = 255;
-            bits++;
-            bits2++;
-            bitsHSL++;
+            // the output rows hold the blurred pixels until the mask is written
+            cv::Mat mChunk(endRow - startRow, width, CV_8UC4, (void *)bits2);
+            cv::cvtColor(mBlurred.rowRange(startRow, endRow), mChunk, cv::COLOR_BGR2BGRA);
+            convertBGRToHSL((const unsigned char *)bits2, (unsigned char *)hslChunk, totalPixels);
         }
-        free(hslImage);
-        return outputImage;
-    }
-    // make mask
-    for (i = 0; i < totalPixels; i++)
-    {
-        bits2->a = lut01[mLutHue[bitsHSL->h]][lut01[mLutSaturation[bitsHSL->s]][mLutLightness[bitsHSL->l]]];
-        bits2++;
-        bitsHSL++;
-    }
-
-    // -------------------------------------------
-    // correct image
-    // -------------------------------------------
-    register int h2, s2, l2;
-    bits2 = (BGRA *)outputImage.bits();
-    if (mRelLightness != 0)
-    {
-        l2 = mRelLightness * 255 / 100;
-
-        if (mRelLightness < 0)
+        else
+            convertBGRToHSL((const unsigned char *)bits, (unsigned char *)hslChunk, totalPixels);
+        // output mask and return
+        if (mOutputMode == Mask)
         {
-            l2 += 255;
             for (i = 0; i < totalPixels; i++)
             {
-                bits2->r = lut01[bits->r][l2];
-                bits2->g = lut01[bits->g][l2];
-                bits2->b = lut01[bits->b][l2];
-
+                bits2->r = bits2->g = bits2->b =
+                        IBP_multiply(bits->a,
+                        IBP_multiply(mLutHue[bitsHSL->h], mLutSaturationLightness[bitsHSL->s][bitsHSL->l]));
+                bits2->a = 255;
                 bits++;
                 bits2++;
+                bitsHSL++;
             }
+            free(hslChunk);
+            return;
+        }
+        // make mask
+        for (i = 0; i < totalPixels; i++)
+        {
+            bits2->a = IBP_multiply(mLutHue[bitsHSL->h], mLutSaturationLightness[bitsHSL->s][bitsHSL->l]);
+            bits2++;
+            bitsHSL++;
+        }
+
+        // -------------------------------------------
+        // correct image
+        // -------------------------------------------
+        register int h2, s2, l2;
+        bits2 = outputBits + startRow * width;
+        if (mRelLightness != 0)
+        {
+            l2 = mRelLightness * 255 / 100;
+
+            if (mRelLightness < 0)
+            {
+                l2 += 255;
+                for (i = 0; i < totalPixels; i++)
+                {
+                    bits2->r = IBP_multiply(bits->r, l2);
+                    bits2->g = IBP_multiply(bits->g, l2);
+                    bits2->b = IBP_multiply(bits->b, l2);
+
+                    bits++;
+                    bits2++;
+                }
+            }
+            else
+            {
+                for (i = 0; i < totalPixels; i++)
+                {
+                    bits2->r = bits->r + IBP_multiply(255 - bits->r, l2);
+                    bits2->g = bits->g + IBP_multiply(255 - bits->g, l2);
+                    bits2->b = bits->b + IBP_multiply(255 - bits->b, l2);
+
+                    bits++;
+                    bits2++;
+                }
+            }
+
         }
         else
         {
             for (i = 0; i < totalPixels; i++)
             {
-                bits2->r = bits->r + lut01[255 - bits->r][l2];
-                bits2->g = bits->g + lut01[255 - bits->g][l2];
-                bits2->b = bits->b + lut01[255 - bits->b][l2];
+                bits2->r = bits->r;
+                bits2->g = bits->g;
+                bits2->b = bits->b;
 
                 bits++;
                 bits2++;
             }
         }
 
-    }
-    else
-    {
-        for (i = 0; i < totalPixels; i++)
-        {
-            bits2->r = bits->r;
-            bits2->g = bits->g;
-            bits2->b = bits->b;
+        // the mask HSL values are still the ones of the corrected image unless it was blurred or relit
+        if (mRelLightness != 0 || preblurred)
+            convertBGRToHSL((const unsigned char *)(outputBits + startRow * width), (unsigned char *)hslChunk,
+                            totalPixels);
+        bitsHSL = hslChunk;
 
-            bits++;
-            bits2++;
+        if (!mColorize)
+        {
+            if (mRelHue != 0 || mRelSaturation != 0)
+            {
+                h2 = mRelHue * 127 / 180;
+                s2 = mRelSaturation * 255 / 100;
+                for (i = 0; i < totalPixels; i++)
+                {
+                    bitsHSL->h = (bitsHSL->h + h2 + 256) % 256;
+                    if (bitsHSL->s > 0)
+                        bitsHSL->s = s2 < 0 ?
+                                  IBP_multiply(bitsHSL->s, s2 + 255) :
+                                  s2 == 255 ? 255 : IBP_minimum(IBP_divide(bitsHSL->s, 255 - s2), 255);
+
+                    bitsHSL++;
+                }
+
+                convertHSLToBGR((unsigned char *)hslChunk, (unsigned char *)(outputBits + startRow * width),
+                                totalPixels);
+            }
         }
-    }
-
-    if (mRelLightness == 0)
-    {
-        if (!qFuzzyIsNull(mPreblurRadius))
-            convertBGRToHSL(outputImage.bits(), (unsigned char *)hslImage, totalPixels);
-    }
-    else
-        convertBGRToHSL(outputImage.bits(), (unsigned char *)hslImage, totalPixels);
-    bitsHSL = hslImage;
-
-    if (!mColorize)
-    {
-        if (mRelHue != 0 || mRelSaturation != 0)
+        else
         {
-            h2 = mRelHue * 127 / 180;
-            s2 = mRelSaturation * 255 / 100;
+            h2 = mAbsHue * 255 / 360;
+            s2 = mAbsSaturation * 255 / 100;
             for (i = 0; i < totalPixels; i++)
             {
-                bitsHSL->h = (bitsHSL->h + h2 + 256) % 256;
-                if (bitsHSL->s > 0)
-                    bitsHSL->s = s2 < 0 ?
-                              lut01[bitsHSL->s][s2 + 255] :
-                              s2 == 255 ? 255 : IBP_minimum(lut02[bitsHSL->s][255 - s2], 255);
+                bitsHSL->h = h2;
+                bitsHSL->s = s2;
 
                 bitsHSL++;
             }
 
-            convertHSLToBGR((unsigned char *)hslImage, (unsigned char *)outputImage.bits(), totalPixels);
+            convertHSLToBGR((unsigned char *)hslChunk, (unsigned char *)(outputBits + startRow * width),
+                            totalPixels);
         }
-    }
-    else
-    {
-        h2 = mAbsHue * 255 / 360;
-        s2 = mAbsSaturation * 255 / 100;
+
+        free(hslChunk);
+
+        // -------------------------------------------
+        // mix images
+        // -------------------------------------------
+        bits = inputBits + startRow * width;
+        bits2 = outputBits + startRow * width;
         for (i = 0; i < totalPixels; i++)
         {
-            bitsHSL->h = h2;
-            bitsHSL->s = s2;
-
-            bitsHSL++;
+            blendSourceAtopDestination(*bits2, *bits, *bits2);
+            bits++;
+            bits2++;
         }
-
-        convertHSLToBGR((unsigned char *)hslImage, (unsigned char *)outputImage.bits(), totalPixels);
-    }
-
-    free(hslImage);
-
-    // -------------------------------------------
-    // mix images
-    // -------------------------------------------
-    bits = (BGRA *)inputImage.bits();
-    bits2 = (BGRA *)outputImage.bits();
-    for (i = 0; i < totalPixels; i++)
-    {
-        blendSourceAtopDestination(*bits2, *bits, *bits2);
-        bits++;
-        bits2++;
-    }
+    });
 
     return outputImage;
 }
@@ -756,7 +772,7 @@ void Filter::setPreblurRadius(double pbr)
     emit parametersChanged();
 }
 
-void Filter::makeLUT(ColorChannel c)
+void Filter::makeLUT(ColorChannel c, bool updateSaturationLightness)
 {
     unsigned char * lut = c == ColorChannel_Hue ? mLutHue :
                           c == ColorChannel_Saturation ? mLutSaturation : mLutLightness;
@@ -766,12 +782,12 @@ void Filter::makeLUT(ColorChannel c)
     bool inverted = c == ColorChannel_Hue ? mIsInvertedHue :
                     c == ColorChannel_Saturation ? mIsInvertedSaturation : mIsInvertedLightness;
 
-    if (inverted)
-        for (int i = 0; i < 256; i++)
-            lut[i] = 255 - IBP_clamp(0, round(splineInterpolator->f(i / 255.) * 255.), 255);
-    else
-        for (int i = 0; i < 256; i++)
-            lut[i] = IBP_clamp(0, round(splineInterpolator->f(i / 255.) * 255.), 255);
+    bakeInterpolator1DLUT(splineInterpolator, lut, 256, inverted);
+
+    if (c != ColorChannel_Hue && updateSaturationLightness)
+        for (int s = 0; s < 256; s++)
+            for (int l = 0; l < 256; l++)
+                mLutSaturationLightness[s][l] = IBP_multiply(mLutSaturation[s], mLutLightness[l]);
 }
 
 void Filter::setRelHue(int v)
@@ -75,8 +75,12 @@ private:
     bool mColorize;
     int mRelHue, mRelSaturation, mRelLightness, mAbsHue, mAbsSaturation;
     unsigned char mLutHue[256], mLutSaturation[256], mLutLightness[256];
+    // mLutSaturation[s] * mLutLightness[l] / 255, so the mask costs two lookups per pixel
+    unsigned char mLutSaturationLightness[256][256];
 
-    void makeLUT(ColorChannel c);
+    // the saturation and lightness LUTs also update mLutSaturationLightness, unless told not to because the other
+    // one is not baked yet
+    void makeLUT(ColorChannel c, bool updateSaturationLightness = true);
 
 signals:
     void hueKnotsChanged(const Interpolator1DKnots & k);
@@ -30,6 +30,8 @@
 #include "filterwidget.h"
 #include <imgproc/types.h>
 #include <imgproc/lut.h>
+#include <imgproc/util.h>
+#include <imgproc/blurring.h>
 #include <imgproc/colorconversion.h>
 #include "../misc/nearestneighborsplineinterpolator1D.h"
 #include "../misc/linearsplineinterpolator1D.h"
@@ -62,7 +64,7 @@ Filter::Filter() :
     mSplineInterpolatorSaturation = new CubicSplineInterpolator1D();
     mSplineInterpolatorSaturation->addKnot(0., 0.);
     mSplineInterpolatorSaturation->addKnot(1., 1.);
-    makeLUT(ColorChannel_Saturation);
+    makeLUT(ColorChannel_Saturation, false);
     mSplineInterpolatorLightness = new CubicSplineInterpolator1D();
     mSplineInterpolatorLightness->addKnot(0., 0.);
     mSplineInterpolatorLightness->addKnot(.5, 1.);
@@ -96,7 +98,7 @@ ImageFilter * Filter::clone()
     f->mSplineInterpolatorSaturation = mSplineInterpolatorSaturation->clone();
     f->mInterpolationModeSaturation = mInterpolationModeSaturation;
     f->mIsInvertedSaturation = mIsInvertedSaturation;
-    f->makeLUT(ColorChannel_Saturation);
+    f->makeLUT(ColorChannel_Saturation, false);
 
     if (f->mSplineInterpolatorLightness)
         delete f->mSplineInterpolatorLightness;
@@ -123,51 +125,67 @@ QImage Filter::process(const QImage & inputImage)
         return inputImage;
 
     QImage i = QImage(inputImage.width(), inputImage.height(), QImage::Format_ARGB32);
-    register int totalPixels = i.width() * i.height();
-    HSL * hslImage = (HSL *)malloc(totalPixels * sizeof(HSL));
-    register BGRA * bits = (BGRA*)inputImage.bits();
-    register BGRA * bits2 = (BGRA*)i.bits();
-    register HSL * bitsHSL = hslImage;
-
-    if (qFuzzyIsNull(mPreblurRadius))
-        convertBGRToHSL(inputImage.bits(), (unsigned char *)hslImage, totalPixels);
-    else
+    const bool preblurred = !qFuzzyIsNull(mPreblurRadius);
+    cv::Mat mBlurred;
+
+    // Alpha takes no part in the key, so only the color channels are blurred
+    if (preblurred)
     {
-        QImage iBlurred = QImage(inputImage.width(), inputImage.height(), QImage::Format_ARGB32);
         cv::Mat mInput(inputImage.height(), inputImage.width(), CV_8UC4, (void *)inputImage.bits());
-        cv::Mat mBlurred(iBlurred.height(), iBlurred.width(), CV_8UC4, iBlurred.bits());
+        cv::cvtColor(mInput, mBlurred, cv::COLOR_BGRA2BGR);
         double sigma = (mPreblurRadius + .5) / 2.45;
-        cv::GaussianBlur(mInput, mBlurred, cv::Size(0, 0), sigma);
-        convertBGRToHSL(iBlurred.bits(), (unsigned char *)hslImage, totalPixels);
+        gaussianBlur(mBlurred, mBlurred, sigma);
     }
 
-    if (mOutputMode == KeyedImage)
-        while (totalPixels--)
-        {
-            bits2->r = bits->r;
-            bits2->g = bits->g;
-            bits2->b = bits->b;
-            bits2->a = lut01[bits->a][255 -
-                       lut01[mLutHue[bitsHSL->h]][lut01[mLutSaturation[bitsHSL->s]][mLutLightness[bitsHSL->l]]]];;
-            bits++;
-            bits2++;
-            bitsHSL++;
-        }
-    else
-        while (totalPixels--)
+    // Convert a few rows at a time to HSL and key them while they are still in cache
+    const int width = i.width();
+    const BGRA * inputBits = (const BGRA *)inputImage.bits();
+    BGRA * outputBits = (BGRA *)i.bits();
+
+    parallelForRows(i.height(), IBP_maximum(1, 16384 / width), [&](int startRow, int endRow)
+    {
+        register int totalPixels = (endRow - startRow) * width;
+        HSL * hslChunk = (HSL *)malloc(totalPixels * sizeof(HSL));
+        register const BGRA * bits = inputBits + startRow * width;
+        register BGRA * bits2 = outputBits + startRow * width;
+        register HSL * bitsHSL = hslChunk;
+
+        if (preblurred)
         {
-            bits2->r = bits2->g = bits2->b =
-                    lut01[bits->a][255 -
-                    lut01[mLutHue[bitsHSL->h]][
-                    lut01[mLutSaturation[bitsHSL->s]][
-                    mLutLightness[bitsHSL->l]]]];
-            bits2->a = 255;
-            bits++;
-            bits2++;
-            bitsHSL++;
+            // the output rows hold the blurred pixels until they are keyed
+            cv::Mat mChunk(endRow - startRow, width, CV_8UC4, (void *)bits2);
+            cv::cvtColor(mBlurred.rowRange(startRow, endRow), mChunk, cv::COLOR_BGR2BGRA);
+            convertBGRToHSL((const unsigned char *)bits2, (unsigned char *)hslChunk, totalPixels);
         }
-
-    free(hslImage);
+        else
+            convertBGRToHSL((const unsigned char *)bits, (unsigned char *)hslChunk, totalPixels);
+
+        if (mOutputMode == KeyedImage)
+            while (totalPixels--)
+            {
+                bits2->r = bits->r;
+                bits2->g = bits->g;
+                bits2->b = bits->b;
+                bits2->a = IBP_multiply(bits->a, 255 -
+                           IBP_multiply(mLutHue[bitsHSL->h], mLutSaturationLightness[bitsHSL->s][bitsHSL->l]));
+                bits++;
+                bits2++;
+                bitsHSL++;
+            }
+        else
+            while (totalPixels--)
+            {
+                bits2->r = bits2->g = bits2->b =
+                        IBP_multiply(bits->a, 255 -
+                        IBP_multiply(mLutHue[bitsHSL->h], mLutSaturationLightness[bitsHSL->s][bitsHSL->l]));
+                bits2->a = 255;
+                bits++;
+                bits2++;
+                bitsHSL++;
+            }
+
+        free(hslChunk);
+    });
 
     return i;
 }
@@ -584,7 +602,7 @@ void Filter::setPreblurRadius(double pbr)
     emit parametersChanged();
 }
 
-void Filter::makeLUT(ColorChannel c)
+void Filter::makeLUT(ColorChannel c, bool updateSaturationLightness)
 {
     unsigned char * lut = c == ColorChannel_Hue ? mLutHue :
                           c == ColorChannel_Saturation ? mLutSaturation : mLutLightness;
@@ -594,10 +612,10 @@ void Filter::makeLUT(ColorChannel c)
     bool inverted = c == ColorChannel_Hue ? mIsInvertedHue :
                     c == ColorChannel_Saturation ? mIsInvertedSaturation : mIsInvertedLightness;
 
-    if (inverted)
-        for (int i = 0; i < 256; i++)
-            lut[i] = 255 - IBP_clamp(0, round(splineInterpolator->f(i / 255.) * 255.), 255);
-    else
-        for (int i = 0; i < 256; i++)
-            lut[i] = IBP_clamp(0, round(splineInterpolator->f(i / 255.) * 255.), 255);
+    bakeInterpolator1DLUT(splineInterpolator, lut, 256, inverted);
+
+    if (c != ColorChannel_Hue && updateSaturationLightness)
+        for (int s = 0; s < 256; s++)
+            for (int l = 0; l < 256; l++)
+                mLutSaturationLightness[s][l] = IBP_multiply(mLutSaturation[s], mLutLightness[l]);
 }
@@ -48,6 +48,11 @@ QImage Filter::process(const QImage &inputImage)
     return inputImage;
 }
 
+ImageFilter::AlphaHandling Filter::alphaHandling()
+{
+    return AlphaHandling_Agnostic;
+}
+
 bool Filter::loadParameters(QSettings &s)
 {
     Q_UNUSED(s)
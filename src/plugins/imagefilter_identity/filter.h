@@ -49,6 +49,7 @@ public:
     bool loadParameters(QSettings & s);
     bool saveParameters(QSettings & s);
     QWidget * widget(QWidget *parent = 0);
+    AlphaHandling alphaHandling();
 };
 
 #endif // FILTER_H
@@ -25,20 +25,21 @@
 #include <opencv2/imgproc.hpp>
 #include <opencv2/ximgproc.hpp>
 #include <opencv2/photo.hpp>
+#include <QElapsedTimer>
 
 #include "filter.h"
 #include "filterwidget.h"
 #include <imgproc/lut.h>
 #include <imgproc/types.h>
 #include <imgproc/colorconversion.h>
+#include <imgproc/resampling.h>
 #include <imgproc/thresholding.h>
 #include <misc/util.h>
 
-#define MAX_IMAGE_SIZE 512
-
 Filter::Filter() :
     mNoiseReduction(.0),
     mMaskExpansion(0),
+    mInpaintingSize(512),
     mOutputMode(CorrectedImageMode1)
 {
 }
@@ -52,6 +53,7 @@ ImageFilter *Filter::clone()
     Filter * f = new Filter();
     f->mNoiseReduction = mNoiseReduction;
     f->mMaskExpansion = mMaskExpansion;
+    f->mInpaintingSize = mInpaintingSize;
     f->mOutputMode = mOutputMode;
     return f;
 }
@@ -74,6 +76,11 @@ QImage Filter::process(const QImage &inputImage)
     cv::Mat mlmask(h, w, CV_8UC1);
     cv::Mat mliihc(h, w, CV_8UC1);
     register unsigned char * mlchannelsl, * mlmasksl, * mliihcsl;
+    const int inpaintingSize = mInpaintingSize;
+    QElapsedTimer timer;
+
+    clearStageTimings();
+    timer.start();
 
     convertBGRToHSL(inputImage.bits(), (unsigned char *)bitsHSL, w * h);
 
@@ -86,6 +93,8 @@ QImage Filter::process(const QImage &inputImage)
         for (x = 0; x < w; x++, bitsHSLsl++, mlchannelsl++, mlmasksl++)
             *mlchannelsl = *mlmasksl = bitsHSLsl->l;
     }
+    addStageTiming("lightness", timer.nsecsElapsed() / 1e6);
+    timer.restart();
 
     // Get original size mask
     // blur
@@ -112,6 +121,7 @@ QImage Filter::process(const QImage &inputImage)
 
     if (mOutputMode == Mask)
     {
+        addStageTiming("mask", timer.nsecsElapsed() / 1e6);
         free(bitsHSL);
         i = QImage(inputImage.width(), inputImage.height(), QImage::Format_ARGB32);
         register BGRA * bits = (BGRA *)i.bits();
@@ -142,36 +152,43 @@ QImage Filter::process(const QImage &inputImage)
                 maskPixelsCount++;
         }
     }
+    addStageTiming("mask", timer.nsecsElapsed() / 1e6);
+    timer.restart();
     if (maskPixelsCount * 100 / totalPixels >= 80)
     {
         free(bitsHSL);
         return inputImage;
     }
 
-    // Resize
-    if (w > MAX_IMAGE_SIZE || h > MAX_IMAGE_SIZE)
+    // Inpaint the illumination at most inpaintingSize pixels per side, where the time of cv::inpaint does not
+    // grow with the masked area of large images
+    if (w > inpaintingSize || h > inpaintingSize)
     {
         int sw, sh;
         if (w > h)
         {
-            sw = MAX_IMAGE_SIZE;
-            sh = h * MAX_IMAGE_SIZE / w;
+            sw = inpaintingSize;
+            sh = h * inpaintingSize / w;
         }
         else
         {
-            sh = MAX_IMAGE_SIZE;
-            sw = w * MAX_IMAGE_SIZE / h;
+            sh = inpaintingSize;
+            sw = w * inpaintingSize / h;
         }
         sw = sw < 1 ? 1 : sw;
         sh = sh < 1 ? 1 : sh;
 
-        cv::Mat mresized(sh, sw, CV_8UC1);
-        cv::Mat mresized2(sh, sw, CV_8UC1);
-        cv::Mat mmaskresized(sh, sw, CV_8UC1);
-        cv::resize(mlchannel, mresized, cv::Size(sw, sh));
-        cv::resize(mlmask, mmaskresized, cv::Size(sw, sh), 0, 0, cv::INTER_NEAREST);
+        // Average only the lightness outside the mask, so the masked foreground does not bleed into the
+        // background around it, and inpaint the pixels that are mostly masked
+        cv::Mat mresized, mmaskresized, mresized2;
+        maskedAreaResize(mlchannel, mlmask, mresized, mmaskresized, cv::Size(sw, sh));
         cv::inpaint(mresized, mmaskresized, mresized2, 1, cv::INPAINT_TELEA);
-        cv::resize(mresized2, mliihc, cv::Size(w, h));
+
+        // Only the masked pixels take the estimate, the others keep their own lightness, the full resolution
+        // detail. It is upsampled guided by the unmasked lightness at both sizes: the masked pixels, foreground in
+        // the lightness and inpainted at the small size, are left out of the range weights, which would pull the
+        // estimate towards values as dark as the foreground, so they take the spatial gaussian of the estimate
+        jointBilateralUpsample(mresized2, mresized, mlchannel, mliihc, mmaskresized, mlmask);
 
         // Combine iihc model with original lightness image
         for (y = 0; y < h; y++)
@@ -188,6 +205,8 @@ QImage Filter::process(const QImage &inputImage)
     {
         cv::inpaint(mlchannel, mlmask, mliihc, 1, cv::INPAINT_NS);
     }
+    addStageTiming("inpainting", timer.nsecsElapsed() / 1e6);
+    timer.restart();
 
     if (mOutputMode == CorrectedImageMode1)
     {
@@ -246,6 +265,7 @@ QImage Filter::process(const QImage &inputImage)
     i = inputImage.copy();
     convertHSLToBGR((const unsigned char *)bitsHSL, i.bits(), w * h);
     free(bitsHSL);
+    addStageTiming("correction", timer.nsecsElapsed() / 1e6);
 
     return i;
 }
@@ -254,6 +274,7 @@ bool Filter::loadParameters(QSettings &s)
 {
     double noiseReduction;
     int maskExpansion;
+    int inpaintingSize;
     QString outputModeStr;
     OutputMode outputMode;
     bool ok;
@@ -266,6 +287,10 @@ bool Filter::loadParameters(QSettings &s)
     if (!ok || maskExpansion > 100)
         return false;
 
+    inpaintingSize = s.value("inpaintingsize", 512).toInt(&ok);
+    if (!ok || inpaintingSize < 64 || inpaintingSize > 2048)
+        return false;
+
     outputModeStr = s.value("outputmode", "correctedimage").toString();
     if (outputModeStr == "correctedimagemode1")
         outputMode = CorrectedImageMode1;
@@ -280,6 +305,7 @@ bool Filter::loadParameters(QSettings &s)
 
     setNoiseReduction(noiseReduction);
     setMaskExpansion(maskExpansion);
+    setInpaintingSize(inpaintingSize);
     setOutputMode(outputMode);
 
     return true;
@@ -289,6 +315,7 @@ bool Filter::saveParameters(QSettings &s)
 {
     s.setValue("noisereduction", mNoiseReduction);
     s.setValue("maskexpansion", mMaskExpansion);
+    s.setValue("inpaintingsize", mInpaintingSize);
     s.setValue("outputmode", mOutputMode == CorrectedImageMode1 ? "correctedimagemode1" :
                              mOutputMode == CorrectedImageMode2 ? "correctedimagemode2" :
                              mOutputMode == Mask ? "mask" : "iihcorrectionmodel");
@@ -300,12 +327,15 @@ QWidget *Filter::widget(QWidget *parent)
     FilterWidget * fw = new FilterWidget(parent);
     fw->setNoiseReduction(mNoiseReduction);
     fw->setMaskExpansion(mMaskExpansion);
+    fw->setInpaintingSize(mInpaintingSize);
     fw->setOutputMode(mOutputMode);
     connect(this, SIGNAL(noiseReductionChanged(double)), fw, SLOT(setNoiseReduction(double)));
     connect(this, SIGNAL(maskExpansionChanged(int)), fw, SLOT(setMaskExpansion(int)));
+    connect(this, SIGNAL(inpaintingSizeChanged(int)), fw, SLOT(setInpaintingSize(int)));
     connect(this, SIGNAL(outputModeChanged(Filter::OutputMode)), fw, SLOT(setOutputMode(Filter::OutputMode)));
     connect(fw, SIGNAL(noiseReductionChanged(double)), this, SLOT(setNoiseReduction(double)));
     connect(fw, SIGNAL(maskExpansionChanged(int)), this, SLOT(setMaskExpansion(int)));
+    connect(fw, SIGNAL(inpaintingSizeChanged(int)), this, SLOT(setInpaintingSize(int)));
     connect(fw, SIGNAL(outputModeChanged(Filter::OutputMode)), this, SLOT(setOutputMode(Filter::OutputMode)));
     return fw;
 }
@@ -328,6 +358,15 @@ void Filter::setMaskExpansion(int v)
     emit parametersChanged();
 }
 
+void Filter::setInpaintingSize(int v)
+{
+    if (v == mInpaintingSize)
+        return;
+    mInpaintingSize = v;
+    emit inpaintingSizeChanged(v);
+    emit parametersChanged();
+}
+
 void Filter::setOutputMode(Filter::OutputMode v)
 {
     if (v == mOutputMode)
@@ -61,16 +61,19 @@ public:
 private:
     double mNoiseReduction;
     int mMaskExpansion;
+    int mInpaintingSize;
     OutputMode mOutputMode;
 
 signals:
     void noiseReductionChanged(double v);
     void maskExpansionChanged(int v);
+    void inpaintingSizeChanged(int v);
     void outputModeChanged(Filter::OutputMode v);
 
 public slots:
     void setNoiseReduction(double v);
     void setMaskExpansion(int v);
+    void setInpaintingSize(int v);
     void setOutputMode(Filter::OutputMode v);
 
 };
@@ -60,6 +60,16 @@ void FilterWidget::setMaskExpansion(int v)
     emit maskExpansionChanged(v);
 }
 
+void FilterWidget::setInpaintingSize(int v)
+{
+    if (ui->mSpinInpaintingSize->value() == v)
+        return;
+    mEmitSignals = false;
+    ui->mSpinInpaintingSize->setValue(v);
+    mEmitSignals = true;
+    emit inpaintingSizeChanged(v);
+}
+
 void FilterWidget::setOutputMode(Filter::OutputMode om)
 {
     if ((om == Filter::CorrectedImageMode1 && ui->mButtonOutputModeCorrectedImageMode1->isChecked()) ||
@@ -108,6 +118,20 @@ void FilterWidget::on_mSpinMaskExpansion_valueChanged(int v)
         emit maskExpansionChanged(v);
 }
 
+void FilterWidget::on_mSliderInpaintingSize_valueChanged(int v)
+{
+    ui->mSpinInpaintingSize->setValue(v);
+    if (mEmitSignals)
+        emit inpaintingSizeChanged(v);
+}
+
+void FilterWidget::on_mSpinInpaintingSize_valueChanged(int v)
+{
+    ui->mSliderInpaintingSize->setValue(v);
+    if (mEmitSignals)
+        emit inpaintingSizeChanged(v);
+}
+
 void FilterWidget::on_mButtonOutputModeCorrectedImageMode1_toggled(bool v)
 {
     if (!v)
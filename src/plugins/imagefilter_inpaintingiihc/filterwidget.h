@@ -48,11 +48,13 @@ private:
 signals:
     void noiseReductionChanged(double v);
     void maskExpansionChanged(int v);
+    void inpaintingSizeChanged(int v);
     void outputModeChanged(Filter::OutputMode v);
 
 public slots:
     void setNoiseReduction(double v);
     void setMaskExpansion(int v);
+    void setInpaintingSize(int v);
     void setOutputMode(Filter::OutputMode v);
 
 private slots:
@@ -60,6 +62,8 @@ private slots:
     void on_mSpinNoiseReduction_valueChanged(double v);
     void on_mSliderMaskExpansion_valueChanged(int v);
     void on_mSpinMaskExpansion_valueChanged(int v);
+    void on_mSliderInpaintingSize_valueChanged(int v);
+    void on_mSpinInpaintingSize_valueChanged(int v);
     void on_mButtonOutputModeCorrectedImageMode1_toggled(bool v);
     void on_mButtonOutputModeCorrectedImageMode2_toggled(bool v);
     void on_mButtonOutputModeMask_toggled(bool v);
@@ -22,6 +22,8 @@
 // SOFTWARE.
 //
 
+#include <QMutex>
+#include <QMutexLocker>
 #include <opencv2/imgproc.hpp>
 #include <itkImage.h>
 #include <itkImportImageFilter.h>
@@ -34,13 +36,63 @@
 #include <imgproc/lut.h>
 #include <imgproc/types.h>
 #include <imgproc/colorconversion.h>
+#include <imgproc/biasfieldcache.h>
+#include <imgproc/util.h>
 #include <misc/util.h>
 
 #define MAX_IMAGE_SIZE 128
+// iterations of the single fitting level, which stops earlier when it converges
+#define MAX_ITERATIONS 50
+
+typedef itk::Image<float, 2> ImageType;
+typedef ImageType::Pointer ImagePointer;
+typedef itk::Image<unsigned char, 2> MaskImageType;
+typedef itk::N4BiasFieldCorrectionImageFilter<ImageType, MaskImageType, ImageType> CorrecterType;
+typedef CorrecterType::BiasFieldControlPointLatticeType LatticeType;
+typedef itk::BSplineControlPointImageFilter <LatticeType, CorrecterType::ScalarImageType> BSplinerType;
+
+// The lattice, and the grid size and resized image size it was fitted for
+struct Filter::WarmStart
+{
+    QMutex mutex;
+    LatticeType::Pointer lattice;
+    QString key;
+};
+
+template <class T>
+static void setNumberOfThreads(T * filter, int threads)
+{
+#if ITK_VERSION_MAJOR >= 5
+    filter->GetMultiThreader()->SetMaximumNumberOfThreads(threads);
+    filter->SetNumberOfWorkUnits(threads);
+#else
+    filter->SetNumberOfThreads(threads);
+#endif
+}
+
+static BSplinerType::Pointer makeBSpliner(LatticeType * lattice, int splineOrder, ImageType * image, int threads)
+{
+    BSplinerType::Pointer bspliner = BSplinerType::New();
+    setNumberOfThreads(bspliner.GetPointer(), threads);
+    bspliner->SetInput(lattice);
+    bspliner->SetSplineOrder(splineOrder);
+    bspliner->SetSize(image->GetLargestPossibleRegion().GetSize());
+    bspliner->SetOrigin(image->GetOrigin());
+    bspliner->SetDirection(image->GetDirection());
+    bspliner->SetSpacing(image->GetSpacing());
+    bspliner->Update();
+    return bspliner;
+}
 
 Filter::Filter() :
     mGridSize(3),
-    mOutputMode(CorrectedImageMode1)
+    mOutputMode(CorrectedImageMode1),
+    mFieldReuseFrames(0),
+    mThreads(0),
+    mConvergenceThreshold(0.001),
+    mWarmStart(false),
+    mBiasFieldCache(new BiasFieldCache),
+    mWarmStartState(new WarmStart)
 {
 }
 
@@ -53,6 +105,12 @@ ImageFilter *Filter::clone()
     Filter * f = new Filter();
     f->mGridSize = mGridSize;
     f->mOutputMode = mOutputMode;
+    f->mFieldReuseFrames = mFieldReuseFrames;
+    f->mBiasFieldCache = mBiasFieldCache;
+    f->mThreads = mThreads;
+    f->mConvergenceThreshold = mConvergenceThreshold;
+    f->mWarmStart = mWarmStart;
+    f->mWarmStartState = mWarmStartState;
     return f;
 }
 
@@ -75,194 +133,243 @@ QImage Filter::process(const QImage &inputImage)
     // Convert to HSL
     convertBGRToHSL(inputImage.bits(), (unsigned char *)bitsHSL, w * h);
 
-    // Separate L channel
-    for (y = 0; y < h; y++)
+    // Estimate the illumination field, unless the batch already shares one for images of this size
+    if (mFieldReuseFrames > 0 && mBiasFieldCache->find(cv::Size(w, h), mlchannel))
+        mean = (int)cv::mean(mlchannel)[0];
+    else
     {
-        bitsHSLsl = bitsHSL + y * w;
-        mbits8 = mlchannel.ptr(y);
-        for (x = 0; x < w; x++)
+        // Separate L channel
+        for (y = 0; y < h; y++)
         {
-            *mbits8 = bitsHSLsl->l;
-            bitsHSLsl++;
-            mbits8++;
+            bitsHSLsl = bitsHSL + y * w;
+            mbits8 = mlchannel.ptr(y);
+            for (x = 0; x < w; x++)
+            {
+                *mbits8 = bitsHSLsl->l;
+                bitsHSLsl++;
+                mbits8++;
+            }
         }
-    }
 
-    // Resample
-    cv::Mat mInitial;
-    if (w != MAX_IMAGE_SIZE || h != MAX_IMAGE_SIZE)
-    {
-        if (w > h)
+        // Resample
+        cv::Mat mInitial;
+        if (w != MAX_IMAGE_SIZE || h != MAX_IMAGE_SIZE)
         {
-            sw = MAX_IMAGE_SIZE;
-            sh = h * MAX_IMAGE_SIZE / w;
+            if (w > h)
+            {
+                sw = MAX_IMAGE_SIZE;
+                sh = h * MAX_IMAGE_SIZE / w;
+            }
+            else
+            {
+                sh = MAX_IMAGE_SIZE;
+                sw = w * MAX_IMAGE_SIZE / h;
+            }
+            sw = sw < 1 ? 1 : sw;
+            sh = sh < 1 ? 1 : sh;
+
+            cv::Mat mresized(sh, sw, CV_8UC1);
+            cv::resize(mlchannel, mresized, cv::Size(sw, sh), 0, 0, cv::INTER_CUBIC);
+            mInitial = mresized;
         }
         else
         {
-            sh = MAX_IMAGE_SIZE;
-            sw = w * MAX_IMAGE_SIZE / h;
+            sw = w;
+            sh = h;
+            mInitial = mlchannel;
         }
-        sw = sw < 1 ? 1 : sw;
-        sh = sh < 1 ? 1 : sh;
 
-        cv::Mat mresized(sh, sw, CV_8UC1);
-        cv::resize(mlchannel, mresized, cv::Size(sw, sh), 0, 0, cv::INTER_CUBIC);
-        mInitial = mresized;
-    }
-    else
-    {
-        sw = w;
-        sh = h;
-        mInitial = mlchannel;
-    }
+        // -----------------------
+        // ITK N4 Bias Correction
+        // -----------------------
+
+        const int threads = mThreads == 0 ? threadBudget() : IBP_minimum(mThreads, threadBudget());
+        const int splineOrder = IBP_minimum(mGridSize, 3);
+
+        // initial image
+        ImageType::SizeType initialImageSize;
+        initialImageSize[0] = mInitial.cols;
+        initialImageSize[1] = mInitial.rows;
+        ImageType::IndexType initialImageStart;
+        initialImageStart.Fill(0);
+        ImageType::RegionType initialImageRegion;
+        initialImageRegion.SetIndex(initialImageStart);
+        initialImageRegion.SetSize(initialImageSize);
+
+        ImagePointer initialImage = ImageType::New();
+        initialImage->SetRegions(initialImageRegion);
+        initialImage->Allocate();
+
+        float * initialImagePtr = initialImage->GetBufferPointer();
+        for (y = 0; y < sh; y++)
+        {
+            mbits8 = mInitial.ptr(y);
+            for (x = 0; x < sw; x++)
+            {
+                *initialImagePtr = ((*mbits8) + 1) / 255.;
+                mbits8++;
+                initialImagePtr++;
+            }
+        }
 
-    // -----------------------
-    // ITK N4 Bias Correction
-    // -----------------------
-
-    // typedef declaration
-    typedef itk::Image<float, 2> ImageType;
-    typedef ImageType::Pointer ImagePointer;
-    typedef itk::Image<unsigned char, 2> MaskImageType;
-    typedef itk::N4BiasFieldCorrectionImageFilter<ImageType, MaskImageType, ImageType> CorrecterType;
-    typedef itk::BSplineControlPointImageFilter <CorrecterType::BiasFieldControlPointLatticeType,
-                                                 CorrecterType::ScalarImageType> BSplinerType;
-
-    // initial image
-    ImageType::SizeType initialImageSize;
-    initialImageSize[0] = mInitial.cols;
-    initialImageSize[1] = mInitial.rows;
-    ImageType::IndexType initialImageStart;
-    initialImageStart.Fill(0);
-    ImageType::RegionType initialImageRegion;
-    initialImageRegion.SetIndex(initialImageStart);
-    initialImageRegion.SetSize(initialImageSize);
-
-    ImagePointer initialImage = ImageType::New();
-    initialImage->SetRegions(initialImageRegion);
-    initialImage->Allocate();
-
-    float * initialImagePtr = initialImage->GetBufferPointer();
-    for (y = 0; y < sh; y++)
-    {
-        mbits8 = mInitial.ptr(y);
-        for (x = 0; x < sw; x++)
+        // warm start: the field of the previous image of the same size is divided out first, so N4 only has to
+        // fit what changed and converges in a few iterations
+        LatticeType::Pointer previousLattice;
+        const QString latticeKey = QString("%1 %2x%3").arg(mGridSize).arg(sw).arg(sh);
+        const QSharedPointer<WarmStart> warmStartState = mWarmStartState;
+        if (mWarmStart)
         {
-            *initialImagePtr = ((*mbits8) + 1) / 255.;
-            mbits8++;
-            initialImagePtr++;
+            QMutexLocker locker(&warmStartState->mutex);
+            if (warmStartState->lattice && warmStartState->key == latticeKey)
+                previousLattice = warmStartState->lattice;
+        }
+        if (previousLattice)
+        {
+            BSplinerType::Pointer previousBSpliner = makeBSpliner(previousLattice, splineOrder, initialImage,
+                                                                  threads);
+            itk::ImageRegionIterator<CorrecterType::ScalarImageType> ItP(
+                previousBSpliner->GetOutput(), previousBSpliner->GetOutput()->GetLargestPossibleRegion());
+            itk::ImageRegionIterator<ImageType> ItI(initialImage, initialImage->GetLargestPossibleRegion());
+            for (ItP.GoToBegin(), ItI.GoToBegin(); !ItP.IsAtEnd(); ++ItP, ++ItI)
+                ItI.Set(ItI.Get() / exp(ItP.Get()[0]));
         }
-    }
 
-    // correcter
-    CorrecterType::Pointer correcter = CorrecterType::New();
-    CorrecterType::ArrayType numberOfControlPoints;
-    numberOfControlPoints.Fill(mGridSize + 1);
-    correcter->SetNumberOfControlPoints(numberOfControlPoints);
-    correcter->SetSplineOrder(IBP_minimum(mGridSize, 3));
-    correcter->SetInput(initialImage);
+        // correcter
+        CorrecterType::Pointer correcter = CorrecterType::New();
+        setNumberOfThreads(correcter.GetPointer(), threads);
+        CorrecterType::ArrayType numberOfControlPoints;
+        numberOfControlPoints.Fill(mGridSize + 1);
+        correcter->SetNumberOfControlPoints(numberOfControlPoints);
+        correcter->SetSplineOrder(splineOrder);
+        CorrecterType::VariableSizeArrayType maximumNumberOfIterations(1);
+        maximumNumberOfIterations.Fill(MAX_ITERATIONS);
+        correcter->SetNumberOfFittingLevels(1);
+        correcter->SetMaximumNumberOfIterations(maximumNumberOfIterations);
+        correcter->SetConvergenceThreshold(mConvergenceThreshold);
+        correcter->SetInput(initialImage);
+
+        try
+        {
+            correcter->Update();
+        }
+        catch (itk::ExceptionObject &excep)
+        {
+            Q_UNUSED(excep)
+            return inputImage;
+        }
 
-    try
-    {
-        correcter->Update();
-    }
-    catch (itk::ExceptionObject &excep)
-    {
-        Q_UNUSED(excep)
-        return inputImage;
-    }
+        // the log fields add up, and so do the control points of lattices over the same image domain
+        const LatticeType * fittedLattice = correcter->GetLogBiasFieldControlPointLattice();
+        LatticeType::Pointer lattice = LatticeType::New();
+        lattice->CopyInformation(fittedLattice);
+        lattice->SetRegions(fittedLattice->GetLargestPossibleRegion());
+        lattice->Allocate();
+        itk::ImageRegionConstIterator<LatticeType> ItL(fittedLattice, fittedLattice->GetLargestPossibleRegion());
+        itk::ImageRegionIterator<LatticeType> ItS(lattice, lattice->GetLargestPossibleRegion());
+        for (ItL.GoToBegin(), ItS.GoToBegin(); !ItL.IsAtEnd(); ++ItL, ++ItS)
+            ItS.Set(ItL.Get());
+        if (previousLattice)
+        {
+            itk::ImageRegionConstIterator<LatticeType> ItP(previousLattice,
+                                                           previousLattice->GetLargestPossibleRegion());
+            for (ItP.GoToBegin(), ItS.GoToBegin(); !ItP.IsAtEnd(); ++ItP, ++ItS)
+                ItS.Set(ItS.Get() + ItP.Get());
+        }
+        if (mWarmStart)
+        {
+            QMutexLocker locker(&warmStartState->mutex);
+            warmStartState->lattice = lattice;
+            warmStartState->key = latticeKey;
+        }
 
-    // spline
-    BSplinerType::Pointer bspliner = BSplinerType::New();
-    bspliner->SetInput(correcter->GetLogBiasFieldControlPointLattice());
-    bspliner->SetSplineOrder(correcter->GetSplineOrder());
-    bspliner->SetSize(initialImage->GetLargestPossibleRegion().GetSize());
-    bspliner->SetOrigin(initialImage->GetOrigin());
-    bspliner->SetDirection(initialImage->GetDirection());
-    bspliner->SetSpacing(initialImage->GetSpacing());
-    bspliner->Update();
+        // spline
+        BSplinerType::Pointer bspliner = makeBSpliner(lattice, splineOrder, initialImage, threads);
 
-    itk::ImageRegionIterator<CorrecterType::ScalarImageType> ItB(bspliner->GetOutput(),
-                                                                 bspliner->GetOutput()->GetLargestPossibleRegion());
-    itk::ImageRegionIterator<ImageType> ItF(initialImage, initialImage->GetLargestPossibleRegion());
-    for (ItB.GoToBegin(), ItF.GoToBegin(); !ItB.IsAtEnd(); ++ItB, ++ItF)
-        ItF.Set(exp(ItB.Get()[0]));
+        itk::ImageRegionIterator<CorrecterType::ScalarImageType> ItB(
+            bspliner->GetOutput(), bspliner->GetOutput()->GetLargestPossibleRegion());
+        itk::ImageRegionIterator<ImageType> ItF(initialImage, initialImage->GetLargestPossibleRegion());
+        for (ItB.GoToBegin(), ItF.GoToBegin(); !ItB.IsAtEnd(); ++ItB, ++ItF)
+            ItF.Set(exp(ItB.Get()[0]));
 
-    // ------------------------------
-    // End of ITK N4 Bias Correction
-    // ------------------------------
+        // ------------------------------
+        // End of ITK N4 Bias Correction
+        // ------------------------------
 
-    // Set up the matrix A and the vector b for least squares fitting with the initial image
-    register int row = 0, totalPixels = sw * sh;
-    Eigen::MatrixXf ls_A = Eigen::MatrixXf(totalPixels, 2);
-    Eigen::VectorXf ls_b = Eigen::VectorXf(totalPixels);
+        // Set up the matrix A and the vector b for least squares fitting with the initial image
+        register int row = 0, totalPixels = sw * sh;
+        Eigen::MatrixXf ls_A = Eigen::MatrixXf(totalPixels, 2);
+        Eigen::VectorXf ls_b = Eigen::VectorXf(totalPixels);
 
-    initialImagePtr = initialImage->GetBufferPointer();
-    for (y = 0; y < sh; y++)
-    {
-        mbits8 = mInitial.ptr(y);
-        for (x = 0; x < sw; x++)
+        initialImagePtr = initialImage->GetBufferPointer();
+        for (y = 0; y < sh; y++)
         {
-            ls_A(row, 0) = 1;
-            ls_A(row, 1) = *initialImagePtr;
-            ls_b(row) = *mbits8;
+            mbits8 = mInitial.ptr(y);
+            for (x = 0; x < sw; x++)
+            {
+                ls_A(row, 0) = 1;
+                ls_A(row, 1) = *initialImagePtr;
+                ls_b(row) = *mbits8;
 
-            initialImagePtr++;
-            mbits8++;
-            row++;
+                initialImagePtr++;
+                mbits8++;
+                row++;
+            }
         }
-    }
-    // Solve...
-    Eigen::VectorXf ls_x = (ls_A).jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(ls_b);
+        // Solve...
+        Eigen::VectorXf ls_x = (ls_A).jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(ls_b);
 
-    initialImagePtr = initialImage->GetBufferPointer();
-    for (y = 0; y < sh; y++)
-    {
-        for (x = 0; x < sw; x++)
+        initialImagePtr = initialImage->GetBufferPointer();
+        for (y = 0; y < sh; y++)
         {
-            *initialImagePtr = ls_x(0) + (*initialImagePtr) * ls_x(1);
-            initialImagePtr++;
+            for (x = 0; x < sw; x++)
+            {
+                *initialImagePtr = ls_x(0) + (*initialImagePtr) * ls_x(1);
+                initialImagePtr++;
+            }
         }
-    }
 
-    // Remap due to out of range values and scale
-    double minIIH = 10000, maxIIH = -10000, minIIHc, maxIIHc, range1, range2;
+        // Remap due to out of range values and scale
+        double minIIH = 10000, maxIIH = -10000, minIIHc, maxIIHc, range1, range2;
 
-    initialImagePtr = initialImage->GetBufferPointer();
-    for (y = 0; y < sh; y++)
-    {
-        for (x = 0; x < sw; x++)
+        initialImagePtr = initialImage->GetBufferPointer();
+        for (y = 0; y < sh; y++)
         {
-            if ((*initialImagePtr) > maxIIH)
-                maxIIH = (*initialImagePtr);
-            if ((*initialImagePtr) < minIIH)
-                minIIH = (*initialImagePtr);
-            initialImagePtr++;
+            for (x = 0; x < sw; x++)
+            {
+                if ((*initialImagePtr) > maxIIH)
+                    maxIIH = (*initialImagePtr);
+                if ((*initialImagePtr) < minIIH)
+                    minIIH = (*initialImagePtr);
+                initialImagePtr++;
+            }
         }
-    }
-    minIIHc = IBP_clamp(0., minIIH, 255.);
-    maxIIHc = IBP_clamp(0., maxIIH, 255.);
-    range1 = maxIIH - minIIH;
-    range2 = maxIIHc - minIIHc;
-    initialImagePtr = initialImage->GetBufferPointer();
-    for (y = 0; y < sh; y++)
-    {
-        mbits8 = mInitial.ptr(y);
-        for (x = 0; x < sw; x++)
+        minIIHc = IBP_clamp(0., minIIH, 255.);
+        maxIIHc = IBP_clamp(0., maxIIH, 255.);
+        range1 = maxIIH - minIIH;
+        range2 = maxIIHc - minIIHc;
+        initialImagePtr = initialImage->GetBufferPointer();
+        for (y = 0; y < sh; y++)
         {
-            *mbits8 = round((minIIHc + ((*initialImagePtr) - minIIH) * range2 / range1));
-            mean += *mbits8;
-            mbits8++;
-            initialImagePtr++;
+            mbits8 = mInitial.ptr(y);
+            for (x = 0; x < sw; x++)
+            {
+                *mbits8 = round((minIIHc + ((*initialImagePtr) - minIIH) * range2 / range1));
+                mean += *mbits8;
+                mbits8++;
+                initialImagePtr++;
+            }
         }
-    }
-    mean /= totalPixels;
+        mean /= totalPixels;
 
-    // Resample
-    if (w != sw || h != sh)
-        cv::resize(mInitial, mlchannel, cv::Size(w, h), 0, 0, cv::INTER_CUBIC);
-    else
-        mlchannel = mInitial;
+        // Resample
+        if (w != sw || h != sh)
+            cv::resize(mInitial, mlchannel, cv::Size(w, h), 0, 0, cv::INTER_CUBIC);
+        else
+            mlchannel = mInitial;
+
+        if (mFieldReuseFrames > 0)
+            mBiasFieldCache->add(mlchannel, mFieldReuseFrames);
+    }
 
     // Make output image
     if (mOutputMode == CorrectedImageMode1)
@@ -324,6 +431,9 @@ bool Filter::loadParameters(QSettings &s)
     int gridSize;
     QString outputModeStr;
     OutputMode outputMode;
+    int fieldReuseFrames, threads;
+    double convergenceThreshold;
+    bool warmStart;
     bool ok;
 
     gridSize = s.value("gridsize", 3).toUInt(&ok);
@@ -340,7 +450,25 @@ bool Filter::loadParameters(QSettings &s)
     else
         return false;
 
+    fieldReuseFrames = s.value("fieldreuseframes", 0).toInt(&ok);
+    if (!ok || fieldReuseFrames < 0 || fieldReuseFrames > 15)
+        return false;
+
+    threads = s.value("threads", 0).toInt(&ok);
+    if (!ok || threads < 0 || threads > 64)
+        return false;
+
+    convergenceThreshold = s.value("convergencethreshold", 0.001).toDouble(&ok);
+    if (!ok || convergenceThreshold < 0.0001 || convergenceThreshold > 0.1)
+        return false;
+
+    warmStart = s.value("warmstart", false).toBool();
+
     setOutputMode(outputMode);
+    setFieldReuseFrames(fieldReuseFrames);
+    setThreads(threads);
+    setConvergenceThreshold(convergenceThreshold);
+    setWarmStart(warmStart);
     setGridSize(gridSize);
 
     return true;
@@ -351,6 +479,10 @@ bool Filter::saveParameters(QSettings &s)
     s.setValue("gridsize", mGridSize);
     s.setValue("outputmode", mOutputMode == CorrectedImageMode1 ? "correctedimagemode1" :
                              mOutputMode == CorrectedImageMode2 ? "correctedimagemode2" : "iihcorrectionmodel");
+    s.setValue("fieldreuseframes", mFieldReuseFrames);
+    s.setValue("threads", mThreads);
+    s.setValue("convergencethreshold", mConvergenceThreshold);
+    s.setValue("warmstart", mWarmStart);
     return true;
 }
 
@@ -359,10 +491,22 @@ QWidget *Filter::widget(QWidget *parent)
     FilterWidget * fw = new FilterWidget(parent);
     fw->setGridSize(mGridSize);
     fw->setOutputMode(mOutputMode);
+    fw->setFieldReuseFrames(mFieldReuseFrames);
+    fw->setThreads(mThreads);
+    fw->setConvergenceThreshold(mConvergenceThreshold);
+    fw->setWarmStart(mWarmStart);
     connect(this, SIGNAL(gridSizeChanged(int)), fw, SLOT(setGridSize(int)));
     connect(this, SIGNAL(outputModeChanged(Filter::OutputMode)), fw, SLOT(setOutputMode(Filter::OutputMode)));
+    connect(this, SIGNAL(fieldReuseFramesChanged(int)), fw, SLOT(setFieldReuseFrames(int)));
+    connect(this, SIGNAL(threadsChanged(int)), fw, SLOT(setThreads(int)));
+    connect(this, SIGNAL(convergenceThresholdChanged(double)), fw, SLOT(setConvergenceThreshold(double)));
+    connect(this, SIGNAL(warmStartChanged(bool)), fw, SLOT(setWarmStart(bool)));
     connect(fw, SIGNAL(gridSizeChanged(int)), this, SLOT(setGridSize(int)));
     connect(fw, SIGNAL(outputModeChanged(Filter::OutputMode)), this, SLOT(setOutputMode(Filter::OutputMode)));
+    connect(fw, SIGNAL(fieldReuseFramesChanged(int)), this, SLOT(setFieldReuseFrames(int)));
+    connect(fw, SIGNAL(threadsChanged(int)), this, SLOT(setThreads(int)));
+    connect(fw, SIGNAL(convergenceThresholdChanged(double)), this, SLOT(setConvergenceThreshold(double)));
+    connect(fw, SIGNAL(warmStartChanged(bool)), this, SLOT(setWarmStart(bool)));
     return fw;
 }
 
@@ -371,6 +515,8 @@ void Filter::setGridSize(int gs)
     if (gs == mGridSize)
         return;
     mGridSize = gs;
+    mBiasFieldCache = QSharedPointer<BiasFieldCache>(new BiasFieldCache);
+    mWarmStartState = QSharedPointer<WarmStart>(new WarmStart);
     emit gridSizeChanged(gs);
     emit parametersChanged();
 }
@@ -383,3 +529,44 @@ void Filter::setOutputMode(Filter::OutputMode om)
     emit outputModeChanged(om);
     emit parametersChanged();
 }
+
+void Filter::setFieldReuseFrames(int n)
+{
+    if (n == mFieldReuseFrames)
+        return;
+    mFieldReuseFrames = n;
+    mBiasFieldCache = QSharedPointer<BiasFieldCache>(new BiasFieldCache);
+    emit fieldReuseFramesChanged(n);
+    emit parametersChanged();
+}
+
+void Filter::setThreads(int n)
+{
+    if (n == mThreads)
+        return;
+    mThreads = n;
+    emit threadsChanged(n);
+    emit parametersChanged();
+}
+
+void Filter::setConvergenceThreshold(double t)
+{
+    if (t == mConvergenceThreshold)
+        return;
+    mConvergenceThreshold = t;
+    mBiasFieldCache = QSharedPointer<BiasFieldCache>(new BiasFieldCache);
+    mWarmStartState = QSharedPointer<WarmStart>(new WarmStart);
+    emit convergenceThresholdChanged(t);
+    emit parametersChanged();
+}
+
+void Filter::setWarmStart(bool w)
+{
+    if (w == mWarmStart)
+        return;
+    mWarmStart = w;
+    mBiasFieldCache = QSharedPointer<BiasFieldCache>(new BiasFieldCache);
+    mWarmStartState = QSharedPointer<WarmStart>(new WarmStart);
+    emit warmStartChanged(w);
+    emit parametersChanged();
+}
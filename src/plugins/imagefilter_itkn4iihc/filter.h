@@ -31,8 +31,10 @@
 #include <QImage>
 #include <QSettings>
 #include <QWidget>
+#include <QSharedPointer>
 
 #include <imgproc/imagefilter.h>
+#include <imgproc/biasfieldcache.h>
 
 using namespace ibp::imgproc;
 
@@ -60,14 +62,32 @@ public:
 private:
     int mGridSize;
     OutputMode mOutputMode;
+    int mFieldReuseFrames;
+    int mThreads;
+    double mConvergenceThreshold;
+    bool mWarmStart;
+    // fields shared with the copies of the filter, started anew when the estimation parameters change
+    QSharedPointer<BiasFieldCache> mBiasFieldCache;
+    // log bias field lattice of the last image corrected with warm start, shared with the copies of the filter (as
+    // each image of a batch is processed by a new one) and started anew when the estimation parameters change
+    struct WarmStart;
+    QSharedPointer<WarmStart> mWarmStartState;
 
 signals:
     void gridSizeChanged(int gs);
     void outputModeChanged(Filter::OutputMode om);
+    void fieldReuseFramesChanged(int n);
+    void threadsChanged(int n);
+    void convergenceThresholdChanged(double t);
+    void warmStartChanged(bool w);
 
 public slots:
     void setGridSize(int gs);
     void setOutputMode(Filter::OutputMode om);
+    void setFieldReuseFrames(int n);
+    void setThreads(int n);
+    void setConvergenceThreshold(double t);
+    void setWarmStart(bool w);
 
 };
 
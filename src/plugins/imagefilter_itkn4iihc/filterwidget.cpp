@@ -67,6 +67,46 @@ void FilterWidget::setOutputMode(Filter::OutputMode om)
     emit outputModeChanged(om);
 }
 
+void FilterWidget::setFieldReuseFrames(int n)
+{
+    if (ui->mSpinFieldReuseFrames->value() == n)
+        return;
+    mEmitSignals = false;
+    ui->mSpinFieldReuseFrames->setValue(n);
+    mEmitSignals = true;
+    emit fieldReuseFramesChanged(n);
+}
+
+void FilterWidget::setThreads(int n)
+{
+    if (ui->mSpinThreads->value() == n)
+        return;
+    mEmitSignals = false;
+    ui->mSpinThreads->setValue(n);
+    mEmitSignals = true;
+    emit threadsChanged(n);
+}
+
+void FilterWidget::setConvergenceThreshold(double t)
+{
+    if (ui->mSpinConvergenceThreshold->value() == t)
+        return;
+    mEmitSignals = false;
+    ui->mSpinConvergenceThreshold->setValue(t);
+    mEmitSignals = true;
+    emit convergenceThresholdChanged(t);
+}
+
+void FilterWidget::setWarmStart(bool w)
+{
+    if (ui->mButtonWarmStart->isChecked() == w)
+        return;
+    mEmitSignals = false;
+    ui->mButtonWarmStart->setChecked(w);
+    mEmitSignals = true;
+    emit warmStartChanged(w);
+}
+
 void FilterWidget::on_mSliderGridSize_valueChanged(int value)
 {
     ui->mSpinGridSize->setValue(value);
@@ -104,3 +144,27 @@ void FilterWidget::on_mButtonOutputModeIIHCorrectionModel_toggled(bool c)
     if (mEmitSignals)
         emit outputModeChanged(Filter::IIHCorrectionModel);
 }
+
+void FilterWidget::on_mSpinFieldReuseFrames_valueChanged(int arg1)
+{
+    if (mEmitSignals)
+        emit fieldReuseFramesChanged(arg1);
+}
+
+void FilterWidget::on_mSpinThreads_valueChanged(int arg1)
+{
+    if (mEmitSignals)
+        emit threadsChanged(arg1);
+}
+
+void FilterWidget::on_mSpinConvergenceThreshold_valueChanged(double arg1)
+{
+    if (mEmitSignals)
+        emit convergenceThresholdChanged(arg1);
+}
+
+void FilterWidget::on_mButtonWarmStart_toggled(bool v)
+{
+    if (mEmitSignals)
+        emit warmStartChanged(v);
+}
@@ -48,10 +48,18 @@ private:
 signals:
     void gridSizeChanged(int gs);
     void outputModeChanged(Filter::OutputMode om);
+    void fieldReuseFramesChanged(int n);
+    void threadsChanged(int n);
+    void convergenceThresholdChanged(double t);
+    void warmStartChanged(bool w);
 
 public slots:
     void setGridSize(int gs);
     void setOutputMode(Filter::OutputMode om);
+    void setFieldReuseFrames(int n);
+    void setThreads(int n);
+    void setConvergenceThreshold(double t);
+    void setWarmStart(bool w);
 
 private slots:
     void on_mSliderGridSize_valueChanged(int value);
@@ -59,6 +67,10 @@ private slots:
     void on_mButtonOutputModeCorrectedImageMode1_toggled(bool c);
     void on_mButtonOutputModeCorrectedImageMode2_toggled(bool c);
     void on_mButtonOutputModeIIHCorrectionModel_toggled(bool c);
+    void on_mSpinFieldReuseFrames_valueChanged(int arg1);
+    void on_mSpinThreads_valueChanged(int arg1);
+    void on_mSpinConvergenceThreshold_valueChanged(double arg1);
+    void on_mButtonWarmStart_toggled(bool v);
 };
 
 #endif // FILTERWIDGET_H
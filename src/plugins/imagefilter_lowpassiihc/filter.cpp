@@ -29,13 +29,16 @@
 #include <imgproc/lut.h>
 #include <imgproc/types.h>
 #include <imgproc/colorconversion.h>
+#include <imgproc/biasfieldcache.h>
 #include <misc/util.h>
 
 #define MAX_IMAGE_SIZE 512
 
 Filter::Filter() :
     mFeatureSize(10),
-    mOutputMode(CorrectedImageMode1)
+    mOutputMode(CorrectedImageMode1),
+    mFieldReuseFrames(0),
+    mBiasFieldCache(new BiasFieldCache)
 {
 }
 
@@ -48,6 +51,8 @@ ImageFilter *Filter::clone()
     Filter * f = new Filter();
     f->mFeatureSize = mFeatureSize;
     f->mOutputMode = mOutputMode;
+    f->mFieldReuseFrames = mFieldReuseFrames;
+    f->mBiasFieldCache = mBiasFieldCache;
     return f;
 }
 
@@ -70,53 +75,60 @@ QImage Filter::process(const QImage &inputImage)
 
     convertBGRToHSL(inputImage.bits(), (unsigned char *)bitsHSL, w * h);
 
-    for (y = 0; y < h; y++)
+    // Estimate the illumination field, unless the batch already shares one for images of this size
+    if (mFieldReuseFrames == 0 || !mBiasFieldCache->find(cv::Size(w, h), mlchannel))
     {
-        bitsHSLsl = bitsHSL + y * w;
-        mlchannelsl = mlchannel.ptr(y);
-        for (x = 0; x < w; x++)
+        for (y = 0; y < h; y++)
         {
-            *mlchannelsl = bitsHSLsl->l;
-            bitsHSLsl++;
-            mlchannelsl++;
+            bitsHSLsl = bitsHSL + y * w;
+            mlchannelsl = mlchannel.ptr(y);
+            for (x = 0; x < w; x++)
+            {
+                *mlchannelsl = bitsHSLsl->l;
+                bitsHSLsl++;
+                mlchannelsl++;
+            }
         }
-    }
 
-    if (w > MAX_IMAGE_SIZE || h > MAX_IMAGE_SIZE)
-    {
-        int sw, sh;
-        if (w > h)
+        if (w > MAX_IMAGE_SIZE || h > MAX_IMAGE_SIZE)
         {
-            sw = MAX_IMAGE_SIZE;
-            sh = h * MAX_IMAGE_SIZE / w;
+            int sw, sh;
+            if (w > h)
+            {
+                sw = MAX_IMAGE_SIZE;
+                sh = h * MAX_IMAGE_SIZE / w;
+            }
+            else
+            {
+                sh = MAX_IMAGE_SIZE;
+                sw = w * MAX_IMAGE_SIZE / h;
+            }
+            sw = sw < 1 ? 1 : sw;
+            sh = sh < 1 ? 1 : sh;
+
+            double ratio = (double)sw / (double)w;
+            size = ceil(size * ratio);
+            if (size % 2 == 0)
+                size++;
+
+            cv::Mat mresized(sh, sw, CV_8UC1);
+            cv::Mat mresized2(sh, sw, CV_8UC1);
+            cv::resize(mlchannel, mresized, cv::Size(sw, sh));
+            cv::GaussianBlur(mresized, mresized2, cv::Size(size, size), 0);
+            cv::resize(mresized2, mlchannel, cv::Size(w, h));
         }
         else
         {
-            sh = MAX_IMAGE_SIZE;
-            sw = w * MAX_IMAGE_SIZE / h;
+            if (size % 2 == 0)
+                size++;
+
+            cv::Mat mlchannel2(h, w, CV_8UC1);
+            cv::GaussianBlur(mlchannel, mlchannel2, cv::Size(size, size), 0);
+            mlchannel = mlchannel2;
         }
-        sw = sw < 1 ? 1 : sw;
-        sh = sh < 1 ? 1 : sh;
-
-        double ratio = (double)sw / (double)w;
-        size = ceil(size * ratio);
-        if (size % 2 == 0)
-            size++;
-
-        cv::Mat mresized(sh, sw, CV_8UC1);
-        cv::Mat mresized2(sh, sw, CV_8UC1);
-        cv::resize(mlchannel, mresized, cv::Size(sw, sh));
-        cv::GaussianBlur(mresized, mresized2, cv::Size(size, size), 0);
-        cv::resize(mresized2, mlchannel, cv::Size(w, h));
-    }
-    else
-    {
-        if (size % 2 == 0)
-            size++;
 
-        cv::Mat mlchannel2(h, w, CV_8UC1);
-        cv::GaussianBlur(mlchannel, mlchannel2, cv::Size(size, size), 0);
-        mlchannel = mlchannel2;
+        if (mFieldReuseFrames > 0)
+            mBiasFieldCache->add(mlchannel, mFieldReuseFrames);
     }
 
     if (mOutputMode == CorrectedImageMode1)
@@ -186,6 +198,7 @@ bool Filter::loadParameters(QSettings &s)
     int featureSize;
     QString outputModeStr;
     OutputMode outputMode;
+    int fieldReuseFrames;
     bool ok;
 
     featureSize = s.value("featuresize", 20).toUInt(&ok);
@@ -202,8 +215,13 @@ bool Filter::loadParameters(QSettings &s)
     else
         return false;
 
+    fieldReuseFrames = s.value("fieldreuseframes", 0).toInt(&ok);
+    if (!ok || fieldReuseFrames < 0 || fieldReuseFrames > 15)
+        return false;
+
     setFeatureSize(featureSize);
     setOutputMode(outputMode);
+    setFieldReuseFrames(fieldReuseFrames);
 
     return true;
 }
@@ -213,6 +231,7 @@ bool Filter::saveParameters(QSettings &s)
     s.setValue("featuresize", mFeatureSize);
     s.setValue("outputmode", mOutputMode == CorrectedImageMode1 ? "correctedimagemode1" :
                              mOutputMode == CorrectedImageMode2 ? "correctedimagemode2" : "iihcorrectionmodel");
+    s.setValue("fieldreuseframes", mFieldReuseFrames);
     return true;
 }
 
@@ -221,10 +240,13 @@ QWidget *Filter::widget(QWidget *parent)
     FilterWidget * fw = new FilterWidget(parent);
     fw->setFeatureSize(mFeatureSize);
     fw->setOutputMode(mOutputMode);
+    fw->setFieldReuseFrames(mFieldReuseFrames);
     connect(this, SIGNAL(featureSizeChanged(int)), fw, SLOT(setFeatureSize(int)));
     connect(this, SIGNAL(outputModeChanged(Filter::OutputMode)), fw, SLOT(setOutputMode(Filter::OutputMode)));
+    connect(this, SIGNAL(fieldReuseFramesChanged(int)), fw, SLOT(setFieldReuseFrames(int)));
     connect(fw, SIGNAL(featureSizeChanged(int)), this, SLOT(setFeatureSize(int)));
     connect(fw, SIGNAL(outputModeChanged(Filter::OutputMode)), this, SLOT(setOutputMode(Filter::OutputMode)));
+    connect(fw, SIGNAL(fieldReuseFramesChanged(int)), this, SLOT(setFieldReuseFrames(int)));
     return fw;
 }
 
@@ -233,6 +255,7 @@ void Filter::setFeatureSize(int fs)
     if (fs == mFeatureSize)
         return;
     mFeatureSize = fs;
+    mBiasFieldCache = QSharedPointer<BiasFieldCache>(new BiasFieldCache);
     emit featureSizeChanged(fs);
     emit parametersChanged();
 }
@@ -245,3 +268,13 @@ void Filter::setOutputMode(Filter::OutputMode om)
     emit outputModeChanged(om);
     emit parametersChanged();
 }
+
+void Filter::setFieldReuseFrames(int n)
+{
+    if (n == mFieldReuseFrames)
+        return;
+    mFieldReuseFrames = n;
+    mBiasFieldCache = QSharedPointer<BiasFieldCache>(new BiasFieldCache);
+    emit fieldReuseFramesChanged(n);
+    emit parametersChanged();
+}
@@ -48,10 +48,12 @@ private:
 signals:
     void featureSizeChanged(int fs);
     void outputModeChanged(Filter::OutputMode om);
+    void fieldReuseFramesChanged(int n);
 
 public slots:
     void setFeatureSize(int fs);
     void setOutputMode(Filter::OutputMode om);
+    void setFieldReuseFrames(int n);
 
 private slots:
     void on_mSliderFeatureSize_valueChanged(int value);
@@ -59,6 +61,7 @@ private slots:
     void on_mButtonOutputModeCorrectedImageMode1_toggled(bool c);
     void on_mButtonOutputModeCorrectedImageMode2_toggled(bool c);
     void on_mButtonOutputModeIIHCorrectionModel_toggled(bool c);
+    void on_mSpinFieldReuseFrames_valueChanged(int arg1);
 };
 
 #endif // FILTERWIDGET_H
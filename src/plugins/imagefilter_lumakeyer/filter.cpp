@@ -31,6 +31,7 @@
 #include <imgproc/types.h>
 #include <imgproc/lut.h>
 #include <imgproc/util.h>
+#include <imgproc/blurring.h>
 #include "../misc/nearestneighborsplineinterpolator1D.h"
 #include "../misc/linearsplineinterpolator1D.h"
 #include "../misc/cubicsplineinterpolator1D.h"
@@ -83,31 +84,49 @@ QImage Filter::process(const QImage & inputImage)
         return inputImage;
 
     QImage i = QImage(inputImage.width(), inputImage.height(), QImage::Format_ARGB32);
-    QImage iBlurred;
     register BGRA * bits = (BGRA*)inputImage.bits();
     register BGRA * bits2 = (BGRA*)i.bits();
-    register BGRA * bits3;
     register int totalPixels = i.width() * i.height();
 
     if (qFuzzyIsNull(mPreblurRadius))
-        bits3 = bits;
-    else
     {
-        iBlurred = QImage(inputImage.width(), inputImage.height(), QImage::Format_ARGB32);
-        cv::Mat mInput(inputImage.height(), inputImage.width(), CV_8UC4, (void *)inputImage.bits());
-        cv::Mat mBlurred(iBlurred.height(), iBlurred.width(), CV_8UC4, iBlurred.bits());
-        double sigma = (mPreblurRadius + .5) / 2.45;
-        cv::GaussianBlur(mInput, mBlurred, cv::Size(0, 0), sigma);
-        bits3 = (BGRA *)iBlurred.bits();
+        if (mOutputMode == KeyedImage)
+            while (totalPixels--)
+            {
+                bits2->r = bits->r;
+                bits2->g = bits->g;
+                bits2->b = bits->b;
+                bits2->a = IBP_multiply(bits->a, mLut[IBP_pixelIntensity4(bits->r, bits->g, bits->b)]);
+                bits++;
+                bits2++;
+            }
+        else
+            while (totalPixels--)
+            {
+                bits2->r = bits2->g = bits2->b =
+                        IBP_multiply(bits->a, mLut[IBP_pixelIntensity4(bits->r, bits->g, bits->b)]);
+                bits2->a = 255;
+                bits++;
+                bits2++;
+            }
+
+        return i;
     }
 
+    // Only the luma is keyed, so blur that plane instead of the four channels
+    cv::Mat mLuma(inputImage.height(), inputImage.width(), CV_8UC1);
+    convertBGRAToLuma(bits, mLuma.data, totalPixels);
+    double sigma = (mPreblurRadius + .5) / 2.45;
+    gaussianBlur(mLuma, mLuma, sigma);
+    register unsigned char * bits3 = mLuma.data;
+
     if (mOutputMode == KeyedImage)
         while (totalPixels--)
         {
             bits2->r = bits->r;
             bits2->g = bits->g;
             bits2->b = bits->b;
-            bits2->a = lut01[bits->a][mLut[IBP_pixelIntensity4(bits3->r, bits3->g, bits3->b)]];
+            bits2->a = IBP_multiply(bits->a, mLut[*bits3]);
             bits++;
             bits2++;
             bits3++;
@@ -115,8 +134,7 @@ QImage Filter::process(const QImage & inputImage)
     else
         while (totalPixels--)
         {
-            bits2->r = bits2->g = bits2->b =
-                    lut01[bits->a][mLut[IBP_pixelIntensity4(bits3->r, bits3->g, bits3->b)]];
+            bits2->r = bits2->g = bits2->b = IBP_multiply(bits->a, mLut[*bits3]);
             bits2->a = 255;
             bits++;
             bits2++;
@@ -324,10 +342,6 @@ void Filter::setPreblurRadius(double pbr)
 
 void Filter::makeLUT()
 {
-    if (mIsInverted)
-        for (int i = 0; i < 256; i++)
-            mLut[i] = IBP_clamp(0, round(mSplineInterpolator->f(i / 255.) * 255.), 255);
-    else
-        for (int i = 0; i < 256; i++)
-            mLut[i] = 255 - IBP_clamp(0, round(mSplineInterpolator->f(i / 255.) * 255.), 255);
+    // the key is the transparency, so the curve is inverted unless the user inverts it
+    bakeInterpolator1DLUT(mSplineInterpolator, mLut, 256, !mIsInverted);
 }
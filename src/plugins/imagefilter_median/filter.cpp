@@ -26,6 +26,7 @@
 
 #include "filter.h"
 #include "filterwidget.h"
+#include <imgproc/blurring.h>
 
 Filter::Filter() :
     mRadius(0)
@@ -63,8 +64,7 @@ QImage Filter::process(const QImage &inputImage)
     cv::Mat msrc(inputImage.height(), inputImage.width(), CV_8UC4, (void *)inputImage.bits());
     cv::Mat mdst(i.height(), i.width(), CV_8UC4, i.bits());
 
-    int size = (mRadius << 1) + 1;
-    cv::medianBlur(msrc, mdst, size);
+    ibp::imgproc::medianBlur(msrc, mdst, mRadius);
 
     return i;
 }
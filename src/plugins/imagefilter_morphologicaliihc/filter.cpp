@@ -29,13 +29,16 @@
 #include <imgproc/lut.h>
 #include <imgproc/types.h>
 #include <imgproc/colorconversion.h>
+#include <imgproc/biasfieldcache.h>
 #include <misc/util.h>
 
 #define MAX_IMAGE_SIZE 512
 
 Filter::Filter() :
     mFeatureSize(10),
-    mOutputMode(CorrectedImageMode1)
+    mOutputMode(CorrectedImageMode1),
+    mFieldReuseFrames(0),
+    mBiasFieldCache(new BiasFieldCache)
 {
 }
 
@@ -48,6 +51,8 @@ ImageFilter *Filter::clone()
     Filter * f = new Filter();
     f->mFeatureSize = mFeatureSize;
     f->mOutputMode = mOutputMode;
+    f->mFieldReuseFrames = mFieldReuseFrames;
+    f->mBiasFieldCache = mBiasFieldCache;
     return f;
 }
 
@@ -70,51 +75,58 @@ QImage Filter::process(const QImage &inputImage)
 
     convertBGRToHSL(inputImage.bits(), (unsigned char *)bitsHSL, w * h);
 
-    for (y = 0; y < h; y++)
+    // Estimate the illumination field, unless the batch already shares one for images of this size
+    if (mFieldReuseFrames == 0 || !mBiasFieldCache->find(cv::Size(w, h), mlchannel))
     {
-        bitsHSLsl = bitsHSL + y * w;
-        mlchannelsl = mlchannel.ptr(y);
-        for (x = 0; x < w; x++)
+        for (y = 0; y < h; y++)
         {
-            *mlchannelsl = bitsHSLsl->l;
-            bitsHSLsl++;
-            mlchannelsl++;
+            bitsHSLsl = bitsHSL + y * w;
+            mlchannelsl = mlchannel.ptr(y);
+            for (x = 0; x < w; x++)
+            {
+                *mlchannelsl = bitsHSLsl->l;
+                bitsHSLsl++;
+                mlchannelsl++;
+            }
         }
-    }
 
-    if (w > MAX_IMAGE_SIZE || h > MAX_IMAGE_SIZE)
-    {
-        int sw, sh;
-        if (w > h)
+        if (w > MAX_IMAGE_SIZE || h > MAX_IMAGE_SIZE)
         {
-            sw = MAX_IMAGE_SIZE;
-            sh = h * MAX_IMAGE_SIZE / w;
+            int sw, sh;
+            if (w > h)
+            {
+                sw = MAX_IMAGE_SIZE;
+                sh = h * MAX_IMAGE_SIZE / w;
+            }
+            else
+            {
+                sh = MAX_IMAGE_SIZE;
+                sw = w * MAX_IMAGE_SIZE / h;
+            }
+            sw = sw < 1 ? 1 : sw;
+            sh = sh < 1 ? 1 : sh;
+
+            double ratio = (double)sw / (double)w;
+            size = ceil(size * ratio);
+
+            cv::Mat mresized(sh, sw, CV_8UC1);
+            cv::Mat mresized2(sh, sw, CV_8UC1);
+            cv::resize(mlchannel, mresized, cv::Size(sw, sh));
+            cv::medianBlur(mresized, mresized2, 5);
+            cv::morphologyEx(mresized2, mresized, cv::MORPH_CLOSE,
+                             cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(size, size)));
+            cv::resize(mresized, mlchannel, cv::Size(w, h));
         }
         else
         {
-            sh = MAX_IMAGE_SIZE;
-            sw = w * MAX_IMAGE_SIZE / h;
+            cv::Mat mlchannel2(h, w, CV_8UC1);
+            cv::medianBlur(mlchannel, mlchannel2, 5);
+            cv::morphologyEx(mlchannel2, mlchannel, cv::MORPH_CLOSE,
+                             cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(size, size)));
         }
-        sw = sw < 1 ? 1 : sw;
-        sh = sh < 1 ? 1 : sh;
-
-        double ratio = (double)sw / (double)w;
-        size = ceil(size * ratio);
-
-        cv::Mat mresized(sh, sw, CV_8UC1);
-        cv::Mat mresized2(sh, sw, CV_8UC1);
-        cv::resize(mlchannel, mresized, cv::Size(sw, sh));
-        cv::medianBlur(mresized, mresized2, 5);
-        cv::morphologyEx(mresized2, mresized, cv::MORPH_CLOSE,
-                         cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(size, size)));
-        cv::resize(mresized, mlchannel, cv::Size(w, h));
-    }
-    else
-    {
-        cv::Mat mlchannel2(h, w, CV_8UC1);
-        cv::medianBlur(mlchannel, mlchannel2, 5);
-        cv::morphologyEx(mlchannel2, mlchannel, cv::MORPH_CLOSE,
-                         cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(size, size)));
+
+        if (mFieldReuseFrames > 0)
+            mBiasFieldCache->add(mlchannel, mFieldReuseFrames);
     }
 
     if (mOutputMode == CorrectedImageMode1)
@@ -184,6 +196,7 @@ bool Filter::loadParameters(QSettings &s)
     int featureSize;
     QString outputModeStr;
     OutputMode outputMode;
+    int fieldReuseFrames;
     bool ok;
 
     featureSize = s.value("featuresize", 20).toUInt(&ok);
@@ -200,8 +213,13 @@ bool Filter::loadParameters(QSettings &s)
     else
         return false;
 
+    fieldReuseFrames = s.value("fieldreuseframes", 0).toInt(&ok);
+    if (!ok || fieldReuseFrames < 0 || fieldReuseFrames > 15)
+        return false;
+
     setFeatureSize(featureSize);
     setOutputMode(outputMode);
+    setFieldReuseFrames(fieldReuseFrames);
 
     return true;
 }
@@ -211,6 +229,7 @@ bool Filter::saveParameters(QSettings &s)
     s.setValue("featuresize", mFeatureSize);
     s.setValue("outputmode", mOutputMode == CorrectedImageMode1 ? "correctedimagemode1" :
                              mOutputMode == CorrectedImageMode2 ? "correctedimagemode2" : "iihcorrectionmodel");
+    s.setValue("fieldreuseframes", mFieldReuseFrames);
     return true;
 }
 
@@ -219,10 +238,13 @@ QWidget *Filter::widget(QWidget *parent)
     FilterWidget * fw = new FilterWidget(parent);
     fw->setFeatureSize(mFeatureSize);
     fw->setOutputMode(mOutputMode);
+    fw->setFieldReuseFrames(mFieldReuseFrames);
     connect(this, SIGNAL(featureSizeChanged(int)), fw, SLOT(setFeatureSize(int)));
     connect(this, SIGNAL(outputModeChanged(Filter::OutputMode)), fw, SLOT(setOutputMode(Filter::OutputMode)));
+    connect(this, SIGNAL(fieldReuseFramesChanged(int)), fw, SLOT(setFieldReuseFrames(int)));
     connect(fw, SIGNAL(featureSizeChanged(int)), this, SLOT(setFeatureSize(int)));
     connect(fw, SIGNAL(outputModeChanged(Filter::OutputMode)), this, SLOT(setOutputMode(Filter::OutputMode)));
+    connect(fw, SIGNAL(fieldReuseFramesChanged(int)), this, SLOT(setFieldReuseFrames(int)));
     return fw;
 }
 
@@ -231,6 +253,7 @@ void Filter::setFeatureSize(int fs)
     if (fs == mFeatureSize)
         return;
     mFeatureSize = fs;
+    mBiasFieldCache = QSharedPointer<BiasFieldCache>(new BiasFieldCache);
     emit featureSizeChanged(fs);
     emit parametersChanged();
 }
@@ -243,3 +266,13 @@ void Filter::setOutputMode(Filter::OutputMode om)
     emit outputModeChanged(om);
     emit parametersChanged();
 }
+
+void Filter::setFieldReuseFrames(int n)
+{
+    if (n == mFieldReuseFrames)
+        return;
+    mFieldReuseFrames = n;
+    mBiasFieldCache = QSharedPointer<BiasFieldCache>(new BiasFieldCache);
+    emit fieldReuseFramesChanged(n);
+    emit parametersChanged();
+}
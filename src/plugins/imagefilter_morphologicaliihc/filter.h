@@ -31,8 +31,10 @@
 #include <QImage>
 #include <QSettings>
 #include <QWidget>
+#include <QSharedPointer>
 
 #include <imgproc/imagefilter.h>
+#include <imgproc/biasfieldcache.h>
 
 using namespace ibp::imgproc;
 
@@ -60,14 +62,19 @@ public:
 private:
     int mFeatureSize;
     OutputMode mOutputMode;
+    int mFieldReuseFrames;
+    // fields shared with the copies of the filter, started anew when the estimation parameters change
+    QSharedPointer<BiasFieldCache> mBiasFieldCache;
 
 signals:
     void featureSizeChanged(int fs);
     void outputModeChanged(Filter::OutputMode om);
+    void fieldReuseFramesChanged(int n);
 
 public slots:
     void setFeatureSize(int fs);
     void setOutputMode(Filter::OutputMode om);
+    void setFieldReuseFrames(int n);
 
 };
 
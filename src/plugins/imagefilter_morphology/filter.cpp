@@ -26,6 +26,7 @@
 
 #include "filter.h"
 #include "filterwidget.h"
+#include <imgproc/morphology.h>
 
 Filter::Filter() :
     mModifyRGB(true),
@@ -126,16 +127,18 @@ QImage Filter::process(const QImage &inputImage)
         switch (mMorphologyOp)
         {
         case Dilation:
-            cv::dilate(mRGB, mRGBMorph, kernel);
+            ibp::imgproc::dilate(mRGB, mRGBMorph, kernel);
             break;
         case Erosion:
-            cv::erode(mRGB, mRGBMorph, kernel);
+            ibp::imgproc::erode(mRGB, mRGBMorph, kernel);
             break;
         case Closing:
-            cv::morphologyEx(mRGB, mRGBMorph, cv::MORPH_CLOSE, kernel);
+            ibp::imgproc::dilate(mRGB, mRGBMorph, kernel);
+            ibp::imgproc::erode(mRGBMorph, mRGBMorph, kernel);
             break;
         case Opening:
-            cv::morphologyEx(mRGB, mRGBMorph, cv::MORPH_OPEN, kernel);
+            ibp::imgproc::erode(mRGB, mRGBMorph, kernel);
+            ibp::imgproc::dilate(mRGBMorph, mRGBMorph, kernel);
             break;
         }
     }
@@ -147,16 +150,18 @@ QImage Filter::process(const QImage &inputImage)
         switch (mMorphologyOp)
         {
         case Dilation:
-            cv::dilate(mAlpha, mAlphaMorph, kernel);
+            ibp::imgproc::dilate(mAlpha, mAlphaMorph, kernel);
             break;
         case Erosion:
-            cv::erode(mAlpha, mAlphaMorph, kernel);
+            ibp::imgproc::erode(mAlpha, mAlphaMorph, kernel);
             break;
         case Closing:
-            cv::morphologyEx(mAlpha, mAlphaMorph, cv::MORPH_CLOSE, kernel);
+            ibp::imgproc::dilate(mAlpha, mAlphaMorph, kernel);
+            ibp::imgproc::erode(mAlphaMorph, mAlphaMorph, kernel);
             break;
         case Opening:
-            cv::morphologyEx(mAlpha, mAlphaMorph, cv::MORPH_OPEN, kernel);
+            ibp::imgproc::erode(mAlpha, mAlphaMorph, kernel);
+            ibp::imgproc::dilate(mAlphaMorph, mAlphaMorph, kernel);
             break;
         }
     }
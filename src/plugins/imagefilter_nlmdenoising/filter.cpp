@@ -22,13 +22,19 @@
 // SOFTWARE.
 //
 
+#include <opencv2/imgproc.hpp>
 #include <opencv2/photo.hpp>
 
 #include "filter.h"
 #include "filterwidget.h"
+#include <imgproc/tiling.h>
+
+// side of the tiles denoised in parallel, before they are grown by the reach of the windows
+static const int kTileSize = 256;
 
 Filter::Filter() :
-    mStrength(0.)
+    mStrength(0.),
+    mMode(RGB)
 {
 }
 
@@ -41,6 +47,7 @@ ImageFilter *Filter::clone()
 {
     Filter * f = new Filter();
     f->mStrength = mStrength;
+    f->mMode = mMode;
     return f;
 }
 
@@ -58,15 +65,15 @@ QImage Filter::process(const QImage &inputImage)
     if (qFuzzyCompare(mStrength, 0.))
         return inputImage;
 
-    QImage i = QImage(inputImage.width(), inputImage.height(), QImage::Format_ARGB32);
+    // the alpha channel is kept from the copy
+    QImage i = inputImage.copy();
     cv::Mat mSrc(inputImage.height(), inputImage.width(), CV_8UC4, (void *)inputImage.bits());
     cv::Mat mDst(i.height(), i.width(), CV_8UC4, i.bits());
-    cv::Mat mRGB(inputImage.height(), inputImage.width(), CV_8UC3);
-    cv::Mat mAlpha(inputImage.height(), inputImage.width(), CV_8UC1);
-    cv::Mat mRGBDenoised;
+    cv::Mat mRGB, mRGBDenoised(inputImage.height(), inputImage.width(), CV_8UC3);
     double sigma, h, hColor;
     int templateWindowSize, searchWindowSize;
-    int fromTo[] = { 0, 0, 1, 1, 2, 2, 3, 3 };
+    int fromTo[] = { 0, 0, 1, 1, 2, 2 };
+    const Mode mode = mMode;
 
     // calculate parameters
     sigma = mStrength;
@@ -75,17 +82,21 @@ QImage Filter::process(const QImage &inputImage)
     templateWindowSize = sigma <= 15. ? 3 : sigma <= 30. ? 5 : sigma <= 45. ? 7 : sigma <= 75. ? 9 : 11;
     searchWindowSize = sigma <= 37.5 ? 21 : 35;
 
-    // split the image channels
-    cv::Mat mOutSplit[] = { mRGB, mAlpha };
-    cv::mixChannels(&mSrc, 1, mOutSplit, 2, fromTo, 4);
-
-    // denoise
-    //cv::fastNlMeansDenoisingColored(mRGB, mRGBDenoised, h, hColor, templateWindowSize, searchWindowSize);
-    cv::fastNlMeansDenoising(mRGB, mRGBDenoised, h, templateWindowSize, searchWindowSize);
+    cv::cvtColor(mSrc, mRGB, cv::COLOR_BGRA2BGR);
+
+    // denoise, in tiles grown by the reach of the search and template windows so they agree on their borders
+    const int margin = searchWindowSize / 2 + templateWindowSize / 2;
+    if (!parallelForTiles(mRGB, mRGBDenoised, kTileSize, margin, [&](const cv::Mat & src, cv::Mat & dst)
+    {
+        if (mode == Colored)
+            cv::fastNlMeansDenoisingColored(src, dst, h, hColor, templateWindowSize, searchWindowSize);
+        else
+            cv::fastNlMeansDenoising(src, dst, h, templateWindowSize, searchWindowSize);
+    }, [this]() { return isCancelled(); }))
+        return inputImage;
 
     // merge image channels
-    cv::Mat mOutMerge[] = { mRGBDenoised, mAlpha };
-    cv::mixChannels(mOutMerge, 2, &mDst, 1, fromTo, 4);
+    cv::mixChannels(&mRGBDenoised, 1, &mDst, 1, fromTo, 3);
 
     return i;
 }
@@ -93,17 +104,28 @@ QImage Filter::process(const QImage &inputImage)
 bool Filter::loadParameters(QSettings &s)
 {
     double strength;
+    QString modeStr;
+    Mode mode;
     bool ok;
     strength = s.value("strength", 0.).toDouble(&ok);
     if (!ok || strength < 0. || strength > 100.)
         return false;
+    modeStr = s.value("mode", "rgb").toString();
+    if (modeStr == "rgb")
+        mode = RGB;
+    else if (modeStr == "colored")
+        mode = Colored;
+    else
+        return false;
     setStrength(strength);
+    setMode(mode);
     return true;
 }
 
 bool Filter::saveParameters(QSettings &s)
 {
     s.setValue("strength", mStrength);
+    s.setValue("mode", mMode == Colored ? "colored" : "rgb");
     return true;
 }
 
@@ -111,8 +133,11 @@ QWidget *Filter::widget(QWidget *parent)
 {
     FilterWidget * fw = new FilterWidget(parent);
     fw->setStrength(mStrength);
+    fw->setMode(mMode);
     connect(this, SIGNAL(strengthChanged(double)), fw, SLOT(setStrength(double)));
+    connect(this, SIGNAL(modeChanged(Filter::Mode)), fw, SLOT(setMode(Filter::Mode)));
     connect(fw, SIGNAL(strengthChanged(double)), this, SLOT(setStrength(double)));
+    connect(fw, SIGNAL(modeChanged(Filter::Mode)), this, SLOT(setMode(Filter::Mode)));
     return fw;
 }
 
@@ -124,3 +149,12 @@ void Filter::setStrength(double s)
     emit strengthChanged(s);
     emit parametersChanged();
 }
+
+void Filter::setMode(Filter::Mode m)
+{
+    if (m == mMode)
+        return;
+    mMode = m;
+    emit modeChanged(m);
+    emit parametersChanged();
+}
@@ -41,6 +41,12 @@ class Filter : public ImageFilter
     Q_OBJECT
 
 public:
+    enum Mode
+    {
+        RGB,
+        Colored
+    };
+
     Filter();
     ~Filter();
     ImageFilter * clone();
@@ -52,12 +58,15 @@ public:
 
 private:
     double mStrength;
+    Mode mMode;
 
 signals:
     void strengthChanged(double s);
+    void modeChanged(Filter::Mode m);
 
 public slots:
     void setStrength(double s);
+    void setMode(Filter::Mode m);
 };
 
 #endif // FILTER_H
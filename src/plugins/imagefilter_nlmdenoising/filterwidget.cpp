@@ -33,6 +33,11 @@ FilterWidget::FilterWidget(QWidget *parent) :
     mEmitSignals(true)
 {
     ui->setupUi(this);
+
+    ui->mComboMode->addItems(QStringList() <<
+                             tr("RGB") <<
+                             tr("Colored (Lab)"));
+    ui->mComboMode->setCurrentIndex(0);
 }
 
 FilterWidget::~FilterWidget()
@@ -50,6 +55,13 @@ void FilterWidget::setStrength(double s)
     emit strengthChanged(s);
 }
 
+void FilterWidget::setMode(Filter::Mode m)
+{
+    if (m == (Filter::Mode)ui->mComboMode->currentIndex())
+        return;
+    ui->mComboMode->setCurrentIndex(m);
+}
+
 void FilterWidget::on_mSliderStrength_valueChanged(int value)
 {
     ui->mSpinStrength->setValue(value / 100.);
@@ -63,3 +75,9 @@ void FilterWidget::on_mSpinStrength_valueChanged(double arg1)
     if (mEmitSignals)
         emit strengthChanged(arg1);
 }
+
+void FilterWidget::on_mComboMode_currentIndexChanged(int index)
+{
+    if (mEmitSignals)
+        emit modeChanged((Filter::Mode)index);
+}
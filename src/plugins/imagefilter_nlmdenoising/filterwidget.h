@@ -47,13 +47,16 @@ private:
 
 signals:
     void strengthChanged(double s);
+    void modeChanged(Filter::Mode m);
 
 public slots:
     void setStrength(double s);
+    void setMode(Filter::Mode m);
 
 private slots:
     void on_mSliderStrength_valueChanged(int value);
     void on_mSpinStrength_valueChanged(double arg1);
+    void on_mComboMode_currentIndexChanged(int index);
 };
 
 #endif // FILTERWIDGET_H
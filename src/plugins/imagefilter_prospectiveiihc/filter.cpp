@@ -22,16 +22,23 @@
 // SOFTWARE.
 //
 
+#include <QMutexLocker>
+
 #include "filter.h"
 #include "filterwidget.h"
 #include <imgproc/lut.h>
 #include <imgproc/types.h>
 #include <imgproc/colorconversion.h>
+#include <imgproc/util.h>
 #include <misc/util.h>
 
+// most backgrounds kept by a filter, one per target size
+#define MAX_CACHED_BACKGROUNDS 8
+
 Filter::Filter() :
     mImage(),
-    mOutputMode(CorrectedImageMode1)
+    mOutputMode(CorrectedImageMode1),
+    mBackgroundCache(new BackgroundCache)
 {
 }
 
@@ -45,6 +52,7 @@ ImageFilter *Filter::clone()
     Filter * f = new Filter();
     f->mImage = mImage;
     f->mOutputMode = mOutputMode;
+    f->mBackgroundCache = mBackgroundCache;
     return f;
 }
 
@@ -54,6 +62,46 @@ QHash<QString, QString> Filter::info()
     return getIBPPluginInfo();
 }
 
+QSharedPointer<const Filter::Background> Filter::background(int width, int height)
+{
+    const QPair<int, int> size(width, height);
+    QMutexLocker locker(&mBackgroundCache->mutex);
+    QSharedPointer<const Background> cached = mBackgroundCache->backgrounds.value(size);
+    if (cached)
+        return cached;
+
+    // prepared under the lock, so the copies processing a batch do it only once
+    QImage bg = mImage.scaled(width, height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    register int totalPixels = width * height;
+    QVector<HSL> bitsHSLbg(totalPixels);
+    convertBGRToHSL(bg.constBits(), (unsigned char *)bitsHSLbg.data(), totalPixels);
+
+    Background * b = new Background;
+    b->lightness.resize(totalPixels);
+    register const HSL * bitsHSLbgsl = bitsHSLbg.constData();
+    register unsigned char * bitsLightness = b->lightness.data();
+    qint64 sum = 0;
+    while (totalPixels--)
+    {
+        sum += bitsHSLbgsl->l;
+        *bitsLightness = bitsHSLbgsl->l;
+        bitsHSLbgsl++;
+        bitsLightness++;
+    }
+    const int mean = sum / (width * height);
+
+    b->correction.resize(256 * 256);
+    for (register int l = 0; l < 256; l++)
+        for (register int lbg = 0; lbg < 256; lbg++)
+            b->correction[(l << 8) + lbg] = IBP_clamp(0, lut02[l][IBP_clamp(1, lbg, 255)] * mean / 255, 255);
+
+    QSharedPointer<const Background> prepared(b);
+    if (mBackgroundCache->backgrounds.size() >= MAX_CACHED_BACKGROUNDS)
+        mBackgroundCache->backgrounds.clear();
+    mBackgroundCache->backgrounds.insert(size, prepared);
+    return prepared;
+}
+
 QImage Filter::process(const QImage &inputImage)
 {
     if (inputImage.isNull() || inputImage.format() != QImage::Format_ARGB32)
@@ -62,70 +110,54 @@ QImage Filter::process(const QImage &inputImage)
     if (mImage.isNull())
         return inputImage;
 
-    QImage bg = mImage.scaled(inputImage.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-    register int w = inputImage.width(), h = inputImage.height(), totalPixels = w * h;
-    register HSL * bitsHSL = 0, * bitsHSLsl, * bitsHSLbg = 0, * bitsHSLbgsl;
+    const int w = inputImage.width(), h = inputImage.height();
+    QSharedPointer<const Background> bg = background(w, h);
+    QImage i = inputImage.copy();
+    BGRA * bitsI = (BGRA *)i.bits();
+    const OutputMode outputMode = mOutputMode;
 
-    bitsHSL = (HSL *)malloc(w * h * sizeof(HSL));
-    if (!bitsHSL)
-        return inputImage;
-    bitsHSLbg = (HSL *)malloc(w * h * sizeof(HSL));
-    if (!bitsHSLbg)
+    // only the input is converted, in chunks of rows
+    parallelForRows(h, IBP_maximum(1, 16384 / w), [&](int startRow, int endRow)
     {
-        free(bitsHSL);
-        return inputImage;
-    }
-    convertBGRToHSL(inputImage.bits(), (unsigned char *)bitsHSL, w * h);
-    convertBGRToHSL(bg.bits(), (unsigned char *)bitsHSLbg, w * h);
+        register int totalPixels = (endRow - startRow) * w;
+        register const unsigned char * bitsLightness = bg->lightness.constData() + startRow * w;
+        register BGRA * bits = bitsI + startRow * w;
 
-    bitsHSLbgsl = bitsHSLbg;
-    bitsHSLsl = bitsHSL;
-    totalPixels = w * h;
-    if (mOutputMode == CorrectedImageMode1)
-    {
-        register int mean = 0;
-        bitsHSLbgsl = bitsHSLbg;
-        totalPixels = w * h;
-        while (totalPixels--)
+        if (outputMode == IIHCorrectionModel)
         {
-            mean += bitsHSLbgsl->l;
-            bitsHSLbgsl++;
+            while (totalPixels--)
+            {
+                bits->b = bits->g = bits->r = *bitsLightness;
+                bits++;
+                bitsLightness++;
+            }
+            return;
         }
-        mean /= w * h;
 
-        bitsHSLbgsl = bitsHSLbg;
-        totalPixels = w * h;
-        while (totalPixels--)
+        QVector<HSL> bitsHSL(totalPixels);
+        register HSL * bitsHSLsl = bitsHSL.data();
+        convertBGRToHSL((const unsigned char *)bits, (unsigned char *)bitsHSLsl, totalPixels);
+        if (outputMode == CorrectedImageMode1)
         {
-            bitsHSLsl->l = IBP_clamp(0, lut02[bitsHSLsl->l][IBP_clamp(1, bitsHSLbgsl->l, 255)] * mean / 255, 255);
-            bitsHSLsl++;
-            bitsHSLbgsl++;
+            register const unsigned char * correction = bg->correction.constData();
+            while (totalPixels--)
+            {
+                bitsHSLsl->l = correction[(bitsHSLsl->l << 8) + *bitsLightness];
+                bitsHSLsl++;
+                bitsLightness++;
+            }
         }
-    }
-    else if (mOutputMode == CorrectedImageMode2)
-    {
-        while (totalPixels--)
+        else
         {
-            bitsHSLsl->l = IBP_clamp(0, lut02[bitsHSLsl->l][IBP_clamp(1, bitsHSLbgsl->l, 255)], 255);
-            bitsHSLsl++;
-            bitsHSLbgsl++;
+            while (totalPixels--)
+            {
+                bitsHSLsl->l = IBP_clamp(0, lut02[bitsHSLsl->l][IBP_clamp(1, *bitsLightness, 255)], 255);
+                bitsHSLsl++;
+                bitsLightness++;
+            }
         }
-    }
-    else
-    {
-        while (totalPixels--)
-        {
-            bitsHSLsl->h = bitsHSLsl->s = 0;
-            bitsHSLsl->l = bitsHSLbgsl->l;
-            bitsHSLsl++;
-            bitsHSLbgsl++;
-        }
-    }
-
-    QImage i = inputImage.copy();
-    convertHSLToBGR((unsigned char *)bitsHSL, i.bits(), w * h);
-    free(bitsHSL);
-    free(bitsHSLbg);
+        convertHSLToBGR((const unsigned char *)bitsHSL.constData(), (unsigned char *)bits, bitsHSL.size());
+    });
 
     return i;
 }
@@ -184,6 +216,8 @@ void Filter::setImage(const QImage &i)
         mImage = i.convertToFormat(QImage::Format_ARGB32);
     else
         mImage = i;
+    // the copies still running keep the backgrounds of the previous image
+    mBackgroundCache = QSharedPointer<BackgroundCache>(new BackgroundCache);
     emit imageChanged(i);
     emit parametersChanged();
 }
@@ -27,6 +27,10 @@
 
 #include <QObject>
 #include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QSharedPointer>
+#include <QVector>
 #include <QString>
 #include <QImage>
 #include <QSettings>
@@ -58,8 +62,26 @@ public:
     QWidget * widget(QWidget *parent = 0);
 
 private:
+    // Lightness of the image scaled to one target size
+    struct Background
+    {
+        QVector<unsigned char> lightness;
+        // corrected lightness for CorrectedImageMode1, [input lightness][background lightness]
+        QVector<unsigned char> correction;
+    };
+
+    // Backgrounds prepared for every target size, shared by the copies of the filter until the image changes
+    struct BackgroundCache
+    {
+        QMutex mutex;
+        QHash<QPair<int, int>, QSharedPointer<const Background> > backgrounds;
+    };
+
+    QSharedPointer<const Background> background(int width, int height);
+
     QImage mImage;
     OutputMode mOutputMode;
+    QSharedPointer<BackgroundCache> mBackgroundCache;
 
 signals:
     void imageChanged(const QImage & i);
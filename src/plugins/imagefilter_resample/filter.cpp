@@ -27,6 +27,7 @@
 #include "filter.h"
 #include "filterwidget.h"
 #include <imgproc/types.h>
+#include <imgproc/resampling.h>
 
 Filter::Filter() :
     mWidth(100),
@@ -66,7 +67,6 @@ QImage Filter::process(const QImage &inputImage)
 
     cv::Mat srcM(inputImage.height(), inputImage.width(), CV_8UC4,
                  (void *)inputImage.bits(), inputImage.bytesPerLine());
-    cv::Mat dstM;
     int width = 0, height = 0;
 
     if (mWidthMode == Percent)
@@ -90,15 +90,16 @@ QImage Filter::process(const QImage &inputImage)
     if (height < 1)
         height = 1;
 
-    cv::resize(srcM, dstM, cv::Size(width, height), 0, 0, mResamplingMode == NearestNeighbor ? cv::INTER_NEAREST :
-                                                          mResamplingMode == Bilinear ? cv::INTER_LINEAR :
-                                                          mResamplingMode == Bicubic ? cv::INTER_CUBIC :
-                                                                                       cv::INTER_LANCZOS4);
-
+    // resized straight into the bits of the output image
     QImage i(width, height, QImage::Format_ARGB32);
+    cv::Mat dstM(height, width, CV_8UC4, i.bits(), i.bytesPerLine());
 
-    for (int y = 0; y < height; y++)
-        memcpy(i.scanLine(y), dstM.row(y).data, i.bytesPerLine());
+    if (mResamplingMode == Lanczos)
+        lanczosResize(srcM, dstM, cv::Size(width, height));
+    else
+        cv::resize(srcM, dstM, cv::Size(width, height), 0, 0, mResamplingMode == NearestNeighbor ? cv::INTER_NEAREST :
+                                                              mResamplingMode == Bilinear ? cv::INTER_LINEAR :
+                                                                                            cv::INTER_CUBIC);
 
     return i;
 }
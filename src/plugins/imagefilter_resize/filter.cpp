@@ -22,11 +22,13 @@
 // SOFTWARE.
 //
 
-#include <QPainter>
+#include <algorithm>
+#include <string.h>
 
 #include "filter.h"
 #include "filterwidget.h"
 #include <imgproc/types.h>
+#include <imgproc/util.h>
 
 Filter::Filter() :
     mWidth(100),
@@ -136,10 +138,29 @@ QImage Filter::process(const QImage &inputImage)
     else
         offsetY = height - inputImage.height();
 
-    i.fill(mBackgroundColor);
-    QPainter p(&i);
-    p.setCompositionMode(QPainter::CompositionMode_Source);
-    p.drawImage(offsetX, offsetY, inputImage);
+    // the source is copied as is, so every row is the background around the part of an input row it shows
+    const QRgb background = mBackgroundColor.rgba();
+    const QRect visible = QRect(offsetX, offsetY, inputImage.width(), inputImage.height()).intersected(i.rect());
+    const QRgb * srcBits = (const QRgb *)inputImage.bits();
+    QRgb * dstBits = (QRgb *)i.bits();
+    const int srcWidth = inputImage.width();
+
+    parallelForRows(height, IBP_maximum(1, 16384 / width), [&](int startRow, int endRow)
+    {
+        for (int y = startRow; y < endRow; y++)
+        {
+            QRgb * row = dstBits + y * width;
+            if (y < visible.top() || y > visible.bottom())
+            {
+                std::fill(row, row + width, background);
+                continue;
+            }
+            std::fill(row, row + visible.left(), background);
+            memcpy(row + visible.left(), srcBits + (y - offsetY) * srcWidth + visible.left() - offsetX,
+                   visible.width() * sizeof(QRgb));
+            std::fill(row + visible.left() + visible.width(), row + width, background);
+        }
+    });
 
     return i;
 }
@@ -24,13 +24,17 @@
 
 #include <opencv2/imgproc.hpp>
 #include <Eigen/Dense>
+#include <Eigen/StdVector>
 #include <limits>
+#include <vector>
 
 #include "filter.h"
 #include "filterwidget.h"
 #include <imgproc/lut.h>
 #include <imgproc/types.h>
 #include <imgproc/colorconversion.h>
+#include <imgproc/biasfieldcache.h>
+#include <imgproc/util.h>
 #include <misc/util.h>
 
 #define MAX_IMAGE_SIZE 128
@@ -41,7 +45,9 @@
 #define BLURKERNELSIZE 5
 
 Filter::Filter() :
-    mOutputMode(CorrectedImageMode1)
+    mOutputMode(CorrectedImageMode1),
+    mFieldReuseFrames(0),
+    mBiasFieldCache(new BiasFieldCache)
 {
 }
 
@@ -53,6 +59,8 @@ ImageFilter *Filter::clone()
 {
     Filter * f = new Filter();
     f->mOutputMode = mOutputMode;
+    f->mFieldReuseFrames = mFieldReuseFrames;
+    f->mBiasFieldCache = mBiasFieldCache;
     return f;
 }
 
@@ -72,201 +80,233 @@ QImage Filter::process(const QImage &inputImage)
     cv::Mat mlchannel(h, w, CV_8UC1);
     register unsigned char * mbits8;
     register double * mbits321, * mbits322;
-    register double weight;
 
     // Convert to HSL
     convertBGRToHSL(inputImage.bits(), (unsigned char *)bitsHSL, w * h);
 
-    // Separate L channel
-    for (y = 0; y < h; y++)
+    // Estimate the illumination field, unless the batch already shares one for images of this size
+    if (mFieldReuseFrames > 0 && mBiasFieldCache->find(cv::Size(w, h), mlchannel))
+        mean = (int)cv::mean(mlchannel)[0];
+    else
     {
-        bitsHSLsl = bitsHSL + y * w;
-        mbits8 = mlchannel.ptr(y);
-        for (x = 0; x < w; x++)
+        // Separate L channel
+        for (y = 0; y < h; y++)
         {
-            *mbits8 = bitsHSLsl->l;
-            bitsHSLsl++;
-            mbits8++;
+            bitsHSLsl = bitsHSL + y * w;
+            mbits8 = mlchannel.ptr(y);
+            for (x = 0; x < w; x++)
+            {
+                *mbits8 = bitsHSLsl->l;
+                bitsHSLsl++;
+                mbits8++;
+            }
         }
-    }
 
-    // Resample
-    cv::Mat mInitial;
-    if (w != MAX_IMAGE_SIZE || h != MAX_IMAGE_SIZE)
-    {
-        if (w > h)
+        // Resample
+        cv::Mat mInitial;
+        if (w != MAX_IMAGE_SIZE || h != MAX_IMAGE_SIZE)
         {
-            sw = MAX_IMAGE_SIZE;
-            sh = h * MAX_IMAGE_SIZE / w;
+            if (w > h)
+            {
+                sw = MAX_IMAGE_SIZE;
+                sh = h * MAX_IMAGE_SIZE / w;
+            }
+            else
+            {
+                sh = MAX_IMAGE_SIZE;
+                sw = w * MAX_IMAGE_SIZE / h;
+            }
+            sw = sw < 1 ? 1 : sw;
+            sh = sh < 1 ? 1 : sh;
+
+            cv::Mat mresized(sh, sw, CV_8UC1);
+            cv::resize(mlchannel, mresized, cv::Size(sw, sh), 0, 0, cv::INTER_CUBIC);
+            mInitial = mresized;
         }
         else
         {
-            sh = MAX_IMAGE_SIZE;
-            sw = w * MAX_IMAGE_SIZE / h;
+            sw = w;
+            sh = h;
+            mInitial = mlchannel;
         }
-        sw = sw < 1 ? 1 : sw;
-        sh = sh < 1 ? 1 : sh;
 
-        cv::Mat mresized(sh, sw, CV_8UC1);
-        cv::resize(mlchannel, mresized, cv::Size(sw, sh), 0, 0, cv::INTER_CUBIC);
-        mInitial = mresized;
-    }
-    else
-    {
-        sw = w;
-        sh = h;
-        mInitial = mlchannel;
-    }
-
-    // Remove noise
-    cv::Mat mMatUChar(sh, sw, CV_8UC1);
-    cv::GaussianBlur(mInitial, mMatUChar, cv::Size(BLURKERNELSIZE, BLURKERNELSIZE), 0);
+        // Remove noise
+        cv::Mat mMatUChar(sh, sw, CV_8UC1);
+        cv::GaussianBlur(mInitial, mMatUChar, cv::Size(BLURKERNELSIZE, BLURKERNELSIZE), 0);
 
-    // Convert to float and scale
-    cv::Mat mMatDouble(sh, sw, CV_64FC1);
-    for (y = 0; y < sh; y++)
-    {
-        mbits8 = mMatUChar.ptr(y);
-        mbits321 = (double *)mMatDouble.ptr(y);
-        for (x = 0; x < sw; x++)
+        // Convert to float and scale
+        cv::Mat mMatDouble(sh, sw, CV_64FC1);
+        for (y = 0; y < sh; y++)
         {
-            *mbits321 = (*mbits8) / 255.;
-            mbits8++;
-            mbits321++;
+            mbits8 = mMatUChar.ptr(y);
+            mbits321 = (double *)mMatDouble.ptr(y);
+            for (x = 0; x < sw; x++)
+            {
+                *mbits321 = (*mbits8) / 255.;
+                mbits8++;
+                mbits321++;
+            }
         }
-    }
 
-    // Get the gradient of the blurred image
-    cv::Mat mGradientX(sh, sw, CV_64FC1);
-    cv::Mat mGradientY(sh, sw, CV_64FC1);
-    cv::Sobel(mMatDouble, mGradientX, -1, 1, 0);
-    cv::Sobel(mMatDouble, mGradientY, -1, 0, 1);
+        // Get the gradient of the blurred image
+        cv::Mat mGradientX(sh, sw, CV_64FC1);
+        cv::Mat mGradientY(sh, sw, CV_64FC1);
+        cv::Sobel(mMatDouble, mGradientX, -1, 1, 0);
+        cv::Sobel(mMatDouble, mGradientY, -1, 0, 1);
 
-    // Calculate weights
-    register int row = 0, column = 0, totalPixels = sw * sh;
-    Eigen::DiagonalMatrix<float, Eigen::Dynamic> ls_W(totalPixels * 2);
-    for (y = 0; y < sh; y++)
-    {
-        mbits321 = (double *)mGradientX.ptr(y);
-        mbits322 = (double *)mGradientY.ptr(y);
-        for (x = 0; x < sw; x++)
+        // Monomial terms as the fit has always used them, x^k for x > 0 and 1 for x = 0, built by products
+        register int totalPixels = sw * sh;
+        cv::Mat mPowers(IBP_maximum(sw, sh), DEGREE + 1, CV_64FC1);
+        for (i = 0; i < mPowers.rows; i++)
         {
-            weight = sqrt(exp(-sqrt((*mbits321) * (*mbits321) + (*mbits322) * (*mbits322)) / MIUSQR));
-            ls_W.diagonal()[row] = ls_W.diagonal()[row + totalPixels] = weight;
-            row++;
-            mbits321++;
-            mbits322++;
+            mbits321 = (double *)mPowers.ptr(i);
+            mbits321[0] = 1.;
+            for (j = 1; j <= DEGREE; j++)
+                mbits321[j] = i == 0 ? 1. : mbits321[j - 1] * i;
         }
-    }
-
-    // Surface fitting using eigen
-    // First set up the matrix A and the vector b for least squares fitting with the gradient image
-    row = 0;
-    column = 0;
-    Eigen::MatrixXf ls_A(totalPixels * 2, MATRIXCOLUMNS);
-    Eigen::VectorXf ls_b(totalPixels * 2);
-    Eigen::VectorXf ls_x;
 
-    for (y = 0; y < sh; y++)
-    {
-        mbits321 = (double *)mGradientX.ptr(y);
-        mbits322 = (double *)mGradientY.ptr(y);
-        for (x = 0; x < sw; x++)
+        // Surface fitting using eigen
+        // Weighted least squares fit of the gradient of the polynomial surface to the gradient of the image. The
+        // normal equations are accumulated for every row in parallel and added in order, so the result does not
+        // depend on the number of threads
+        typedef Eigen::Matrix<double, MATRIXCOLUMNS, MATRIXCOLUMNS> NormalMatrix;
+        typedef Eigen::Matrix<double, MATRIXCOLUMNS, 1> NormalVector;
+        std::vector<NormalMatrix, Eigen::aligned_allocator<NormalMatrix> > rowsAtA(sh);
+        std::vector<NormalVector, Eigen::aligned_allocator<NormalVector> > rowsAtb(sh);
+        parallelForRows(sh, 1, [&](int startRow, int endRow)
         {
-            column = 0;
-            // Fill matrix A with the monomial terms of the polynomial surface
-            for (i = 1; i <= DEGREE; i++)
+            NormalVector ax, ay;
+            for (int y = startRow; y < endRow; y++)
             {
-                for (j = 0; j <= i; j++)
+                const double * py = (const double *)mPowers.ptr(y);
+                const double * gx = (const double *)mGradientX.ptr(y), * gy = (const double *)mGradientY.ptr(y);
+                NormalMatrix & AtA = rowsAtA[y];
+                NormalVector & Atb = rowsAtb[y];
+                AtA.setZero();
+                Atb.setZero();
+                for (int x = 0; x < sw; x++)
                 {
-                    ls_A(row, column) = (i - j) * (x == 0 ? 1 : pow(x, i - j - 1)) * (y == 0 ? 1 : pow(y, j));
-                    ls_A(row + totalPixels, column) = j * (x == 0 ? 1 : pow(x, i - j)) * (y == 0 ? 1 : pow(y, j - 1));
-
-                    column++;
+                    const double * px = (const double *)mPowers.ptr(x);
+                    // square of the weight of every equation
+                    const double weight = exp(-sqrt(gx[x] * gx[x] + gy[x] * gy[x]) / MIUSQR);
+                    int column = 0;
+                    for (int i = 1; i <= DEGREE; i++)
+                    {
+                        for (int j = 0; j <= i; j++)
+                        {
+                            ax(column) = i > j ? (i - j) * px[i - j - 1] * py[j] : 0.;
+                            ay(column) = j > 0 ? j * px[i - j] * py[j - 1] : 0.;
+                            column++;
+                        }
+                    }
+                    AtA.noalias() += weight * (ax * ax.transpose() + ay * ay.transpose());
+                    Atb.noalias() += weight * (gx[x] * ax + gy[x] * ay);
                 }
             }
-            // Fill vector b with the image gradient values
-            ls_b(row) = *mbits321;
-            ls_b(row + totalPixels) = *mbits322;
+        });
 
-            mbits321++;
-            mbits322++;
-            row++;
+        // Solve the small system, with the columns scaled to unit norm because the monomials differ by orders of
+        // magnitude
+        NormalMatrix AtA = NormalMatrix::Zero();
+        NormalVector Atb = NormalVector::Zero();
+        for (y = 0; y < sh; y++)
+        {
+            AtA += rowsAtA[y];
+            Atb += rowsAtb[y];
         }
-    }
-    // Solve...
-    ls_x = (ls_W * ls_A).jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(ls_W * ls_b);
-
-    // Set up the matrix A and the vector b for least squares fitting with the blurred image
-    ls_A = Eigen::MatrixXf(totalPixels, 2);
-    ls_b = Eigen::VectorXf(totalPixels);
-    ls_W.diagonal().conservativeResize(totalPixels);
-    register double value;
-    row = 0;
-    for (y = 0; y < sh; y++)
-    {
-        mbits321 = (double *)mMatDouble.ptr(y);
-        for (x = 0; x < sw; x++)
+        NormalVector scale = AtA.diagonal().cwiseSqrt();
+        for (i = 0; i < MATRIXCOLUMNS; i++)
+            if (scale(i) == 0.)
+                scale(i) = 1.;
+        const NormalMatrix scaledAtA = AtA.cwiseQuotient(scale * scale.transpose());
+        const NormalVector ls_x = scaledAtA.jacobiSvd(Eigen::ComputeFullU | Eigen::ComputeFullV).
+                                  solve(Atb.cwiseQuotient(scale)).cwiseQuotient(scale);
+
+        // Evaluate the surface and fit it to the blurred image, value * a + b, the same way
+        cv::Mat mSurface(sh, sw, CV_64FC1);
+        std::vector<Eigen::Matrix2d, Eigen::aligned_allocator<Eigen::Matrix2d> > rowsAtA2(sh);
+        std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > rowsAtb2(sh);
+        parallelForRows(sh, 1, [&](int startRow, int endRow)
         {
-            column = 0;
-            value = 0.;
-            for (i = 1; i <= DEGREE; i++)
+            for (int y = startRow; y < endRow; y++)
             {
-                for (j = 0; j <= i; j++)
+                const double * py = (const double *)mPowers.ptr(y), * image = (const double *)mMatDouble.ptr(y);
+                const double * gx = (const double *)mGradientX.ptr(y), * gy = (const double *)mGradientY.ptr(y);
+                double * surface = (double *)mSurface.ptr(y);
+                Eigen::Matrix2d & AtA2 = rowsAtA2[y];
+                Eigen::Vector2d & Atb2 = rowsAtb2[y];
+                AtA2.setZero();
+                Atb2.setZero();
+                for (int x = 0; x < sw; x++)
                 {
-                    value += ls_x(column) * (x == 0 ? 1 : pow(x, i - j)) * (y == 0 ? 1 : pow(y, j));
-                    column++;
+                    const double * px = (const double *)mPowers.ptr(x);
+                    const double weight = exp(-sqrt(gx[x] * gx[x] + gy[x] * gy[x]) / MIUSQR);
+                    double value = 0.;
+                    int column = 0;
+                    for (int i = 1; i <= DEGREE; i++)
+                        for (int j = 0; j <= i; j++)
+                            value += ls_x(column++) * px[i - j] * py[j];
+                    surface[x] = value;
+                    AtA2(0, 0) += weight * value * value;
+                    AtA2(0, 1) += weight * value;
+                    AtA2(1, 1) += weight;
+                    Atb2(0) += weight * value * image[x];
+                    Atb2(1) += weight * image[x];
                 }
+                AtA2(1, 0) = AtA2(0, 1);
             }
-            ls_A(row, 0) = value;
-            ls_A(row, 1) = 1;
-            ls_b(row) = *mbits321;
-
-            mbits321++;
-            row++;
+        });
+        Eigen::Matrix2d AtA2 = Eigen::Matrix2d::Zero();
+        Eigen::Vector2d Atb2 = Eigen::Vector2d::Zero();
+        for (y = 0; y < sh; y++)
+        {
+            AtA2 += rowsAtA2[y];
+            Atb2 += rowsAtb2[y];
         }
-    }
-    // Solve...
-    ls_x = (ls_W * ls_A).jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(ls_W * ls_b);
+        const Eigen::Vector2d ls_x2 = AtA2.jacobiSvd(Eigen::ComputeFullU | Eigen::ComputeFullV).solve(Atb2);
 
-    // Create the IIH model image
-    row = 0;
-    for (y = 0; y < sh; y++)
-    {
-        mbits321 = (double *)mMatDouble.ptr(y);
-        for (x = 0; x < sw; x++)
+        // Create the IIH model image
+        for (y = 0; y < sh; y++)
         {
-            *mbits321 = ls_A(row, 0) * ls_x(0) + ls_x(1);
+            mbits321 = (double *)mMatDouble.ptr(y);
+            mbits322 = (double *)mSurface.ptr(y);
+            for (x = 0; x < sw; x++)
+            {
+                *mbits321 = (*mbits322) * ls_x2(0) + ls_x2(1);
 
-            mbits321++;
-            row++;
+                mbits321++;
+                mbits322++;
+            }
         }
-    }
 
-    // Remap due to out of range values and scale
-    double minIIH, maxIIH, minIIHc, maxIIHc;
-    cv::minMaxLoc(mMatDouble, &minIIH, &maxIIH);
-    minIIHc = IBP_clamp(0., minIIH, 1.);
-    maxIIHc = IBP_clamp(0., maxIIH, 1.);
-    for (y = 0; y < sh; y++)
-    {
-        mbits321 = (double *)mMatDouble.ptr(y);
-        mbits8 = mMatUChar.ptr(y);
-        for (x = 0; x < sw; x++)
+        // Remap due to out of range values and scale
+        double minIIH, maxIIH, minIIHc, maxIIHc;
+        cv::minMaxLoc(mMatDouble, &minIIH, &maxIIH);
+        minIIHc = IBP_clamp(0., minIIH, 1.);
+        maxIIHc = IBP_clamp(0., maxIIH, 1.);
+        for (y = 0; y < sh; y++)
         {
-            *mbits8 = round((minIIHc + ((*mbits321) - minIIH) * (maxIIHc - minIIHc) / (maxIIH - minIIH)) * 255.);
-            mean += *mbits8;
-            mbits8++;
-            mbits321++;
+            mbits321 = (double *)mMatDouble.ptr(y);
+            mbits8 = mMatUChar.ptr(y);
+            for (x = 0; x < sw; x++)
+            {
+                *mbits8 = round((minIIHc + ((*mbits321) - minIIH) * (maxIIHc - minIIHc) / (maxIIH - minIIH)) * 255.);
+                mean += *mbits8;
+                mbits8++;
+                mbits321++;
+            }
         }
-    }
-    mean /= totalPixels;
+        mean /= totalPixels;
 
-    // Resample
-    if (w != sw || h != sh)
-        cv::resize(mMatUChar, mlchannel, cv::Size(w, h), 0, 0, cv::INTER_CUBIC);
-    else
-        mlchannel = mMatUChar;
+        // Resample
+        if (w != sw || h != sh)
+            cv::resize(mMatUChar, mlchannel, cv::Size(w, h), 0, 0, cv::INTER_CUBIC);
+        else
+            mlchannel = mMatUChar;
+
+        if (mFieldReuseFrames > 0)
+            mBiasFieldCache->add(mlchannel, mFieldReuseFrames);
+    }
 
     // Make output image
     if (mOutputMode == CorrectedImageMode1)
@@ -327,6 +367,8 @@ bool Filter::loadParameters(QSettings &s)
 {
     QString outputModeStr;
     OutputMode outputMode;
+    int fieldReuseFrames;
+    bool ok;
 
     outputModeStr = s.value("outputmode", "correctedimagemode1").toString();
     if (outputModeStr == "correctedimagemode1")
@@ -338,7 +380,12 @@ bool Filter::loadParameters(QSettings &s)
     else
         return false;
 
+    fieldReuseFrames = s.value("fieldreuseframes", 0).toInt(&ok);
+    if (!ok || fieldReuseFrames < 0 || fieldReuseFrames > 15)
+        return false;
+
     setOutputMode(outputMode);
+    setFieldReuseFrames(fieldReuseFrames);
 
     return true;
 }
@@ -347,6 +394,7 @@ bool Filter::saveParameters(QSettings &s)
 {
     s.setValue("outputmode", mOutputMode == CorrectedImageMode1 ? "correctedimagemode1" :
                              mOutputMode == CorrectedImageMode2 ? "correctedimagemode2" : "iihcorrectionmodel");
+    s.setValue("fieldreuseframes", mFieldReuseFrames);
     return true;
 }
 
@@ -354,8 +402,11 @@ QWidget *Filter::widget(QWidget *parent)
 {
     FilterWidget * fw = new FilterWidget(parent);
     fw->setOutputMode(mOutputMode);
+    fw->setFieldReuseFrames(mFieldReuseFrames);
     connect(this, SIGNAL(outputModeChanged(Filter::OutputMode)), fw, SLOT(setOutputMode(Filter::OutputMode)));
+    connect(this, SIGNAL(fieldReuseFramesChanged(int)), fw, SLOT(setFieldReuseFrames(int)));
     connect(fw, SIGNAL(outputModeChanged(Filter::OutputMode)), this, SLOT(setOutputMode(Filter::OutputMode)));
+    connect(fw, SIGNAL(fieldReuseFramesChanged(int)), this, SLOT(setFieldReuseFrames(int)));
     return fw;
 }
 
@@ -367,3 +418,13 @@ void Filter::setOutputMode(Filter::OutputMode om)
     emit outputModeChanged(om);
     emit parametersChanged();
 }
+
+void Filter::setFieldReuseFrames(int n)
+{
+    if (n == mFieldReuseFrames)
+        return;
+    mFieldReuseFrames = n;
+    mBiasFieldCache = QSharedPointer<BiasFieldCache>(new BiasFieldCache);
+    emit fieldReuseFramesChanged(n);
+    emit parametersChanged();
+}
@@ -57,6 +57,16 @@ void FilterWidget::setOutputMode(Filter::OutputMode om)
     emit outputModeChanged(om);
 }
 
+void FilterWidget::setFieldReuseFrames(int n)
+{
+    if (ui->mSpinFieldReuseFrames->value() == n)
+        return;
+    mEmitSignals = false;
+    ui->mSpinFieldReuseFrames->setValue(n);
+    mEmitSignals = true;
+    emit fieldReuseFramesChanged(n);
+}
+
 void FilterWidget::on_mButtonOutputModeCorrectedImageMode1_toggled(bool c)
 {
     if (!c)
@@ -80,3 +90,9 @@ void FilterWidget::on_mButtonOutputModeIIHCorrectionModel_toggled(bool c)
     if (mEmitSignals)
         emit outputModeChanged(Filter::IIHCorrectionModel);
 }
+
+void FilterWidget::on_mSpinFieldReuseFrames_valueChanged(int arg1)
+{
+    if (mEmitSignals)
+        emit fieldReuseFramesChanged(arg1);
+}
@@ -47,14 +47,17 @@ private:
 
 signals:
     void outputModeChanged(Filter::OutputMode om);
+    void fieldReuseFramesChanged(int n);
 
 public slots:
     void setOutputMode(Filter::OutputMode om);
+    void setFieldReuseFrames(int n);
 
 private slots:
     void on_mButtonOutputModeCorrectedImageMode1_toggled(bool c);
     void on_mButtonOutputModeCorrectedImageMode2_toggled(bool c);
     void on_mButtonOutputModeIIHCorrectionModel_toggled(bool c);
+    void on_mSpinFieldReuseFrames_valueChanged(int arg1);
 };
 
 #endif // FILTERWIDGET_H
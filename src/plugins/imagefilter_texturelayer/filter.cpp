@@ -23,7 +23,10 @@
 //
 
 #include <QRegularExpression>
+#include <QHash>
 #include <QPainter>
+#include <QMutex>
+#include <QMutexLocker>
 
 #include "filter.h"
 #include "filterwidget.h"
@@ -31,11 +34,78 @@
 #include <imgproc/pixelblending.h>
 #include <imgproc/lut.h>
 
+// rows of the texture painted by each thread
+#define TEXTURE_STRIP_HEIGHT 64
+// bytes of the textures kept, the least recently used dropped first
+#define MAX_CACHED_TEXTURE_BYTES ((qint64)256 << 20)
+
+struct Filter::TextureCache
+{
+    QMutex mutex;
+    QHash<QPair<int, int>, QImage> textures;
+    // sizes from the least to the most recently used
+    QList<QPair<int, int> > order;
+    qint64 bytes;
+
+    TextureCache() : bytes(0) {}
+};
+
+QImage Filter::texture(const QTransform & tfm, int width, int height)
+{
+    // the copies still running keep the cache of the previous texture
+    const QSharedPointer<TextureCache> cache = mTextureCache;
+    const QPair<int, int> size = qMakePair(width, height);
+    {
+        QMutexLocker locker(&cache->mutex);
+        QHash<QPair<int, int>, QImage>::const_iterator i = cache->textures.constFind(size);
+        if (i != cache->textures.constEnd())
+        {
+            cache->order.removeOne(size);
+            cache->order.append(size);
+            return i.value();
+        }
+    }
+
+    // every strip is painted on its own, with the brush origin moved so the strips line up
+    QImage texture(width, height, QImage::Format_ARGB32);
+    QBrush brush(mImage);
+    brush.setTransform(tfm);
+    uchar * bits = texture.bits();
+    const int bytesPerLine = texture.bytesPerLine();
+    parallelForRows(height, TEXTURE_STRIP_HEIGHT, [&](int startRow, int endRow)
+    {
+        QImage strip(bits + startRow * bytesPerLine, width, endRow - startRow, bytesPerLine, QImage::Format_ARGB32);
+        QPainter p(&strip);
+        p.setRenderHint(QPainter::Antialiasing);
+        p.setRenderHint(QPainter::SmoothPixmapTransform);
+        p.setBrushOrigin(width >> 1, (height >> 1) - startRow);
+        p.fillRect(strip.rect(), brush);
+    });
+
+    const qint64 textureBytes = (qint64)bytesPerLine * height;
+    if (textureBytes > MAX_CACHED_TEXTURE_BYTES)
+        return texture;
+    QMutexLocker locker(&cache->mutex);
+    // another copy may have painted it meanwhile
+    if (cache->textures.contains(size))
+        return cache->textures.value(size);
+    while (cache->bytes + textureBytes > MAX_CACHED_TEXTURE_BYTES)
+    {
+        const QImage evicted = cache->textures.take(cache->order.takeFirst());
+        cache->bytes -= (qint64)evicted.bytesPerLine() * evicted.height();
+    }
+    cache->textures.insert(size, texture);
+    cache->order.append(size);
+    cache->bytes += textureBytes;
+    return texture;
+}
+
 Filter::Filter() :
     mImage(),
     mPosition(Front),
     mColorCompositionMode(ColorCompositionMode_Normal),
-    mOpacity(100)
+    mOpacity(100),
+    mTextureCache(new TextureCache)
 {
 }
 
@@ -53,6 +123,7 @@ ImageFilter *Filter::clone()
     f->mOpacity = mOpacity;
     f->mTransformations = mTransformations;
     f->mBypasses = mBypasses;
+    f->mTextureCache = mTextureCache;
     return f;
 }
 
@@ -68,10 +139,7 @@ QImage Filter::process(const QImage &inputImage)
         return inputImage;
 
     // Create texture
-    QImage texture(inputImage.width(), inputImage.height(), QImage::Format_ARGB32);
-    QBrush brush(mImage);
     QTransform tfm;
-    QPainter p(&texture);
     for (int i = mTransformations.size() - 1; i >= 0; i--)
     {
         if (mTransformations.at(i).type == Translation)
@@ -84,23 +152,22 @@ QImage Filter::process(const QImage &inputImage)
             tfm.shear(mTransformations.at(i).x / 100., mTransformations.at(i).y / 100.);
     }
     tfm.translate(-mImage.width() / 2, -mImage.height() / 2);
-    brush.setTransform(tfm);
-    p.setRenderHint(QPainter::Antialiasing);
-    p.setRenderHint(QPainter::SmoothPixmapTransform);
-    p.setBrushOrigin(inputImage.width() >> 1, inputImage.height() >> 1);
-    p.fillRect(texture.rect(), brush);
+    const QImage texture = this->texture(tfm, inputImage.width(), inputImage.height());
 
-    // Paint Texture
+    // Paint Texture, the cached texture is only read
     QImage i = QImage(inputImage.width(), inputImage.height(), QImage::Format_ARGB32);
-    register BGRA * src = (BGRA *)texture.bits(), * dst = (BGRA *)inputImage.bits(), * blend = (BGRA *)i.bits();
+    register const BGRA * src = (const BGRA *)texture.constBits();
+    register BGRA * dst = (BGRA *)inputImage.bits(), * blend = (BGRA *)i.bits();
     register int totalPixels = i.width() * i.height();
     const int opacity = qRound(mOpacity * 255 / 100.);
+    BGRA s;
     if (mPosition == Front)
     {
         while (totalPixels--)
         {
-            src->a = lut01[src->a][opacity];
-            blendColors[mColorCompositionMode](*src, *dst, *blend);
+            s = *src;
+            s.a = lut01[s.a][opacity];
+            blendColors[mColorCompositionMode](s, *dst, *blend);
             src++;
             dst++;
             blend++;
@@ -112,8 +179,9 @@ QImage Filter::process(const QImage &inputImage)
         {
             while (totalPixels--)
             {
-                src->a = lut01[src->a][opacity];
-                blendSourceAtopDestination(*src, *dst, *blend);
+                s = *src;
+                s.a = lut01[s.a][opacity];
+                blendSourceAtopDestination(s, *dst, *blend);
                 src++;
                 dst++;
                 blend++;
@@ -123,8 +191,9 @@ QImage Filter::process(const QImage &inputImage)
         {
             while (totalPixels--)
             {
-                src->a = lut01[src->a][opacity];
-                blendColors[mColorCompositionMode](*src, *dst, *blend);
+                s = *src;
+                s.a = lut01[s.a][opacity];
+                blendColors[mColorCompositionMode](s, *dst, *blend);
                 blendSourceAtopDestination(*blend, *dst, *blend);
                 src++;
                 dst++;
@@ -136,8 +205,9 @@ QImage Filter::process(const QImage &inputImage)
     {
         while (totalPixels--)
         {
-            src->a = lut01[src->a][opacity];
-            blendDestinationOverSource(*src, *dst, *blend);
+            s = *src;
+            s.a = lut01[s.a][opacity];
+            blendDestinationOverSource(s, *dst, *blend);
             src++;
             dst++;
             blend++;
@@ -316,6 +386,7 @@ void Filter::setImage(const QImage &i)
     if (i == mImage)
         return;
     mImage = i;
+    mTextureCache = QSharedPointer<TextureCache>(new TextureCache);
     emit imageChanged(i);
     emit parametersChanged();
 }
@@ -353,6 +424,7 @@ void Filter::setTransformations(const QList<AffineTransformation> &t, const QLis
         return;
     mTransformations = t;
     mBypasses = b;
+    mTextureCache = QSharedPointer<TextureCache>(new TextureCache);
     emit transformationsChanged(t, b);
     emit parametersChanged();
 }
@@ -31,6 +31,8 @@
 #include <QImage>
 #include <QSettings>
 #include <QWidget>
+#include <QSharedPointer>
+#include <QTransform>
 
 #include <imgproc/imagefilter.h>
 #include <imgproc/types.h>
@@ -57,12 +59,20 @@ public:
     QWidget * widget(QWidget *parent = 0);
 
 private:
+    // Textures painted for every output size, shared by the copies of the filter until the texture image or its
+    // transformations change, so a batch of images of the same size, or changes of the opacity, position or
+    // composition mode alone, do not paint the texture again
+    struct TextureCache;
+
+    QImage texture(const QTransform & tfm, int width, int height);
+
     QImage mImage;
     Position mPosition;
     ColorCompositionMode mColorCompositionMode;
     int mOpacity;
     QList<AffineTransformation> mTransformations;
     QList<bool> mBypasses;
+    QSharedPointer<TextureCache> mTextureCache;
 
 signals:
     void imageChanged(const QImage & i);
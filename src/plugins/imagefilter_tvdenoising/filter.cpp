@@ -27,11 +27,14 @@
 
 #include "filter.h"
 #include "filterwidget.h"
+#include <imgproc/tvdenoising.h>
+#include <imgproc/util.h>
 #include <misc/util.h>
 
 Filter::Filter() :
     mStrength(0.),
-    mIterations(30)
+    mIterations(30),
+    mMode(SingleScale)
 {
 }
 
@@ -45,6 +48,7 @@ ImageFilter *Filter::clone()
     Filter * f = new Filter();
     f->mStrength = mStrength;
     f->mIterations = mIterations;
+    f->mMode = mMode;
     return f;
 }
 
@@ -72,23 +76,34 @@ QImage Filter::process(const QImage &inputImage)
     cv::Mat mRedDenoised, mGreenDenoised, mBlueDenoised;
     double lambda = pow(IBP_maximum(100. - mStrength, .001) / 100., 3) * 10.;
     int fromTo[] = { 0, 0, 1, 1, 2, 2, 3, 3 };
+    const Mode mode = mMode;
+    const int iterations = mIterations;
 
     // split the image channels
     cv::Mat mOutSplit[] = { mBlue, mGreen, mRed, mAlpha };
     cv::mixChannels(&mSrc, 1, mOutSplit, 4, fromTo, 4);
 
-    // denoise
-    std::vector<cv::Mat> observations;
-    observations.push_back(mBlue);
-    cv::denoise_TVL1(observations, mBlueDenoised, lambda, mIterations);
-
-    observations.clear();
-    observations.push_back(mGreen);
-    cv::denoise_TVL1(observations, mGreenDenoised, lambda, mIterations);
-
-    observations.clear();
-    observations.push_back(mRed);
-    cv::denoise_TVL1(observations, mRedDenoised, lambda, mIterations);
+    // denoise. denoiseTVL1 runs its rows in parallel, so the multiscale mode takes the channels one after another;
+    // it stops every level early once it has converged, so iterations is only a bound there. cv::denoise_TVL1 is
+    // single threaded, so the single scale mode denoises the channels in parallel
+    const cv::Mat mChannels[] = { mBlue, mGreen, mRed };
+    cv::Mat * mChannelsDenoised[] = { &mBlueDenoised, &mGreenDenoised, &mRedDenoised };
+    if (mode == Multiscale)
+    {
+        for (int c = 0; c < 3; c++)
+            denoiseTVL1(mChannels[c], *mChannelsDenoised[c], lambda, iterations);
+    }
+    else
+    {
+        parallelForRows(3, 1, [&](int startChannel, int endChannel)
+        {
+            for (int c = startChannel; c < endChannel; c++)
+            {
+                std::vector<cv::Mat> observations(1, mChannels[c]);
+                cv::denoise_TVL1(observations, *mChannelsDenoised[c], lambda, iterations);
+            }
+        });
+    }
 
     // merge image channels
     cv::Mat mOutMerge[] = { mBlueDenoised, mGreenDenoised, mRedDenoised, mAlpha };
@@ -101,6 +116,8 @@ bool Filter::loadParameters(QSettings &s)
 {
     double strength;
     int iterations;
+    QString modeStr;
+    Mode mode;
     bool ok;
     strength = s.value("strength", 0.).toDouble(&ok);
     if (!ok || strength < 0 || strength > 100)
@@ -108,8 +125,16 @@ bool Filter::loadParameters(QSettings &s)
     iterations = s.value("iterations", 30).toInt(&ok);
     if (!ok || iterations < 1 || iterations > 100)
         return false;
+    modeStr = s.value("mode", "singlescale").toString();
+    if (modeStr == "singlescale")
+        mode = SingleScale;
+    else if (modeStr == "multiscale")
+        mode = Multiscale;
+    else
+        return false;
     setStrength(strength);
     setIterations(iterations);
+    setMode(mode);
     return true;
 }
 
@@ -117,6 +142,7 @@ bool Filter::saveParameters(QSettings &s)
 {
     s.setValue("strength", mStrength);
     s.setValue("iterations", mIterations);
+    s.setValue("mode", mMode == Multiscale ? "multiscale" : "singlescale");
     return true;
 }
 
@@ -125,10 +151,13 @@ QWidget *Filter::widget(QWidget *parent)
     FilterWidget * fw = new FilterWidget(parent);
     fw->setStrength(mStrength);
     fw->setIterations(mIterations);
+    fw->setMode(mMode);
     connect(this, SIGNAL(strengthChanged(double)), fw, SLOT(setStrength(double)));
     connect(this, SIGNAL(iterationsChanged(int)), fw, SLOT(setIterations(int)));
+    connect(this, SIGNAL(modeChanged(Filter::Mode)), fw, SLOT(setMode(Filter::Mode)));
     connect(fw, SIGNAL(strengthChanged(double)), this, SLOT(setStrength(double)));
     connect(fw, SIGNAL(iterationsChanged(int)), this, SLOT(setIterations(int)));
+    connect(fw, SIGNAL(modeChanged(Filter::Mode)), this, SLOT(setMode(Filter::Mode)));
     return fw;
 }
 
@@ -149,3 +178,12 @@ void Filter::setIterations(int i)
     emit iterationsChanged(i);
     emit parametersChanged();
 }
+
+void Filter::setMode(Filter::Mode m)
+{
+    if (m == mMode)
+        return;
+    mMode = m;
+    emit modeChanged(m);
+    emit parametersChanged();
+}
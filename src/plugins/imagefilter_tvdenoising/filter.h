@@ -41,6 +41,12 @@ class Filter : public ImageFilter
     Q_OBJECT
 
 public:
+    enum Mode
+    {
+        SingleScale,
+        Multiscale
+    };
+
     Filter();
     ~Filter();
     ImageFilter * clone();
@@ -53,14 +59,17 @@ public:
 private:
     double mStrength;
     int mIterations;
+    Mode mMode;
 
 signals:
     void strengthChanged(double s);
     void iterationsChanged(int i);
+    void modeChanged(Filter::Mode m);
 
 public slots:
     void setStrength(double s);
     void setIterations(int i);
+    void setMode(Filter::Mode m);
 };
 
 #endif // FILTER_H
@@ -33,6 +33,11 @@ FilterWidget::FilterWidget(QWidget *parent) :
     mEmitSignals(true)
 {
     ui->setupUi(this);
+
+    ui->mComboMode->addItems(QStringList() <<
+                             tr("Single scale") <<
+                             tr("Multiscale"));
+    ui->mComboMode->setCurrentIndex(0);
 }
 
 FilterWidget::~FilterWidget()
@@ -60,6 +65,13 @@ void FilterWidget::setIterations(int i)
     emit iterationsChanged(i);
 }
 
+void FilterWidget::setMode(Filter::Mode m)
+{
+    if (m == (Filter::Mode)ui->mComboMode->currentIndex())
+        return;
+    ui->mComboMode->setCurrentIndex(m);
+}
+
 void FilterWidget::on_mSliderStrength_valueChanged(int v)
 {
     ui->mSpinStrength->setValue(v / 100.);
@@ -87,3 +99,9 @@ void FilterWidget::on_mSpinIterations_valueChanged(int v)
     if (mEmitSignals)
         emit iterationsChanged(v);
 }
+
+void FilterWidget::on_mComboMode_currentIndexChanged(int index)
+{
+    if (mEmitSignals)
+        emit modeChanged((Filter::Mode)index);
+}
@@ -48,16 +48,19 @@ private:
 signals:
     void strengthChanged(double s);
     void iterationsChanged(int i);
+    void modeChanged(Filter::Mode m);
 
 public slots:
     void setStrength(double s);
     void setIterations(int i);
+    void setMode(Filter::Mode m);
 
 private slots:
     void on_mSliderStrength_valueChanged(int v);
     void on_mSpinStrength_valueChanged(double v);
     void on_mSliderIterations_valueChanged(int v);
     void on_mSpinIterations_valueChanged(int v);
+    void on_mComboMode_currentIndexChanged(int index);
 };
 
 #endif // FILTERWIDGET_H
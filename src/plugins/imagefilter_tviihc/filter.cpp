@@ -37,6 +37,7 @@
 #include <imgproc/lut.h>
 #include <imgproc/types.h>
 #include <imgproc/colorconversion.h>
+#include <imgproc/biasfieldcache.h>
 #include <misc/util.h>
 
 #define MAX_IMAGE_SIZE 256
@@ -70,7 +71,9 @@ Imrect * modified_xy_normf(Imrect *im, double constant, double sigma, double thr
 Filter::Filter() :
     mRefinement(10),
     mSmoothness(10),
-    mOutputMode(CorrectedImageMode1)
+    mOutputMode(CorrectedImageMode1),
+    mFieldReuseFrames(0),
+    mBiasFieldCache(new BiasFieldCache)
 {
 }
 
@@ -84,6 +87,8 @@ ImageFilter *Filter::clone()
     f->mRefinement = mRefinement;
     f->mSmoothness = mSmoothness;
     f->mOutputMode = mOutputMode;
+    f->mFieldReuseFrames = mFieldReuseFrames;
+    f->mBiasFieldCache = mBiasFieldCache;
     return f;
 }
 
@@ -106,141 +111,150 @@ QImage Filter::process(const QImage &inputImage)
     // Convert to HSL
     convertBGRToHSL(inputImage.bits(), (unsigned char *)bitsHSL, w * h);
 
-    // Separate L channel
-    for (y = 0; y < h; y++)
+    // Estimate the illumination field, unless the batch already shares one for images of this size
+    if (mFieldReuseFrames > 0 && mBiasFieldCache->find(cv::Size(w, h), mlchannel))
+        mean = (int)cv::mean(mlchannel)[0];
+    else
     {
-        bitsHSLsl = bitsHSL + y * w;
-        mbits8 = mlchannel.ptr(y);
-        for (x = 0; x < w; x++)
+        // Separate L channel
+        for (y = 0; y < h; y++)
         {
-            *mbits8 = bitsHSLsl->l;
-            bitsHSLsl++;
-            mbits8++;
+            bitsHSLsl = bitsHSL + y * w;
+            mbits8 = mlchannel.ptr(y);
+            for (x = 0; x < w; x++)
+            {
+                *mbits8 = bitsHSLsl->l;
+                bitsHSLsl++;
+                mbits8++;
+            }
         }
-    }
 
-    // Resample
-    cv::Mat mInitial;
-    if (w != MAX_IMAGE_SIZE || h != MAX_IMAGE_SIZE)
-    {
-        if (w > h)
+        // Resample
+        cv::Mat mInitial;
+        if (w != MAX_IMAGE_SIZE || h != MAX_IMAGE_SIZE)
         {
-            sw = MAX_IMAGE_SIZE;
-            sh = h * MAX_IMAGE_SIZE / w;
+            if (w > h)
+            {
+                sw = MAX_IMAGE_SIZE;
+                sh = h * MAX_IMAGE_SIZE / w;
+            }
+            else
+            {
+                sh = MAX_IMAGE_SIZE;
+                sw = w * MAX_IMAGE_SIZE / h;
+            }
+            sw = sw < 1 ? 1 : sw;
+            sh = sh < 1 ? 1 : sh;
+
+            cv::Mat mresized(sh, sw, CV_8UC1);
+            cv::resize(mlchannel, mresized, cv::Size(sw, sh), 0, 0, cv::INTER_CUBIC);
+            mInitial = mresized;
         }
         else
         {
-            sh = MAX_IMAGE_SIZE;
-            sw = w * MAX_IMAGE_SIZE / h;
+            sw = w;
+            sh = h;
+            mInitial = mlchannel;
         }
-        sw = sw < 1 ? 1 : sw;
-        sh = sh < 1 ? 1 : sh;
-
-        cv::Mat mresized(sh, sw, CV_8UC1);
-        cv::resize(mlchannel, mresized, cv::Size(sw, sh), 0, 0, cv::INTER_CUBIC);
-        mInitial = mresized;
-    }
-    else
-    {
-        sw = w;
-        sh = h;
-        mInitial = mlchannel;
-    }
 
-    // ---------------------------
-    // Tina Vision Bias Correction
-    // ---------------------------
+        // ---------------------------
+        // Tina Vision Bias Correction
+        // ---------------------------
 
-    Imrect * tvInitialImage = im_alloc(sh, sw, 0, uchar_v);
-    for (y = 0; y < sh; y++)
-        memcpy(((unsigned char **)tvInitialImage->data)[y], mInitial.ptr(y), sw);
+        Imrect * tvInitialImage = im_alloc(sh, sw, 0, uchar_v);
+        for (y = 0; y < sh; y++)
+            memcpy(((unsigned char **)tvInitialImage->data)[y], mInitial.ptr(y), sw);
 
-    Imrect * tvBiasImage = modified_xy_normf(tvInitialImage, mRefinement, mSmoothness, 0);
-    im_free(tvInitialImage);
-    Imrect * tvExpImage = im_exp(tvBiasImage);
-    im_free(tvBiasImage);
+        Imrect * tvBiasImage = modified_xy_normf(tvInitialImage, mRefinement, mSmoothness, 0);
+        im_free(tvInitialImage);
+        Imrect * tvExpImage = im_exp(tvBiasImage);
+        im_free(tvBiasImage);
 
-    float * tvImagePtr;
-    Imrect * tvFinalImage = tvExpImage;
-    int totalPixels = sw * sh;
+        float * tvImagePtr;
+        Imrect * tvFinalImage = tvExpImage;
+        int totalPixels = sw * sh;
 
-    // Set up the matrix A and the vector b for least squares fitting with the initial image
-    register int row = 0;
-    Eigen::MatrixXf ls_A = Eigen::MatrixXf(totalPixels, 2);
-    Eigen::VectorXf ls_b = Eigen::VectorXf(totalPixels);
+        // Set up the matrix A and the vector b for least squares fitting with the initial image
+        register int row = 0;
+        Eigen::MatrixXf ls_A = Eigen::MatrixXf(totalPixels, 2);
+        Eigen::VectorXf ls_b = Eigen::VectorXf(totalPixels);
 
-    for (y = 0; y < sh; y++)
-    {
-        mbits8 = mInitial.ptr(y);
-        tvImagePtr = ((float **)tvFinalImage->data)[y];
-        for (x = 0; x < sw; x++)
+        for (y = 0; y < sh; y++)
         {
-            ls_A(row, 0) = 1;
-            ls_A(row, 1) = *tvImagePtr;
-            ls_b(row) = *mbits8;
+            mbits8 = mInitial.ptr(y);
+            tvImagePtr = ((float **)tvFinalImage->data)[y];
+            for (x = 0; x < sw; x++)
+            {
+                ls_A(row, 0) = 1;
+                ls_A(row, 1) = *tvImagePtr;
+                ls_b(row) = *mbits8;
 
-            tvImagePtr++;
-            mbits8++;
-            row++;
+                tvImagePtr++;
+                mbits8++;
+                row++;
+            }
         }
-    }
-    // Solve...
-    Eigen::VectorXf ls_x = (ls_A).jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(ls_b);
+        // Solve...
+        Eigen::VectorXf ls_x = (ls_A).jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(ls_b);
 
-    for (y = 0; y < sh; y++)
-    {
-        tvImagePtr = ((float **)tvFinalImage->data)[y];
-        for (x = 0; x < sw; x++)
+        for (y = 0; y < sh; y++)
         {
-            *tvImagePtr = ls_x(0) + (*tvImagePtr) * ls_x(1);
-            tvImagePtr++;
+            tvImagePtr = ((float **)tvFinalImage->data)[y];
+            for (x = 0; x < sw; x++)
+            {
+                *tvImagePtr = ls_x(0) + (*tvImagePtr) * ls_x(1);
+                tvImagePtr++;
+            }
         }
-    }
 
-    // Remap due to out of range values and scale
-    double minIIH = 10000, maxIIH = -10000, minIIHc, maxIIHc, range1, range2;
+        // Remap due to out of range values and scale
+        double minIIH = 10000, maxIIH = -10000, minIIHc, maxIIHc, range1, range2;
 
-    for (y = 0; y < sh; y++)
-    {
-        tvImagePtr = ((float **)tvFinalImage->data)[y];
-        for (x = 0; x < sw; x++)
+        for (y = 0; y < sh; y++)
         {
-            if ((*tvImagePtr) > maxIIH)
-                maxIIH = (*tvImagePtr);
-            if ((*tvImagePtr) < minIIH)
-                minIIH = (*tvImagePtr);
-            tvImagePtr++;
+            tvImagePtr = ((float **)tvFinalImage->data)[y];
+            for (x = 0; x < sw; x++)
+            {
+                if ((*tvImagePtr) > maxIIH)
+                    maxIIH = (*tvImagePtr);
+                if ((*tvImagePtr) < minIIH)
+                    minIIH = (*tvImagePtr);
+                tvImagePtr++;
+            }
         }
-    }
-    minIIHc = IBP_clamp(0., minIIH, 255.);
-    maxIIHc = IBP_clamp(0., maxIIH, 255.);
-    range1 = maxIIH - minIIH;
-    range2 = maxIIHc - minIIHc;
-    for (y = 0; y < sh; y++)
-    {
-        mbits8 = mInitial.ptr(y);
-        tvImagePtr = ((float **)tvFinalImage->data)[y];
-        for (x = 0; x < sw; x++)
+        minIIHc = IBP_clamp(0., minIIH, 255.);
+        maxIIHc = IBP_clamp(0., maxIIH, 255.);
+        range1 = maxIIH - minIIH;
+        range2 = maxIIHc - minIIHc;
+        for (y = 0; y < sh; y++)
         {
-            *mbits8 = round((minIIHc + ((*tvImagePtr) - minIIH) * range2 / range1));
-            mean += *mbits8;
-            mbits8++;
-            tvImagePtr++;
+            mbits8 = mInitial.ptr(y);
+            tvImagePtr = ((float **)tvFinalImage->data)[y];
+            for (x = 0; x < sw; x++)
+            {
+                *mbits8 = round((minIIHc + ((*tvImagePtr) - minIIH) * range2 / range1));
+                mean += *mbits8;
+                mbits8++;
+                tvImagePtr++;
+            }
         }
-    }
-    mean /= totalPixels;
+        mean /= totalPixels;
 
-    im_free(tvFinalImage);
+        im_free(tvFinalImage);
 
-    // ----------------------------------
-    // End of Tina Vision Bias Correction
-    // ----------------------------------
+        // ----------------------------------
+        // End of Tina Vision Bias Correction
+        // ----------------------------------
 
-    // Resample
-    if (w != sw || h != sh)
-        cv::resize(mInitial, mlchannel, cv::Size(w, h), 0, 0, cv::INTER_CUBIC);
-    else
-        mlchannel = mInitial;
+        // Resample
+        if (w != sw || h != sh)
+            cv::resize(mInitial, mlchannel, cv::Size(w, h), 0, 0, cv::INTER_CUBIC);
+        else
+            mlchannel = mInitial;
+
+        if (mFieldReuseFrames > 0)
+            mBiasFieldCache->add(mlchannel, mFieldReuseFrames);
+    }
 
     // Make output image
     if (mOutputMode == CorrectedImageMode1)
@@ -302,6 +316,7 @@ bool Filter::loadParameters(QSettings &s)
     int refinement, smoothness;
     QString outputModeStr;
     OutputMode outputMode;
+    int fieldReuseFrames;
     bool ok;
 
     refinement = s.value("refinement", 0).toUInt(&ok);
@@ -322,7 +337,12 @@ bool Filter::loadParameters(QSettings &s)
     else
         return false;
 
+    fieldReuseFrames = s.value("fieldreuseframes", 0).toInt(&ok);
+    if (!ok || fieldReuseFrames < 0 || fieldReuseFrames > 15)
+        return false;
+
     setOutputMode(outputMode);
+    setFieldReuseFrames(fieldReuseFrames);
     setRefinement(refinement);
     setSmoothness(smoothness);
 
@@ -335,6 +355,7 @@ bool Filter::saveParameters(QSettings &s)
     s.setValue("smoothness", mSmoothness);
     s.setValue("outputmode", mOutputMode == CorrectedImageMode1 ? "correctedimagemode1" :
                              mOutputMode == CorrectedImageMode2 ? "correctedimagemode2" : "iihcorrectionmodel");
+    s.setValue("fieldreuseframes", mFieldReuseFrames);
     return true;
 }
 
@@ -344,12 +365,15 @@ QWidget *Filter::widget(QWidget *parent)
     fw->setRefinement(mRefinement);
     fw->setSmoothness(mSmoothness);
     fw->setOutputMode(mOutputMode);
+    fw->setFieldReuseFrames(mFieldReuseFrames);
     connect(this, SIGNAL(refinementChanged(int)), fw, SLOT(setRefinement(int)));
     connect(this, SIGNAL(smoothnessChanged(int)), fw, SLOT(setSmoothness(int)));
     connect(this, SIGNAL(outputModeChanged(Filter::OutputMode)), fw, SLOT(setOutputMode(Filter::OutputMode)));
+    connect(this, SIGNAL(fieldReuseFramesChanged(int)), fw, SLOT(setFieldReuseFrames(int)));
     connect(fw, SIGNAL(refinementChanged(int)), this, SLOT(setRefinement(int)));
     connect(fw, SIGNAL(smoothnessChanged(int)), this, SLOT(setSmoothness(int)));
     connect(fw, SIGNAL(outputModeChanged(Filter::OutputMode)), this, SLOT(setOutputMode(Filter::OutputMode)));
+    connect(fw, SIGNAL(fieldReuseFramesChanged(int)), this, SLOT(setFieldReuseFrames(int)));
     return fw;
 }
 
@@ -358,6 +382,7 @@ void Filter::setRefinement(int v)
     if (v == mRefinement)
         return;
     mRefinement = v;
+    mBiasFieldCache = QSharedPointer<BiasFieldCache>(new BiasFieldCache);
     emit refinementChanged(v);
     emit parametersChanged();
 }
@@ -367,6 +392,7 @@ void Filter::setSmoothness(int v)
     if (v == mSmoothness)
         return;
     mSmoothness = v;
+    mBiasFieldCache = QSharedPointer<BiasFieldCache>(new BiasFieldCache);
     emit smoothnessChanged(v);
     emit parametersChanged();
 }
@@ -379,3 +405,13 @@ void Filter::setOutputMode(Filter::OutputMode om)
     emit outputModeChanged(om);
     emit parametersChanged();
 }
+
+void Filter::setFieldReuseFrames(int n)
+{
+    if (n == mFieldReuseFrames)
+        return;
+    mFieldReuseFrames = n;
+    mBiasFieldCache = QSharedPointer<BiasFieldCache>(new BiasFieldCache);
+    emit fieldReuseFramesChanged(n);
+    emit parametersChanged();
+}
@@ -31,8 +31,10 @@
 #include <QImage>
 #include <QSettings>
 #include <QWidget>
+#include <QSharedPointer>
 
 #include <imgproc/imagefilter.h>
+#include <imgproc/biasfieldcache.h>
 
 using namespace ibp::imgproc;
 
@@ -60,16 +62,21 @@ public:
 private:
     int mRefinement, mSmoothness;
     OutputMode mOutputMode;
+    int mFieldReuseFrames;
+    // fields shared with the copies of the filter, started anew when the estimation parameters change
+    QSharedPointer<BiasFieldCache> mBiasFieldCache;
 
 signals:
     void refinementChanged(int v);
     void smoothnessChanged(int v);
     void outputModeChanged(Filter::OutputMode om);
+    void fieldReuseFramesChanged(int n);
 
 public slots:
     void setRefinement(int v);
     void setSmoothness(int v);
     void setOutputMode(Filter::OutputMode om);
+    void setFieldReuseFrames(int n);
 
 };
 
@@ -77,6 +77,16 @@ void FilterWidget::setOutputMode(Filter::OutputMode om)
     emit outputModeChanged(om);
 }
 
+void FilterWidget::setFieldReuseFrames(int n)
+{
+    if (ui->mSpinFieldReuseFrames->value() == n)
+        return;
+    mEmitSignals = false;
+    ui->mSpinFieldReuseFrames->setValue(n);
+    mEmitSignals = true;
+    emit fieldReuseFramesChanged(n);
+}
+
 void FilterWidget::on_mSliderRefinement_valueChanged(int value)
 {
     ui->mSpinRefinement->setValue(value);
@@ -128,3 +138,9 @@ void FilterWidget::on_mButtonOutputModeIIHCorrectionModel_toggled(bool c)
     if (mEmitSignals)
         emit outputModeChanged(Filter::IIHCorrectionModel);
 }
+
+void FilterWidget::on_mSpinFieldReuseFrames_valueChanged(int arg1)
+{
+    if (mEmitSignals)
+        emit fieldReuseFramesChanged(arg1);
+}
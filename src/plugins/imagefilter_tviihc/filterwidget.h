@@ -49,11 +49,13 @@ signals:
     void refinementChanged(int v);
     void smoothnessChanged(int v);
     void outputModeChanged(Filter::OutputMode om);
+    void fieldReuseFramesChanged(int n);
 
 public slots:
     void setRefinement(int v);
     void setSmoothness(int v);
     void setOutputMode(Filter::OutputMode om);
+    void setFieldReuseFrames(int n);
 
 private slots:
     void on_mSliderRefinement_valueChanged(int value);
@@ -63,6 +65,7 @@ private slots:
     void on_mButtonOutputModeCorrectedImageMode1_toggled(bool c);
     void on_mButtonOutputModeCorrectedImageMode2_toggled(bool c);
     void on_mButtonOutputModeIIHCorrectionModel_toggled(bool c);
+    void on_mSpinFieldReuseFrames_valueChanged(int arg1);
 };
 
 #endif // FILTERWIDGET_H
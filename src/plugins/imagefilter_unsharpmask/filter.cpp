@@ -27,6 +27,7 @@
 #include "filter.h"
 #include "filterwidget.h"
 #include <imgproc/types.h>
+#include <imgproc/blurring.h>
 #include <misc/util.h>
 
 #define EXPONENTIALSIGMOIDSIZE 7.5
@@ -77,7 +78,7 @@ QImage Filter::process(const QImage &inputImage)
     cv::Mat mBlurred(i.height(), i.width(), CV_8UC4, i.bits());
 
     double sigma = (mRadius + .5) / 2.45;
-    cv::GaussianBlur(mInput, mBlurred, cv::Size(0, 0), sigma);
+    gaussianBlur(mInput, mBlurred, sigma);
 
     BGRA * bits81 = (BGRA *)inputImage.bits();
     BGRA * bits82 = (BGRA *)i.bits();
@@ -0,0 +1,57 @@
+// this_file: tests/imgproc/test_biasfieldcache.cpp
+
+#include "../test_utils.h"
+#include <gtest/gtest.h>
+#include <ibp/imgproc/biasfieldcache.h>
+
+namespace ibp {
+namespace test {
+
+class BiasFieldCacheTest : public ImageProcessingTest {
+protected:
+    ibp::imgproc::BiasFieldCache cache;
+};
+
+TEST_F(BiasFieldCacheTest, MedianOfFirstFramesIsShared) {
+    const cv::Size size(64, 48);
+    cv::Mat field;
+
+    cache.add(cv::Mat(size, CV_8UC1, cv::Scalar(100)), 3);
+    EXPECT_FALSE(cache.find(size, field));
+    cache.add(cv::Mat(size, CV_8UC1, cv::Scalar(180)), 3);
+    cache.add(cv::Mat(size, CV_8UC1, cv::Scalar(120)), 3);
+    ASSERT_TRUE(cache.find(size, field));
+    EXPECT_EQ(field.size(), size);
+    EXPECT_EQ(field.type(), CV_8UC1);
+    EXPECT_EQ(cv::norm(field, cv::Scalar(120), cv::NORM_INF), 0.);
+
+    // later fields do not replace the median
+    cache.add(cv::Mat(size, CV_8UC1, cv::Scalar(10)), 3);
+    ASSERT_TRUE(cache.find(size, field));
+    EXPECT_EQ(cv::norm(field, cv::Scalar(120), cv::NORM_INF), 0.);
+}
+
+TEST_F(BiasFieldCacheTest, FieldsAreKeyedBySize) {
+    cv::Mat field;
+    cache.add(cv::Mat(1200, 1600, CV_8UC1, cv::Scalar(90)), 1);
+
+    ASSERT_TRUE(cache.find(cv::Size(1600, 1200), field));
+    EXPECT_EQ(field.size(), cv::Size(1600, 1200));
+    EXPECT_EQ(cv::norm(field, cv::Scalar(90), cv::NORM_INF), 0.);
+    EXPECT_FALSE(cache.find(cv::Size(1200, 1600), field));
+}
+
+TEST_F(BiasFieldCacheTest, CachesAreIndependent) {
+    // every filter, and so every batch, has its own fields
+    const cv::Size size(64, 48);
+    ibp::imgproc::BiasFieldCache other;
+    cv::Mat field;
+    cache.add(cv::Mat(size, CV_8UC1, cv::Scalar(90)), 1);
+    EXPECT_FALSE(other.find(size, field));
+
+    cache.clear();
+    EXPECT_FALSE(cache.find(size, field));
+}
+
+} // namespace test
+} // namespace ibp
@@ -0,0 +1,118 @@
+// this_file: tests/imgproc/test_blurring.cpp
+
+#include "../test_utils.h"
+#include <gtest/gtest.h>
+#include <opencv2/imgproc.hpp>
+#include <ibp/imgproc/blurring.h>
+
+namespace ibp {
+namespace test {
+
+class BlurringTest : public ImageProcessingTest {
+protected:
+    void SetUp() override {
+        ImageProcessingTest::SetUp();
+    }
+};
+
+TEST_F(BlurringTest, FlatImageStaysFlat) {
+    cv::Mat src(37, 53, CV_8UC4, cv::Scalar(10, 120, 240, 77));
+    cv::Mat dst;
+
+    for (double sigma : {2., ibp::imgproc::kStackedBoxBlurMinimumSigma, 500.}) {
+        ibp::imgproc::gaussianBlur(src, dst, sigma);
+        ASSERT_EQ(dst.type(), src.type());
+        EXPECT_EQ(cv::norm(src, dst, cv::NORM_INF), 0.) << "sigma = " << sigma;
+    }
+}
+
+TEST_F(BlurringTest, StackedBoxBlurApproximatesGaussian) {
+    cv::Mat src(120, 160, CV_8UC1, cv::Scalar(0));
+    src(cv::Rect(40, 30, 80, 60)).setTo(255);
+    const double sigma = 2. * ibp::imgproc::kStackedBoxBlurMinimumSigma;
+
+    cv::Mat expected, dst = src.clone();
+    cv::GaussianBlur(src, expected, cv::Size(0, 0), sigma);
+    // in place
+    ibp::imgproc::gaussianBlur(dst, dst, sigma);
+
+    // measured: 5 grey levels at worst, 1.14 on average, with the horizontal passes rounded to 8 bits
+    EXPECT_LE(cv::norm(expected, dst, cv::NORM_INF), 5.);
+    EXPECT_LE(cv::norm(expected, dst, cv::NORM_L1) / dst.total(), 1.25);
+}
+
+TEST_F(BlurringTest, HistogramMedianMatchesOpenCV) {
+    cv::Mat src(67, 150, CV_8UC4);
+    cv::randu(src, cv::Scalar::all(0), cv::Scalar::all(256));
+
+    for (int radius : {ibp::imgproc::kHistogramMedianMinimumRadius, 12, 40}) {
+        cv::Mat expected, dst;
+        cv::medianBlur(src, expected, 2 * radius + 1);
+        ibp::imgproc::medianBlur(src, dst, radius);
+        EXPECT_EQ(cv::norm(expected, dst, cv::NORM_INF), 0.) << "radius = " << radius;
+    }
+}
+
+TEST_F(BlurringTest, MedianBlurFiltersTwoChannelImages) {
+    cv::Mat src(40, 50, CV_8UC2);
+    cv::randu(src, cv::Scalar::all(0), cv::Scalar::all(256));
+
+    for (int radius : {1, 3, ibp::imgproc::kHistogramMedianMinimumRadius, 130}) {
+        cv::Mat planes[2], expected, dst;
+        cv::split(src, planes);
+        for (int c = 0; c < 2; c++)
+            cv::medianBlur(planes[c], planes[c], 2 * radius + 1);
+        cv::merge(planes, 2, expected);
+        ibp::imgproc::medianBlur(src, dst, radius);
+        EXPECT_EQ(cv::norm(expected, dst, cv::NORM_INF), 0.) << "radius = " << radius;
+    }
+}
+
+TEST_F(BlurringTest, BilateralGridMatchesOpenCV) {
+    cv::Mat gray(90, 120, CV_8UC1, cv::Scalar(60)), noise(gray.size(), CV_8UC1), bgr;
+    gray.colRange(60, 120).setTo(200);
+    cv::randu(noise, 0, 21);
+    gray = gray + noise - 10;
+    // grey BGR pixels, whose summed channel differences are three times their luma differences
+    cv::cvtColor(gray, bgr, cv::COLOR_GRAY2BGR);
+
+    // the grid of the smaller sigma is sampled coarser to stay below the image size
+    for (double sigmaSpace : {ibp::imgproc::kBilateralGridMinimumSigma, 6.}) {
+        for (const cv::Mat & src : {gray, bgr}) {
+            const double sigmaColor = src.channels() == 1 ? 30. : 90.;
+            cv::Mat expected, dst;
+            cv::bilateralFilter(src, expected, 0, sigmaColor, sigmaSpace);
+            ibp::imgproc::bilateralGrid(src, dst, sigmaColor, sigmaSpace);
+            // measured: 3 levels at worst, 0.55 on average
+            EXPECT_LE(cv::norm(expected, dst, cv::NORM_INF), 4.) << "sigmaSpace = " << sigmaSpace;
+            EXPECT_LE(cv::norm(expected, dst, cv::NORM_L1) / dst.total() / dst.channels(), .75)
+                << "sigmaSpace = " << sigmaSpace;
+        }
+    }
+}
+
+TEST_F(BlurringTest, BilateralGridKeepsIsoluminantEdges) {
+    // two colours of about the same luma (110), that a luma grid blurred into each other (80 levels off the sides'
+    // colours). Filtering every channel on its own grid keeps the red and blue edges whole, the green step of 39
+    // is softened where cv::bilateralFilter, weighting the differences of the three channels together, keeps it
+    const cv::Vec3b left(40, 90, 200), right(130, 129, 40);
+    cv::Mat src(90, 120, CV_8UC3, cv::Scalar(left)), noise(src.size(), CV_8UC3);
+    src.colRange(60, 120).setTo(cv::Scalar(right));
+    cv::randu(noise, 0, 21);
+    cv::subtract(src + noise, cv::Scalar::all(10), src);
+
+    for (double sigmaSpace : {ibp::imgproc::kBilateralGridMinimumSigma, 6.}) {
+        cv::Mat expected, dst;
+        cv::bilateralFilter(src, expected, 0, 90., sigmaSpace);
+        ibp::imgproc::bilateralGrid(src, dst, 90., sigmaSpace);
+        // measured: 17 levels at worst, on the green channel by the edge, 0.77 on average
+        EXPECT_LE(cv::norm(expected, dst, cv::NORM_INF), 20.) << "sigmaSpace = " << sigmaSpace;
+        EXPECT_LE(cv::norm(expected, dst, cv::NORM_L1) / dst.total() / dst.channels(), 1.)
+            << "sigmaSpace = " << sigmaSpace;
+        EXPECT_LE(cv::norm(dst.colRange(0, 60), cv::Mat(90, 60, CV_8UC3, cv::Scalar(left)), cv::NORM_INF), 20.);
+        EXPECT_LE(cv::norm(dst.colRange(60, 120), cv::Mat(90, 60, CV_8UC3, cv::Scalar(right)), cv::NORM_INF), 20.);
+    }
+}
+
+} // namespace test
+} // namespace ibp
@@ -0,0 +1,67 @@
+// this_file: tests/imgproc/test_decolorization.cpp
+
+#include "../test_utils.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/photo.hpp>
+#include <ibp/imgproc/decolorization.h>
+
+namespace ibp {
+namespace test {
+
+class DecolorizationTest : public ImageProcessingTest {
+protected:
+    void SetUp() override {
+        ImageProcessingTest::SetUp();
+        // smooth color gradients with some structure
+        src = cv::Mat(240, 320, CV_8UC4);
+        for (int y = 0; y < src.rows; y++) {
+            for (int x = 0; x < src.cols; x++) {
+                src.at<cv::Vec4b>(y, x) = cv::Vec4b(cv::saturate_cast<uchar>(128 + 100 * std::sin(x * .05)),
+                                                    cv::saturate_cast<uchar>(y * 255 / src.rows),
+                                                    cv::saturate_cast<uchar>(x * 255 / src.cols), 255);
+            }
+        }
+    }
+
+    cv::Mat src;
+};
+
+TEST_F(DecolorizationTest, SpansTheFullRange) {
+    cv::Mat gray;
+    imgproc::decolorize(src, gray, 512);
+    ASSERT_EQ(gray.type(), CV_8UC1);
+    ASSERT_EQ(gray.size(), src.size());
+    double minimum, maximum;
+    cv::minMaxLoc(gray, &minimum, &maximum);
+    EXPECT_EQ(minimum, 0.);
+    EXPECT_EQ(maximum, 255.);
+}
+
+TEST_F(DecolorizationTest, MatchesOpenCV) {
+    // cv::decolor downsamples when width + height is above 800, and a solve size of 512 keeps the whole image
+    ASSERT_LE(src.cols + src.rows, 800);
+    cv::Mat bgr, expected, boost, gray;
+    cv::cvtColor(src, bgr, cv::COLOR_BGRA2BGR);
+    cv::decolor(bgr, expected, boost);
+    imgproc::decolorize(src, gray, 512);
+    // the same weights, up to single precision rounding of the polynomial
+    EXPECT_LE(cv::norm(expected, gray, cv::NORM_INF), 1.);
+}
+
+TEST_F(DecolorizationTest, NoDownsamplingBelowTheSolveSize) {
+    cv::Mat a, b;
+    imgproc::decolorize(src, a, 320);
+    imgproc::decolorize(src, b, 1024);
+    EXPECT_EQ(cv::norm(a, b, cv::NORM_INF), 0.);
+}
+
+TEST_F(DecolorizationTest, FlatImageIsBlack) {
+    cv::Mat gray;
+    imgproc::decolorize(cv::Mat(50, 70, CV_8UC4, cv::Scalar(30, 60, 90, 255)), gray, 64);
+    EXPECT_EQ(cv::countNonZero(gray), 0);
+}
+
+} // namespace test
+} // namespace ibp
@@ -2,6 +2,9 @@
 
 #include "../test_utils.h"
 #include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <ibp/imgproc/imagefilter.h>
 
 namespace ibp {
 namespace test {
@@ -68,5 +71,56 @@ TEST_F(ImageFilterTest, ProcessDifferentFormats) {
     EXPECT_EQ(grayscaleResult.format(), grayscaleImage.format());
 }
 
+// ImageFilter that times three stages, for the stage timings read from another thread
+class TimedFilter : public ibp::imgproc::ImageFilter {
+public:
+    virtual ibp::imgproc::ImageFilter * clone() { return new TimedFilter(); }
+    virtual QHash<QString, QString> info() { return QHash<QString, QString>(); }
+    virtual QImage process(const QImage & inputImage) {
+        clearStageTimings();
+        addStageTiming("first", 1.);
+        addStageTiming("second", 2.);
+        addStageTiming("third", 3.);
+        return inputImage;
+    }
+    virtual bool loadParameters(QSettings &) { return true; }
+    virtual bool saveParameters(QSettings &) { return true; }
+    virtual QWidget * widget(QWidget *) { return 0; }
+};
+
+TEST_F(ImageFilterTest, StageTimingsInOrder) {
+    TimedFilter filter;
+    EXPECT_TRUE(filter.stageTimings().isEmpty());
+
+    filter.process(testImage);
+    const QList<QPair<QString, double> > timings = filter.stageTimings();
+    ASSERT_EQ(timings.size(), 3);
+    EXPECT_EQ(timings[0], qMakePair(QString("first"), 1.));
+    EXPECT_EQ(timings[1], qMakePair(QString("second"), 2.));
+    EXPECT_EQ(timings[2], qMakePair(QString("third"), 3.));
+}
+
+TEST_F(ImageFilterTest, StageTimingsReadWhileProcessing) {
+    TimedFilter filter;
+    std::atomic<bool> done(false);
+    std::thread worker([&]() {
+        for (int i = 0; i < 2000; i++)
+            filter.process(testImage);
+        done.store(true);
+    });
+
+    // every read sees the stages finished so far, in order
+    int nReads = 0;
+    while (!done.load() || nReads == 0) {
+        const QList<QPair<QString, double> > timings = filter.stageTimings();
+        ASSERT_LE(timings.size(), 3);
+        for (int i = 0; i < timings.size(); i++)
+            ASSERT_EQ(timings[i].second, i + 1.);
+        nReads++;
+    }
+    worker.join();
+    EXPECT_EQ(filter.stageTimings().size(), 3);
+}
+
 } // namespace test
 } // namespace ibp
\ No newline at end of file
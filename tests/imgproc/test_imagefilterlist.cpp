@@ -2,6 +2,7 @@
 
 #include "../test_utils.h"
 #include <gtest/gtest.h>
+#include <ibp/imgproc/imagefilterlist.h>
 
 namespace ibp {
 namespace test {
@@ -150,5 +151,110 @@ TEST_F(ImageFilterListTest, InvalidOperations) {
     EXPECT_EQ(filterList.count(), 1);
 }
 
+// Filter timing a single stage, to check the list keeps the timings of the copies it runs
+class TimedFilter : public ibp::imgproc::ImageFilter {
+public:
+    virtual ibp::imgproc::ImageFilter * clone() { return new TimedFilter(); }
+    virtual QHash<QString, QString> info() { return QHash<QString, QString>(); }
+    virtual QImage process(const QImage & inputImage) {
+        clearStageTimings();
+        addStageTiming("copy", 1.5);
+        return inputImage.copy();
+    }
+    virtual bool loadParameters(QSettings &) { return true; }
+    virtual bool saveParameters(QSettings &) { return true; }
+    virtual QWidget * widget(QWidget *) { return 0; }
+};
+
+TEST_F(ImageFilterListTest, KeepsTheStageTimingsOfTheCopiesItRuns) {
+    ibp::imgproc::ImageFilterList filterList;
+    filterList.append(new TimedFilter());
+    filterList.append(new TimedFilter());
+    filterList.setBypass(1, true);
+    EXPECT_TRUE(filterList.stageTimings(0).isEmpty());
+
+    filterList.setInputImage(testImage);
+    filterList.startProcessing();
+    ASSERT_TRUE(filterList.wait(10000));
+
+    // the list runs copies, the filters it holds never process
+    EXPECT_TRUE(filterList.at(0)->stageTimings().isEmpty());
+    const QList<QPair<QString, double> > timings = filterList.stageTimings(0);
+    ASSERT_EQ(timings.size(), 1);
+    EXPECT_EQ(timings[0], qMakePair(QString("copy"), 1.5));
+    // bypassed filters are not run
+    EXPECT_TRUE(filterList.stageTimings(1).isEmpty());
+
+    filterList.removeAt(0);
+    EXPECT_TRUE(filterList.stageTimings(0).isEmpty());
+}
+
+// Filter recording the format of the images it gets, with the alpha handling it is made with
+class FormatRecordingFilter : public ibp::imgproc::ImageFilter {
+public:
+    FormatRecordingFilter(AlphaHandling alphaHandling, QList<QImage::Format> * formats) :
+        mAlphaHandling(alphaHandling), mFormats(formats) {}
+    virtual ibp::imgproc::ImageFilter * clone() { return new FormatRecordingFilter(mAlphaHandling, mFormats); }
+    virtual QHash<QString, QString> info() { return QHash<QString, QString>(); }
+    virtual QImage process(const QImage & inputImage) {
+        mFormats->append(inputImage.format());
+        return inputImage;
+    }
+    virtual bool loadParameters(QSettings &) { return true; }
+    virtual bool saveParameters(QSettings &) { return true; }
+    virtual QWidget * widget(QWidget *) { return 0; }
+    virtual AlphaHandling alphaHandling() { return mAlphaHandling; }
+
+private:
+    AlphaHandling mAlphaHandling;
+    QList<QImage::Format> * mFormats;
+};
+
+typedef ibp::imgproc::ImageFilter::AlphaHandling AlphaHandling;
+
+// runs the filters of the given alpha handlings on a straight alpha image, returning the formats they got
+static QList<QImage::Format> runFormatRecordingFilters(const QImage & image, bool premultipliedAlpha,
+                                                       const QList<AlphaHandling> & handlings,
+                                                       QImage::Format & outputFormat) {
+    QList<QImage::Format> formats;
+    ibp::imgproc::ImageFilterList filterList;
+    filterList.setPremultipliedAlpha(premultipliedAlpha);
+    for (int i = 0; i < handlings.size(); i++)
+        filterList.append(new FormatRecordingFilter(handlings.at(i), &formats));
+    QObject::connect(&filterList, &ibp::imgproc::ImageFilterList::processingCompleted,
+                     [&](const QImage & outputImage) { outputFormat = outputImage.format(); });
+    filterList.setInputImage(image.convertToFormat(QImage::Format_ARGB32));
+    filterList.startProcessing();
+    EXPECT_TRUE(filterList.wait(10000));
+    return formats;
+}
+
+TEST_F(ImageFilterListTest, PremultipliedAlphaConvertsOnlyForTheFiltersNeedingIt) {
+    typedef ibp::imgproc::ImageFilter F;
+    const QList<AlphaHandling> handlings = QList<AlphaHandling>()
+        << F::AlphaHandling_Agnostic << F::AlphaHandling_Straight << F::AlphaHandling_Agnostic
+        << F::AlphaHandling_Premultiplied << F::AlphaHandling_Agnostic << F::AlphaHandling_Premultiplied
+        << F::AlphaHandling_Straight;
+    QImage::Format outputFormat = QImage::Format_Invalid;
+
+    // a flip before a straight alpha filter converts nothing, the agnostic filters keep the format they get, and
+    // the list returns straight alpha
+    const QList<QImage::Format> formats = runFormatRecordingFilters(testImage, true, handlings, outputFormat);
+    const QList<QImage::Format> expected = QList<QImage::Format>()
+        << QImage::Format_ARGB32 << QImage::Format_ARGB32 << QImage::Format_ARGB32
+        << QImage::Format_ARGB32_Premultiplied << QImage::Format_ARGB32_Premultiplied
+        << QImage::Format_ARGB32_Premultiplied << QImage::Format_ARGB32;
+    EXPECT_EQ(formats, expected);
+    EXPECT_EQ(outputFormat, QImage::Format_ARGB32);
+
+    // out of premultiplied alpha mode every filter gets straight alpha
+    const QList<QImage::Format> straightFormats = runFormatRecordingFilters(testImage, false, handlings,
+                                                                            outputFormat);
+    ASSERT_EQ(straightFormats.size(), handlings.size());
+    for (QImage::Format format : straightFormats)
+        EXPECT_EQ(format, QImage::Format_ARGB32);
+    EXPECT_EQ(outputFormat, QImage::Format_ARGB32);
+}
+
 } // namespace test
 } // namespace ibp
\ No newline at end of file
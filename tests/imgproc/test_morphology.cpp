@@ -0,0 +1,53 @@
+// this_file: tests/imgproc/test_morphology.cpp
+
+#include "../test_utils.h"
+#include <gtest/gtest.h>
+#include <opencv2/imgproc.hpp>
+#include <ibp/imgproc/morphology.h>
+
+namespace ibp {
+namespace test {
+
+class MorphologyTest : public ImageProcessingTest {
+protected:
+    void SetUp() override {
+        ImageProcessingTest::SetUp();
+        src = cv::Mat(71, 97, CV_8UC4);
+        cv::randu(src, cv::Scalar::all(0), cv::Scalar::all(256));
+    }
+
+    void expectSameAsOpenCV(const cv::Mat & kernel) {
+        cv::Mat expected, dst;
+        cv::dilate(src, expected, kernel);
+        ibp::imgproc::dilate(src, dst, kernel);
+        EXPECT_EQ(cv::norm(expected, dst, cv::NORM_INF), 0.) << "dilation " << kernel.cols << "x" << kernel.rows;
+        cv::erode(src, expected, kernel);
+        ibp::imgproc::erode(src, dst, kernel);
+        EXPECT_EQ(cv::norm(expected, dst, cv::NORM_INF), 0.) << "erosion " << kernel.cols << "x" << kernel.rows;
+    }
+
+    cv::Mat src;
+};
+
+TEST_F(MorphologyTest, RectangleMatchesOpenCV) {
+    expectSameAsOpenCV(cv::getStructuringElement(cv::MORPH_RECT, cv::Size(11, 11)));
+    expectSameAsOpenCV(cv::getStructuringElement(cv::MORPH_RECT, cv::Size(61, 23)));
+    expectSameAsOpenCV(cv::getStructuringElement(cv::MORPH_RECT, cv::Size(201, 151)));
+}
+
+TEST_F(MorphologyTest, GeneralShapesMatchOpenCV) {
+    expectSameAsOpenCV(cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(41, 25)));
+    expectSameAsOpenCV(cv::getStructuringElement(cv::MORPH_CROSS, cv::Size(31, 31)));
+
+    // diamond and ring, several runs per row
+    cv::Mat diamond = cv::Mat::zeros(33, 21, CV_8UC1), ring = cv::Mat::zeros(35, 35, CV_8UC1);
+    for (int y = 0; y < diamond.rows; y++)
+        for (int x = 0; x < diamond.cols; x++)
+            diamond.at<unsigned char>(y, x) = abs(x - 10) * 33 + abs(y - 16) * 21 <= 21 * 16;
+    cv::circle(ring, cv::Point(17, 17), 15, cv::Scalar(1));
+    expectSameAsOpenCV(diamond);
+    expectSameAsOpenCV(ring);
+}
+
+} // namespace test
+} // namespace ibp
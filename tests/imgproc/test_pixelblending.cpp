@@ -0,0 +1,104 @@
+// this_file: tests/imgproc/test_pixelblending.cpp
+
+#include "../test_utils.h"
+#include <gtest/gtest.h>
+#include <QVector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ibp/imgproc/pixelblending.h>
+#include <ibp/imgproc/util.h>
+
+namespace ibp {
+namespace test {
+
+using namespace ibp::imgproc;
+
+class PixelBlendingTest : public ImageProcessingTest {
+protected:
+    void SetUp() override {
+        ImageProcessingTest::SetUp();
+        srand(39);
+        dst.resize(5000);
+        for (int i = 0; i < dst.size(); i++) {
+            dst[i].b = rand() % 256;
+            dst[i].g = rand() % 256;
+            dst[i].r = rand() % 256;
+            // plenty of opaque and transparent pixels, the early discard cases
+            dst[i].a = i % 4 == 0 ? 255 : i % 9 == 0 ? 0 : rand() % 256;
+        }
+        src.b = 30;
+        src.g = 200;
+        src.r = 90;
+        src.a = 180;
+    }
+
+    QVector<BGRA> blendEachPixel(ColorCompositionMode mode) const {
+        QVector<BGRA> blend(dst.size());
+        for (int i = 0; i < dst.size(); i++)
+            blendColors[mode](src, dst[i], blend[i]);
+        return blend;
+    }
+
+    QVector<BGRA> dst;
+    BGRA src;
+};
+
+TEST_F(PixelBlendingTest, TablesMatchSeparableModes) {
+    ConstantSourceBlendTables * tables = new ConstantSourceBlendTables;
+    QVector<BGRA> blend(dst.size());
+
+    for (int mode = ColorCompositionMode_Normal; mode < ColorCompositionMode_Unsupported; mode++) {
+        if (!isSeparableColorCompositionMode((ColorCompositionMode)mode))
+            continue;
+        makeConstantSourceBlendTables(src, blendColors[mode], *tables);
+        blendConstantSource(*tables, dst.constData(), blend.data(), dst.size());
+        EXPECT_EQ(memcmp(blend.constData(), blendEachPixel((ColorCompositionMode)mode).constData(),
+                         dst.size() * sizeof(BGRA)), 0) << mode;
+    }
+    delete tables;
+}
+
+TEST_F(PixelBlendingTest, ConstantSourceMatchesNonSeparableModes) {
+    const ColorCompositionMode modes[] = { ColorCompositionMode_DarkerColor, ColorCompositionMode_LighterColor,
+                                           ColorCompositionMode_Hue, ColorCompositionMode_Saturation,
+                                           ColorCompositionMode_Color, ColorCompositionMode_Luminosity };
+    QVector<BGRA> blend(dst.size());
+
+    for (ColorCompositionMode mode : modes) {
+        EXPECT_FALSE(isSeparableColorCompositionMode(mode));
+        blendConstantSource(src, dst.constData(), blend.data(), dst.size(), mode);
+        EXPECT_EQ(memcmp(blend.constData(), blendEachPixel(mode).constData(), dst.size() * sizeof(BGRA)), 0) << mode;
+    }
+}
+
+TEST_F(PixelBlendingTest, PremultipliedOperatorsMatchStraightOnes) {
+    // the premultiplied alpha operators on premultiplied pixels give the straight alpha ones, premultiplied, but for
+    // the rounding of the straight ones (2 levels at most), and keep the colors within the alpha
+    const BGRA sources[] = { src, { 200, 10, 120, 255 }, { 70, 160, 250, 0 }, { 255, 255, 255, 37 } };
+    for (int mode = AlphaCompositionMode_Source; mode <= AlphaCompositionMode_SourceXorDestination; mode++) {
+        int maximumError = 0;
+        for (const BGRA & s : sources) {
+            BGRA premultipliedSource = s;
+            IBP_premultiplyBGRA(premultipliedSource);
+            for (int i = 0; i < dst.size(); i++) {
+                BGRA premultipliedDestination = dst[i], straight, premultiplied;
+                IBP_premultiplyBGRA(premultipliedDestination);
+                alphaBlendColors[mode](s, dst[i], straight);
+                IBP_premultiplyBGRA(straight);
+                premultipliedAlphaBlendColors[mode](premultipliedSource, premultipliedDestination, premultiplied);
+                ASSERT_LE(premultiplied.r, premultiplied.a) << mode << " " << i;
+                ASSERT_LE(premultiplied.g, premultiplied.a) << mode << " " << i;
+                ASSERT_LE(premultiplied.b, premultiplied.a) << mode << " " << i;
+                maximumError = std::max(maximumError, abs(straight.r - premultiplied.r));
+                maximumError = std::max(maximumError, abs(straight.g - premultiplied.g));
+                maximumError = std::max(maximumError, abs(straight.b - premultiplied.b));
+                maximumError = std::max(maximumError, abs(straight.a - premultiplied.a));
+            }
+        }
+        EXPECT_LE(maximumError, 2) << mode;
+    }
+}
+
+} // namespace test
+} // namespace ibp
@@ -0,0 +1,77 @@
+// this_file: tests/imgproc/test_random.cpp
+
+#include "../test_utils.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <ibp/imgproc/random.h>
+
+namespace ibp {
+namespace test {
+
+class RandomTest : public ImageProcessingTest {
+};
+
+TEST_F(RandomTest, UniformPiecesMatchWhole) {
+    const unsigned long long key = ibp::imgproc::randomStreamKey(1234);
+    std::vector<int> whole(1001), pieces(1001);
+    ibp::imgproc::uniformNoise(key, 17, 1001, 40, whole.data());
+    const int cuts[] = { 0, 1, 4, 7, 300, 301, 1000, 1001 };
+    for (size_t i = 0; i + 1 < sizeof(cuts) / sizeof(cuts[0]); i++)
+        ibp::imgproc::uniformNoise(key, 17 + cuts[i], cuts[i + 1] - cuts[i], 40, pieces.data() + cuts[i]);
+    EXPECT_EQ(whole, pieces);
+}
+
+TEST_F(RandomTest, EmptyRangesWriteNothing) {
+    const unsigned long long key = ibp::imgproc::randomStreamKey(5);
+    int uniform = 12345;
+    float gaussian = 12345.f;
+    for (long long first : {0LL, 1LL, 7LL}) {
+        ibp::imgproc::uniformNoise(key, first, 0, 40, &uniform);
+        ibp::imgproc::gaussianNoise(key, first, 0, &gaussian);
+        EXPECT_EQ(uniform, 12345) << "first = " << first;
+        EXPECT_EQ(gaussian, 12345.f) << "first = " << first;
+    }
+}
+
+TEST_F(RandomTest, GaussianPiecesMatchWhole) {
+    const unsigned long long key = ibp::imgproc::randomStreamKey(99);
+    std::vector<float> whole(999), pieces(999);
+    ibp::imgproc::gaussianNoise(key, 3, 999, whole.data());
+    const int cuts[] = { 0, 1, 2, 5, 500, 998, 999 };
+    for (size_t i = 0; i + 1 < sizeof(cuts) / sizeof(cuts[0]); i++)
+        ibp::imgproc::gaussianNoise(key, 3 + cuts[i], cuts[i + 1] - cuts[i], pieces.data() + cuts[i]);
+    EXPECT_EQ(whole, pieces);
+}
+
+TEST_F(RandomTest, UniformRangeAndMean) {
+    std::vector<int> values(100000);
+    ibp::imgproc::uniformNoise(ibp::imgproc::randomStreamKey(7), 0, values.size(), 10, values.data());
+    double sum = 0.;
+    int minimum = 0, maximum = 0;
+    for (int v : values) {
+        sum += v;
+        minimum = std::min(minimum, v);
+        maximum = std::max(maximum, v);
+    }
+    EXPECT_EQ(minimum, -10);
+    EXPECT_EQ(maximum, 10);
+    EXPECT_NEAR(sum / values.size(), 0., .1);
+}
+
+TEST_F(RandomTest, GaussianMoments) {
+    std::vector<float> values(100000);
+    ibp::imgproc::gaussianNoise(ibp::imgproc::randomStreamKey(7), 0, values.size(), values.data());
+    double sum = 0., sumSq = 0.;
+    for (float v : values) {
+        ASSERT_TRUE(std::isfinite(v));
+        sum += v;
+        sumSq += v * v;
+    }
+    EXPECT_NEAR(sum / values.size(), 0., .02);
+    EXPECT_NEAR(sumSq / values.size(), 1., .02);
+}
+
+} // namespace test
+} // namespace ibp
@@ -0,0 +1,189 @@
+// this_file: tests/imgproc/test_resampling.cpp
+
+#include "../test_utils.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/photo.hpp>
+#include <ibp/imgproc/resampling.h>
+
+namespace ibp {
+namespace test {
+
+class ResamplingTest : public ImageProcessingTest {
+protected:
+    void SetUp() override {
+        ImageProcessingTest::SetUp();
+        src = cv::Mat(301, 413, CV_8UC4);
+        cv::randu(src, cv::Scalar::all(0), cv::Scalar::all(256));
+    }
+
+    // Lanczos weights of dst index d, the kernel widened by the ratio when shrinking, in double precision
+    static void referenceWeights(int srcSize, int dstSize, int d, std::vector<int> & indices,
+                                 std::vector<double> & weights) {
+        const double ratio = (double)srcSize / dstSize, scale = std::max(1., ratio);
+        const double center = (d + .5) * ratio - .5;
+        double sum = 0.;
+        indices.clear();
+        weights.clear();
+        for (int i = (int)std::ceil(center - 3. * scale); i <= (int)std::floor(center + 3. * scale); i++) {
+            const double x = (i - center) / scale, px = CV_PI * x;
+            const double w = x == 0. ? 1. :
+                             std::fabs(x) >= 3. ? 0. : 3. * std::sin(px) * std::sin(px / 3.) / (px * px);
+            indices.push_back(std::min(std::max(i, 0), srcSize - 1));
+            weights.push_back(w);
+            sum += w;
+        }
+        for (double & w : weights)
+            w /= sum;
+    }
+
+    // the separable filter lanczosResize rounds to fixed point, computed in double and rounded once
+    static cv::Mat reference(const cv::Mat & src, cv::Size dsize) {
+        std::vector<int> indices;
+        std::vector<double> weights;
+        cv::Mat rows(src.rows, dsize.width, CV_64FC4), dst(dsize, CV_8UC4);
+        for (int x = 0; x < dsize.width; x++) {
+            referenceWeights(src.cols, dsize.width, x, indices, weights);
+            for (int y = 0; y < src.rows; y++) {
+                cv::Vec4d sum(0., 0., 0., 0.);
+                for (size_t k = 0; k < indices.size(); k++)
+                    sum += cv::Vec4d(src.at<cv::Vec4b>(y, indices[k])) * weights[k];
+                rows.at<cv::Vec4d>(y, x) = sum;
+            }
+        }
+        for (int y = 0; y < dsize.height; y++) {
+            referenceWeights(src.rows, dsize.height, y, indices, weights);
+            for (int x = 0; x < dsize.width; x++) {
+                cv::Vec4d sum(0., 0., 0., 0.);
+                for (size_t k = 0; k < indices.size(); k++)
+                    sum += rows.at<cv::Vec4d>(indices[k], x) * weights[k];
+                for (int c = 0; c < 4; c++)
+                    dst.at<cv::Vec4b>(y, x)[c] = cv::saturate_cast<unsigned char>(sum[c]);
+            }
+        }
+        return dst;
+    }
+
+    cv::Mat src;
+};
+
+TEST_F(ResamplingTest, FlatImageStaysFlat) {
+    cv::Mat flat(src.size(), CV_8UC4, cv::Scalar(10, 80, 160, 255)), dst;
+    imgproc::lanczosResize(flat, dst, cv::Size(37, 29));
+    ASSERT_EQ(dst.size(), cv::Size(37, 29));
+    EXPECT_EQ(cv::norm(dst, cv::Mat(dst.size(), CV_8UC4, cv::Scalar(10, 80, 160, 255)), cv::NORM_INF), 0.);
+}
+
+TEST_F(ResamplingTest, DownscaleAveragesLikeArea) {
+    // a widened kernel averages all source pixels, so large downscales of noise stay close to the area average
+    cv::Mat dst, area;
+    imgproc::lanczosResize(src, dst, cv::Size(src.cols / 8, src.rows / 8));
+    cv::resize(src, area, dst.size(), 0, 0, cv::INTER_AREA);
+    EXPECT_LT(cv::norm(dst, area, cv::NORM_L1) / dst.total() / 4, 8.);
+}
+
+TEST_F(ResamplingTest, DownscaleMatchesFloatReference) {
+    // measured against the unrounded reference: 0.54 at worst, the fixed point weights only add rounding
+    for (cv::Size dsize : {cv::Size(206, 150), cv::Size(137, 100), cv::Size(51, 37), cv::Size(413, 100)}) {
+        cv::Mat dst;
+        imgproc::lanczosResize(src, dst, dsize);
+        EXPECT_LE(cv::norm(dst, reference(src, dsize), cv::NORM_INF), 1.) << dsize;
+    }
+}
+
+TEST_F(ResamplingTest, SmallRatiosMatchOpenCV) {
+    cv::Mat dst, expected;
+    imgproc::lanczosResize(src, dst, cv::Size(300, 400));
+    cv::resize(src, expected, cv::Size(300, 400), 0, 0, cv::INTER_LANCZOS4);
+    EXPECT_EQ(cv::norm(dst, expected, cv::NORM_INF), 0.);
+}
+
+TEST_F(ResamplingTest, WritesIntoExistingMemory) {
+    cv::Mat buffer(20, 30, CV_8UC4), dst = buffer;
+    imgproc::lanczosResize(src, dst, cv::Size(30, 20));
+    EXPECT_EQ(dst.data, buffer.data);
+}
+
+// flat lightness of 200 with a dark disk of 30, and the mask of the disk, as Inpainting IIH Correction finds it
+static void maskedBlob(cv::Mat & lightness, cv::Mat & mask) {
+    lightness = cv::Mat(900, 1200, CV_8UC1, cv::Scalar(200));
+    mask = cv::Mat::zeros(lightness.size(), CV_8UC1);
+    cv::circle(lightness, cv::Point(500, 400), 120, cv::Scalar(30), -1);
+    cv::circle(mask, cv::Point(500, 400), 120, cv::Scalar(255), -1);
+}
+
+TEST_F(ResamplingTest, MaskedAreaResizeAveragesTheBackground) {
+    cv::Mat lightness, mask, dst, dstMask;
+    maskedBlob(lightness, mask);
+    imgproc::maskedAreaResize(lightness, mask, dst, dstMask, cv::Size(256, 192));
+    ASSERT_EQ(dst.size(), cv::Size(256, 192));
+    EXPECT_EQ(dstMask.at<uchar>(85, 107), 255);
+    EXPECT_EQ(dstMask.at<uchar>(10, 10), 0);
+    // the pixels left out of the mask are the background alone, even across the border of the disk
+    double minimum, maximum;
+    cv::minMaxLoc(dst, &minimum, &maximum, 0, 0, dstMask == 0);
+    EXPECT_EQ(minimum, 200.);
+    EXPECT_EQ(maximum, 200.);
+}
+
+TEST_F(ResamplingTest, DownscaledInpaintingDoesNotBleed) {
+    // the downscaled path of Inpainting IIH Correction: the background estimate over and around the disk must not
+    // take its darkness, as the plain area resize did (down to 107). cv::INPAINT_TELEA overshoots flat regions by
+    // about 10 levels
+    cv::Mat lightness, mask, small, smallMask, inpainted, estimate;
+    maskedBlob(lightness, mask);
+    imgproc::maskedAreaResize(lightness, mask, small, smallMask, cv::Size(256, 192));
+    cv::inpaint(small, smallMask, inpainted, 1, cv::INPAINT_TELEA);
+    imgproc::jointBilateralUpsample(inpainted, small, lightness, estimate, smallMask, mask);
+    ASSERT_EQ(estimate.size(), lightness.size());
+    double minimum, maximum;
+    cv::minMaxLoc(estimate, &minimum, &maximum);
+    EXPECT_GE(minimum, 199.);
+    EXPECT_LE(maximum, 215.);
+}
+
+TEST_F(ResamplingTest, JointBilateralUpsampleLeavesTheMaskOutOfTheRange) {
+    // the downscaled path of Inpainting IIH Correction over a page lit at 200 with a shadow of 110 from column 603,
+    // and masked strokes of half its lightness, one far from the shadow and one right beside it. Guided by the
+    // inpainted estimate and the strokes, the stroke beside the shadow takes its values (down to 115). Leaving the
+    // masked pixels out of the range weights, it only takes the blur of the small size (down to 162)
+    cv::Mat illumination(900, 1200, CV_8UC1, cv::Scalar(200)), strokes = cv::Mat::zeros(900, 1200, CV_8UC1);
+    illumination.colRange(603, 1200).setTo(cv::Scalar(110));
+    strokes(cv::Rect(300, 200, 40, 500)).setTo(cv::Scalar(255));
+    strokes(cv::Rect(560, 200, 40, 500)).setTo(cv::Scalar(255));
+    cv::Mat lightness = illumination.clone(), halved = illumination / 2;
+    halved.copyTo(lightness, strokes);
+
+    cv::Mat small, smallMask, inpainted, estimate, unmasked;
+    imgproc::maskedAreaResize(lightness, strokes, small, smallMask, cv::Size(256, 192));
+    cv::inpaint(small, smallMask, inpainted, 1, cv::INPAINT_TELEA);
+    imgproc::jointBilateralUpsample(inpainted, small, lightness, estimate, smallMask, strokes);
+    imgproc::jointBilateralUpsample(inpainted, inpainted, lightness, unmasked);
+
+    const cv::Rect farStroke(300, 200, 40, 500), nearStroke(560, 200, 40, 500);
+    cv::Mat error, unmaskedError;
+    cv::subtract(estimate, illumination, error, cv::noArray(), CV_32S);
+    cv::subtract(unmasked, illumination, unmaskedError, cv::noArray(), CV_32S);
+    double minimum, maximum;
+    cv::minMaxLoc(error(farStroke), &minimum, &maximum);
+    EXPECT_GE(minimum, 0.);
+    EXPECT_LE(maximum, 2.);
+    cv::minMaxLoc(error(nearStroke), &minimum, &maximum);
+    EXPECT_GE(minimum, -40.);
+    EXPECT_LE(maximum, 2.);
+    cv::minMaxLoc(unmaskedError(nearStroke), &minimum, &maximum);
+    EXPECT_LE(minimum, -80.);
+}
+
+TEST_F(ResamplingTest, JointBilateralUpsampleOfUnlikeGuideIsSpatial) {
+    // where the guide is unlike every src pixel, the range weights all hit their floor, so a flat src stays flat
+    cv::Mat small(20, 30, CV_8UC1, cv::Scalar(180)), guide(80, 120, CV_8UC1, cv::Scalar(0)), dst;
+    imgproc::jointBilateralUpsample(small, small, guide, dst);
+    EXPECT_EQ(cv::norm(dst, cv::Mat(guide.size(), CV_8UC1, cv::Scalar(180)), cv::NORM_INF), 0.);
+}
+
+} // namespace test
+} // namespace ibp
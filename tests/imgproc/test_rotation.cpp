@@ -0,0 +1,60 @@
+// this_file: tests/imgproc/test_rotation.cpp
+
+#include "../test_utils.h"
+#include <gtest/gtest.h>
+#include <opencv2/core.hpp>
+#include <ibp/imgproc/rotation.h>
+
+namespace ibp {
+namespace test {
+
+class RotationTest : public ImageProcessingTest {
+protected:
+    void SetUp() override {
+        ImageProcessingTest::SetUp();
+        // sizes that are not multiples of the tiles nor of the SSE2 blocks
+        src = cv::Mat(77, 101, CV_8UC4);
+        cv::randu(src, cv::Scalar::all(0), cv::Scalar::all(256));
+    }
+
+    static const imgproc::BGRA * pixels(const cv::Mat & m) {
+        return (const imgproc::BGRA *)m.data;
+    }
+
+    static imgproc::BGRA * pixels(cv::Mat & m) {
+        return (imgproc::BGRA *)m.data;
+    }
+
+    cv::Mat src;
+};
+
+TEST_F(RotationTest, Rotate90MatchesOpenCV) {
+    cv::Mat dst(src.cols, src.rows, CV_8UC4), expected;
+
+    imgproc::rotatePixels90(pixels(src), pixels(dst), src.cols, src.rows, true);
+    cv::rotate(src, expected, cv::ROTATE_90_CLOCKWISE);
+    EXPECT_EQ(cv::norm(expected, dst, cv::NORM_INF), 0.);
+
+    imgproc::rotatePixels90(pixels(src), pixels(dst), src.cols, src.rows, false);
+    cv::rotate(src, expected, cv::ROTATE_90_COUNTERCLOCKWISE);
+    EXPECT_EQ(cv::norm(expected, dst, cv::NORM_INF), 0.);
+}
+
+TEST_F(RotationTest, FlipMatchesOpenCV) {
+    // horizontally, vertically and both, as the flip codes of OpenCV
+    const int flipCodes[] = { 1, 0, -1 };
+    for (int flipCode : flipCodes) {
+        const bool horizontally = flipCode != 0, vertically = flipCode <= 0;
+        cv::Mat expected, dst(src.size(), CV_8UC4), inPlace = src.clone();
+        cv::flip(src, expected, flipCode);
+
+        imgproc::flipPixels(pixels(src), pixels(dst), src.cols, src.rows, horizontally, vertically);
+        EXPECT_EQ(cv::norm(expected, dst, cv::NORM_INF), 0.) << flipCode;
+
+        imgproc::flipPixels(pixels(inPlace), pixels(inPlace), src.cols, src.rows, horizontally, vertically);
+        EXPECT_EQ(cv::norm(expected, inPlace, cv::NORM_INF), 0.) << flipCode;
+    }
+}
+
+} // namespace test
+} // namespace ibp
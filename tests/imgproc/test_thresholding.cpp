@@ -0,0 +1,94 @@
+// this_file: tests/imgproc/test_thresholding.cpp
+
+#include "../test_utils.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <opencv2/imgproc.hpp>
+#include <ibp/imgproc/thresholding.h>
+#include <ibp/imgproc/util.h>
+
+namespace ibp {
+namespace test {
+
+class ThresholdingTest : public ImageProcessingTest {
+protected:
+    void SetUp() override {
+        ImageProcessingTest::SetUp();
+        src = cv::Mat(67, 93, CV_8UC1);
+        cv::randu(src, cv::Scalar::all(0), cv::Scalar::all(256));
+    }
+
+    // Sauvola's threshold over the clamped window of every pixel, summed directly
+    static cv::Mat bruteForce(const cv::Mat & src, int blockSize, double k) {
+        const int radius = blockSize / 2;
+        cv::Mat dst(src.size(), CV_8UC1);
+        for (int y = 0; y < src.rows; y++) {
+            for (int x = 0; x < src.cols; x++) {
+                long long sum = 0, sumSq = 0, n = 0;
+                for (int wy = std::max(0, y - radius); wy <= std::min(src.rows - 1, y + radius); wy++) {
+                    for (int wx = std::max(0, x - radius); wx <= std::min(src.cols - 1, x + radius); wx++) {
+                        const int v = src.at<unsigned char>(wy, wx);
+                        sum += v;
+                        sumSq += v * v;
+                        n++;
+                    }
+                }
+                const int mean = (int)(sum / n);
+                const int variance = (int)(sumSq / (double)n - mean * mean);
+                dst.at<unsigned char>(y, x) =
+                        src.at<unsigned char>(y, x) < mean * (1. + k * (std::sqrt((double)variance) / 128. - 1.)) ?
+                            0 : 255;
+            }
+        }
+        return dst;
+    }
+
+    cv::Mat src;
+};
+
+TEST_F(ThresholdingTest, AdaptiveMatchesBruteForce) {
+    const int blockSizes[] = { 3, 21, 51, 201 };
+    for (int blockSize : blockSizes) {
+        cv::Mat dst;
+        ibp::imgproc::adaptiveThresholdIntegral(src, dst, blockSize, .05);
+        EXPECT_EQ(cv::norm(bruteForce(src, blockSize, .05), dst, cv::NORM_INF), 0.) << blockSize;
+    }
+}
+
+TEST_F(ThresholdingTest, AdaptiveInPlace) {
+    cv::Mat expected = bruteForce(src, 21, .2), dst = src.clone();
+    ibp::imgproc::adaptiveThresholdIntegral(dst, dst, 21, .2);
+    EXPECT_EQ(cv::norm(expected, dst, cv::NORM_INF), 0.);
+}
+
+TEST_F(ThresholdingTest, ChannelsReachTheirPlanes) {
+    cv::Mat image(src.size(), CV_8UC4), planes[4];
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::split(image, planes);
+    const auto invert = [](cv::Mat & plane) { cv::bitwise_not(plane, plane); };
+
+    // red and alpha in RGB mode, the luma flag is ignored
+    const bool redAndAlpha[5] = { true, true, false, false, true };
+    cv::Mat dst = image.clone(), dstPlanes[4];
+    ibp::imgproc::thresholdChannels(dst, false, redAndAlpha, invert);
+    cv::split(dst, dstPlanes);
+    EXPECT_EQ(cv::norm(planes[0], dstPlanes[0], cv::NORM_INF), 0.);
+    EXPECT_EQ(cv::norm(planes[1], dstPlanes[1], cv::NORM_INF), 0.);
+    EXPECT_EQ(cv::norm(~planes[2], dstPlanes[2], cv::NORM_INF), 0.);
+    EXPECT_EQ(cv::norm(~planes[3], dstPlanes[3], cv::NORM_INF), 0.);
+
+    // the luma goes to B, G and R in luma mode, the colour flags are ignored
+    const bool lumaAndRed[5] = { true, true, false, false, false };
+    dst = image.clone();
+    ibp::imgproc::thresholdChannels(dst, true, lumaAndRed, invert);
+    cv::split(dst, dstPlanes);
+    EXPECT_EQ(cv::norm(dstPlanes[0], dstPlanes[1], cv::NORM_INF), 0.);
+    EXPECT_EQ(cv::norm(dstPlanes[0], dstPlanes[2], cv::NORM_INF), 0.);
+    EXPECT_EQ(cv::norm(planes[3], dstPlanes[3], cv::NORM_INF), 0.);
+    const ibp::imgproc::BGRA pixel = image.at<ibp::imgproc::BGRA>(5, 7);
+    EXPECT_EQ(dst.at<ibp::imgproc::BGRA>(5, 7).b, 255 - IBP_pixelIntensity4(pixel.r, pixel.g, pixel.b));
+}
+
+} // namespace test
+} // namespace ibp
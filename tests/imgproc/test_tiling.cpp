@@ -0,0 +1,161 @@
+// this_file: tests/imgproc/test_tiling.cpp
+
+#include "../test_utils.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cmath>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/photo.hpp>
+#include <opencv2/ximgproc.hpp>
+#include <opencv2/xphoto.hpp>
+#include <ibp/imgproc/tiling.h>
+
+namespace ibp {
+namespace test {
+
+class TilingTest : public ImageProcessingTest {
+protected:
+    void SetUp() override {
+        ImageProcessingTest::SetUp();
+        src = cv::Mat(77, 100, CV_8UC3);
+        cv::randu(src, cv::Scalar::all(0), cv::Scalar::all(256));
+    }
+
+    // smooth colour waves with a fine pattern on top, for the edge-preserving filters
+    static cv::Mat texturedImage() {
+        cv::Mat image(300, 400, CV_8UC3);
+        for (int y = 0; y < image.rows; y++) {
+            for (int x = 0; x < image.cols; x++) {
+                for (int c = 0; c < 3; c++) {
+                    image.at<cv::Vec3b>(y, x)[c] = cv::saturate_cast<uchar>(
+                        128. + 90. * std::sin(x * .03 + c) * std::cos(y * .05 + c) +
+                        (x * 7 + y * 13 + c * 5) % 41 - 20);
+                }
+            }
+        }
+        return image;
+    }
+
+    cv::Mat src;
+};
+
+TEST_F(TilingTest, GrownTilesMatchWholeImage) {
+    const int radius = 4;
+    cv::Mat expected, dst(src.size(), src.type());
+    cv::blur(src, expected, cv::Size(2 * radius + 1, 2 * radius + 1));
+
+    EXPECT_TRUE(ibp::imgproc::parallelForTiles(src, dst, 32, radius, [&](const cv::Mat & tile, cv::Mat & out) {
+        // a copy, so the blur cannot read past the tile
+        cv::blur(tile.clone(), out, cv::Size(2 * radius + 1, 2 * radius + 1));
+    }));
+    EXPECT_EQ(cv::norm(expected, dst, cv::NORM_INF), 0.);
+}
+
+TEST_F(TilingTest, StopsWhenCancelled) {
+    std::atomic<int> nTiles(0);
+    cv::Mat dst(src.size(), src.type());
+
+    EXPECT_FALSE(ibp::imgproc::parallelForTiles(src, dst, 4, 0, [&](const cv::Mat & tile, cv::Mat & out) {
+        nTiles++;
+        out = tile.clone();
+    }, [&]() { return nTiles.load() > 0; }));
+    EXPECT_LT(nTiles.load(), 25 * 20);
+}
+
+TEST_F(TilingTest, BlendedTilesOfTheSameImageMatchIt) {
+    cv::Mat dst(src.size(), src.type());
+    EXPECT_TRUE(ibp::imgproc::parallelForBlendedTiles(src, dst, 20, 3, 8, [](const cv::Mat & tile, cv::Mat & out) {
+        out = tile.clone();
+    }));
+    EXPECT_EQ(cv::norm(src, dst, cv::NORM_INF), 0.);
+}
+
+TEST_F(TilingTest, BudgetedTilesShrinkWithTheMemory) {
+    const int large = ibp::imgproc::budgetedTileSize(10, 32.);
+    const int small = ibp::imgproc::budgetedTileSize(10, 1024.);
+    EXPECT_LT(small, large);
+    EXPECT_GE(small, ibp::imgproc::kMinimumTileSize);
+    EXPECT_EQ(ibp::imgproc::budgetedTileSize(10, 1e12), ibp::imgproc::kMinimumTileSize);
+}
+
+// The tiles and margins of the edge-preserving plugins against the filters on the whole image. Differences were
+// measured with OpenCV 5.0 on this image: none for the guided filter and DCT denoising, 1 level at most for the
+// domain transform, whatever its margin (its float box sums round differently from the tile border), and 4 at
+// most (0.31 on average) for the adaptive manifolds with large sigmas
+TEST_F(TilingTest, GuidedFilterTilesMatchWholeImage) {
+    const cv::Mat image = texturedImage();
+    const int radius = 5;
+    const double eps = 1020.;
+    cv::Mat expected, dst(image.size(), image.type());
+    cv::ximgproc::guidedFilter(image, image, expected, radius, eps);
+    EXPECT_TRUE(ibp::imgproc::parallelForTiles(image, dst, 96, 2 * radius, [&](const cv::Mat & tile, cv::Mat & out) {
+        cv::ximgproc::guidedFilter(tile, tile, out, radius, eps);
+    }));
+    EXPECT_EQ(cv::norm(expected, dst, cv::NORM_INF), 0.);
+}
+
+TEST_F(TilingTest, DCTDenoisingTilesMatchWholeImage) {
+    const cv::Mat image = texturedImage();
+    const int patchSize = 16;
+    cv::Mat expected(image.size(), image.type()), dst(image.size(), image.type());
+    cv::xphoto::dctDenoising(image, expected, 20., patchSize);
+    EXPECT_TRUE(ibp::imgproc::parallelForTiles(image, dst, 96, patchSize, [&](const cv::Mat & tile, cv::Mat & out) {
+        out.create(tile.size(), tile.type());
+        cv::xphoto::dctDenoising(tile, out, 20., patchSize);
+    }));
+    EXPECT_EQ(cv::norm(expected, dst, cv::NORM_INF), 0.);
+}
+
+TEST_F(TilingTest, NLMDenoisingTilesMatchWholeImage) {
+    // the windows and filter strengths of imagefilter_nlmdenoising for strengths of 10 and 40. One pixel less of
+    // margin already differs, by 4 to 7 levels
+    cv::Mat image = texturedImage(), noise(image.size(), CV_16SC3);
+    cv::RNG rng(7);
+    rng.fill(noise, cv::RNG::NORMAL, 0., 20.);
+    cv::add(image, noise, image, cv::noArray(), CV_8UC3);
+    const struct { float h, hColor; int templateWindowSize, searchWindowSize; } settings[] = {
+        { 4.f, 5.5f, 3, 21 }, { 14.f, 16.f, 7, 35 } };
+    for (const auto & p : settings) {
+        const int margin = p.searchWindowSize / 2 + p.templateWindowSize / 2;
+        cv::Mat expected, dst(image.size(), image.type());
+        cv::fastNlMeansDenoisingColored(image, expected, p.h, p.hColor, p.templateWindowSize, p.searchWindowSize);
+        EXPECT_TRUE(ibp::imgproc::parallelForTiles(image, dst, 96, margin, [&](const cv::Mat & tile, cv::Mat & out) {
+            cv::fastNlMeansDenoisingColored(tile, out, p.h, p.hColor, p.templateWindowSize, p.searchWindowSize);
+        }));
+        EXPECT_EQ(cv::norm(expected, dst, cv::NORM_INF), 0.) << "search window = " << p.searchWindowSize;
+    }
+}
+
+TEST_F(TilingTest, DomainTransformTilesStayClose) {
+    const cv::Mat image = texturedImage();
+    for (double radius : {10., 30.}) {
+        const double sigmaS = (radius + .5) / 2.45, sigmaR = 102.;
+        const int margin = (int)std::ceil(4.6 * sigmaS);
+        cv::Mat expected, dst(image.size(), image.type());
+        cv::ximgproc::dtFilter(image, image, expected, sigmaS, sigmaR);
+        EXPECT_TRUE(ibp::imgproc::parallelForTiles(image, dst, 96, margin, [&](const cv::Mat & tile, cv::Mat & out) {
+            cv::ximgproc::dtFilter(tile, tile, out, sigmaS, sigmaR);
+        }));
+        EXPECT_LE(cv::norm(expected, dst, cv::NORM_INF), 2.) << "radius = " << radius;
+        EXPECT_LE(cv::norm(expected, dst, cv::NORM_L1) / dst.total() / 3, .01) << "radius = " << radius;
+    }
+}
+
+TEST_F(TilingTest, AdaptiveManifoldBlendedTilesStayClose) {
+    const cv::Mat image = texturedImage();
+    for (double radius : {5., 20.}) {
+        const double sigmaS = (radius + .5) / 2.45 + 1., sigmaR = radius < 10. ? .5 : .2;
+        const int margin = (int)std::ceil(4. * sigmaS);
+        cv::Mat expected, dst(image.size(), image.type());
+        cv::ximgproc::amFilter(image, image, expected, sigmaS, sigmaR, true);
+        EXPECT_TRUE(ibp::imgproc::parallelForBlendedTiles(image, dst, 128, margin, margin,
+                                                          [&](const cv::Mat & tile, cv::Mat & out) {
+            cv::ximgproc::amFilter(tile, tile, out, sigmaS, sigmaR, true);
+        }));
+        EXPECT_LE(cv::norm(expected, dst, cv::NORM_INF), 6.) << "radius = " << radius;
+        EXPECT_LE(cv::norm(expected, dst, cv::NORM_L1) / dst.total() / 3, .5) << "radius = " << radius;
+    }
+}
+
+} // namespace test
+} // namespace ibp
@@ -0,0 +1,59 @@
+// this_file: tests/imgproc/test_tvdenoising.cpp
+
+#include "../test_utils.h"
+#include <gtest/gtest.h>
+#include <opencv2/imgproc.hpp>
+#include <ibp/imgproc/tvdenoising.h>
+
+namespace ibp {
+namespace test {
+
+class TVDenoisingTest : public ImageProcessingTest {
+protected:
+    void SetUp() override {
+        ImageProcessingTest::SetUp();
+        // two flat halves and a disk, with gaussian noise
+        clean = cv::Mat(120, 160, CV_8UC1, cv::Scalar(60));
+        clean.colRange(80, 160).setTo(cv::Scalar(180));
+        cv::circle(clean, cv::Point(100, 60), 30, cv::Scalar(230), -1);
+        cv::Mat noise(clean.size(), CV_16SC1);
+        cv::randn(noise, cv::Scalar::all(0), cv::Scalar::all(20));
+        clean.convertTo(noisy, CV_16SC1);
+        noisy += noise;
+        noisy.convertTo(noisy, CV_8UC1);
+    }
+
+    cv::Mat clean, noisy;
+};
+
+TEST_F(TVDenoisingTest, FlatImageStaysFlat) {
+    cv::Mat flat(clean.size(), CV_8UC1, cv::Scalar(77)), dst;
+    imgproc::denoiseTVL1(flat, dst, .5, 30);
+    ASSERT_EQ(dst.type(), CV_8UC1);
+    ASSERT_EQ(dst.size(), flat.size());
+    EXPECT_EQ(cv::norm(dst, flat, cv::NORM_INF), 0.);
+}
+
+TEST_F(TVDenoisingTest, RemovesNoise) {
+    cv::Mat dst;
+    imgproc::denoiseTVL1(noisy, dst, 1., 100);
+    EXPECT_LT(cv::norm(dst, clean, cv::NORM_L2SQR), cv::norm(noisy, clean, cv::NORM_L2SQR) / 5.);
+}
+
+TEST_F(TVDenoisingTest, MultiscaleIsCloseToTheConvergedSolution) {
+    cv::Mat converged, multiscale;
+    imgproc::denoiseTVL1(noisy, converged, 1., 1000, 1, 0.);
+    imgproc::denoiseTVL1(noisy, multiscale, 1., 100);
+    EXPECT_LT(cv::norm(converged, multiscale, cv::NORM_L1) / converged.total(), 2.);
+}
+
+TEST_F(TVDenoisingTest, StopsOnceTheChangeIsBelowTheTolerance) {
+    // no iteration changes x by a mean of 1 or more, so the first one is the last
+    cv::Mat a, b;
+    imgproc::denoiseTVL1(noisy, a, 1., 50, 1, 1.);
+    imgproc::denoiseTVL1(noisy, b, 1., 1, 1, 0.);
+    EXPECT_EQ(cv::norm(a, b, cv::NORM_INF), 0.);
+}
+
+} // namespace test
+} // namespace ibp
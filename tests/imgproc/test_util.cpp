@@ -2,6 +2,9 @@
 
 #include "../test_utils.h"
 #include <gtest/gtest.h>
+#include <QVector>
+#include <cstring>
+#include <ibp/imgproc/util.h>
 
 namespace ibp {
 namespace test {
@@ -117,5 +120,113 @@ TEST_F(UtilTest, EdgeCases) {
     EXPECT_TRUE(emptyRect.isEmpty());
 }
 
+TEST_F(UtilTest, ArithmeticKernelsMatchLookupTables) {
+    using namespace ibp::imgproc;
+
+    for (int a = 0; a < 256; a++) {
+        for (int b = 0; b < 256; b++) {
+            ASSERT_EQ(normalizedMultiply(a, b), lut01[a][b]) << a << " " << b;
+            ASSERT_EQ(normalizedDivide(a, b), lut02[a][b]) << a << " " << b;
+            ASSERT_EQ(normalizedScreen(a, b), lut03[a][b]) << a << " " << b;
+        }
+    }
+}
+
+TEST_F(UtilTest, SpanKernelsMatchPixelMacros) {
+    using namespace ibp::imgproc;
+
+    // Odd length so that the scalar tail runs too
+    const int n = 256 * 256 + 3;
+    QVector<BGRA> pixels(n), premultiplied(n), expected(n);
+    QVector<unsigned char> a(n), b(n), product(n);
+    for (int i = 0; i < n; i++) {
+        pixels[i].b = (i * 7) & 255;
+        pixels[i].g = (i * 13) & 255;
+        pixels[i].r = i & 255;
+        pixels[i].a = (i >> 8) & 255;
+        a[i] = i & 255;
+        b[i] = (i >> 8) & 255;
+    }
+
+    normalizedMultiply(a.constData(), b.constData(), product.data(), n);
+    for (int i = 0; i < n; i++)
+        ASSERT_EQ(product[i], lut01[a[i]][b[i]]) << i;
+
+    premultiplied = pixels;
+    premultiplyBGRA(premultiplied.data(), n);
+    for (int i = 0; i < n; i++) {
+        BGRA p = pixels[i];
+        IBP_premultiplyBGRA(p);
+        ASSERT_EQ(memcmp(&p, &premultiplied[i], sizeof(BGRA)), 0) << i;
+    }
+
+    expected = premultiplied;
+    postmultiplyBGRA(premultiplied.data(), n);
+    for (int i = 0; i < n; i++) {
+        BGRA p = expected[i];
+        IBP_postmultiplyBGRA(p);
+        ASSERT_EQ(memcmp(&p, &premultiplied[i], sizeof(BGRA)), 0) << i;
+    }
+}
+
+TEST_F(UtilTest, PremultipliedAlphaConversions) {
+    using namespace ibp::imgproc;
+
+    QImage image(16, 16, QImage::Format_ARGB32);
+    image.fill(QColor(200, 100, 50, 255));
+    image.setPixelColor(0, 0, QColor(200, 100, 50, 128));
+
+    QImage premultiplied = convertToPremultipliedAlpha(image);
+    EXPECT_EQ(premultiplied.format(), QImage::Format_ARGB32_Premultiplied);
+    EXPECT_EQ(qRed(premultiplied.pixel(1, 1)), 200);
+    EXPECT_EQ(((const BGRA *)premultiplied.constBits())->r, lut01[200][128]);
+    // Already premultiplied images pass through
+    EXPECT_EQ(convertToPremultipliedAlpha(premultiplied).constBits(), premultiplied.constBits());
+
+    QImage straight = convertToStraightAlpha(premultiplied);
+    EXPECT_EQ(straight.format(), QImage::Format_ARGB32);
+    // Opaque pixels round trip exactly
+    EXPECT_EQ(straight.pixel(1, 1), image.pixel(1, 1));
+    EXPECT_EQ(qAlpha(straight.pixel(0, 0)), 128);
+}
+
+TEST_F(UtilTest, LumaPlaneMatchesPixelMacro) {
+    using namespace ibp::imgproc;
+
+    QVector<BGRA> pixels(4099);
+    for (int i = 0; i < pixels.size(); i++)
+    {
+        pixels[i].b = (i * 7) & 255;
+        pixels[i].g = (i * 13 + 5) & 255;
+        pixels[i].r = (i * 29 + 11) & 255;
+        pixels[i].a = (i * 3) & 255;
+    }
+    QVector<unsigned char> luma(pixels.size());
+    convertBGRAToLuma(pixels.constData(), luma.data(), pixels.size());
+
+    for (int i = 0; i < pixels.size(); i++)
+    {
+        ASSERT_EQ(luma[i], IBP_pixelLuma(pixels[i].r, pixels[i].g, pixels[i].b)) << "pixel " << i;
+        // IBP_pixelIntensity4 only differs on exact halves
+        ASSERT_LE(qAbs(luma[i] - IBP_pixelIntensity4(pixels[i].r, pixels[i].g, pixels[i].b)), 1);
+    }
+}
+
+TEST_F(UtilTest, ParallelForRowsCoversEveryRowOnce) {
+    using namespace ibp::imgproc;
+
+    QVector<int> visits(1000, 0);
+    parallelForRows(visits.size(), 7, [&](int startRow, int endRow) {
+        EXPECT_LE(endRow - startRow, 7);
+        for (int row = startRow; row < endRow; row++)
+            visits[row]++;
+    });
+    EXPECT_EQ(visits.count(1), visits.size());
+
+    int calls = 0;
+    parallelForRows(0, 7, [&](int, int) { calls++; });
+    EXPECT_EQ(calls, 0);
+}
+
 } // namespace test
 } // namespace ibp
\ No newline at end of file
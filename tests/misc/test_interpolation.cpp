@@ -2,6 +2,10 @@
 
 #include "../test_utils.h"
 #include <gtest/gtest.h>
+#include <cmath>
+#include <ibp/misc/cubicsplineinterpolator1D.h>
+#include <ibp/misc/linearsplineinterpolator1D.h>
+#include <ibp/misc/nearestneighborsplineinterpolator1D.h>
 
 namespace ibp {
 namespace test {
@@ -150,5 +154,60 @@ TEST_F(InterpolationTest, MonotonicData) {
     EXPECT_DOUBLE_EQ(interpolator.interpolate(2.5), 5.0);
 }
 
+TEST_F(InterpolationTest, BatchEvaluationMatchesPointEvaluation) {
+    using namespace ibp::misc;
+
+    Interpolator1D * interpolators[3] = {
+        new CubicSplineInterpolator1D(), new LinearSplineInterpolator1D(), new NearestNeighborSplineInterpolator1D()
+    };
+    QVector<double> x(300), y(300);
+    for (int i = 0; i < x.size(); i++)
+        x[i] = i / 199. - .25;
+    // unsorted tail, the batch must not assume ascending x
+    for (int i = 250; i < x.size(); i++)
+        x[i] = (i * 37 % 50) / 49.;
+
+    for (Interpolator1D * interpolator : interpolators)
+    {
+        interpolator->addKnot(0.1, 0.2);
+        interpolator->addKnot(0.4, 0.9);
+        interpolator->addKnot(0.7, 0.1);
+        interpolator->addKnot(0.9, 0.6);
+        interpolator->setExtrapolationMode(Interpolator1D::ExtrapolationMode_Mirror,
+                                           Interpolator1D::ExtrapolationMode_FollowTangent);
+        interpolator->evaluate(x.constData(), y.data(), x.size());
+        for (int i = 0; i < x.size(); i++)
+            EXPECT_DOUBLE_EQ(y[i], interpolator->f(x[i])) << "x = " << x[i];
+        delete interpolator;
+    }
+}
+
+TEST_F(InterpolationTest, BakedLUTFollowsCurveChanges) {
+    using namespace ibp::misc;
+
+    CubicSplineInterpolator1D interpolator;
+    interpolator.addKnot(0., 0.);
+    interpolator.addKnot(1., 1.);
+    unsigned char lut[256], invertedLUT[256];
+
+    bakeInterpolator1DLUT(&interpolator, lut);
+    bakeInterpolator1DLUT(&interpolator, invertedLUT, 256, true);
+    for (int i = 0; i < 256; i++)
+    {
+        EXPECT_EQ(lut[i], i);
+        EXPECT_EQ(invertedLUT[i], 255 - i);
+    }
+
+    // same knots, different curve: the memoised table must not be reused
+    interpolator.addKnot(.5, .75);
+    bakeInterpolator1DLUT(&interpolator, lut);
+    EXPECT_EQ(lut[128], (int)round(interpolator.f(128 / 255.) * 255.));
+    interpolator.setBoundaryConditions(CubicSplineInterpolator1D::BoundaryConditions_Copy,
+                                       CubicSplineInterpolator1D::BoundaryConditions_Copy);
+    bakeInterpolator1DLUT(&interpolator, lut);
+    for (int i = 0; i < 256; i++)
+        EXPECT_EQ(lut[i], qBound(0, (int)round(interpolator.f(i / 255.) * 255.), 255));
+}
+
 } // namespace test
 } // namespace ibp
\ No newline at end of file